@@ -132,6 +132,7 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 	/* static threads overwrite them afterwards with real values */
 	tcs->init_data = NULL;
 	tcs->fn_abort = NULL;
+	tcs->pended_mutex = NULL;
 #else
 	tcs->link = NULL;
 	tcs->flags = priority == -1 ? TASK | PREEMPTIBLE : FIBER;
@@ -139,6 +140,18 @@ void _new_thread(char *pStackMem, unsigned stackSize,
 #endif
 	tcs->prio = priority;
 
+#ifdef CONFIG_SCHED_DEADLINE
+	tcs->deadline = 0;
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	memset(&tcs->runtime_stats, 0, sizeof(tcs->runtime_stats));
+#endif
+
+#ifdef CONFIG_THREAD_STACK_USAGE
+	tcs->stack_size = stackSize;
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 
@@ -239,13 +239,30 @@ struct tcs {
 	atomic_t sched_locked;
 	void *init_data;
 	void (*fn_abort)(void);
+	struct k_mutex *pended_mutex; /* mutex the thread waits on */
+#endif
+#ifdef CONFIG_SCHED_DEADLINE
+	uint32_t deadline; /* absolute, in hardware clock cycles */
+#endif
+#ifdef CONFIG_SYS_CLOCK_HIRES
+	struct _hires_timeout hires_timeout; /* used by k_sleep_cycles() */
+#endif
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	struct k_thread_runtime_stats runtime_stats;
+#endif
+#ifdef CONFIG_THREAD_STACK_USAGE
+	/* size of the stack area, thread control structure included */
+	unsigned int stack_size;
 #endif
 };
 
 #ifdef CONFIG_KERNEL_V2
 struct ready_q {
 	struct k_thread *cache;
-	uint32_t prio_bmap[1];
+#if (K_NUM_PRIO_BITMAPS > 1)
+	uint32_t prio_bmap_summary;
+#endif
+	uint32_t prio_bmap[K_NUM_PRIO_BITMAPS];
 	sys_dlist_t q[K_NUM_PRIORITIES];
 };
 #endif
@@ -41,6 +41,8 @@ extern "C" {
 
 #ifndef _ASMLANGUAGE
 
+#include <string.h>
+
 extern void _firq_stack_setup(void);
 extern char _interrupt_stack[];
 
@@ -60,6 +62,11 @@ static ALWAYS_INLINE void _irq_setup(void)
 	nano_cpu_sleep_mode = _ARC_V2_WAKE_IRQ_LEVEL;
 	_arc_v2_aux_reg_write(_ARC_V2_AUX_IRQ_CTRL, aux_irq_ctrl_value);
 
+#ifdef CONFIG_INIT_STACKS
+	/* the kernel boots on a stack at the top of memory: safe to paint */
+	memset(_interrupt_stack, 0xaa, CONFIG_ISR_STACK_SIZE);
+#endif
+
 	_nanokernel.rirq_sp = _interrupt_stack + CONFIG_ISR_STACK_SIZE;
 	_firq_stack_setup();
 }
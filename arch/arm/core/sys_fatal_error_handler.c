@@ -33,8 +33,10 @@
 #ifdef CONFIG_PRINTK
 #include <misc/printk.h>
 #define PRINTK(...) printk(__VA_ARGS__)
+#define PRINTK_FLUSH() printk_flush()
 #else
 #define PRINTK(...)
+#define PRINTK_FLUSH()
 #endif
 
 #ifdef CONFIG_MICROKERNEL
@@ -89,6 +91,7 @@ void _SysFatalErrorHandler(unsigned int reason, const NANO_ESF * pEsf)
 			       ? "ISR"
 			       : NANO_CTX_FIBER == curCtx ? "essential fiber"
 							  : "essential task");
+		PRINTK_FLUSH();
 		for (;;)
 			; /* spin forever */
 	}
@@ -43,6 +43,8 @@ extern "C" {
 
 #else
 
+#include <string.h>
+
 extern char _interrupt_stack[CONFIG_ISR_STACK_SIZE];
 
 /**
@@ -51,6 +53,8 @@ extern char _interrupt_stack[CONFIG_ISR_STACK_SIZE];
  *
  * On Cortex-M, the interrupt stack is registered in the MSP (main stack
  * pointer) register, and switched to automatically when taking an exception.
+ * The kernel boots on a separate stack, so the interrupt stack can still be
+ * painted here when CONFIG_INIT_STACKS is enabled.
  *
  * @return N/A
  */
@@ -58,6 +62,10 @@ static ALWAYS_INLINE void _InterruptStackSetup(void)
 {
 	uint32_t msp = (uint32_t)(_interrupt_stack + CONFIG_ISR_STACK_SIZE);
 
+#ifdef CONFIG_INIT_STACKS
+	memset(_interrupt_stack, 0xaa, CONFIG_ISR_STACK_SIZE);
+#endif
+
 	_MspSet(msp);
 }
 
@@ -253,6 +253,7 @@ FUNC_NORETURN void _SysFatalErrorHandler(unsigned int reason,
 		       ? "ISR"
 		       : curCtx == NANO_CTX_FIBER ? "essential fiber"
 						  : "essential task");
+	printk_flush();
 #ifdef ALT_CPU_HAS_DEBUG_STUB
 	_nios2_break();
 #endif
@@ -101,6 +101,7 @@ void _new_thread(char *stack_memory, unsigned stack_size,
 	/* static threads overwrite it afterwards with real value */
 	tcs->init_data = NULL;
 	tcs->fn_abort = NULL;
+	tcs->pended_mutex = NULL;
 #else
 	if (priority == -1) {
 		tcs->flags = PREEMPTIBLE | TASK;
@@ -111,6 +112,18 @@ void _new_thread(char *stack_memory, unsigned stack_size,
 	tcs->link = (struct tcs *)NULL; /* thread not inserted into list yet */
 #endif /* CONFIG_KERNEL_V2 */
 
+#ifdef CONFIG_SCHED_DEADLINE
+	tcs->deadline = 0;
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	memset(&tcs->runtime_stats, 0, sizeof(tcs->runtime_stats));
+#endif
+
+#ifdef CONFIG_THREAD_STACK_USAGE
+	tcs->stack_size = stack_size;
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 	tcs->custom_data = NULL;
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <kernel.h>
+#include <arch/cpu.h>
+#include <nano_private.h>
+#include <misc/printk.h>
+#include <posix_core.h>
+
+const NANO_ESF _default_esf = {
+	0xdeadbaad
+};
+
+/**
+ *
+ * @brief Nanokernel fatal error handler
+ *
+ * This routine is called when a fatal error condition is detected by
+ * software. Faults of the host process, such as invalid memory accesses, are
+ * reported by the host.
+ *
+ * @param reason the reason that the handler was called
+ * @param esf pointer to the exception stack frame
+ *
+ * @return This function does not return.
+ */
+FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
+					  const NANO_ESF *esf)
+{
+#ifdef CONFIG_PRINTK
+	switch (reason) {
+	case _NANO_ERR_CPU_EXCEPTION:
+	case _NANO_ERR_SPURIOUS_INT:
+		break;
+
+	case _NANO_ERR_INVALID_TASK_EXIT:
+		printk("***** Invalid Exit Software Error! *****\n");
+		break;
+
+
+	case _NANO_ERR_ALLOCATION_FAIL:
+		printk("**** Kernel Allocation Failure! ****\n");
+		break;
+
+	default:
+		printk("**** Unknown Fatal Error %u! ****\n", reason);
+		break;
+	}
+
+	printk("Current thread ID: %p\n", k_current_get());
+#endif
+
+	_SysFatalErrorHandler(reason, esf);
+}
+
+/**
+ *
+ * @brief Fatal error handler
+ *
+ * This routine implements the corrective action to be taken when the system
+ * detects a fatal error.
+ *
+ * This sample implementation attempts to abort the current thread and allow
+ * the system to continue executing. When the thread is essential, or the
+ * error happened in an ISR, the host process exits with a failure status.
+ *
+ * @param reason the fatal error reason
+ * @param pEsf pointer to exception stack frame
+ *
+ * @return N/A
+ */
+FUNC_NORETURN void _SysFatalErrorHandler(unsigned int reason,
+					 const NANO_ESF *pEsf)
+{
+	nano_context_type_t curCtx = sys_execution_context_type_get();
+
+	ARG_UNUSED(reason);
+	ARG_UNUSED(pEsf);
+
+	if ((curCtx != NANO_CTX_ISR) && !_is_thread_essential()) {
+		printk("Fatal thread error! Aborting thread.\n");
+		k_thread_abort(_current);
+		CODE_UNREACHABLE;
+	}
+
+	printk("Fatal fault in %s ! Exiting...\n",
+	       curCtx == NANO_CTX_ISR
+		       ? "ISR"
+		       : curCtx == NANO_CTX_FIBER ? "essential fiber"
+						  : "essential task");
+	printk_flush();
+	posix_exit(1);
+}
@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief Host side of the POSIX architecture
+ *
+ * Each kernel thread is backed by a host thread. The host thread owning the
+ * CPU is the only one running kernel code: the others wait on their own
+ * condition variable until posix_thread_swap() gives them the CPU.
+ *
+ * The interrupt controller model is a pair of bit masks. Host threads
+ * modelling the hardware raise interrupts, and publish the pending and
+ * enabled ones in posix_irq_pending, which the thread owning the CPU polls.
+ *
+ * This file is built against the host C library. The minimal C library of the
+ * kernel is linked in the same executable, so the output goes through write()
+ * rather than stdio.
+ */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <posix_core.h>
+
+struct posix_thread {
+	pthread_t pthread;
+	pthread_cond_t cond;	/* signalled when given the CPU or aborted */
+	int aborted;
+	void (*entry)(void *);
+	void *arg;
+};
+
+static pthread_mutex_t cpu_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct posix_thread *cpu_owner;
+
+static pthread_mutex_t irq_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t irq_cond = PTHREAD_COND_INITIALIZER;
+static uint32_t irq_raised;
+static uint32_t irq_enabled;
+
+uint32_t posix_irq_pending;
+
+static void fatal(const char *msg)
+{
+	static const char prefix[] = "posix: ";
+
+	(void)write(2, prefix, sizeof(prefix) - 1);
+	(void)write(2, msg, strlen(msg));
+	(void)write(2, "\n", 1);
+	abort();
+}
+
+static struct posix_thread *thread_alloc(void)
+{
+	struct posix_thread *t = calloc(1, sizeof(*t));
+
+	if (!t || pthread_cond_init(&t->cond, NULL)) {
+		fatal("cannot allocate a thread");
+	}
+
+	return t;
+}
+
+/* called with cpu_lock held, which is released if the thread exits */
+static void wait_for_cpu(struct posix_thread *t)
+{
+	while (cpu_owner != t && !t->aborted) {
+		pthread_cond_wait(&t->cond, &cpu_lock);
+	}
+
+	if (t->aborted) {
+		pthread_mutex_unlock(&cpu_lock);
+		pthread_cond_destroy(&t->cond);
+		free(t);
+		pthread_exit(NULL);
+	}
+}
+
+static void *thread_start(void *arg)
+{
+	struct posix_thread *t = arg;
+
+	pthread_mutex_lock(&cpu_lock);
+	wait_for_cpu(t);
+	pthread_mutex_unlock(&cpu_lock);
+
+	t->entry(t->arg);
+
+	fatal("thread entry point returned");
+	return NULL;
+}
+
+void *posix_cpu_boot(void)
+{
+	struct posix_thread *t = thread_alloc();
+
+	t->pthread = pthread_self();
+
+	pthread_mutex_lock(&cpu_lock);
+	cpu_owner = t;
+	pthread_mutex_unlock(&cpu_lock);
+
+	return t;
+}
+
+void *posix_thread_create(void (*entry)(void *), void *arg)
+{
+	struct posix_thread *t = thread_alloc();
+	pthread_attr_t attr;
+
+	t->entry = entry;
+	t->arg = arg;
+
+	if (pthread_attr_init(&attr) ||
+	    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED) ||
+	    pthread_create(&t->pthread, &attr, thread_start, t)) {
+		fatal("cannot create a thread");
+	}
+	pthread_attr_destroy(&attr);
+
+	return t;
+}
+
+void posix_thread_swap(void *next, void *prev)
+{
+	struct posix_thread *n = next;
+
+	pthread_mutex_lock(&cpu_lock);
+
+	cpu_owner = n;
+	pthread_cond_signal(&n->cond);
+
+	wait_for_cpu(prev);
+
+	pthread_mutex_unlock(&cpu_lock);
+}
+
+void posix_thread_abort(void *thread)
+{
+	struct posix_thread *t = thread;
+
+	pthread_mutex_lock(&cpu_lock);
+
+	t->aborted = 1;
+	if (cpu_owner != t) {
+		pthread_cond_signal(&t->cond);
+	}
+
+	pthread_mutex_unlock(&cpu_lock);
+}
+
+void posix_exit(int status)
+{
+	exit(status);
+}
+
+/* called with irq_mutex held */
+static void irq_update(void)
+{
+	uint32_t pending = irq_raised & irq_enabled;
+
+	__atomic_store_n(&posix_irq_pending, pending, __ATOMIC_RELEASE);
+	if (pending) {
+		pthread_cond_signal(&irq_cond);
+	}
+}
+
+void posix_cpu_halt(void)
+{
+	pthread_mutex_lock(&irq_mutex);
+
+	while (!(irq_raised & irq_enabled)) {
+		pthread_cond_wait(&irq_cond, &irq_mutex);
+	}
+
+	pthread_mutex_unlock(&irq_mutex);
+}
+
+void posix_irq_raise(unsigned int irq)
+{
+	pthread_mutex_lock(&irq_mutex);
+	irq_raised |= 1u << irq;
+	irq_update();
+	pthread_mutex_unlock(&irq_mutex);
+}
+
+void posix_irq_enable(unsigned int irq)
+{
+	pthread_mutex_lock(&irq_mutex);
+	irq_enabled |= 1u << irq;
+	irq_update();
+	pthread_mutex_unlock(&irq_mutex);
+}
+
+void posix_irq_disable(unsigned int irq)
+{
+	pthread_mutex_lock(&irq_mutex);
+	irq_enabled &= ~(1u << irq);
+	irq_update();
+	pthread_mutex_unlock(&irq_mutex);
+}
+
+int posix_irq_is_enabled(unsigned int irq)
+{
+	int enabled;
+
+	pthread_mutex_lock(&irq_mutex);
+	enabled = !!(irq_enabled & (1u << irq));
+	pthread_mutex_unlock(&irq_mutex);
+
+	return enabled;
+}
+
+int posix_irq_next(void)
+{
+	uint32_t pending;
+	int irq = -1;
+
+	pthread_mutex_lock(&irq_mutex);
+
+	pending = irq_raised & irq_enabled;
+	if (pending) {
+		irq = __builtin_ffs(pending) - 1;
+		irq_raised &= ~(1u << irq);
+		irq_update();
+	}
+
+	pthread_mutex_unlock(&irq_mutex);
+
+	return irq;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief POSIX interrupt management code
+ *
+ * Interrupts are raised by host threads, and are taken by the thread owning
+ * the CPU when it unlocks interrupts or polls for them: an ISR never
+ * interrupts a thread in the middle of a kernel operation, and it runs on the
+ * host thread of the interrupted thread.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <arch/cpu.h>
+#include <irq.h>
+#include <misc/printk.h>
+#include <sw_isr_table.h>
+#include <misc/kernel_event_logger.h>
+#include <kernel_event_logger_arch.h>
+#include <ksched.h>
+#include <posix_core.h>
+
+extern int _is_next_thread_current(void);
+
+void _irq_spurious(void *unused);
+
+_IsrTableEntry_t _sw_isr_table[CONFIG_NUM_IRQS] = {
+	[0 ... (CONFIG_NUM_IRQS - 1)] = { NULL, _irq_spurious },
+};
+
+/* interrupts are locked until the first thread is started */
+unsigned int _posix_irqs_locked = 1;
+
+int _posix_current_irq = -1;
+
+void _irq_spurious(void *unused)
+{
+	ARG_UNUSED(unused);
+	printk("Spurious interrupt detected! irq: %d\n", _posix_current_irq);
+	_NanoFatalErrorHandler(_NANO_ERR_SPURIOUS_INT, &_default_esf);
+}
+
+void _posix_irq_connect(unsigned int irq, void (*isr)(void *), void *arg)
+{
+	unsigned int key;
+
+	__ASSERT(irq < CONFIG_NUM_IRQS, "invalid irq %u", irq);
+
+	key = irq_lock();
+
+	_sw_isr_table[irq].arg = arg;
+	_sw_isr_table[irq].isr = isr;
+
+	irq_unlock(key);
+}
+
+void _arch_irq_enable(unsigned int irq)
+{
+	posix_irq_enable(irq);
+}
+
+void _arch_irq_disable(unsigned int irq)
+{
+	posix_irq_disable(irq);
+}
+
+int _arch_irq_is_enabled(unsigned int irq)
+{
+	return posix_irq_is_enabled(irq);
+}
+
+/**
+ * @brief Return from an interrupt to the interrupted thread
+ *
+ * Swap the interrupted thread out if the interrupt made a thread of higher
+ * priority ready, or aborted the interrupted thread, and restore the
+ * interrupt lock state of the thread.
+ *
+ * @param key Interrupt lock state of the interrupted thread
+ */
+void _posix_irq_exit(unsigned int key)
+{
+	if (!_is_thread_ready(_current)) {
+		_Swap(key);
+		return;
+	}
+
+	/* cooperative threads and threads with the scheduler locked stay in */
+	if (_is_preempt(_current) && !_current->sched_locked &&
+	    !_is_next_thread_current()) {
+		_Swap(key);
+		return;
+	}
+
+	_arch_irq_unlock(key);
+}
+
+/**
+ * @brief Interrupt demux function
+ *
+ * Run the handlers of the pending interrupts, then return to the interrupted
+ * thread, or swap it out.
+ */
+void _posix_irq_handler(void)
+{
+	int irq;
+
+	_posix_irqs_locked = 1;
+	_nanokernel.nested++;
+
+	while ((irq = posix_irq_next()) >= 0) {
+		_IsrTableEntry_t *ite;
+
+		_posix_current_irq = irq;
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_INTERRUPT
+		_sys_k_event_logger_interrupt();
+#endif
+
+		ite = &_sw_isr_table[irq];
+		ite->isr(ite->arg);
+	}
+
+	_posix_current_irq = -1;
+	_nanokernel.nested--;
+
+	_posix_irq_exit(0);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief Software interrupts utility code - POSIX implementation
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <irq_offload.h>
+
+/**
+ * @brief Run a function in interrupt context
+ *
+ * The routine runs on the calling host thread, as the ISRs do, and the
+ * interrupted thread is rescheduled on return as it is after an interrupt.
+ */
+void irq_offload(irq_offload_routine_t routine, void *parameter)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	_nanokernel.nested++;
+
+	routine(parameter);
+
+	_nanokernel.nested--;
+	_posix_irq_exit(key);
+}
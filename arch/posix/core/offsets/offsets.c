@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief POSIX kernel structure member offset definition file
+ *
+ * This module is responsible for the generation of the absolute symbols whose
+ * value represents the member offsets for various POSIX kernel structures.
+ *
+ * All of the absolute symbols defined by this module will be present in the
+ * final kernel ELF image (due to the linker's reference to the _OffsetAbsSyms
+ * symbol).
+ */
+
+#include <gen_offset.h>
+#include <nano_private.h>
+#include <nano_offsets.h>
+
+/* POSIX specific tNANO structure member offsets */
+GEN_OFFSET_SYM(tNANO, nested);
+
+/* struct coop member offsets */
+GEN_OFFSET_SYM(t_coop, key);
+GEN_OFFSET_SYM(t_coop, retval);
+GEN_OFFSET_SYM(t_coop, thread);
+
+/* size of the struct tcs structure sans save area for floating point regs */
+GEN_ABSOLUTE_SYM(__tTCS_NOFLOAT_SIZEOF, sizeof(tTCS));
+
+GEN_ABS_SYM_END
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief Kernel swapper code for POSIX
+ *
+ * The context of the outgoing thread is kept by the host thread backing it,
+ * which blocks until the thread is swapped back in.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <ksched.h>
+#include <posix_core.h>
+
+extern const int _k_neg_eagain;
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
+extern void _sys_k_event_logger_context_switch(void);
+#endif
+
+/**
+ *
+ * @brief Initiate a cooperative context switch
+ *
+ * The _Swap() routine is invoked by various kernel services to effect
+ * a cooperative context switch. Prior to invoking _Swap(), the caller
+ * disables interrupts via irq_lock() and the return 'key' is passed as a
+ * parameter to _Swap(). The key is restored when the thread is swapped back
+ * in, which takes the interrupts that are pending by then.
+ *
+ * Some kernel services call _Swap() from an ISR when they make a thread of
+ * higher priority ready. As with the PendSV exception of ARM, the switch is
+ * then deferred to the interrupt exit, which picks the next thread.
+ *
+ * @return -EAGAIN, or a return value set by a call to
+ * _set_thread_return_value()
+ */
+unsigned int _Swap(unsigned int key)
+{
+	struct tcs *prev = _current;
+	unsigned int retval;
+
+	if (_is_in_isr()) {
+		_arch_irq_unlock(key);
+		return _k_neg_eagain;
+	}
+
+	prev->coopReg.key = key;
+	prev->coopReg.retval = _k_neg_eagain;
+
+#ifdef CONFIG_KERNEL_EVENT_LOGGER_CONTEXT_SWITCH
+	_sys_k_event_logger_context_switch();
+#endif
+
+	_current = _get_next_ready_thread();
+
+	posix_thread_swap(_current->coopReg.thread, prev->coopReg.thread);
+
+	/* swapped back in: _current is prev again */
+	retval = _current->coopReg.retval;
+	_arch_irq_unlock(_current->coopReg.key);
+
+	return retval;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief New thread creation for POSIX
+ *
+ * Each thread is backed by a host thread, created with the thread and blocked
+ * until the thread is first scheduled in. The stack area of the thread only
+ * holds its thread control structure and its entry point: the thread runs on
+ * the stack of the host thread.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <wait_q.h>
+#include <string.h>
+#include <posix_core.h>
+
+tNANO _nanokernel = {0};
+
+#if defined(CONFIG_THREAD_MONITOR)
+/*
+ * Add a thread to the kernel's list of active threads.
+ */
+static ALWAYS_INLINE void thread_monitor_init(struct tcs *tcs)
+{
+	unsigned int key;
+
+	key = irq_lock();
+	tcs->next_thread = _nanokernel.threads;
+	_nanokernel.threads = tcs;
+	irq_unlock(key);
+}
+#else
+#define thread_monitor_init(tcs) \
+	do {/* do nothing */     \
+	} while ((0))
+#endif /* CONFIG_THREAD_MONITOR */
+
+struct init_stack_frame {
+	_thread_entry_t entry_point;
+	void *arg1;
+	void *arg2;
+	void *arg3;
+};
+
+/* first code run by the host thread, when it is given the CPU */
+static void _thread_entry_wrapper(void *arg)
+{
+	struct init_stack_frame *iframe = arg;
+
+	/* threads start with interrupts unlocked */
+	_arch_irq_unlock(0);
+
+	_thread_entry(iframe->entry_point, iframe->arg1, iframe->arg2,
+		      iframe->arg3);
+}
+
+void _new_thread(char *stack_memory, unsigned stack_size,
+		 void *uk_task_ptr, _thread_entry_t thread_func,
+		 void *arg1, void *arg2, void *arg3,
+		 int priority, unsigned options)
+{
+	struct tcs *tcs;
+	struct init_stack_frame *iframe;
+
+	ARG_UNUSED(uk_task_ptr);
+
+#ifdef CONFIG_INIT_STACKS
+	memset(stack_memory, 0xaa, stack_size);
+#endif
+	/* Initial stack frame data, stored at the base of the stack */
+	iframe = (struct init_stack_frame *)
+		STACK_ROUND_DOWN(stack_memory + stack_size - sizeof(*iframe));
+
+	iframe->entry_point = thread_func;
+	iframe->arg1 = arg1;
+	iframe->arg2 = arg2;
+	iframe->arg3 = arg3;
+
+	/* Initialize various struct tcs members */
+	tcs = (struct tcs *)stack_memory;
+	tcs->prio = priority;
+
+	/* k_q_node initialized upon first insertion in a list */
+	tcs->flags = options | K_PRESTART;
+	tcs->sched_locked = 0;
+
+	/* static threads overwrite it afterwards with real value */
+	tcs->init_data = NULL;
+	tcs->fn_abort = NULL;
+	tcs->pended_mutex = NULL;
+
+#ifdef CONFIG_SCHED_DEADLINE
+	tcs->deadline = 0;
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	memset(&tcs->runtime_stats, 0, sizeof(tcs->runtime_stats));
+#endif
+
+#ifdef CONFIG_THREAD_STACK_USAGE
+	tcs->stack_size = stack_size;
+#endif
+
+#ifdef CONFIG_THREAD_CUSTOM_DATA
+	/* Initialize custom data field (value is opaque to kernel) */
+	tcs->custom_data = NULL;
+#endif
+
+	tcs->coopReg.key = 0;
+	tcs->coopReg.thread = posix_thread_create(_thread_entry_wrapper,
+						  iframe);
+
+#ifdef CONFIG_NANO_TIMEOUTS
+	_nano_timeout_tcs_init(tcs);
+#endif
+
+	thread_monitor_init(tcs);
+}
+
+void _posix_arch_init(void)
+{
+	/* the kernel initialization runs in the main host thread */
+	_current->coopReg.thread = posix_cpu_boot();
+}
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief POSIX k_thread_abort() routine
+ *
+ * The POSIX architecture provides its own k_thread_abort() to terminate the
+ * host thread backing the aborted thread, and because an ISR must not swap
+ * the interrupted thread out: when the current thread is aborted from an ISR,
+ * the context switch happens when the interrupt exits.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <toolchain.h>
+#include <sections.h>
+#include <ksched.h>
+#include <wait_q.h>
+#include <posix_core.h>
+
+extern void _k_thread_single_abort(struct tcs *thread);
+
+void k_thread_abort(k_tid_t thread)
+{
+	unsigned int key;
+
+	key = irq_lock();
+
+	_k_thread_single_abort(thread);
+	_thread_monitor_exit(thread);
+
+	/*
+	 * The host thread exits when it is given the CPU, or when it gives
+	 * it away if it is the current thread.
+	 */
+	posix_thread_abort(thread->coopReg.thread);
+
+	if (_is_in_isr()) {
+		irq_unlock(key);
+		return;
+	}
+
+	if (_current == thread) {
+		_Swap(key);
+		CODE_UNREACHABLE;
+	}
+
+	/* The abort handler might have altered the ready queue. */
+	_reschedule_threads(key);
+}
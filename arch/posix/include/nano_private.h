@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Private nanokernel definitions
+ *
+ * This file contains private nanokernel structures definitions and various
+ * other definitions for the POSIX architecture.
+ *
+ * The context of a thread is saved by the host thread backing it: the thread
+ * control structure only records the handle of the host thread, the interrupt
+ * lock key of the thread and the return value of _Swap().
+ */
+
+#ifndef _NANO_PRIVATE_H
+#define _NANO_PRIVATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <toolchain.h>
+#include <sections.h>
+#include <arch/cpu.h>
+
+#ifndef _ASMLANGUAGE
+#include <kernel.h>		   /* public kernel API */
+#include <../../../kernel/unified/include/nano_internal.h>
+#include <stdint.h>
+#include <misc/util.h>
+#include <misc/dlist.h>
+#endif
+
+/* Bitmask definitions for the struct tcs->flags bit field */
+#define K_STATIC  0x00000800
+
+#define K_READY              0x00000000    /* Thread is ready to run */
+#define K_TIMING             0x00001000    /* Thread is waiting on a timeout */
+#define K_PENDING            0x00002000    /* Thread is waiting on an object */
+#define K_PRESTART           0x00004000    /* Thread has not yet started */
+#define K_DEAD               0x00008000    /* Thread has terminated */
+#define K_SUSPENDED          0x00010000    /* Thread is suspended */
+#define K_DUMMY              0x00020000    /* Not a real thread */
+#define K_EXECUTION_MASK    (K_TIMING | K_PENDING | K_PRESTART | \
+			     K_DEAD | K_SUSPENDED | K_DUMMY)
+
+#define INT_ACTIVE     0x002 /* 1 = executing context is interrupt handler */
+#define EXC_ACTIVE     0x004 /* 1 = executing context is exception handler */
+#define USE_FP         0x010 /* 1 = thread uses floating point unit */
+#define ESSENTIAL      0x200 /* 1 = system thread that must not abort */
+#define NO_METRICS     0x400 /* 1 = _Swap() not to update task metrics */
+
+/* stacks */
+
+#define STACK_ALIGN_SIZE 4
+
+#define STACK_ROUND_UP(x) ROUND_UP(x, STACK_ALIGN_SIZE)
+#define STACK_ROUND_DOWN(x) ROUND_DOWN(x, STACK_ALIGN_SIZE)
+
+#ifndef _ASMLANGUAGE
+
+/*
+ * The registers of a thread are saved by the host when the host thread
+ * backing it blocks: only the state _Swap() hands over is kept here.
+ */
+struct s_coop {
+	uint32_t key; /* IRQ status before irq_lock() and call to _Swap() */
+	uint32_t retval; /* Return value of _Swap() */
+	void *thread; /* host thread backing the thread */
+};
+typedef struct s_coop t_coop;
+
+/*
+ * Interrupts never preempt a thread in the middle of its execution, there are
+ * no caller-saved registers to save.
+ */
+struct preempt {
+};
+
+
+/* 'struct tcs_base' must match the beginning of 'struct tcs' */
+struct tcs_base {
+	sys_dnode_t  k_q_node;
+	uint32_t     flags;
+	int          prio;     /* thread priority used to sort linked list */
+	void        *swap_data;
+#ifdef CONFIG_NANO_TIMEOUTS
+	struct _timeout timeout;
+#endif
+};
+
+
+struct tcs {
+	sys_dnode_t k_q_node;	/* node object in any kernel queue */
+	int         flags;
+	int         prio;     /* thread priority used to sort linked list */
+	void       *swap_data;
+#ifdef CONFIG_NANO_TIMEOUTS
+	struct _timeout timeout;
+#endif
+	struct preempt preempReg;
+	t_coop coopReg;
+
+#ifdef CONFIG_ERRNO
+	int errno_var;
+#endif
+#if defined(CONFIG_THREAD_MONITOR)
+	struct __thread_entry *entry; /* thread entry and parameters description */
+	struct tcs *next_thread; /* next item in list of ALL fiber+tasks */
+#endif
+#ifdef CONFIG_THREAD_CUSTOM_DATA
+	void *custom_data;        /* available for custom use */
+#endif
+	atomic_t sched_locked;
+	void *init_data;
+	void (*fn_abort)(void);
+	struct k_mutex *pended_mutex; /* mutex the thread waits on */
+#ifdef CONFIG_SCHED_DEADLINE
+	uint32_t deadline; /* absolute, in hardware clock cycles */
+#endif
+#ifdef CONFIG_SYS_CLOCK_HIRES
+	struct _hires_timeout hires_timeout; /* used by k_sleep_cycles() */
+#endif
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	struct k_thread_runtime_stats runtime_stats;
+#endif
+#ifdef CONFIG_THREAD_STACK_USAGE
+	/* size of the stack area, thread control structure included */
+	unsigned int stack_size;
+#endif
+};
+
+
+struct ready_q {
+	struct k_thread *cache;
+#if (K_NUM_PRIO_BITMAPS > 1)
+	uint32_t prio_bmap_summary;
+#endif
+	uint32_t prio_bmap[K_NUM_PRIO_BITMAPS];
+	sys_dlist_t q[K_NUM_PRIORITIES];
+};
+
+
+struct s_NANO {
+	struct tcs *current;  /* currently scheduled thread (fiber or task) */
+
+#if defined(CONFIG_NANO_TIMEOUTS) || defined(CONFIG_NANO_TIMERS)
+	sys_dlist_t timeout_q;
+#endif
+#if defined(CONFIG_THREAD_MONITOR)
+	struct tcs *threads; /* singly linked list of ALL fiber+tasks */
+#endif
+	struct ready_q ready_q;
+
+	/* POSIX-specific members */
+
+	uint32_t nested;	/* IRQ nest level */
+};
+
+typedef struct s_NANO tNANO;
+extern tNANO _nanokernel;
+
+
+/* Arch-specific nanokernel APIs */
+void nano_cpu_idle(void);
+void nano_cpu_atomic_idle(unsigned int key);
+
+extern void _posix_arch_init(void);
+
+static ALWAYS_INLINE void nanoArchInit(void)
+{
+	_posix_arch_init();
+}
+
+static ALWAYS_INLINE void fiberRtnValueSet(struct tcs *fiber,
+					   unsigned int value)
+{
+	fiber->coopReg.retval = value;
+}
+
+#define _current _nanokernel.current
+#define _ready_q _nanokernel.ready_q
+#define _timeout_q _nanokernel.timeout_q
+#define _set_thread_return_value fiberRtnValueSet
+static ALWAYS_INLINE void
+_set_thread_return_value_with_data(struct k_thread *thread, unsigned int value,
+				   void *data)
+{
+	_set_thread_return_value(thread, value);
+	thread->swap_data = data;
+}
+#define _IDLE_THREAD_PRIO (CONFIG_NUM_PREEMPT_PRIORITIES)
+
+
+static inline void _IntLibInit(void)
+{
+	/* No special initialization of the interrupt subsystem required */
+}
+
+FUNC_NORETURN void _NanoFatalErrorHandler(unsigned int reason,
+					  const NANO_ESF *esf);
+
+
+#define _is_in_isr() (_nanokernel.nested != 0)
+
+/* reschedule, if needed, when returning from an interrupt to a thread */
+extern void _posix_irq_exit(unsigned int key);
+
+#endif /* _ASMLANGUAGE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NANO_PRIVATE_H */
@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Host side of the POSIX architecture
+ *
+ * Interface between the kernel and the host threads that back the kernel
+ * threads and model the interrupt controller. This header is shared by the
+ * kernel and the host sources, and must only use plain C types.
+ *
+ * Only the host thread owning the CPU runs: posix_thread_swap() hands the CPU
+ * over to another thread and blocks the calling one until it gets the CPU
+ * back. The host threads modelling the hardware never own the CPU, they raise
+ * interrupts, which the thread owning the CPU takes when it polls for them.
+ */
+
+#ifndef _POSIX_CORE_H
+#define _POSIX_CORE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* give the CPU to the calling host thread, and return its handle */
+void *posix_cpu_boot(void);
+
+/*
+ * Create a host thread that runs entry(arg) once it is given the CPU, and
+ * return its handle.
+ */
+void *posix_thread_create(void (*entry)(void *), void *arg);
+
+/*
+ * Give the CPU to thread <next>, and block the calling thread <prev> until
+ * it is given the CPU back. <next> and <prev> can be the same thread.
+ */
+void posix_thread_swap(void *next, void *prev);
+
+/*
+ * Terminate a host thread: the thread exits instead of running when it is
+ * given the CPU, or when it gives the CPU away if it owns it.
+ */
+void posix_thread_abort(void *thread);
+
+/* block the CPU until an enabled interrupt is pending */
+void posix_cpu_halt(void);
+
+/*
+ * Terminate the host process with <status>, once the functions registered
+ * with atexit() by the host side of the board have run
+ */
+void posix_exit(int status) __attribute__((noreturn));
+
+/* interrupt controller model */
+void posix_irq_raise(unsigned int irq);
+void posix_irq_enable(unsigned int irq);
+void posix_irq_disable(unsigned int irq);
+int posix_irq_is_enabled(unsigned int irq);
+
+/* acknowledge the next pending interrupt, and return its line or -1 */
+int posix_irq_next(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _POSIX_CORE_H */
@@ -38,8 +38,10 @@
 #ifdef CONFIG_PRINTK
 #include <misc/printk.h>
 #define PRINTK(...) printk(__VA_ARGS__)
+#define PRINTK_FLUSH() printk_flush()
 #else
 #define PRINTK(...)
+#define PRINTK_FLUSH()
 #endif /* CONFIG_PRINTK */
 
 /**
@@ -100,6 +102,8 @@ FUNC_NORETURN void _SysFatalErrorHandler(unsigned int reason,
 #endif /* CONFIG_PRINTK */
 	}
 
+	PRINTK_FLUSH();
+
 	do {
 	} while (1);
 }
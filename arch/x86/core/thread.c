@@ -112,6 +112,7 @@ static void _new_thread_internal(char *pStackMem, unsigned stackSize,
 	/* static threads overwrite it afterwards with real value */
 	tcs->init_data = NULL;
 	tcs->fn_abort = NULL;
+	tcs->pended_mutex = NULL;
 #else
 	if (priority == -1)
 		tcs->flags = PREEMPTIBLE | TASK;
@@ -121,6 +122,18 @@ static void _new_thread_internal(char *pStackMem, unsigned stackSize,
 	tcs->link = (struct tcs *)NULL; /* thread not inserted into list yet */
 #endif
 
+#ifdef CONFIG_SCHED_DEADLINE
+	tcs->deadline = 0;
+#endif
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+	memset(&tcs->runtime_stats, 0, sizeof(tcs->runtime_stats));
+#endif
+
+#ifdef CONFIG_THREAD_STACK_USAGE
+	tcs->stack_size = stackSize;
+#endif
+
 #ifdef CONFIG_THREAD_CUSTOM_DATA
 	/* Initialize custom data field (value is opaque to kernel) */
 
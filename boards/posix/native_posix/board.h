@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief Board configuration macros for the native POSIX board
+ *
+ * This header file is used to specify and describe board-level aspects for
+ * the native POSIX board. It is shared by the kernel and the host sources of
+ * the board, and must only use plain C types.
+ */
+
+#ifndef __INC_BOARD_H
+#define __INC_BOARD_H
+
+#include <stdint.h>
+
+/* IRQ line of the system timer */
+#define POSIX_TIMER_IRQ 0
+
+/* count of the hardware clock, at CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC */
+uint64_t posix_timer_cycles(void);
+
+/* raise the system timer IRQ every <period> hardware clock cycles */
+void posix_timer_start(uint32_t period);
+
+/* output a character on the standard output of the process */
+void posix_console_putchar(int c);
+
+/* write the console output buffered so far */
+void posix_console_flush(void);
+
+#endif /* __INC_BOARD_H */
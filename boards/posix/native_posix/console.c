@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief Standard output of the native POSIX board
+ *
+ * The output is written one line at a time. Only the thread owning the CPU
+ * writes to the console, so the line buffer needs no lock.
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include "board.h"
+
+static char line[256];
+static unsigned int line_len;
+
+void posix_console_flush(void)
+{
+	unsigned int done = 0;
+
+	while (done < line_len) {
+		ssize_t ret = write(STDOUT_FILENO, line + done,
+				    line_len - done);
+
+		if (ret < 0 && errno == EINTR) {
+			continue;
+		}
+		if (ret <= 0) {
+			break;
+		}
+		done += ret;
+	}
+
+	line_len = 0;
+}
+
+void posix_console_putchar(int c)
+{
+	line[line_len++] = c;
+
+	if (c == '\n' || line_len == sizeof(line)) {
+		posix_console_flush();
+	}
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief System timer of the native POSIX board
+ *
+ * The hardware clock is the monotonic clock of the host. A host thread
+ * raises the timer IRQ at each period, sleeping until absolute deadlines so
+ * that the periods do not drift. If the process was stopped, e.g. in a
+ * debugger, the missed periods are skipped: the system clock driver catches
+ * up from the hardware clock.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <posix_core.h>
+#include "board.h"
+
+#define NSEC_PER_SEC 1000000000ULL
+
+static uint64_t period_ns;
+
+static uint64_t host_time_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+uint64_t posix_timer_cycles(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC +
+	       (uint64_t)ts.tv_nsec * CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC /
+	       NSEC_PER_SEC;
+}
+
+static void *timer_thread(void *arg)
+{
+	uint64_t next = host_time_ns();
+	struct timespec ts;
+
+	(void)arg;
+
+	for (;;) {
+		uint64_t now;
+
+		next += period_ns;
+		ts.tv_sec = next / NSEC_PER_SEC;
+		ts.tv_nsec = next % NSEC_PER_SEC;
+
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts,
+				       NULL) == EINTR) {
+		}
+
+		now = host_time_ns();
+		if (now - next > period_ns) {
+			next = now;
+		}
+
+		posix_irq_raise(POSIX_TIMER_IRQ);
+	}
+
+	return NULL;
+}
+
+void posix_timer_start(uint32_t period)
+{
+	pthread_t thread;
+
+	period_ns = (uint64_t)period * NSEC_PER_SEC /
+		    CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC;
+	if (!period_ns) {
+		period_ns = 1;
+	}
+
+	if (pthread_create(&thread, NULL, timer_thread, NULL) ||
+	    pthread_detach(thread)) {
+		abort();
+	}
+}
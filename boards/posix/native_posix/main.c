@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief Entry point of the native POSIX board
+ *
+ * The host C runtime starts the process as any other: main() sets up the
+ * board and starts the kernel in the main host thread, which backs the
+ * kernel initialization until the first thread is swapped in.
+ */
+
+#include <stdlib.h>
+#include <posix_core.h>
+#include "board.h"
+
+extern void _Cstart(void);
+
+int main(int argc, char *argv[])
+{
+	(void)argc;
+	(void)argv;
+
+	/* the console output is written when the process exits */
+	atexit(posix_console_flush);
+
+	_Cstart();
+
+	/* not reached */
+	return 0;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief Console on the standard output of the native POSIX board
+ */
+
+#include <kernel.h>
+#include <misc/printk.h>
+#include <device.h>
+#include <init.h>
+#include <board.h>
+
+#if defined(CONFIG_PRINTK)
+extern void __printk_hook_install(int (*fn)(int));
+extern void __printk_flush_hook_install(void (*fn)(void));
+#endif
+#if defined(CONFIG_STDOUT_CONSOLE)
+extern void __stdout_hook_install(int (*fn)(int));
+#endif
+
+#if defined(CONFIG_PRINTK) || defined(CONFIG_STDOUT_CONSOLE)
+static int native_posix_console_out(int character)
+{
+	posix_console_putchar(character);
+	return character;
+}
+#endif
+
+static int native_posix_console_init(struct device *d)
+{
+	ARG_UNUSED(d);
+#if defined(CONFIG_PRINTK)
+	__printk_hook_install(native_posix_console_out);
+	__printk_flush_hook_install(posix_console_flush);
+#endif
+#if defined(CONFIG_STDOUT_CONSOLE)
+	__stdout_hook_install(native_posix_console_out);
+#endif
+
+	return 0;
+}
+
+SYS_INIT(native_posix_console_init, PRIMARY,
+	 CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -20,7 +20,9 @@
  *
  *
  * Serial console driver.
- * Hooks into the printk and fputc (for printf) modules. Poll driven.
+ * Hooks into the printk and fputc (for printf) modules. Output is poll driven,
+ * or buffered and sent from the UART transmit interrupt with
+ * CONFIG_UART_CONSOLE_TX_BUFFERED.
  */
 
 #include <nanokernel.h>
@@ -41,6 +43,7 @@
 #include <sections.h>
 #include <atomic.h>
 #include <misc/printk.h>
+#include <misc/util.h>
 
 static struct device *uart_console_dev;
 
@@ -88,6 +91,183 @@ static int console_in(void)
 }
 #endif
 
+#ifdef CONFIG_UART_CONSOLE_TX_BUFFERED
+
+#define TX_BUF_SIZE CONFIG_UART_CONSOLE_TX_BUFFER_SIZE
+#define TX_BUF_MASK (TX_BUF_SIZE - 1)
+
+#if (TX_BUF_SIZE & TX_BUF_MASK) != 0
+#error "CONFIG_UART_CONSOLE_TX_BUFFER_SIZE must be a power of 2"
+#endif
+
+/*
+ * Characters waiting to be sent by the transmit interrupt. The indexes run
+ * freely and are masked on access; both are only updated with interrupts
+ * locked.
+ */
+static uint8_t tx_buf[TX_BUF_SIZE];
+static unsigned int tx_head;
+static unsigned int tx_tail;
+
+#ifdef CONFIG_UART_CONSOLE_TX_OVERFLOW_DROP
+/* number of characters dropped because the buffer was full */
+static unsigned int tx_dropped;
+#else
+/* given by the transmit interrupt when it makes room for tx_waiters */
+static struct nano_sem tx_space;
+static unsigned int tx_waiters;
+
+/* set once threads can wait for room, i.e. after the pre-kernel init */
+static int tx_can_block;
+#endif
+
+/* set when the output has been flushed for a fatal error: poll from now on */
+static int tx_panic;
+
+/**
+ *
+ * @brief Queue one character for transmission
+ *
+ * @param c Character to queue
+ *
+ * @return N/A
+ */
+
+static void console_tx_put(uint8_t c)
+{
+	unsigned int key = irq_lock();
+
+	if (tx_panic) {
+		irq_unlock(key);
+		uart_poll_out(uart_console_dev, c);
+		return;
+	}
+
+	while (tx_head - tx_tail == TX_BUF_SIZE) {
+#ifdef CONFIG_UART_CONSOLE_TX_OVERFLOW_DROP
+		tx_dropped++;
+		irq_unlock(key);
+		return;
+#else
+		if (tx_can_block &&
+		    sys_execution_context_type_get() != NANO_CTX_ISR) {
+			/* wait for the transmit interrupt to make room */
+			tx_waiters++;
+			irq_unlock(key);
+			nano_sem_take(&tx_space, TICKS_UNLIMITED);
+			key = irq_lock();
+			tx_waiters--;
+		} else {
+			/*
+			 * The transmit interrupt cannot be waited for: send
+			 * the oldest character ourselves, like the polled
+			 * console does, with interrupts unlocked.
+			 */
+			uint8_t oldest = tx_buf[tx_tail & TX_BUF_MASK];
+
+			tx_tail++;
+			irq_unlock(key);
+			uart_poll_out(uart_console_dev, oldest);
+			key = irq_lock();
+		}
+#endif
+	}
+
+	tx_buf[tx_head & TX_BUF_MASK] = c;
+	tx_head++;
+
+	uart_irq_tx_enable(uart_console_dev);
+
+	irq_unlock(key);
+}
+
+/**
+ *
+ * @brief Refill the UART transmitter from the transmit buffer
+ *
+ * Called from the UART interrupt handler.
+ *
+ * @return N/A
+ */
+
+static void console_tx_isr(void)
+{
+	unsigned int key = irq_lock();
+	unsigned int old_tail = tx_tail;
+
+	while (tx_head != tx_tail) {
+		unsigned int index = tx_tail & TX_BUF_MASK;
+		int len = min(tx_head - tx_tail, TX_BUF_SIZE - index);
+
+		len = uart_fifo_fill(uart_console_dev, &tx_buf[index], len);
+		if (len <= 0) {
+			break;
+		}
+
+		tx_tail += len;
+	}
+
+	if (tx_head == tx_tail) {
+		uart_irq_tx_disable(uart_console_dev);
+	}
+
+#ifndef CONFIG_UART_CONSOLE_TX_OVERFLOW_DROP
+	if (tx_waiters && tx_tail != old_tail) {
+		nano_isr_sem_give(&tx_space);
+	}
+#else
+	ARG_UNUSED(old_tail);
+#endif
+
+	irq_unlock(key);
+}
+
+/**
+ *
+ * @brief Send the buffered output and switch to polled output
+ *
+ * Installed as the printk flush hook: this is called when the system is about
+ * to stop on a fatal error, and the transmit interrupt may never be serviced
+ * again.
+ *
+ * @return N/A
+ */
+
+static void console_flush(void)
+{
+	unsigned int key = irq_lock();
+
+	tx_panic = 1;
+	uart_irq_tx_disable(uart_console_dev);
+
+	while (tx_head != tx_tail) {
+		uart_poll_out(uart_console_dev, tx_buf[tx_tail & TX_BUF_MASK]);
+		tx_tail++;
+	}
+
+	irq_unlock(key);
+}
+
+#if !defined(CONFIG_CONSOLE_HANDLER)
+void uart_console_isr(struct device *unused)
+{
+	ARG_UNUSED(unused);
+
+	while (uart_irq_update(uart_console_dev) &&
+	       uart_irq_is_pending(uart_console_dev)) {
+		if (uart_irq_tx_ready(uart_console_dev)) {
+			console_tx_isr();
+		}
+	}
+}
+#endif
+
+#define CONSOLE_PUTC(c) console_tx_put(c)
+
+#else
+#define CONSOLE_PUTC(c) uart_poll_out(uart_console_dev, c)
+#endif /* CONFIG_UART_CONSOLE_TX_BUFFERED */
+
 #if defined(CONFIG_PRINTK) || defined(CONFIG_STDOUT_CONSOLE)
 /**
  *
@@ -109,9 +289,9 @@ static int console_out(int c)
 	}
 
 	if ('\n' == c) {
-		uart_poll_out(uart_console_dev, '\r');
+		CONSOLE_PUTC('\r');
 	}
-	uart_poll_out(uart_console_dev, c);
+	CONSOLE_PUTC(c);
 
 	return c;
 }
@@ -128,6 +308,7 @@ extern void __stdout_hook_install(int (*hook)(int));
 
 #if defined(CONFIG_PRINTK)
 extern void __printk_hook_install(int (*fn)(int));
+extern void __printk_flush_hook_install(void (*fn)(void));
 #else
 #define __printk_hook_install(x)		\
 	do {/* nothing */			\
@@ -321,6 +502,12 @@ void uart_console_isr(struct device *unused)
 		uint8_t byte;
 		int rx;
 
+#ifdef CONFIG_UART_CONSOLE_TX_BUFFERED
+		if (uart_irq_tx_ready(uart_console_dev)) {
+			console_tx_isr();
+		}
+#endif
+
 		if (!uart_irq_rx_ready(uart_console_dev)) {
 			continue;
 		}
@@ -412,7 +599,10 @@ static void console_input_init(void)
 	uint8_t c;
 
 	uart_irq_rx_disable(uart_console_dev);
+#ifndef CONFIG_UART_CONSOLE_TX_BUFFERED
+	/* with buffered output, the transmit interrupt is already in use */
 	uart_irq_tx_disable(uart_console_dev);
+#endif
 
 	uart_irq_callback_set(uart_console_dev, uart_console_isr);
 
@@ -454,6 +644,9 @@ void uart_console_hook_install(void)
 {
 	__stdout_hook_install(console_out);
 	__printk_hook_install(console_out);
+#if defined(CONFIG_PRINTK) && defined(CONFIG_UART_CONSOLE_TX_BUFFERED)
+	__printk_flush_hook_install(console_flush);
+#endif
 }
 
 /**
@@ -468,6 +661,11 @@ static int uart_console_init(struct device *arg)
 
 	uart_console_dev = device_get_binding(CONFIG_UART_CONSOLE_ON_DEV_NAME);
 
+#ifdef CONFIG_UART_CONSOLE_TX_BUFFERED
+	uart_irq_tx_disable(uart_console_dev);
+	uart_irq_callback_set(uart_console_dev, uart_console_isr);
+#endif
+
 	uart_console_hook_install();
 
 	return 0;
@@ -481,3 +679,22 @@ SYS_INIT(uart_console_init,
 			SECONDARY,
 #endif
 			CONFIG_UART_CONSOLE_INIT_PRIORITY);
+
+#if defined(CONFIG_UART_CONSOLE_TX_BUFFERED) && \
+	!defined(CONFIG_UART_CONSOLE_TX_OVERFLOW_DROP)
+/*
+ * The initialization levels after PRIMARY run in the main thread, which can
+ * wait for room in the output buffer.
+ */
+static int uart_console_tx_block_init(struct device *arg)
+{
+	ARG_UNUSED(arg);
+
+	nano_sem_init(&tx_space);
+	tx_can_block = 1;
+
+	return 0;
+}
+
+SYS_INIT(uart_console_tx_block_init, SECONDARY, 0);
+#endif
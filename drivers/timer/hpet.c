@@ -49,6 +49,12 @@
  * it expires on the next tick, and announces the number of elapsed ticks (if
  * any) to the microkernel.
  *
+ * When configured as a tickless kernel, timer0 is also programmed in one-shot
+ * mode, but never for the next tick only: the kernel gives it the number of
+ * ticks until its next deadline, and the interrupt handler announces all the
+ * ticks elapsed since the previous interrupt. The kernel catches up with the
+ * elapsed ticks in between when it needs the current time.
+ *
  * In a nanokernel-only system this device driver omits more complex
  * capabilities (such as tickless idle support) that are only used with a
  * microkernel.
@@ -132,6 +138,11 @@ extern struct nano_stack _k_command_stack;
 #define _HPET_TIMER0_FSB_INT_ROUTE ((volatile uint64_t *) \
 		(CONFIG_HPET_TIMER_BASE_ADDRESS + TIMER0_FSB_INT_ROUTE_REG))
 
+#define _HPET_TIMER1_CONFIG_CAPS ((volatile uint64_t *) \
+		(CONFIG_HPET_TIMER_BASE_ADDRESS + TIMER1_CONFIG_CAP_REG))
+#define _HPET_TIMER1_COMPARATOR_LSW ((volatile uint32_t *) \
+		(CONFIG_HPET_TIMER_BASE_ADDRESS + TIMER1_COMPARATOR_REG))
+
 /* general capabilities register macros */
 
 #define HPET_COUNTER_CLK_PERIOD(caps) (caps >> 32)
@@ -184,6 +195,12 @@ extern struct nano_stack _k_command_stack;
 #endif
 
 
+#ifdef CONFIG_HPET_TIMER_LEGACY_EMULATION
+#define HPET_HIRES_IRQ 8 /* timer1 replaces the RTC */
+#else
+#define HPET_HIRES_IRQ CONFIG_HPET_TIMER_HIRES_IRQ
+#endif
+
 #ifdef CONFIG_INT_LATENCY_BENCHMARK
 static uint32_t main_count_first_irq_value;
 static uint32_t main_count_expected_value;
@@ -277,6 +294,31 @@ void _timer_int_handler(void *unused)
 
 	_sys_clock_tick_announce();
 
+#elif defined(CONFIG_TICKLESS_KERNEL)
+
+	/* see if interrupt was triggered while timer was being reprogrammed */
+
+	if (stale_irq_check) {
+		stale_irq_check = 0;
+		if (_hpetMainCounterAtomic() < *_HPET_TIMER0_COMPARATOR) {
+			return; /* ignore "stale" interrupt */
+		}
+	}
+
+	/*
+	 * announce the ticks elapsed since the previous interrupt; the kernel
+	 * then programs the timer for its next deadline
+	 */
+
+	_sys_idle_elapsed_ticks = (int32_t)((_hpetMainCounterAtomic() -
+					     counter_last_value) /
+					    counter_load_value);
+	counter_last_value +=
+		(uint64_t)_sys_idle_elapsed_ticks * counter_load_value;
+	programmed_ticks = K_FOREVER;
+
+	_sys_clock_tick_announce();
+
 #else
 
 	/* see if interrupt was triggered while timer was being reprogrammed */
@@ -445,6 +487,182 @@ void _timer_idle_exit(void)
 
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+
+/**
+ *
+ * @brief Account for the ticks elapsed since the last one announced
+ *
+ * The ticks that would reach the tick the timer is programmed for are left
+ * for the interrupt handler to announce.
+ *
+ * @return number of whole ticks elapsed
+ *
+ * \INTERNAL IMPLEMENTATION DETAILS
+ * Called while interrupts are locked.
+ */
+
+int32_t _timer_tickless_catch_up(void)
+{
+	int32_t ticks = (int32_t)((_hpetMainCounterAtomic() -
+				   counter_last_value) / counter_load_value);
+
+	if (programmed_ticks != K_FOREVER && ticks >= programmed_ticks) {
+		ticks = programmed_ticks - 1;
+	}
+
+	if (ticks <= 0) {
+		return 0;
+	}
+
+	counter_last_value += (uint64_t)ticks * counter_load_value;
+	if (programmed_ticks != K_FOREVER) {
+		programmed_ticks -= ticks;
+	}
+
+	return ticks;
+}
+
+/**
+ *
+ * @brief Program the timer interrupt for the kernel's next deadline
+ *
+ * The comparator only matches if it is written before the main counter
+ * reaches it, so a deadline closer than HPET_COMP_DELAY is pushed back, and
+ * the delay is doubled until the write is known to have made it in time.
+ *
+ * @return N/A
+ *
+ * \INTERNAL IMPLEMENTATION DETAILS
+ * Called while interrupts are locked.
+ */
+
+void _timer_tickless_deadline_set(int32_t ticks)
+{
+	uint64_t deadline;
+	uint64_t now;
+	uint32_t delay = HPET_COMP_DELAY;
+
+	stale_irq_check = 1;
+	programmed_ticks = ticks;
+
+	*_HPET_TIMER0_CONFIG_CAPS |= HPET_Tn_VAL_SET_CNF;
+
+	if (ticks == K_FOREVER) {
+		*_HPET_TIMER0_COMPARATOR = ~(uint64_t)0;
+		return;
+	}
+
+	deadline = counter_last_value + (uint64_t)ticks * counter_load_value;
+	now = _hpetMainCounterAtomic();
+
+	while (1) {
+		if (deadline < now + delay) {
+			deadline = now + delay;
+		}
+
+		*_HPET_TIMER0_COMPARATOR = deadline;
+
+		now = _hpetMainCounterAtomic();
+		if (deadline > now) {
+			break;
+		}
+
+		delay <<= 1;
+	}
+}
+
+#endif /* CONFIG_TICKLESS_KERNEL */
+
+#ifdef CONFIG_SYS_CLOCK_HIRES
+
+/*
+ * High-resolution timers use timer1 in one-shot, 32-bit mode: its comparator
+ * is matched against the lower 32 bits of the main counter, which is what
+ * k_cycle_get_32() returns.
+ */
+
+static void hires_int_handler(void *unused)
+{
+	ARG_UNUSED(unused);
+
+#if defined(CONFIG_HPET_TIMER_LEVEL_LOW) || defined(CONFIG_HPET_TIMER_LEVEL_HIGH)
+	/* Acknowledge interrupt */
+	*_HPET_GENERAL_INT_STATUS = 1 << 1;
+#endif
+
+	_sys_clock_hires_announce();
+}
+
+/**
+ *
+ * @brief Program the high-resolution timer interrupt
+ *
+ * The comparator only matches if it is written before the main counter
+ * reaches it, so a cycle closer than HPET_COMP_DELAY is pushed back, and the
+ * delay is doubled until the write is known to have made it in time.
+ *
+ * @return N/A
+ *
+ * \INTERNAL IMPLEMENTATION DETAILS
+ * Called while interrupts are locked.
+ */
+
+void _timer_hires_set(uint32_t cycle)
+{
+	uint32_t now = *_HPET_MAIN_COUNTER_LSW;
+	uint32_t delay = HPET_COMP_DELAY;
+
+	*_HPET_TIMER1_CONFIG_CAPS &= ~HPET_Tn_INT_ENB_CNF;
+
+	while (1) {
+		if ((int32_t)(cycle - now) < (int32_t)delay) {
+			cycle = now + delay;
+		}
+
+		*_HPET_TIMER1_COMPARATOR_LSW = cycle;
+
+		now = *_HPET_MAIN_COUNTER_LSW;
+		if ((int32_t)(cycle - now) > 0) {
+			break;
+		}
+
+		delay <<= 1;
+	}
+
+	*_HPET_TIMER1_CONFIG_CAPS |= HPET_Tn_INT_ENB_CNF;
+}
+
+void _timer_hires_cancel(void)
+{
+	*_HPET_TIMER1_CONFIG_CAPS &= ~HPET_Tn_INT_ENB_CNF;
+}
+
+static void hires_init(void)
+{
+	/* one-shot, 32-bit mode, interrupt disabled until a timer is set */
+	*_HPET_TIMER1_CONFIG_CAPS =
+		(*_HPET_TIMER1_CONFIG_CAPS &
+		 ~(HPET_Tn_TYPE_CNF | HPET_Tn_INT_ENB_CNF |
+		   HPET_Tn_INT_ROUTE_CNF_MASK | HPET_Tn_INT_TYPE_CNF))
+		| HPET_Tn_32MODE_CNF
+#ifndef CONFIG_HPET_TIMER_LEGACY_EMULATION
+		| (HPET_HIRES_IRQ << HPET_Tn_INT_ROUTE_CNF_SHIFT)
+#endif
+#if defined(CONFIG_HPET_TIMER_LEVEL_LOW) || defined(CONFIG_HPET_TIMER_LEVEL_HIGH)
+		| HPET_Tn_INT_TYPE_CNF;
+#else
+		;
+#endif
+
+	IRQ_CONNECT(HPET_HIRES_IRQ, CONFIG_HPET_TIMER_HIRES_IRQ_PRIORITY,
+		    hires_int_handler, 0, HPET_IOAPIC_FLAGS);
+
+	irq_enable(HPET_HIRES_IRQ);
+}
+
+#endif /* CONFIG_SYS_CLOCK_HIRES */
+
 /**
  *
  * @brief Initialize and enable the system clock
@@ -595,6 +813,10 @@ int _sys_clock_driver_init(struct device *device)
 
 	irq_enable(CONFIG_HPET_TIMER_IRQ);
 
+#ifdef CONFIG_SYS_CLOCK_HIRES
+	hires_init();
+#endif
+
 	/* enable the HPET generally, and timer0 specifically */
 
 	*_HPET_GENERAL_CONFIG |= HPET_ENABLE_CNF;
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+/**
+ * @file
+ * @brief System clock driver of the native POSIX board
+ *
+ * The hardware clock is the monotonic clock of the host, read in units of
+ * CONFIG_SYS_CLOCK_HW_CYCLES_PER_SEC. A host thread raises the timer
+ * interrupt every tick period; as the host may deliver the interrupt late,
+ * or coalesce several of them, the handler announces all the ticks elapsed
+ * since the last announced one.
+ */
+
+#include <kernel.h>
+#include <arch/cpu.h>
+#include <device.h>
+#include <system_timer.h>
+#include <board.h>
+
+/* hardware clock count at the last announced tick */
+static uint64_t last_tick_cycles;
+
+static void timer_irq_handler(void *unused)
+{
+	uint32_t ticks;
+
+	ARG_UNUSED(unused);
+
+	ticks = (posix_timer_cycles() - last_tick_cycles) /
+		sys_clock_hw_cycles_per_tick;
+	if (!ticks) {
+		return;
+	}
+
+	last_tick_cycles += (uint64_t)ticks * sys_clock_hw_cycles_per_tick;
+	_nano_sys_clock_tick_announce(ticks);
+}
+
+
+#ifdef CONFIG_TICKLESS_IDLE
+#error "Tickless idle not yet implemented for the native POSIX timer"
+#endif
+
+
+int _sys_clock_driver_init(struct device *device)
+{
+	ARG_UNUSED(device);
+
+	last_tick_cycles = posix_timer_cycles();
+
+	IRQ_CONNECT(POSIX_TIMER_IRQ, 0, timer_irq_handler, NULL, 0);
+	irq_enable(POSIX_TIMER_IRQ);
+
+	posix_timer_start(sys_clock_hw_cycles_per_tick);
+
+	return 0;
+}
+
+
+/**
+ *
+ * @brief Read the platform's timer hardware
+ *
+ * This routine returns the current time in terms of timer hardware clock
+ * cycles.
+ *
+ * As the interrupts cannot preempt a thread on this board, the pending ones
+ * are taken here if interrupts are not locked: a thread waiting for the time
+ * to pass, e.g. in k_busy_wait(), lets the system clock run.
+ *
+ * @return up counter of elapsed clock cycles
+ */
+uint32_t sys_cycle_get_32(void)
+{
+	_posix_irq_poll();
+
+	return (uint32_t)posix_timer_cycles();
+}
@@ -27,6 +27,8 @@
 #include <arch/arc/arch.h>
 #elif defined(CONFIG_NIOS2)
 #include <arch/nios2/arch.h>
+#elif defined(CONFIG_ARCH_POSIX)
+#include <arch/posix/arch.h>
 #else
 #error "Unknown Architecture"
 #endif
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief POSIX specific kernel interface header
+ *
+ * This header contains the POSIX specific kernel interface. It is included
+ * by the generic kernel interface header (arch/cpu.h).
+ *
+ * The POSIX architecture runs the kernel as an ordinary host process. Each
+ * thread is backed by a host thread, and only one of them runs at any time,
+ * so that the kernel keeps the semantics of a single CPU. Interrupts are
+ * raised by host threads modelling the hardware, and are taken by the kernel
+ * when it unlocks interrupts, idles or reads the cycle counter.
+ */
+
+#ifndef _ARCH_IFACE_H
+#define _ARCH_IFACE_H
+
+#include <toolchain.h>
+#include <arch/posix/asm_inline.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STACK_ALIGN  4
+
+#define _NANO_ERR_CPU_EXCEPTION (0)     /* Any unhandled exception */
+#define _NANO_ERR_INVALID_TASK_EXIT (1) /* Invalid task exit */
+#define _NANO_ERR_STACK_CHK_FAIL (2)    /* Stack corruption detected */
+#define _NANO_ERR_ALLOCATION_FAIL (3)   /* Kernel Allocation Failure */
+#define _NANO_ERR_SPURIOUS_INT (4)	/* Spurious interrupt */
+
+/* APIs need to support non-byte addressible architectures */
+
+#define OCTET_TO_SIZEOFUNIT(X) (X)
+#define SIZEOFUNIT_TO_OCTET(X) (X)
+
+#ifndef _ASMLANGUAGE
+#include <stdint.h>
+#include <irq.h>
+#include <sw_isr_table.h>
+
+/* physical/virtual address types required by microkernel */
+typedef unsigned int paddr_t;
+typedef unsigned int vaddr_t;
+
+extern void _posix_irq_connect(unsigned int irq, void (*isr)(void *),
+			       void *arg);
+
+/**
+ * Configure an interrupt.
+ *
+ * The ISR table has no section per IRQ line in a host executable, so the
+ * interrupt is registered at runtime, when the macro is executed. There is
+ * no notion of priority with the host interrupt model and no flags are
+ * currently supported.
+ *
+ * @param irq_p IRQ line number
+ * @param priority_p Interrupt priority (ignored)
+ * @param isr_p Interrupt service routine
+ * @param isr_param_p ISR parameter
+ * @param flags_p IRQ triggering options (currently unused)
+ *
+ * @return The vector assigned to this interrupt
+ */
+#define _ARCH_IRQ_CONNECT(irq_p, priority_p, isr_p, isr_param_p, flags_p) \
+({ \
+	_posix_irq_connect(irq_p, (void (*)(void *))isr_p, \
+			   (void *)isr_param_p); \
+	irq_p; \
+})
+
+/* 1 when interrupts are locked */
+extern unsigned int _posix_irqs_locked;
+
+/* interrupts raised by the host and enabled, updated by the host threads */
+extern uint32_t posix_irq_pending;
+
+extern void _posix_irq_handler(void);
+
+/**
+ * @brief Take the pending interrupts, if interrupts are not locked
+ *
+ * Interrupts raised by the host cannot preempt the running thread, they are
+ * taken at the points where the kernel polls for them.
+ */
+static ALWAYS_INLINE void _posix_irq_poll(void)
+{
+	if (!_posix_irqs_locked &&
+	    __atomic_load_n(&posix_irq_pending, __ATOMIC_ACQUIRE)) {
+		_posix_irq_handler();
+	}
+}
+
+static ALWAYS_INLINE unsigned int _arch_irq_lock(void)
+{
+	unsigned int key = _posix_irqs_locked;
+
+	_posix_irqs_locked = 1;
+	compiler_barrier();
+
+	return key;
+}
+
+static ALWAYS_INLINE void _arch_irq_unlock(unsigned int key)
+{
+	compiler_barrier();
+	_posix_irqs_locked = key;
+
+	_posix_irq_poll();
+}
+
+void _arch_irq_enable(unsigned int irq);
+void _arch_irq_disable(unsigned int irq);
+int _arch_irq_is_enabled(unsigned int irq);
+
+/* the host saves the context of a thread: there is no register frame */
+struct __esf {
+	uint32_t dummy;
+};
+
+typedef struct __esf NANO_ESF;
+extern const NANO_ESF _default_esf;
+
+FUNC_NORETURN void _SysFatalErrorHandler(unsigned int reason,
+					 const NANO_ESF *esf);
+
+#endif /* _ASMLANGUAGE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Renames applied to the kernel and application sources
+ *
+ * This header is included before every kernel and application source file
+ * of the POSIX architecture. The host C runtime owns main(): the main()
+ * function of the application is renamed, and is called by the kernel as
+ * on the other architectures.
+ *
+ * The host side of the architecture and board is built with
+ * NO_POSIX_CHEATS defined, and sees the host names.
+ */
+
+#ifndef _POSIX_CHEATS_H
+#define _POSIX_CHEATS_H
+
+#ifndef NO_POSIX_CHEATS
+#define main(...) zephyr_app_main(__VA_ARGS__)
+#endif
+
+#endif /* _POSIX_CHEATS_H */
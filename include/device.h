@@ -33,6 +33,7 @@
  * @{
  */
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -104,7 +105,62 @@ extern "C" {
  * during initialization.
  */
 
+/**
+ * @def DEVICE_AND_API_INIT_ASYNC
+ *
+ * @brief Create device object whose initialization may run asynchronously.
+ *
+ * @copydetails DEVICE_AND_API_INIT
+ * @details When CONFIG_DEVICE_ASYNC_INIT is enabled, the init function of
+ * the device is run by the device init threads, concurrently with the other
+ * devices of its level, as soon as all the devices it depends on have been
+ * initialized. This is only done from the SECONDARY level on; PRIMARY
+ * devices are always initialized in order, since there are no threads yet.
+ * A device looked up with device_get_binding() while its initialization is
+ * pending is initialized by the caller, or waited for if it is already in
+ * progress. Otherwise, this is the same as DEVICE_AND_API_INIT().
+ *
+ * @param flags 0, or DEVICE_INIT_DEFERRED to let the next levels and main()
+ * start before the device has been initialized.
+ * @param ... Names of the devices that must be initialized before this one,
+ * which must be in the same or in an earlier initialization level.
+ */
+
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+#define _DEVICE_ASYNC_DEFINE(dev_name, async_flags, ...) \
+	static const char * const _CONCAT(__deps_, dev_name)[] = { \
+		__VA_ARGS__ \
+	}; \
+	static struct device_async _CONCAT(__async_, dev_name) = { \
+		.deps = _CONCAT(__deps_, dev_name), \
+		.num_deps = sizeof(_CONCAT(__deps_, dev_name)) / \
+			    sizeof(const char *), \
+		.flags = async_flags, \
+	};
+#define _DEVICE_ASYNC_INIT(dev_name) .async = &_CONCAT(__async_, dev_name),
+#else
+#define _DEVICE_ASYNC_DEFINE(dev_name, async_flags, ...)
+#define _DEVICE_ASYNC_INIT(dev_name)
+#endif
+
 #ifndef CONFIG_DEVICE_POWER_MANAGEMENT
+#define DEVICE_AND_API_INIT_ASYNC(dev_name, drv_name, init_fn, data, \
+				  cfg_info, level, prio, api, flags, ...) \
+	_DEVICE_ASYNC_DEFINE(dev_name, flags, __VA_ARGS__) \
+	static struct device_config _CONCAT(__config_, dev_name) __used \
+	__attribute__((__section__(".devconfig.init"))) = { \
+		.name = drv_name, .init = (init_fn), \
+		_DEVICE_ASYNC_INIT(dev_name) \
+		.config_info = (cfg_info) \
+	}; \
+	\
+	static struct device _CONCAT(__device_, dev_name) __used \
+	__attribute__((__section__(".init_" #level STRINGIFY(prio)))) = { \
+		 .config = &_CONCAT(__config_, dev_name), \
+		 .driver_api = api, \
+		 .driver_data = data \
+	}
+
 #define DEVICE_AND_API_INIT(dev_name, drv_name, init_fn, data, cfg_info, \
 			    level, prio, api) \
 	\
@@ -214,6 +270,25 @@ extern struct device_pm_ops device_pm_ops_nop;
 	DEVICE_DEFINE(dev_name, drv_name, init_fn, \
 		      device_pm_control_nop, data, cfg_info, level, \
 		      prio, api)
+
+#define DEVICE_AND_API_INIT_ASYNC(dev_name, drv_name, init_fn, data, \
+				  cfg_info, level, prio, api, flags, ...) \
+	_DEVICE_ASYNC_DEFINE(dev_name, flags, __VA_ARGS__) \
+	static struct device_config _CONCAT(__config_, dev_name) __used \
+	__attribute__((__section__(".devconfig.init"))) = { \
+		.name = drv_name, .init = (init_fn), \
+		.device_pm_control = (device_pm_control_nop), \
+		.dev_pm_ops = (&device_pm_ops_nop), \
+		_DEVICE_ASYNC_INIT(dev_name) \
+		.config_info = (cfg_info) \
+	}; \
+	\
+	static struct device _CONCAT(__device_, dev_name) __used \
+	__attribute__((__section__(".init_" #level STRINGIFY(prio)))) = { \
+		 .config = &_CONCAT(__config_, dev_name), \
+		 .driver_api = api, \
+		 .driver_data = data \
+	}
 #endif
 
 /* deprecated */
@@ -370,6 +445,30 @@ struct device_pm_ops {
 #define DEVICE_PM_OPS_GET(_name) NULL
 #endif
 
+/**
+ * @brief Let later levels start before the device is initialized
+ *
+ * See DEVICE_AND_API_INIT_ASYNC().
+ */
+#define DEVICE_INIT_DEFERRED (1 << 0)
+
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+/**
+ * @brief Asynchronous initialization information (In RAM) Per driver instance
+ *
+ * @param deps names of the devices to initialize before this one
+ * @param num_deps number of entries in deps
+ * @param flags DEVICE_INIT_DEFERRED or 0
+ * @param state initialization state, for kernel use only
+ */
+struct device_async {
+	const char * const *deps;
+	uint8_t num_deps;
+	uint8_t flags;
+	volatile uint8_t state;
+};
+#endif
+
 /**
  * @brief Static device information (In ROM) Per driver instance
  *
@@ -387,6 +486,9 @@ struct device_config {
 	struct device_pm_ops *dev_pm_ops; /* deprecated */
 	int (*device_pm_control)(struct device *device, uint32_t command,
 			      void *context);
+#endif
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+	struct device_async *async;
 #endif
 	const void *config_info;
 };
@@ -420,6 +522,81 @@ void _sys_device_do_config_level(int level);
  */
 struct device *device_get_binding(const char *name);
 
+/**
+ * @brief Wait for the initialization of a device to complete
+ *
+ * Devices created with DEVICE_AND_API_INIT_ASYNC() may be initialized after
+ * their init level has started, or after main() has started if they are
+ * deferred. device_get_binding() already waits for them; this must be called
+ * before using such a device obtained by other means, such as DEVICE_GET().
+ * If the initialization of the device has not started yet, it is run by the
+ * caller.
+ *
+ * Must not be called from an ISR.
+ *
+ * @param dev Pointer to the device structure.
+ */
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+void device_init_wait(struct device *dev);
+#else
+static inline void device_init_wait(struct device *dev)
+{
+	(void)dev;
+}
+#endif
+
+/**
+ * @brief Device handle
+ *
+ * A device handle is a compact, string-free reference to a device object,
+ * which can be stored instead of a pointer or a name and turned back into the
+ * device in constant time. The handle 0 does not refer to any device.
+ */
+typedef uint16_t device_handle_t;
+
+#define DEVICE_HANDLE_NULL 0
+
+extern struct device __device_init_start[];
+extern struct device __device_init_end[];
+
+/**
+ * @brief Get the handle of a device
+ *
+ * @param dev Pointer to the device structure.
+ *
+ * @return Handle of the device.
+ */
+static inline device_handle_t device_handle_get(struct device *dev)
+{
+	return (device_handle_t)(dev - __device_init_start) + 1;
+}
+
+/**
+ * @brief Get the device referred to by a handle
+ *
+ * This is the counterpart of device_handle_get(). Hot paths that would
+ * otherwise call device_get_binding() repeatedly should look the device up
+ * once and keep its handle (or its pointer).
+ *
+ * @param handle Handle of the device.
+ *
+ * @return pointer to device structure; NULL if the handle does not refer to
+ * any device or if the device cannot be used.
+ */
+static inline struct device *device_from_handle(device_handle_t handle)
+{
+	struct device *dev;
+
+	if (handle == DEVICE_HANDLE_NULL ||
+	    handle > __device_init_end - __device_init_start) {
+		return NULL;
+	}
+
+	dev = &__device_init_start[handle - 1];
+
+	return dev->driver_api ? dev : NULL;
+}
+
 /**
  * @brief Device Power Management APIs
  * @defgroup device_power_management_api Device Power Management APIs
@@ -55,6 +55,35 @@ extern void _timer_idle_enter(int32_t ticks);
 extern void _timer_idle_exit(void);
 #endif /* CONFIG_TICKLESS_IDLE */
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * The timer driver keeps the time of the last tick announced to the kernel.
+ * _timer_tickless_catch_up() returns the number of whole ticks elapsed since
+ * then, which the kernel accounts for without announcing them, and moves the
+ * time of the last tick forward accordingly; it never returns enough ticks
+ * to reach the programmed interrupt. _timer_tickless_deadline_set()
+ * programs the timer interrupt the given number of ticks after the last
+ * tick, or disables it for K_FOREVER. The interrupt handler announces all
+ * the ticks elapsed since the last tick.
+ *
+ * Both are called with interrupts locked.
+ */
+extern int32_t _timer_tickless_catch_up(void);
+extern void _timer_tickless_deadline_set(int32_t ticks);
+#endif /* CONFIG_TICKLESS_KERNEL */
+
+#ifdef CONFIG_SYS_CLOCK_HIRES
+/*
+ * Program the high-resolution timer interrupt at a given hardware cycle count
+ * (as returned by k_cycle_get_32()), replacing the previous one. If that
+ * cycle is too close or already past, the interrupt is raised as soon as
+ * possible. The interrupt handler must call _sys_clock_hires_announce().
+ */
+extern void _timer_hires_set(uint32_t cycle);
+extern void _timer_hires_cancel(void);
+extern void _sys_clock_hires_announce(void);
+#endif /* CONFIG_SYS_CLOCK_HIRES */
+
 #ifndef CONFIG_KERNEL_V2
 extern uint32_t _nano_get_earliest_deadline(void);
 #endif /* CONFIG_KERNEL_V2 */
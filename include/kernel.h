@@ -77,6 +77,14 @@ typedef sys_dlist_t _wait_q_t;
 #define _DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(type)
 #endif
 
+#ifdef CONFIG_POLL
+#define _POLL_EVENT_OBJ_INIT .poll_event = NULL,
+#define _POLL_EVENT struct k_poll_event *poll_event
+#else
+#define _POLL_EVENT_OBJ_INIT
+#define _POLL_EVENT
+#endif
+
 #define k_thread tcs
 struct tcs;
 struct k_mutex;
@@ -91,6 +99,7 @@ struct k_stack;
 struct k_mem_slab;
 struct k_mem_pool;
 struct k_timer;
+struct k_poll_event;
 
 typedef struct k_thread *k_tid_t;
 
@@ -205,13 +214,193 @@ extern void k_thread_priority_set(k_tid_t thread, int prio);
 extern void k_thread_suspend(k_tid_t thread);
 extern void k_thread_resume(k_tid_t thread);
 
+/**
+ * @brief Set time-slicing period and scope.
+ *
+ * When time slicing is enabled, a preemptible thread that has been running
+ * for a whole time slice is put at the end of the list of ready threads of
+ * its priority, giving the other threads of equal priority the opportunity
+ * to run. Each thread gets a full time slice every time it is switched in.
+ *
+ * @param slice Maximum time slice length (in milliseconds), or 0 to disable
+ * time slicing.
+ * @param prio Highest thread priority level eligible for time slicing.
+ * Threads of higher priority are never time-sliced.
+ *
+ * @return N/A
+ */
 extern void k_sched_time_slice_set(int32_t slice, int prio);
 
+#ifdef CONFIG_SCHED_DEADLINE
+/**
+ * @brief Set the deadline of a thread.
+ *
+ * Among ready threads of equal priority, the one with the earliest deadline
+ * runs first. The deadline is only used for ordering: the kernel takes no
+ * action when a thread misses it. It must be set again for each job of a
+ * periodic thread.
+ *
+ * Threads whose deadline has never been set have a deadline of 0, which
+ * compares against other deadlines modulo the wrap-around of the hardware
+ * clock: a priority level should use either deadlines for all its threads,
+ * or for none of them.
+ *
+ * This routine can be called from an ISR.
+ *
+ * @param thread Thread to set the deadline of.
+ * @param deadline Deadline, relative to the current time, in hardware clock
+ * cycles (see k_cycle_get_32()). Must be less than 2^31 cycles.
+ *
+ * @return N/A
+ */
+extern void k_thread_deadline_set(k_tid_t thread, int deadline);
+#endif
+
 extern int k_am_in_isr(void);
 
 extern void k_thread_custom_data_set(void *value);
 extern void *k_thread_custom_data_get(void);
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/**
+ * @brief Execution statistics of a thread.
+ *
+ * Times are measured in hardware clock cycles (see k_cycle_get_32()). Time
+ * spent in interrupt service routines is charged to the thread that was
+ * interrupted.
+ */
+struct k_thread_runtime_stats {
+	/** Total number of cycles the thread has been running for. */
+	uint64_t total_cycles;
+
+	/** Number of cycles the thread ran for the last time it ran. */
+	uint32_t last_slice_cycles;
+
+	/** Number of times the thread has been switched in. */
+	uint32_t switches;
+
+	/**
+	 * Number of times the thread has been switched out while still ready
+	 * to run, i.e. without having pended, slept, been suspended or
+	 * aborted. This includes switching out due to k_yield() or time
+	 * slicing.
+	 */
+	uint32_t preemptions;
+};
+
+/**
+ * @brief Execution statistics of the system.
+ */
+struct k_sys_runtime_stats {
+	/** Total number of cycles accounted for since the kernel started. */
+	uint64_t total_cycles;
+
+	/** Number of cycles spent running the idle thread. */
+	uint64_t idle_cycles;
+};
+
+/**
+ * @brief Get the execution statistics of a thread.
+ *
+ * If @a thread is the current thread, its statistics include the time it has
+ * been running for since it was last switched in.
+ *
+ * @param thread Thread to get the statistics of.
+ * @param stats Address of structure filled with the statistics.
+ *
+ * @return N/A
+ */
+extern void k_thread_runtime_stats_get(k_tid_t thread,
+				       struct k_thread_runtime_stats *stats);
+
+/**
+ * @brief Get the execution statistics of the system.
+ *
+ * The ratio of idle cycles to total cycles gives the fraction of the CPU
+ * left unused since the kernel started.
+ *
+ * @param stats Address of structure filled with the statistics.
+ *
+ * @return N/A
+ */
+extern void k_sys_runtime_stats_get(struct k_sys_runtime_stats *stats);
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
+
+#ifdef CONFIG_THREAD_STACK_USAGE
+/**
+ * @brief Stack usage of a thread, or of the interrupt stack.
+ *
+ * Stacks are painted with a known pattern when created; the unused space is
+ * the part of the stack, starting from its far end, still holding the
+ * pattern. It is the headroom left by the deepest use of the stack so far,
+ * not the space currently free.
+ */
+struct k_stack_usage {
+	/** Size of the stack, in bytes, excluding the thread control
+	 * structure at its base.
+	 */
+	size_t size;
+
+	/** Number of bytes of the stack never used so far. */
+	size_t unused;
+};
+
+/**
+ * @brief Callback invoked by k_stack_usage_foreach().
+ *
+ * @param thread Thread owning the stack, or NULL for the interrupt stack.
+ * @param usage Stack usage of the thread.
+ * @param user_data User data passed to k_stack_usage_foreach().
+ */
+typedef void (*k_stack_usage_cb_t)(k_tid_t thread,
+				   const struct k_stack_usage *usage,
+				   void *user_data);
+
+/**
+ * @brief Get the stack usage of a thread.
+ *
+ * The stack is scanned from its far end, so this takes time proportional to
+ * the unused space.
+ *
+ * @param thread Thread to get the stack usage of.
+ * @param usage Address of structure filled with the stack usage.
+ *
+ * @return N/A
+ */
+extern void k_thread_stack_usage_get(k_tid_t thread,
+				     struct k_stack_usage *usage);
+
+/**
+ * @brief Get the stack usage of the interrupt stack.
+ *
+ * @param usage Address of structure filled with the stack usage.
+ *
+ * @return N/A
+ */
+extern void k_isr_stack_usage_get(struct k_stack_usage *usage);
+
+/**
+ * @brief Get the stack usage of all threads and of the interrupt stack.
+ *
+ * @a cb is invoked for each thread, including the main and idle threads,
+ * then once with a NULL thread for the interrupt stack. Threads are invoked
+ * with the scheduler locked, so @a cb must not block.
+ *
+ * @param cb Callback invoked for each stack.
+ * @param user_data User data passed to @a cb.
+ *
+ * @return N/A
+ */
+extern void k_stack_usage_foreach(k_stack_usage_cb_t cb, void *user_data);
+
+/**
+ * @brief Print the stack usage of all threads and of the interrupt stack.
+ *
+ * @return N/A
+ */
+extern void k_stack_usage_print(void);
+#endif /* CONFIG_THREAD_STACK_USAGE */
+
 /**
  *  kernel timing
  */
@@ -239,14 +428,40 @@ static int64_t __ticks_to_ms(int64_t ticks)
 struct _timeout;
 typedef void (*_timeout_func_t)(struct _timeout *t);
 
+/*
+ * With the pairing heap timeout queue, delta_ticks_from_prev does not hold a
+ * delta: it is still -1 when the timeout is not queued and 0 once it has
+ * expired, but the expiry point is kept in expiry_tick instead.
+ */
 struct _timeout {
 	sys_dlist_t node;
+#ifdef CONFIG_TIMEOUT_QUEUE_PAIRING_HEAP
+	struct _timeout *heap_child;
+	struct _timeout *heap_next;
+	struct _timeout *heap_prev;
+	uint32_t expiry_tick;
+#endif
 	struct k_thread *thread;
 	sys_dlist_t *wait_q;
 	int32_t delta_ticks_from_prev;
 	_timeout_func_t func;
 };
 
+#ifdef CONFIG_SYS_CLOCK_HIRES
+struct _hires_timeout;
+typedef void (*_hires_timeout_func_t)(struct _hires_timeout *t);
+
+/*
+ * High-resolution timeout, expiring at an absolute hardware cycle count (as
+ * returned by k_cycle_get_32()). node.next is NULL when it is not queued.
+ */
+struct _hires_timeout {
+	sys_dnode_t node;
+	uint32_t expiry_cycle;
+	_hires_timeout_func_t func;
+};
+#endif
+
 
 /* timers */
 
@@ -273,15 +488,26 @@ struct k_timer {
 	/* timer status */
 	uint32_t status;
 
+#ifdef CONFIG_SYS_CLOCK_HIRES
+	/* used instead of timeout when started by k_timer_start_cycles() */
+	struct _hires_timeout hires_timeout;
+
+	/* timer period, in hardware cycles */
+	uint32_t hires_period;
+#endif
+
 	/* used to support legacy timer APIs */
 	void *_legacy_data;
 
+	_POLL_EVENT;
+
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_timer);
 };
 
 #define K_TIMER_INITIALIZER(obj) \
 	{ \
 	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
+	_POLL_EVENT_OBJ_INIT \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT \
 	}
 
@@ -322,6 +548,28 @@ extern void k_timer_init(struct k_timer *timer,
 extern void k_timer_start(struct k_timer *timer,
 			  int32_t duration, int32_t period);
 
+#ifdef CONFIG_SYS_CLOCK_HIRES
+/**
+ * @brief Start a timer with a high-resolution duration and period.
+ *
+ * This routine behaves like k_timer_start(), but the duration and the period
+ * are expressed in hardware clock cycles (see k_cycle_get_32()) and are not
+ * rounded up to system ticks: the system timer is programmed to interrupt at
+ * the exact cycle the timer expires. Periodic expiries are computed from the
+ * previous expiry point, so they do not drift.
+ *
+ * Both values must be less than 2^31 cycles.
+ *
+ * @param timer     Address of timer.
+ * @param duration  Initial timer duration (in hardware cycles).
+ * @param period    Timer period (in hardware cycles).
+ *
+ * @return N/A
+ */
+extern void k_timer_start_cycles(struct k_timer *timer,
+				 uint32_t duration, uint32_t period);
+#endif
+
 /**
  * @brief Stop a timer.
  *
@@ -437,6 +685,34 @@ extern uint32_t k_uptime_delta_32(int64_t *reftime);
 
 extern uint32_t k_cycle_get_32(void);
 
+#ifdef CONFIG_SYS_CLOCK_HIRES
+/**
+ * @brief Convert microseconds to hardware clock cycles.
+ *
+ * @param us Number of microseconds.
+ *
+ * @return Number of hardware clock cycles, rounded down.
+ */
+static inline uint32_t k_us_to_cycles(uint32_t us)
+{
+	return (uint32_t)(((uint64_t)us * sys_clock_hw_cycles_per_sec) /
+			  USEC_PER_SEC);
+}
+
+/**
+ * @brief Put the current thread to sleep for a number of hardware cycles.
+ *
+ * This routine behaves like k_sleep(), but the duration is expressed in
+ * hardware clock cycles and is not rounded up to system ticks. A thread
+ * sleeping this way cannot be woken up early by k_wakeup().
+ *
+ * @param cycles Number of hardware clock cycles to sleep, less than 2^31.
+ *
+ * @return N/A
+ */
+extern void k_sleep_cycles(uint32_t cycles);
+#endif
+
 /**
  *  data transfers (basic)
  */
@@ -446,6 +722,7 @@ extern uint32_t k_cycle_get_32(void);
 struct k_fifo {
 	_wait_q_t wait_q;
 	sys_slist_t data_q;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_fifo);
 };
@@ -460,6 +737,7 @@ extern void *k_fifo_get(struct k_fifo *fifo, int32_t timeout);
 	{ \
 	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
 	.data_q = SYS_SLIST_STATIC_INIT(&obj.data_q), \
+	_POLL_EVENT_OBJ_INIT \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT \
 	}
 
@@ -528,16 +806,27 @@ struct k_work;
 typedef void (*k_work_handler_t)(struct k_work *);
 
 /**
- * A workqueue is a fiber that executes @ref k_work items that are
- * queued to it.  This is useful for drivers which need to schedule
+ * A workqueue is a pool of one or more fibers that execute @ref k_work items
+ * that are queued to it.  This is useful for drivers which need to schedule
  * execution of code which might sleep from ISR context.  The actual
- * fiber identifier is not stored in the structure in order to save
+ * fiber identifiers are not stored in the structure in order to save
  * space.
+ *
+ * Each work item is queued with a priority class, from 0 (highest) to
+ * CONFIG_NUM_WORK_PRIORITIES - 1 (lowest and default): an idle fiber always
+ * takes the oldest item of the highest priority class.
  */
 struct k_work_q {
-	struct k_fifo fifo;
+	_wait_q_t wait_q;		/* idle worker fibers */
+	uint32_t pending_prios;		/* bitmap of non-empty queues */
+	sys_slist_t queues[CONFIG_NUM_WORK_PRIORITIES];
 };
 
+/**
+ * @brief Priority class of work items submitted without one.
+ */
+#define K_WORK_PRIO_DEFAULT (CONFIG_NUM_WORK_PRIORITIES - 1)
+
 /**
  * @brief Work flags.
  */
@@ -573,16 +862,47 @@ static inline void k_work_init(struct k_work *work, k_work_handler_t handler)
 	work->handler = handler;
 }
 
+/**
+ * @brief Submit a work item to a workqueue with a priority class.
+ *
+ * This procedure schedules a work item to be processed, ahead of the work
+ * items of lower priority classes that are not being processed yet.
+ * In the case where the work item has already been submitted and is pending
+ * execution, calling this function will result in a no-op. In this case, the
+ * work item must not be modified externally (e.g. by the caller of this
+ * function), since that could cause the work item to be processed in a
+ * corrupted state.
+ *
+ * A work item is no longer pending once its handler starts, so it can be
+ * resubmitted while it is being processed. On a workqueue served by several
+ * fibers, another fiber can then process it before the handler returns: a
+ * handler that resubmits its own work item, or whose work item may be
+ * submitted again while it runs, must tolerate running concurrently.
+ *
+ * @param work_q to schedule the work item
+ * @param work work item
+ * @param prio priority class, from 0 (highest) to
+ *        CONFIG_NUM_WORK_PRIORITIES - 1 (lowest)
+ *
+ * @return N/A
+ */
+extern void k_work_submit_to_queue_prio(struct k_work_q *work_q,
+					struct k_work *work, int prio);
+
 /**
  * @brief Submit a work item to a workqueue.
  *
- * This procedure schedules a work item to be processed.
+ * This procedure schedules a work item to be processed, with the lowest
+ * priority class (K_WORK_PRIO_DEFAULT).
  * In the case where the work item has already been submitted and is pending
  * execution, calling this function will result in a no-op. In this case, the
  * work item must not be modified externally (e.g. by the caller of this
  * function), since that could cause the work item to be processed in a
  * corrupted state.
  *
+ * See k_work_submit_to_queue_prio() for the processing of a work item
+ * submitted again while its handler runs.
+ *
  * @param work_q to schedule the work item
  * @param work work item
  *
@@ -591,9 +911,7 @@ static inline void k_work_init(struct k_work *work, k_work_handler_t handler)
 static inline void k_work_submit_to_queue(struct k_work_q *work_q,
 					  struct k_work *work)
 {
-	if (!atomic_test_and_set_bit(work->flags, K_WORK_STATE_PENDING)) {
-		k_fifo_put(&work_q->fifo, work);
-	}
+	k_work_submit_to_queue_prio(work_q, work, K_WORK_PRIO_DEFAULT);
 }
 
 /**
@@ -611,6 +929,25 @@ static inline int k_work_pending(struct k_work *work)
 extern void k_work_q_start(struct k_work_q *work_q, char *stack,
 			   unsigned stack_size, unsigned prio);
 
+/**
+ * @brief Start a new workqueue served by several fibers.
+ *
+ * Each of the @a num_workers fibers processes one work item at a time, so a
+ * slow work item only holds up one of them. This routine can be called from
+ * either fiber or task context.
+ *
+ * @param work_q Workqueue to start
+ * @param stacks Array of @a num_workers stacks of @a stack_size bytes each
+ * @param stack_size Size of each stack (a multiple of STACK_ALIGN)
+ * @param num_workers Number of fibers serving the workqueue
+ * @param prio Priority of the fibers
+ *
+ * @return N/A
+ */
+extern void k_work_q_start_pool(struct k_work_q *work_q, char *stacks,
+				unsigned stack_size, unsigned num_workers,
+				unsigned prio);
+
 #if defined(CONFIG_SYS_CLOCK_EXISTS)
 
  /*
@@ -686,6 +1023,16 @@ static inline void k_work_submit(struct k_work *work)
 	k_work_submit_to_queue(&k_sys_work_q, work);
 }
 
+/*
+ * @brief Submit a work item to the system workqueue with a priority class.
+ *
+ * @ref k_work_submit_to_queue_prio
+ */
+static inline void k_work_submit_prio(struct k_work *work, int prio)
+{
+	k_work_submit_to_queue_prio(&k_sys_work_q, work, prio);
+}
+
 #if defined(CONFIG_SYS_CLOCK_EXISTS)
 /*
  * @brief Submit a delayed work item to the system workqueue.
@@ -754,6 +1101,7 @@ struct k_sem {
 	_wait_q_t wait_q;
 	unsigned int count;
 	unsigned int limit;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_sem);
 };
@@ -901,6 +1249,7 @@ extern void k_sem_group_reset(struct k_sem *sem_array[]);
 	.wait_q = SYS_DLIST_STATIC_INIT(&obj.wait_q), \
 	.count = initial_count, \
 	.limit = count_limit, \
+	_POLL_EVENT_OBJ_INIT \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT \
 	}
 
@@ -974,6 +1323,7 @@ struct k_msgq {
 	char *read_ptr;
 	char *write_ptr;
 	uint32_t used_msgs;
+	_POLL_EVENT;
 
 	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_msgq);
 };
@@ -988,6 +1338,7 @@ struct k_msgq {
 	.read_ptr = q_buffer, \
 	.write_ptr = q_buffer, \
 	.used_msgs = 0, \
+	_POLL_EVENT_OBJ_INIT \
 	_DEBUG_TRACING_KERNEL_OBJECTS_INIT \
 	}
 
@@ -1064,6 +1415,81 @@ extern int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout);
  */
 extern int k_msgq_get(struct k_msgq *q, void *data, int32_t timeout);
 
+/**
+ * @brief Add multiple messages to a message queue.
+ *
+ * This routine adds up to @a num_msgs messages to the message queue, under
+ * a single interrupt lock, without waiting for space to become available.
+ * Threads waiting to obtain a message are given one directly; the remaining
+ * messages are copied to the queue buffer with at most two memcpy() calls.
+ *
+ * Since interrupts are locked while the messages are copied, the interrupt
+ * latency grows with the amount of data transferred.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Pointer to the message queue object.
+ * @param data Pointer to the array of messages to add.
+ * @param num_msgs Number of messages in the array.
+ *
+ * @return Number of messages added, starting from the first one.
+ */
+extern int k_msgq_put_many(struct k_msgq *q, void *data, uint32_t num_msgs);
+
+/**
+ * @brief Obtain multiple messages from a message queue.
+ *
+ * This routine fetches up to @a num_msgs of the oldest messages from the
+ * message queue, under a single interrupt lock, without waiting for messages
+ * to become available. The messages are copied from the queue buffer with at
+ * most two memcpy() calls. The space freed is then filled with the messages
+ * of the threads waiting to add one, if any.
+ *
+ * @note Can be called by ISRs.
+ *
+ * @param q Pointer to the message queue object.
+ * @param data Pointer to the array receiving the messages.
+ * @param num_msgs Maximum number of messages to obtain.
+ *
+ * @return Number of messages obtained.
+ */
+extern int k_msgq_get_many(struct k_msgq *q, void *data, uint32_t num_msgs);
+
+/**
+ * @brief Add a message to a single-producer/single-consumer message queue.
+ *
+ * This routine adds a message to a message queue that has a single
+ * producer and a single consumer, which can each be either a thread or an
+ * ISR. It does not lock interrupts, and never waits.
+ *
+ * A message queue used with k_msgq_spsc_put() and k_msgq_spsc_get() must not
+ * be used with any other message queue routine, except k_msgq_init(). One of
+ * its slots is kept empty, so it can hold one message less than its maximum.
+ * Its consumer is not notified of new messages: use another kernel object,
+ * such as a semaphore, if it needs to wait for them.
+ *
+ * @param q Pointer to the message queue object.
+ * @param data Pointer to message data area.
+ *
+ * @return 0 if successful, -ENOMSG if the queue is full.
+ */
+extern int k_msgq_spsc_put(struct k_msgq *q, void *data);
+
+/**
+ * @brief Obtain a message from a single-producer/single-consumer message
+ * queue.
+ *
+ * This routine fetches the oldest message from a message queue that has a
+ * single producer and a single consumer, without locking interrupts nor
+ * waiting. See k_msgq_spsc_put() for the restrictions on such a queue.
+ *
+ * @param q Pointer to the message queue object.
+ * @param data Pointer to message data area.
+ *
+ * @return 0 if successful, -ENOMSG if the queue is empty.
+ */
+extern int k_msgq_spsc_get(struct k_msgq *q, void *data);
+
 /**
  * @brief Purge contents of a message queue.
  *
@@ -1370,6 +1796,76 @@ extern int k_pipe_get(struct k_pipe *pipe, void *data,
 		      size_t bytes_to_read, size_t *bytes_read,
 		      size_t min_xfer, int32_t timeout);
 
+/**
+ * @brief Claim data from the specified pipe without copying it
+ *
+ * This routine gives the caller direct access to the data at the head of the
+ * ring buffer of the pipe specified by @a pipe. The region is contiguous, so
+ * it may hold less than the total amount of data in the pipe when the data
+ * wraps around the end of the ring buffer. The routine never waits.
+ *
+ * The data stays in the pipe until it is released by k_pipe_get_finish().
+ * While a claim is outstanding, no other thread may read from the pipe.
+ *
+ * @param pipe Pointer to the pipe
+ * @param data Address of area to hold the pointer to the claimed data
+ * @param bytes_max Maximum number of bytes to claim
+ *
+ * @return Number of bytes claimed (0 if the pipe's ring buffer is empty)
+ */
+extern size_t k_pipe_get_claim(struct k_pipe *pipe, unsigned char **data,
+			       size_t bytes_max);
+
+/**
+ * @brief Release data claimed from the specified pipe
+ *
+ * This routine removes the first @a bytes_read bytes of the region returned
+ * by k_pipe_get_claim() from the pipe specified by @a pipe. The space freed
+ * is refilled from any writers waiting on the pipe.
+ *
+ * @param pipe Pointer to the pipe
+ * @param bytes_read Number of bytes consumed (at most the number claimed)
+ *
+ * @return N/A
+ */
+extern void k_pipe_get_finish(struct k_pipe *pipe, size_t bytes_read);
+
+/**
+ * @brief Claim space in the specified pipe without copying data
+ *
+ * This routine gives the caller direct access to the free space at the tail
+ * of the ring buffer of the pipe specified by @a pipe. The region is
+ * contiguous, so it may be smaller than the total free space in the pipe
+ * when that space wraps around the end of the ring buffer. The routine never
+ * waits.
+ *
+ * The data written to the region is only made available to readers by
+ * k_pipe_put_finish(). While a claim is outstanding, no other thread may
+ * write to the pipe.
+ *
+ * @param pipe Pointer to the pipe
+ * @param data Address of area to hold the pointer to the claimed space
+ * @param bytes_max Maximum number of bytes to claim
+ *
+ * @return Number of bytes claimed (0 if the pipe's ring buffer is full)
+ */
+extern size_t k_pipe_put_claim(struct k_pipe *pipe, unsigned char **data,
+			       size_t bytes_max);
+
+/**
+ * @brief Commit data written into space claimed from the specified pipe
+ *
+ * This routine adds the first @a bytes_written bytes of the region returned
+ * by k_pipe_put_claim() to the pipe specified by @a pipe. Any readers waiting
+ * on the pipe are handed the data.
+ *
+ * @param pipe Pointer to the pipe
+ * @param bytes_written Number of bytes written (at most the number claimed)
+ *
+ * @return N/A
+ */
+extern void k_pipe_put_finish(struct k_pipe *pipe, size_t bytes_written);
+
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
 /**
  * @brief Send a message to the specified pipe
@@ -1520,8 +2016,236 @@ static inline uint32_t k_mem_slab_num_free_get(struct k_mem_slab *slab)
 	return slab->num_blocks - slab->num_used;
 }
 
+#ifdef CONFIG_MEM_SLAB_CACHE
+
+/* memory slab caches */
+
+struct k_mem_slab_cache_stats {
+	uint32_t alloc_hits;     /* allocations from the cache */
+	uint32_t alloc_misses;   /* allocations that went to the slab */
+	uint32_t free_hits;      /* frees to the cache */
+	uint32_t free_misses;    /* frees that drained the cache */
+};
+
+struct k_mem_slab_cache {
+	struct k_mem_slab *slab;
+	char *free_list;
+	uint32_t num_free;
+	uint32_t capacity;
+	struct k_mem_slab_cache_stats stats;
+};
+
+#define K_MEM_SLAB_CACHE_INITIALIZER(cache_slab, cache_capacity) \
+	{ \
+	.slab = cache_slab, \
+	.free_list = NULL, \
+	.num_free = 0, \
+	.capacity = cache_capacity, \
+	.stats = { 0 }, \
+	}
+
+/**
+ * @brief Define a memory slab cache
+ *
+ * This declares and initializes a cache (or magazine) of at most
+ * @a capacity blocks of memory slab @a slab.
+ *
+ * @param name Name of the memory slab cache
+ * @param slab Address of the memory slab
+ * @param capacity Maximum number of blocks held by the cache (at least 2)
+ */
+#define K_MEM_SLAB_CACHE_DEFINE(name, slab, capacity) \
+	struct k_mem_slab_cache name = \
+		K_MEM_SLAB_CACHE_INITIALIZER(slab, capacity)
+
+/**
+ * @brief Initialize a memory slab cache
+ *
+ * A memory slab cache holds free blocks of a memory slab on behalf of a
+ * single thread, which can then allocate and free blocks without locking
+ * interrupts. The cache is refilled from, or drained to, its memory slab
+ * half a cache at a time, with interrupts locked once per batch.
+ *
+ * A cache must only ever be used by one thread, and never by an ISR: each
+ * thread that churns through blocks of a memory slab should have its own.
+ *
+ * @param cache Address of the memory slab cache
+ * @param slab Address of the memory slab
+ * @param capacity Maximum number of blocks held by the cache (at least 2)
+ *
+ * @return N/A
+ */
+extern void k_mem_slab_cache_init(struct k_mem_slab_cache *cache,
+				  struct k_mem_slab *slab, uint32_t capacity);
+
+/**
+ * @brief Allocate a memory slab block through a cache
+ *
+ * Takes a block from the cache. If the cache is empty, it is first refilled
+ * from its memory slab; if the memory slab has no free block either, the
+ * thread waits for one as k_mem_slab_alloc() would.
+ *
+ * @param cache Address of the memory slab cache
+ * @param mem Pointer to area to receive block address.
+ * @param timeout Maximum time (milliseconds) to wait for allocation to
+ *        complete.  Use K_NO_WAIT to return immediately, or K_FOREVER to wait
+ *        as long as necessary.
+ *
+ * @return 0 if successful, -ENOMEM if failed immediately, -EAGAIN if timed out
+ */
+extern int k_mem_slab_cache_alloc(struct k_mem_slab_cache *cache, void **mem,
+				  int32_t timeout);
+
+/**
+ * @brief Free a memory slab block through a cache
+ *
+ * Gives the block to the cache. If the cache is full, half of its blocks are
+ * first returned to its memory slab, where they go to waiting threads first.
+ *
+ * @param cache Address of the memory slab cache
+ * @param mem Pointer to area to containing block address.
+ *
+ * @return N/A
+ */
+extern void k_mem_slab_cache_free(struct k_mem_slab_cache *cache, void **mem);
+
+/**
+ * @brief Return all the blocks of a memory slab cache to its memory slab
+ *
+ * This routine should be called before the thread owning the cache stops
+ * using it, e.g. before it terminates, so that no block remains stranded.
+ *
+ * @param cache Address of the memory slab cache
+ *
+ * @return N/A
+ */
+extern void k_mem_slab_cache_flush(struct k_mem_slab_cache *cache);
+
+/**
+ * @brief Get the statistics of a memory slab cache
+ *
+ * The hit rate of allocations is alloc_hits / (alloc_hits + alloc_misses),
+ * and likewise for frees.
+ *
+ * @param cache Address of the memory slab cache
+ * @param stats Address of area to receive the statistics
+ *
+ * @return N/A
+ */
+static inline void k_mem_slab_cache_stats_get(
+	struct k_mem_slab_cache *cache, struct k_mem_slab_cache_stats *stats)
+{
+	*stats = cache->stats;
+}
+
+#endif /* CONFIG_MEM_SLAB_CACHE */
+
 /* memory pools */
 
+#ifdef CONFIG_MEM_POOL_BUDDY
+
+/*
+ * A buddy memory pool splits its maximum sized blocks into four blocks of
+ * the next size, and so on down to the minimum block size. Each block size
+ * (or level) keeps a list of its free blocks, whose links are stored in the
+ * free blocks themselves, and a bitmap with a bit set for each free block.
+ * A block and its three siblings are merged back as soon as all of them are
+ * free.
+ */
+struct k_mem_pool_level {
+	uint32_t *free_bits;
+	sys_dlist_t free_list;
+};
+
+/* Memory pool descriptor */
+struct k_mem_pool {
+	size_t max_block_size;
+	size_t min_block_size;
+	uint32_t nr_of_maxblocks;
+	uint32_t nr_of_levels;
+	struct k_mem_pool_level *levels;
+	uint32_t *bitmap;
+	char *bufblock;
+	_wait_q_t wait_q;
+	_DEBUG_TRACING_KERNEL_OBJECTS_NEXT_PTR(k_mem_pool);
+};
+
+#define _MEM_POOL_HAS_LEVEL(min_size, max_size, l) \
+	((((max_size) >> (2 * (l))) >= (min_size)) ? 1 : 0)
+
+/* Number of block sizes from @a max_size down to @a min_size (at most 12) */
+#define _MEM_POOL_NUM_LEVELS(min_size, max_size) \
+	(1 + _MEM_POOL_HAS_LEVEL(min_size, max_size, 1) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 2) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 3) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 4) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 5) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 6) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 7) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 8) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 9) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 10) + \
+	 _MEM_POOL_HAS_LEVEL(min_size, max_size, 11))
+
+/*
+ * The maximum block size must be the minimum block size times a power of 4,
+ * and a minimum sized block must be able to hold the links of a free list.
+ */
+#define _MEM_POOL_SIZES_VALID(min_size, max_size) \
+	(((min_size) >= sizeof(sys_dnode_t)) && \
+	 (((min_size) << (2 * (_MEM_POOL_NUM_LEVELS(min_size, max_size) - 1))) \
+	  == (max_size)))
+
+/*
+ * Number of words for the bitmaps of all levels, each level starting on a
+ * word boundary: level l has n_max * 4^l blocks.
+ */
+#define _MEM_POOL_BITMAP_WORDS(n_max, num_levels) \
+	((((n_max) * ((1U << (2 * (num_levels))) - 1) / 3) + 31) / 32 + \
+	 (num_levels))
+
+/**
+ * @brief Define a memory pool
+ *
+ * This declares and initializes a memory pool whose buffer is aligned to
+ * a @a align -byte boundary. The new memory pool can be passed to the
+ * kernel's memory pool functions.
+ *
+ * Note that for each of the minimum sized blocks to be aligned to @a align
+ * bytes, then @a min_size must be a multiple of @a align.
+ *
+ * @a max_size must be @a min_size times a power of 4, and @a min_size must be
+ * large enough to hold two pointers: the build fails otherwise.
+ *
+ * @param name Name of the memory pool
+ * @param min_size Minimum block size in the pool
+ * @param max_size Maximum block size in the pool
+ * @param n_max Number of maximum sized blocks in the pool
+ * @param align Alignment of the memory pool's buffer
+ */
+#define K_MEM_POOL_DEFINE(name, min_size, max_size, n_max, align)	\
+	typedef char _mem_pool_sizes_valid_##name[			\
+		_MEM_POOL_SIZES_VALID(min_size, max_size) ? 1 : -1];	\
+	char __noinit __aligned(align)					\
+		_mem_pool_buffer_##name[(max_size) * (n_max)];		\
+	static struct k_mem_pool_level					\
+		_mem_pool_levels_##name[_MEM_POOL_NUM_LEVELS(min_size,	\
+							     max_size)]; \
+	static uint32_t _mem_pool_bitmap_##name[_MEM_POOL_BITMAP_WORDS(	\
+		n_max, _MEM_POOL_NUM_LEVELS(min_size, max_size))];	\
+	struct k_mem_pool name						\
+		__in_section(_k_memory_pool, buddy, name) = {		\
+		.max_block_size = max_size,				\
+		.min_block_size = min_size,				\
+		.nr_of_maxblocks = n_max,				\
+		.nr_of_levels = _MEM_POOL_NUM_LEVELS(min_size, max_size), \
+		.levels = _mem_pool_levels_##name,			\
+		.bitmap = _mem_pool_bitmap_##name,			\
+		.bufblock = _mem_pool_buffer_##name,			\
+	}
+
+#else /* CONFIG_MEM_POOL_QUAD_BLOCK */
+
 /*
  * Memory pool requires a buffer and two arrays of structures for the
  * memory block accounting:
@@ -1739,6 +2463,8 @@ static void __attribute__ ((used)) __k_mem_pool_quad_block_size_define(void)
 	    : "n"(sizeof(struct k_mem_pool_quad_block)));
 }
 
+#endif /* CONFIG_MEM_POOL_BUDDY */
+
 /**
  * @brief Allocate memory from a memory pool
  *
@@ -1766,6 +2492,9 @@ extern void k_mem_pool_free(struct k_mem_block *block);
 /**
  * @brief Defragment the specified memory pool
  *
+ * This routine has nothing to do if CONFIG_MEM_POOL_BUDDY is enabled, since
+ * free blocks are then merged as soon as they are freed.
+ *
  * @param pool Pointer to the memory pool object
  *
  * @return N/A
@@ -1796,6 +2525,117 @@ extern void *k_malloc(size_t size);
  */
 extern void k_free(void *ptr);
 
+/**
+ *  polling
+ */
+
+#ifdef CONFIG_POLL
+
+/* types of objects that can be polled, and the condition polled for */
+enum {
+	K_POLL_TYPE_IGNORE,
+	K_POLL_TYPE_SEM_AVAILABLE,
+	K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+	K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+	K_POLL_TYPE_TIMER_EXPIRED,
+
+	K_POLL_NUM_TYPES
+};
+
+/* state of a poll event: not ready, or the condition that was fulfilled */
+enum {
+	K_POLL_STATE_NOT_READY,
+	K_POLL_STATE_SEM_AVAILABLE,
+	K_POLL_STATE_FIFO_DATA_AVAILABLE,
+	K_POLL_STATE_MSGQ_DATA_AVAILABLE,
+	K_POLL_STATE_TIMER_EXPIRED,
+
+	K_POLL_NUM_STATES
+};
+
+/* private, used by k_poll() */
+struct _poller {
+	volatile int is_polling;
+	struct k_thread *thread;
+};
+
+struct k_poll_event {
+	/* private, the poller that registered this event with its object */
+	struct _poller *poller;
+
+	/* one of K_POLL_TYPE_xxx */
+	uint8_t type;
+
+	/* one of K_POLL_STATE_xxx, set by k_poll() */
+	uint8_t state;
+
+	/* the object being polled */
+	union {
+		void *obj;
+		struct k_sem *sem;
+		struct k_fifo *fifo;
+		struct k_msgq *msgq;
+		struct k_timer *timer;
+	};
+};
+
+#define K_POLL_EVENT_INITIALIZER(event_type, event_obj) \
+	{ \
+	.poller = NULL, \
+	.type = event_type, \
+	.state = K_POLL_STATE_NOT_READY, \
+	{ .obj = event_obj }, \
+	}
+
+/**
+ * @brief Initialize a poll event.
+ *
+ * @param event Pointer to the poll event.
+ * @param type One of the K_POLL_TYPE_xxx values, matching the object type.
+ * @param obj Pointer to the kernel object to poll.
+ *
+ * @return N/A
+ */
+extern void k_poll_event_init(struct k_poll_event *event, uint32_t type,
+			      void *obj);
+
+/**
+ * @brief Wait for one or more kernel objects to become ready.
+ *
+ * This routine waits until at least one of the conditions described by the
+ * @a events array is fulfilled, or until the timeout expires. The objects can
+ * be of different types: semaphores, fifos, message queues and timers.
+ *
+ * When the routine returns, the state field of each event is set to the
+ * condition that was fulfilled, or to K_POLL_STATE_NOT_READY. Polling does not
+ * take anything from the objects: the caller must still take the semaphore,
+ * or get the data from the fifo or message queue, typically with K_NO_WAIT.
+ * Another thread pending directly on the object has precedence over the
+ * poller, so the condition might not be fulfilled anymore by then.
+ *
+ * Only one thread at a time can poll a given object. This is what allows an
+ * object to wake up its poller in constant time.
+ *
+ * Cannot be called from ISR.
+ *
+ * @param events Array of poll events.
+ * @param num_events Number of events in the array.
+ * @param timeout Number of milliseconds to wait, or one of the special values
+ *                K_NO_WAIT and K_FOREVER.
+ *
+ * @retval 0 One or more events are ready.
+ * @retval -EAGAIN No event was ready before the timeout expired.
+ * @retval -EADDRINUSE One of the objects is already being polled.
+ */
+extern int k_poll(struct k_poll_event *events, int num_events,
+		  int32_t timeout);
+
+/* private, used by objects to signal their poller */
+extern int _handle_obj_poll_event(struct k_poll_event **obj_poll_event,
+				  uint32_t state);
+
+#endif /* CONFIG_POLL */
+
 /*
  * legacy.h must be before arch/cpu.h to allow the ioapic/loapic drivers to
  * hook into the device subsystem, which itself uses nanokernel semaphores,
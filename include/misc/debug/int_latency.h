@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _debug__int_latency__h_
+#define _debug__int_latency__h_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * @brief Interrupt latency metrics
+ *
+ * The interrupt latency benchmark measures how long interrupts are kept
+ * locked, from the outermost irq_lock() to the irq_unlock() that re-enables
+ * interrupts. With CONFIG_INT_LATENCY_HISTOGRAM, it also keeps the
+ * distribution of these durations, both globally and for each of the code
+ * locations locking interrupts that held them locked the longest.
+ */
+
+/**
+ * @brief Start tracking interrupt latency metrics
+ *
+ * Also measures the overhead of the tracking itself, which is subtracted
+ * from the durations reported.
+ *
+ * @return N/A
+ */
+extern void int_latency_init(void);
+
+/**
+ * @brief Print interrupt latency metrics, and start a new sampling interval
+ *
+ * @return N/A
+ */
+extern void int_latency_show(void);
+
+#ifdef CONFIG_INT_LATENCY_HISTOGRAM
+
+/**
+ * Number of histogram buckets: bucket N counts the durations between 2^N and
+ * 2^(N+1) - 1 cycles, except for the last bucket, which counts all durations
+ * longer than that.
+ */
+#define INT_LATENCY_HIST_BUCKETS 24
+
+/** Distribution of the durations interrupts were kept locked */
+struct int_latency_stats {
+	/** number of times interrupts were locked */
+	uint32_t count;
+	/** longest duration, in cycles */
+	uint32_t max;
+	/** sum of all durations, in cycles */
+	uint64_t total;
+	/** number of durations in each power-of-two range */
+	uint32_t hist[INT_LATENCY_HIST_BUCKETS];
+};
+
+/** Interrupt latency metrics of a code location locking interrupts */
+struct int_latency_site {
+	/** address of the code that called irq_lock() */
+	void *pc;
+	/** durations interrupts were locked from this location */
+	struct int_latency_stats stats;
+};
+
+/**
+ * @brief Get the distribution of all interrupt locking durations
+ *
+ * @param stats Filled with the metrics of the current sampling interval.
+ *
+ * @return N/A
+ */
+extern void int_latency_histogram_get(struct int_latency_stats *stats);
+
+/**
+ * @brief Get the code locations holding interrupts locked the longest
+ *
+ * Up to CONFIG_INT_LATENCY_HISTOGRAM_SITES locations are tracked. When a new
+ * location locks interrupts and all entries are in use, it replaces the
+ * tracked location with the shortest maximum duration if its own duration
+ * is longer, so the longest offenders are always kept.
+ *
+ * The location recorded is the one of the outermost irq_lock(): nested
+ * lock/unlock pairs are accounted to it.
+ *
+ * @param sites Array filled with the locations, longest maximum first.
+ * @param num Maximum number of locations to report.
+ *
+ * @return Number of locations written to @a sites.
+ */
+extern int int_latency_top_sites_get(struct int_latency_site *sites, int num);
+
+/**
+ * @brief Clear the interrupt latency distributions
+ *
+ * @return N/A
+ */
+extern void int_latency_histogram_reset(void);
+
+#endif /* CONFIG_INT_LATENCY_HISTOGRAM */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _debug__int_latency__h_ */
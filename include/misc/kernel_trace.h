@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Binary kernel trace stream.
+ *
+ * The kernel records thread switches, interrupts, waits on kernel objects and
+ * timeouts in a RAM buffer, as a stream of compact binary records. Writers
+ * reserve the space of each record with a single atomic operation and never
+ * lock interrupts, so tracing does not add to the interrupt latency.
+ *
+ * Each record is made of 32-bit little-endian words:
+ *
+ * - a header word: the event type in bits 0-7, the length of the record
+ *   in words, header included, in bits 8-15, and an event argument in
+ *   bits 16-31;
+ * - the hardware cycle count when the event occurred;
+ * - up to three words of event data.
+ *
+ * Records are stored in the order of their timestamps. The stream can be
+ * decoded with scripts/trace_decode.py.
+ */
+
+#ifndef __KERNEL_TRACE_H__
+#define __KERNEL_TRACE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Kernel Trace Stream
+ * @defgroup kernel_trace Kernel Trace Stream
+ * @{
+ */
+
+/** Thread switch: arg is the priority, data is the incoming thread. */
+#define K_TRACE_THREAD_SWITCH  0x01
+/** Interrupt handler entry: arg is the interrupt vector. */
+#define K_TRACE_ISR_ENTER      0x02
+/** Interrupt handler exit. */
+#define K_TRACE_ISR_EXIT       0x03
+/** Thread pending: data is the thread, the wait queue and the timeout. */
+#define K_TRACE_PEND           0x04
+/** Thread unpended: data is the thread and the wait queue, or 0. */
+#define K_TRACE_UNPEND         0x05
+/** Timeout added: data is the timeout, the thread or 0, and the ticks. */
+#define K_TRACE_TIMEOUT_ADD    0x06
+/** Timeout expired: data is the timeout and the thread or 0. */
+#define K_TRACE_TIMEOUT_EXPIRE 0x07
+/** Application event: arg is the event id, data is the event value. */
+#define K_TRACE_USER           0x08
+/** Events lost because the buffer was full: data is their number. */
+#define K_TRACE_DROPPED        0xfe
+/**
+ * Start of a stream: data is K_TRACE_MAGIC and the number of hardware cycles
+ * per second.
+ */
+#define K_TRACE_STREAM_START   0xff
+
+/** Magic value identifying a trace stream or a trace buffer RAM dump */
+#define K_TRACE_MAGIC 0x4352545a /* "ZTRC" */
+
+#define K_TRACE_HDR(type, len, arg) \
+	((uint32_t)(type) | ((uint32_t)(len) << 8) | ((uint32_t)(arg) << 16))
+
+#define K_TRACE_HDR_TYPE(hdr) ((hdr) & 0xff)
+#define K_TRACE_HDR_LEN(hdr) (((hdr) >> 8) & 0xff)
+#define K_TRACE_HDR_ARG(hdr) ((hdr) >> 16)
+
+#ifdef CONFIG_KERNEL_TRACE
+
+/**
+ * @brief Record an application event in the kernel trace
+ *
+ * @param id Event identifier, shown by the decoder.
+ * @param value Event value.
+ *
+ * @return N/A
+ */
+extern void sys_k_trace_user(uint16_t id, uint32_t value);
+
+/**
+ * @brief Read records from the kernel trace buffer
+ *
+ * Copies as many complete records as fit in @a buf, and frees their space
+ * in the trace buffer. If events have been dropped since the last read, a
+ * K_TRACE_DROPPED record is produced first.
+ *
+ * This routine must not be called concurrently from several threads. It is
+ * called by the trace stream sink thread when there is one.
+ *
+ * @param buf Buffer receiving the records, 4-byte aligned.
+ * @param size Size of @a buf in bytes.
+ *
+ * @return Number of bytes written to @a buf.
+ */
+extern int sys_k_trace_read(void *buf, int size);
+
+#else
+
+static inline void sys_k_trace_user(uint16_t id, uint32_t value) { }
+
+#endif /* CONFIG_KERNEL_TRACE */
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __KERNEL_TRACE_H__ */
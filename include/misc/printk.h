@@ -43,6 +43,9 @@ extern "C" {
  * No other conversion specification capabilities are supported, such as flags,
  * field width, precision, or length attributes.
  *
+ * With CONFIG_PRINTK_DEFERRED, the message is only recorded, and is output
+ * later from a low priority thread; see printk_flush().
+ *
  * @param fmt Format string.
  * @param ... Optional list of format arguments.
  *
@@ -57,6 +60,30 @@ static inline __printf_like(1, 2) void printk(const char *fmt, ...)
 }
 #endif
 
+/**
+ *
+ * @brief Output the pending printk() messages.
+ *
+ * With CONFIG_PRINTK_DEFERRED, printk() only records its format string and
+ * arguments, which are output later by a low priority thread; with
+ * CONFIG_UART_CONSOLE_TX_BUFFERED, the console sends its output from the UART
+ * transmit interrupt. This routine outputs everything pending from the
+ * calling context, so that it is not lost when the system is about to stop,
+ * e.g. on a fatal error. The console stays in polled mode afterwards.
+ *
+ * It can preempt the thread outputting the deferred messages, but must not be
+ * called concurrently with itself.
+ *
+ * @return N/A
+ */
+#ifdef CONFIG_PRINTK
+extern void printk_flush(void);
+#else
+static inline void printk_flush(void)
+{
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -117,6 +117,23 @@ static inline void sys_ring_buf_init(struct ring_buf *buf, uint32_t size,
 	SYS_TRACING_OBJ_INIT(sys_ring_buf, buf);
 }
 
+/*
+ * The producer only writes the tail index, and the consumer only writes the
+ * head index. Each side reads the index of the other side with acquire
+ * semantics and publishes its own with release semantics: the data is stored
+ * before the consumer can see it, and read before its space is handed back to
+ * the producer, even on a CPU that reorders memory accesses.
+ */
+static inline uint32_t _ring_buf_index_acquire(uint32_t *index)
+{
+	return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void _ring_buf_index_release(uint32_t *index, uint32_t value)
+{
+	__atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
 /**
  * @brief Determine if a ring buffer is empty
  *
@@ -124,7 +141,8 @@ static inline void sys_ring_buf_init(struct ring_buf *buf, uint32_t size,
  */
 static inline int sys_ring_buf_is_empty(struct ring_buf *buf)
 {
-	return (buf->head == buf->tail);
+	return (_ring_buf_index_acquire(&buf->head) ==
+		_ring_buf_index_acquire(&buf->tail));
 }
 
 /**
@@ -135,16 +153,15 @@ static inline int sys_ring_buf_is_empty(struct ring_buf *buf)
  */
 static inline int sys_ring_buf_space_get(struct ring_buf *buf)
 {
-	if (sys_ring_buf_is_empty(buf)) {
-		return buf->size - 1;
-	}
+	uint32_t head = _ring_buf_index_acquire(&buf->head);
+	uint32_t tail = _ring_buf_index_acquire(&buf->tail);
 
-	if (buf->tail < buf->head) {
-		return buf->head - buf->tail - 1;
+	if (tail < head) {
+		return head - tail - 1;
 	}
 
-	/* buf->tail > buf->head */
-	return (buf->size - buf->tail) + buf->head - 1;
+	/* tail >= head */
+	return (buf->size - tail) + head - 1;
 }
 
 /**
@@ -152,7 +169,8 @@ static inline int sys_ring_buf_space_get(struct ring_buf *buf)
  *
  * Concurrency control is not implemented, however no synchronization is needed
  * between put() and get() operations as they independently work on the
- * tail and head values, respectively.
+ * tail and head values, respectively: one producer and one consumer, e.g. an
+ * ISR and a thread, can use the buffer concurrently without locking.
  * Any use-cases involving multiple producers will need to synchronize use
  * of this function, by either disabling preemption or using a mutex.
  *
@@ -169,6 +187,9 @@ int sys_ring_buf_put(struct ring_buf *buf, uint16_t type, uint8_t value,
 /**
  * @brief Fetch data from the ring buffer
  *
+ * Any use-cases involving multiple consumers will need to synchronize use
+ * of this function, as for sys_ring_buf_put().
+ *
  * @param buf Ring buffer to extract data from
  * @param type Return storage of the retrieved event type
  * @param value Return storage of the data value
@@ -182,6 +203,97 @@ int sys_ring_buf_put(struct ring_buf *buf, uint16_t type, uint8_t value,
 int sys_ring_buf_get(struct ring_buf *buf, uint16_t *type, uint8_t *value,
 		     uint32_t *data, uint8_t *size32);
 
+/*
+ * Byte stream access
+ *
+ * A ring buffer can also carry a stream of bytes instead of items: its data
+ * area then holds size * 4 bytes, one of which is always kept empty. A given
+ * ring buffer must be used either for items or for bytes, not both. The same
+ * rules apply for concurrency: one producer and one consumer need no locking.
+ *
+ * The claim routines give direct access to the largest contiguous area that
+ * can be written or read, so that the data can be produced or consumed in
+ * place; the matching finish routine then commits what was used of it.
+ */
+
+/**
+ * @brief Claim contiguous space in a byte stream ring buffer
+ *
+ * Finds the contiguous free area following the data already in the buffer.
+ * Nothing is reserved until sys_ring_buf_byte_put_finish() is called, and
+ * claiming again returns the same area.
+ *
+ * @param buf Ring buffer to write to
+ * @param data Return storage of the address of the free area
+ * @param size Number of bytes wanted
+ * @return Number of bytes that can be written at *data, up to size; 0 if the
+ *	buffer is full
+ */
+uint32_t sys_ring_buf_byte_put_claim(struct ring_buf *buf, uint8_t **data,
+				     uint32_t size);
+
+/**
+ * @brief Commit the bytes written in a byte stream ring buffer
+ *
+ * Makes the first size bytes of the area returned by
+ * sys_ring_buf_byte_put_claim() available to the consumer.
+ *
+ * @param buf Ring buffer written to
+ * @param size Number of bytes written
+ * @return 0 on success, -EINVAL if size exceeds the free space
+ */
+int sys_ring_buf_byte_put_finish(struct ring_buf *buf, uint32_t size);
+
+/**
+ * @brief Copy bytes into a byte stream ring buffer
+ *
+ * @param buf Ring buffer to write to
+ * @param data Bytes to copy
+ * @param size Number of bytes to copy
+ * @return Number of bytes copied, less than size if the buffer became full
+ */
+uint32_t sys_ring_buf_byte_put(struct ring_buf *buf, const uint8_t *data,
+			       uint32_t size);
+
+/**
+ * @brief Claim contiguous data in a byte stream ring buffer
+ *
+ * Finds the contiguous data at the front of the buffer. Nothing is removed
+ * from the buffer until sys_ring_buf_byte_get_finish() is called, and
+ * claiming again returns the same data.
+ *
+ * @param buf Ring buffer to read from
+ * @param data Return storage of the address of the data
+ * @param size Number of bytes wanted
+ * @return Number of bytes that can be read at *data, up to size; 0 if the
+ *	buffer is empty
+ */
+uint32_t sys_ring_buf_byte_get_claim(struct ring_buf *buf, uint8_t **data,
+				     uint32_t size);
+
+/**
+ * @brief Release the bytes read from a byte stream ring buffer
+ *
+ * Frees the first size bytes of the data returned by
+ * sys_ring_buf_byte_get_claim() for the producer.
+ *
+ * @param buf Ring buffer read from
+ * @param size Number of bytes read
+ * @return 0 on success, -EINVAL if size exceeds the data in the buffer
+ */
+int sys_ring_buf_byte_get_finish(struct ring_buf *buf, uint32_t size);
+
+/**
+ * @brief Copy bytes out of a byte stream ring buffer
+ *
+ * @param buf Ring buffer to read from
+ * @param data Buffer to copy the bytes into
+ * @param size Size of the data buffer, in bytes
+ * @return Number of bytes copied, less than size if the buffer became empty
+ */
+uint32_t sys_ring_buf_byte_get(struct ring_buf *buf, uint8_t *data,
+			       uint32_t size);
+
 /**
  * @}
  */
@@ -49,6 +49,18 @@ void shell_init(const char *prompt, const struct shell_cmd *cmds);
  */
 void shell_register_app_cmd_handler(shell_cmd_function_t handler);
 
+#ifdef CONFIG_THREAD_STACK_USAGE
+/** @brief Command handler printing the stack usage of all threads.
+ *
+ *  Applications add it to the commands passed to shell_init() with
+ *  SHELL_CMD_STACKS.
+ */
+int shell_cmd_stacks(int argc, char *argv[]);
+
+#define SHELL_CMD_STACKS { "stacks", shell_cmd_stacks, \
+			   "print the unused stack space of each thread" }
+#endif
+
 /** @brief Callback to get the current prompt.
  *
  *  @returns Current prompt string.
@@ -49,8 +49,8 @@ extern "C" {
 
 #define IS_SYS_LOG_ACTIVE 1
 
-/* decide print func */
-#if defined(CONFIG_STDOUT_CONSOLE)
+/* decide print func: deferred logging only applies to printk */
+#if defined(CONFIG_STDOUT_CONSOLE) && !defined(CONFIG_PRINTK_DEFERRED)
 #include <stdio.h>
 #define SYS_LOG_BACKEND_FN printf
 #else
@@ -86,6 +86,10 @@
 
     #define PERFOPT_ALIGN .balign 4
 
+  #elif defined(CONFIG_ARCH_POSIX)
+
+    #define PERFOPT_ALIGN .balign 16
+
   #else
 
     #error Architecture unsupported
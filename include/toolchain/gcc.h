@@ -76,6 +76,9 @@ do {                                                                    \
 #define likely(x)   __builtin_expect((long)!!(x), 1L)
 #define unlikely(x) __builtin_expect((long)!!(x), 0L)
 
+/* prevent the compiler from moving memory accesses across this point */
+#define compiler_barrier() __asm__ __volatile__ ("" : : : "memory")
+
 #define __weak __attribute__((__weak__))
 #define __unused __attribute__((__unused__))
 
@@ -264,7 +267,7 @@ A##a:
 		",%B0"                              \
 		"\n\t.type\t" #name ",%%object" :  : "n"(~(value)))
 
-#elif defined(CONFIG_X86) || defined(CONFIG_ARC)
+#elif defined(CONFIG_X86) || defined(CONFIG_ARC) || defined(CONFIG_ARCH_POSIX)
 
 #define GEN_ABSOLUTE_SYM(name, value)               \
 	__asm__(".globl\t" #name "\n\t.equ\t" #name \
@@ -17,16 +17,22 @@
 #include <errno.h>
 #include <string.h>
 #include <device.h>
+#include <init.h>
 #include <misc/util.h>
 #include <atomic.h>
 
-extern struct device __device_init_start[];
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+#include <nano_private.h>
+#include <wait_q.h>
+#include <ksched.h>
+#include <misc/__assert.h>
+#endif
+
 extern struct device __device_PRIMARY_start[];
 extern struct device __device_SECONDARY_start[];
 extern struct device __device_NANOKERNEL_start[];
 extern struct device __device_MICROKERNEL_start[];
 extern struct device __device_APPLICATION_start[];
-extern struct device __device_init_end[];
 
 static struct device *config_levels[] = {
 	__device_PRIMARY_start,
@@ -37,6 +43,82 @@ static struct device *config_levels[] = {
 	__device_init_end,
 };
 
+#ifdef CONFIG_DEVICE_LOOKUP_HASH
+#define DEVICE_HASH_MASK (CONFIG_DEVICE_LOOKUP_HASH_SIZE - 1)
+
+#if (CONFIG_DEVICE_LOOKUP_HASH_SIZE & DEVICE_HASH_MASK) != 0
+#error "CONFIG_DEVICE_LOOKUP_HASH_SIZE must be a power of 2"
+#endif
+
+/*
+ * Open addressing hash table of the devices, keyed by the hash of their name.
+ * Each slot holds the handle of a device (0 marking an empty slot) and the
+ * upper bits of the hash of its name, so that names are only compared when
+ * they are very likely to match. Devices are inserted in the order of the
+ * device table, so that a probe sequence finds devices sharing a name in the
+ * same order a linear search would.
+ */
+struct device_hash_slot {
+	uint16_t tag;
+	device_handle_t handle;
+};
+
+static struct device_hash_slot device_hash[CONFIG_DEVICE_LOOKUP_HASH_SIZE];
+
+/* devices past this one did not fit in the table */
+static struct device *device_hash_end = __device_init_start;
+
+static uint32_t device_name_hash(const char *name)
+{
+	uint32_t hash = 2166136261U; /* 32-bit FNV-1a */
+
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+/**
+ * @brief Index all the devices in the device hash table
+ *
+ * Devices without a name, such as the ones created by SYS_INIT(), are never
+ * looked up by name and are not indexed. If the table is too small, the
+ * remaining devices are left out and are found by a linear search.
+ */
+static void device_hash_build(void)
+{
+	struct device *info;
+
+	for (info = __device_init_start; info != __device_init_end; info++) {
+		const char *name = info->config->name;
+		uint32_t hash, slot;
+		int probes = 0;
+
+		if (!name[0]) {
+			continue;
+		}
+
+		hash = device_name_hash(name);
+		slot = hash & DEVICE_HASH_MASK;
+
+		while (device_hash[slot].handle) {
+			if (++probes == CONFIG_DEVICE_LOOKUP_HASH_SIZE) {
+				goto full;
+			}
+			slot = (slot + 1) & DEVICE_HASH_MASK;
+		}
+
+		device_hash[slot].tag = hash >> 16;
+		device_hash[slot].handle = device_handle_get(info);
+	}
+
+full:
+	device_hash_end = info;
+}
+#endif
+
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
 struct device_pm_ops device_pm_ops_nop = {device_pm_nop, device_pm_nop};
 extern uint32_t __device_busy_start[];
@@ -44,6 +126,320 @@ extern uint32_t __device_busy_end[];
 #define DEVICE_BUSY_SIZE (__device_busy_end - __device_busy_start)
 #endif
 
+static inline int device_is_bound(struct device *info)
+{
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+	device_init_wait(info);
+#endif
+	return info->driver_api != NULL;
+}
+
+/*
+ * Find a device by name. If bound is set, only devices that can be used are
+ * considered, which means waiting for the ones being initialized
+ * asynchronously.
+ */
+static struct device *device_lookup_linear(struct device *info,
+					   const char *name, int bound)
+{
+	for (; info != __device_init_end; info++) {
+		if (!strcmp(name, info->config->name) &&
+		    (!bound || device_is_bound(info))) {
+			return info;
+		}
+	}
+
+	return NULL;
+}
+
+#ifdef CONFIG_DEVICE_LOOKUP_HASH
+static struct device *device_lookup(const char *name, int bound)
+{
+	uint32_t hash, slot;
+	uint16_t tag;
+	int probes;
+
+	if (!name[0]) {
+		return device_lookup_linear(__device_init_start, name, bound);
+	}
+
+	hash = device_name_hash(name);
+	slot = hash & DEVICE_HASH_MASK;
+	tag = hash >> 16;
+
+	for (probes = 0; probes < CONFIG_DEVICE_LOOKUP_HASH_SIZE &&
+			 device_hash[slot].handle; probes++) {
+		if (device_hash[slot].tag == tag) {
+			struct device *info =
+				&__device_init_start[device_hash[slot].handle - 1];
+
+			if (!strcmp(name, info->config->name) &&
+			    (!bound || device_is_bound(info))) {
+				return info;
+			}
+		}
+		slot = (slot + 1) & DEVICE_HASH_MASK;
+	}
+
+	return device_lookup_linear(device_hash_end, name, bound);
+}
+#else
+static struct device *device_lookup(const char *name, int bound)
+{
+	return device_lookup_linear(__device_init_start, name, bound);
+}
+#endif
+
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+/* initialization states of an asynchronous device */
+#define DEVICE_ASYNC_IDLE 0 /* init level not reached yet */
+#define DEVICE_ASYNC_QUEUED 1
+#define DEVICE_ASYNC_RUNNING 2
+#define DEVICE_ASYNC_DONE 3
+
+/*
+ * All the devices before the cursor have been reached by the boot thread: the
+ * synchronous ones are initialized, the asynchronous ones are queued.
+ */
+static struct device *device_init_cursor = __device_init_start;
+
+/* threads waiting for the initialization of a device to progress */
+static _wait_q_t device_init_wait_q =
+	SYS_DLIST_STATIC_INIT(&device_init_wait_q);
+
+/* incremented each time the initialization of the devices progresses */
+static volatile uint32_t device_init_gen;
+
+static int device_async_queued;		/* queued, not running yet */
+static int device_async_blocking;	/* not deferred, not done yet */
+static int device_async_all_queued;	/* APPLICATION level reached */
+
+static int device_init_threads_started;
+static char __stack device_init_stacks[CONFIG_DEVICE_ASYNC_INIT_THREADS]
+				      [CONFIG_DEVICE_ASYNC_INIT_STACK_SIZE];
+
+static int device_is_initialized(struct device *dev)
+{
+	struct device_async *async = dev->config->async;
+
+	if (async) {
+		return async->state == DEVICE_ASYNC_DONE;
+	}
+
+	return dev < device_init_cursor;
+}
+
+/* devices that are not found are not waited for */
+static int device_async_deps_done(struct device_async *async)
+{
+	for (int i = 0; i < async->num_deps; i++) {
+		struct device *dep = device_lookup(async->deps[i], 0);
+
+		if (dep && !device_is_initialized(dep)) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/* wake up all the threads waiting for the initialization to progress */
+static void device_async_wake(void)
+{
+	unsigned int key = irq_lock();
+	struct k_thread *thread;
+
+	device_init_gen++;
+
+	while ((thread = _unpend_first_thread(&device_init_wait_q))) {
+		_abort_thread_timeout(thread);
+		_ready_thread(thread);
+	}
+
+	_reschedule_threads(key);
+}
+
+/* wait for the initialization to progress, unless it did since gen */
+static void device_async_pend(uint32_t gen)
+{
+	unsigned int key = irq_lock();
+
+	if (gen != device_init_gen) {
+		irq_unlock(key);
+		return;
+	}
+
+	_pend_current_thread(&device_init_wait_q, K_FOREVER);
+	_Swap(key);
+}
+
+static int device_async_claim(struct device_async *async)
+{
+	unsigned int key = irq_lock();
+	int claimed = async->state == DEVICE_ASYNC_QUEUED;
+
+	if (claimed) {
+		async->state = DEVICE_ASYNC_RUNNING;
+		device_async_queued--;
+	}
+
+	irq_unlock(key);
+
+	return claimed;
+}
+
+/* the device must have been claimed */
+static void device_async_run(struct device *dev)
+{
+	struct device_async *async = dev->config->async;
+	unsigned int key;
+
+	dev->config->init(dev);
+
+	key = irq_lock();
+	async->state = DEVICE_ASYNC_DONE;
+	if (!(async->flags & DEVICE_INIT_DEFERRED)) {
+		device_async_blocking--;
+	}
+	irq_unlock(key);
+
+	device_async_wake();
+}
+
+/*
+ * Initialize the first queued device whose dependencies are initialized, if
+ * any. Returns 1 if a device was initialized, 0 otherwise.
+ */
+static int device_async_run_next(int deferred)
+{
+	struct device *info;
+
+	for (info = __device_init_start; info < device_init_cursor; info++) {
+		struct device_async *async = info->config->async;
+
+		if (!async || async->state != DEVICE_ASYNC_QUEUED ||
+		    (!deferred && (async->flags & DEVICE_INIT_DEFERRED))) {
+			continue;
+		}
+
+		if (device_async_deps_done(async) && device_async_claim(async)) {
+			device_async_run(info);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void device_init_thread(void *unused1, void *unused2, void *unused3)
+{
+	ARG_UNUSED(unused1);
+	ARG_UNUSED(unused2);
+	ARG_UNUSED(unused3);
+
+	while (1) {
+		uint32_t gen = device_init_gen;
+
+		if (device_async_run_next(1)) {
+			continue;
+		}
+
+		if (device_async_all_queued && device_async_queued == 0) {
+			return;
+		}
+
+		device_async_pend(gen);
+	}
+}
+
+static void device_async_queue(struct device *dev)
+{
+	struct device_async *async = dev->config->async;
+	unsigned int key;
+
+	if (!device_init_threads_started) {
+		device_init_threads_started = 1;
+		for (int i = 0; i < CONFIG_DEVICE_ASYNC_INIT_THREADS; i++) {
+			k_thread_spawn(device_init_stacks[i],
+				       CONFIG_DEVICE_ASYNC_INIT_STACK_SIZE,
+				       device_init_thread, NULL, NULL, NULL,
+				       CONFIG_MAIN_THREAD_PRIORITY, 0, 0);
+		}
+	}
+
+	key = irq_lock();
+	async->state = DEVICE_ASYNC_QUEUED;
+	device_async_queued++;
+	if (!(async->flags & DEVICE_INIT_DEFERRED)) {
+		device_async_blocking++;
+	}
+	device_init_cursor = dev + 1;
+	irq_unlock(key);
+
+	device_async_wake();
+}
+
+/* called after the boot thread has initialized a device synchronously */
+static void device_async_advance(struct device *dev)
+{
+	if (dev->config->async) {
+		dev->config->async->state = DEVICE_ASYNC_DONE;
+	}
+
+	device_init_cursor = dev + 1;
+
+	if (device_init_threads_started) {
+		device_async_wake();
+	}
+}
+
+/*
+ * Wait for the devices of a level that are not deferred, helping the device
+ * init threads in the meantime.
+ */
+static void device_async_level_done(int level)
+{
+	while (device_async_blocking) {
+		uint32_t gen = device_init_gen;
+
+		if (!device_async_run_next(0)) {
+			device_async_pend(gen);
+		}
+	}
+
+	if (level == _SYS_INIT_LEVEL_APPLICATION) {
+		device_async_all_queued = 1;
+		device_async_wake();
+	}
+}
+
+void device_init_wait(struct device *dev)
+{
+	struct device_async *async = dev->config->async;
+
+	if (!async) {
+		return;
+	}
+
+	while (async->state == DEVICE_ASYNC_QUEUED ||
+	       async->state == DEVICE_ASYNC_RUNNING) {
+		uint32_t gen = device_init_gen;
+
+		__ASSERT(!_is_in_isr(), "device %s not initialized yet\n",
+			 dev->config->name);
+
+		/* not started yet: initialize it in the caller */
+		if (async->state == DEVICE_ASYNC_QUEUED &&
+		    device_async_deps_done(async) && device_async_claim(async)) {
+			device_async_run(dev);
+			return;
+		}
+
+		device_async_pend(gen);
+	}
+}
+#endif
+
 /**
  * @brief Execute all the device initialization functions at a given level
  *
@@ -59,24 +455,38 @@ void _sys_device_do_config_level(int level)
 {
 	struct device *info;
 
+#ifdef CONFIG_DEVICE_LOOKUP_HASH
+	if (level == _SYS_INIT_LEVEL_PRIMARY) {
+		device_hash_build();
+	}
+#endif
+
 	for (info = config_levels[level]; info < config_levels[level+1]; info++) {
 		struct device_config *device = info->config;
 
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+		if (device->async && level != _SYS_INIT_LEVEL_PRIMARY) {
+			device_async_queue(info);
+			continue;
+		}
+
+		device->init(info);
+		device_async_advance(info);
+#else
 		device->init(info);
+#endif
 	}
+
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+	if (level != _SYS_INIT_LEVEL_PRIMARY) {
+		device_async_level_done(level);
+	}
+#endif
 }
 
 struct device *device_get_binding(const char *name)
 {
-	struct device *info;
-
-	for (info = __device_init_start; info != __device_init_end; info++) {
-		if (info->driver_api && !strcmp(name, info->config->name)) {
-			return info;
-		}
-	}
-
-	return NULL;
+	return device_lookup(name, 1);
 }
 
 #ifdef CONFIG_DEVICE_POWER_MANAGEMENT
@@ -34,10 +34,29 @@ void k_fifo_init(struct k_fifo *fifo)
 {
 	sys_slist_init(&fifo->data_q);
 	sys_dlist_init(&fifo->wait_q);
+#ifdef CONFIG_POLL
+	fifo->poll_event = NULL;
+#endif
 
 	SYS_TRACING_OBJ_INIT(k_fifo, fifo);
 }
 
+/*
+ * Notify the thread polling the fifo, if any, that data is available.
+ *
+ * Returns 1 if a thread was readied, 0 otherwise.
+ */
+static inline int handle_poll_event(struct k_fifo *fifo)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_FIFO_DATA_AVAILABLE;
+
+	return _handle_obj_poll_event(&fifo->poll_event, state);
+#else
+	return 0;
+#endif
+}
+
 static void prepare_thread_to_run(struct k_thread *thread, void *data)
 {
 	_abort_thread_timeout(thread);
@@ -62,6 +81,11 @@ void k_fifo_put(struct k_fifo *fifo, void *data)
 		}
 	} else {
 		sys_slist_append(&fifo->data_q, data);
+		if (handle_poll_event(fifo) &&
+		    !_is_in_isr() && _must_switch_threads()) {
+			(void)_Swap(key);
+			return;
+		}
 	}
 
 	irq_unlock(key);
@@ -72,6 +96,7 @@ void k_fifo_put_list(struct k_fifo *fifo, void *head, void *tail)
 	__ASSERT(head && tail, "invalid head or tail");
 
 	struct k_thread *first_thread, *thread;
+	int poller_readied = 0;
 	unsigned int key;
 
 	key = irq_lock();
@@ -84,9 +109,10 @@ void k_fifo_put_list(struct k_fifo *fifo, void *head, void *tail)
 
 	if (head) {
 		sys_slist_append_list(&fifo->data_q, head, tail);
+		poller_readied = handle_poll_event(fifo);
 	}
 
-	if (first_thread) {
+	if (first_thread || poller_readied) {
 		if (!_is_in_isr() && _must_switch_threads()) {
 			(void)_Swap(key);
 			return;
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief High-resolution timeout queue
+ *
+ * High-resolution timeouts expire at an absolute hardware cycle count instead
+ * of a system tick. They are kept in a list sorted by expiry cycle, and the
+ * system timer driver is programmed to interrupt at the expiry cycle of the
+ * first one. Expiry cycles are compared relative to each other, so that they
+ * can wrap around, which limits durations to 2^31 cycles.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <ksched.h>
+#include <wait_q.h>
+#include <drivers/system_timer.h>
+
+/* queued high-resolution timeouts, the one expiring first at the head */
+static sys_dlist_t hires_timeout_q = SYS_DLIST_STATIC_INIT(&hires_timeout_q);
+
+/* set while expired timeouts are handled, which reprograms the timer once */
+static int hires_announcing;
+
+static inline int is_cycle_before(uint32_t c1, uint32_t c2)
+{
+	return (int32_t)(c1 - c2) < 0;
+}
+
+/*
+ * callback for sys_dlist_insert_at(): insert before the first timeout that
+ * expires strictly later, so that timeouts expiring at the same cycle are
+ * handled in the order they were added
+ */
+static int is_hires_insert_point(sys_dnode_t *node, void *expiry_cycle)
+{
+	struct _hires_timeout *t = (struct _hires_timeout *)node;
+
+	return is_cycle_before(*(uint32_t *)expiry_cycle, t->expiry_cycle);
+}
+
+/* program the timer driver for the first timeout, if any */
+static void hires_timer_program(void)
+{
+	struct _hires_timeout *first =
+		(struct _hires_timeout *)sys_dlist_peek_head(&hires_timeout_q);
+
+	if (first) {
+		_timer_hires_set(first->expiry_cycle);
+	} else {
+		_timer_hires_cancel();
+	}
+}
+
+void _hires_timeout_add(struct _hires_timeout *t, uint32_t expiry_cycle)
+{
+	t->expiry_cycle = expiry_cycle;
+	sys_dlist_insert_at(&hires_timeout_q, &t->node, is_hires_insert_point,
+			    &t->expiry_cycle);
+
+	if (!hires_announcing &&
+	    sys_dlist_peek_head(&hires_timeout_q) == &t->node) {
+		hires_timer_program();
+	}
+}
+
+int _hires_timeout_abort(struct _hires_timeout *t)
+{
+	int was_first;
+
+	if (!_is_hires_timeout_queued(t)) {
+		return -1;
+	}
+
+	was_first = sys_dlist_peek_head(&hires_timeout_q) == &t->node;
+
+	sys_dlist_remove(&t->node);
+	t->node.next = NULL;
+
+	if (was_first && !hires_announcing) {
+		hires_timer_program();
+	}
+
+	return 0;
+}
+
+/**
+ *
+ * @brief Announce a high-resolution timer interrupt to the kernel
+ *
+ * This function is only to be called by the system timer driver from its
+ * high-resolution timer interrupt handler. It handles the timeouts that have
+ * expired, then programs the driver for the next one.
+ *
+ * @return N/A
+ */
+void _sys_clock_hires_announce(void)
+{
+	unsigned int key = irq_lock();
+	uint32_t now = k_cycle_get_32();
+	struct _hires_timeout *t;
+
+	hires_announcing = 1;
+
+	while ((t = (struct _hires_timeout *)
+		    sys_dlist_peek_head(&hires_timeout_q)) &&
+	       !is_cycle_before(now, t->expiry_cycle)) {
+		sys_dlist_remove(&t->node);
+		t->node.next = NULL;
+
+		/* the handler may add the timeout again */
+		t->func(t);
+	}
+
+	hires_announcing = 0;
+	hires_timer_program();
+
+	irq_unlock(key);
+}
+
+static void hires_sleep_expired(struct _hires_timeout *t)
+{
+	_ready_thread(CONTAINER_OF(t, struct k_thread, hires_timeout));
+}
+
+void k_sleep_cycles(uint32_t cycles)
+{
+	__ASSERT(!_is_in_isr(), "");
+	__ASSERT((int32_t)cycles >= 0, "duration too long\n");
+
+	unsigned int key;
+
+	if (cycles == 0) {
+		k_yield();
+		return;
+	}
+
+	_init_hires_timeout(&_current->hires_timeout, hires_sleep_expired);
+
+	key = irq_lock();
+
+	_mark_thread_as_timing(_current);
+	_remove_thread_from_ready_q(_current);
+	_hires_timeout_add(&_current->hires_timeout, k_cycle_get_32() + cycles);
+
+	_Swap(key);
+}
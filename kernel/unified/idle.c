@@ -58,7 +58,11 @@ static void set_kernel_idle_time_in_ticks(int32_t ticks)
 
 static void _sys_power_save_idle(int32_t ticks __unused)
 {
-#if defined(CONFIG_TICKLESS_IDLE)
+	/*
+	 * With the tickless kernel, the timer is always programmed for the
+	 * next timeout: there is nothing to do for the idle period.
+	 */
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/*
 		 * Stop generating system timer interrupts until it's time for
@@ -111,7 +115,7 @@ void _sys_power_save_idle_exit(int32_t ticks)
 		_sys_soc_resume();
 	}
 #endif
-#ifdef CONFIG_TICKLESS_IDLE
+#if defined(CONFIG_TICKLESS_IDLE) && !defined(CONFIG_TICKLESS_KERNEL)
 	if ((ticks == K_FOREVER) || ticks >= _sys_idle_threshold_ticks) {
 		/* Resume normal periodic system timer interrupts */
 
@@ -138,7 +142,8 @@ void idle(void *unused1, void *unused2, void *unused3)
 #endif
 
 	for (;;) {
-		_sys_power_save_idle(_get_next_timeout_expiry());
+		_sys_power_save_idle(
+			_thread_runtime_bound_ticks(_get_next_timeout_expiry()));
 
 		k_yield();
 	}
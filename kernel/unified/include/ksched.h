@@ -21,6 +21,7 @@
 #include <nano_private.h>
 #include <atomic.h>
 #include <misc/dlist.h>
+#include <ktrace.h>
 
 extern k_tid_t const _main_thread;
 extern k_tid_t const _idle_thread;
@@ -32,11 +33,21 @@ extern void k_sched_unlock(void);
 extern void _pend_thread(struct k_thread *thread,
 			 _wait_q_t *wait_q, int32_t timeout);
 extern void _pend_current_thread(_wait_q_t *wait_q, int32_t timeout);
+extern void _reorder_pended_thread(struct k_thread *thread,
+				   _wait_q_t *wait_q);
 extern void _move_thread_to_end_of_prio_q(struct k_thread *thread);
 extern struct k_thread *_get_next_ready_thread(void);
 extern int __must_switch_threads(void);
 extern int32_t _ms_to_ticks(int32_t ms);
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+extern void _thread_runtime_update(void);
+extern int32_t _thread_runtime_bound_ticks(int32_t ticks);
+#else
+#define _thread_runtime_update() do { } while (0)
+#define _thread_runtime_bound_ticks(ticks) (ticks)
+#endif
+
 /*
  * The _is_prio_higher family: I created this because higher priorities are
  * lower numerically and I always found somewhat confusing seeing, e.g.:
@@ -71,6 +82,15 @@ static inline int _is_higher_prio_than_current(struct k_thread *thread)
 	return _is_t1_higher_prio_than_t2(thread, _nanokernel.current);
 }
 
+#ifdef CONFIG_SCHED_DEADLINE
+/* deadlines wrap around with the hardware clock: compare them as a delta */
+static inline int _is_deadline_earlier(struct k_thread *t1,
+				       struct k_thread *t2)
+{
+	return (int32_t)(t1->deadline - t2->deadline) < 0;
+}
+#endif
+
 /* is thread currenlty cooperative ? */
 static inline int _is_coop(struct k_thread *thread)
 {
@@ -122,17 +142,29 @@ static inline int _get_ready_q_q_index(int prio)
 	return prio + CONFIG_NUM_COOP_PRIORITIES;
 }
 
-#if (K_NUM_PRIORITIES > 32)
-	#error not supported yet
+/* the summary bitmap has one bit per priority bitmap */
+#if (K_NUM_PRIO_BITMAPS > 32)
+	#error too many priorities
 #endif
 
-/* find out the currently highest priority where a thread is ready to run */
+/*
+ * Find out the currently highest priority where a thread is ready to run: the
+ * summary bitmap gives the first non-empty priority bitmap, which gives the
+ * priority. This takes at most two find-first-set operations, whatever the
+ * number of priorities.
+ */
 /* interrupts must be locked */
 static inline int _get_highest_ready_prio(void)
 {
-	uint32_t ready = _nanokernel.ready_q.prio_bmap[0];
+#if (K_NUM_PRIO_BITMAPS > 1)
+	int bmap_index = find_lsb_set(_nanokernel.ready_q.prio_bmap_summary) - 1;
+#else
+	int bmap_index = 0;
+#endif
+	uint32_t ready = _nanokernel.ready_q.prio_bmap[bmap_index];
 
-	return find_lsb_set(ready) - 1 - CONFIG_NUM_COOP_PRIORITIES;
+	return (bmap_index << 5) + find_lsb_set(ready) - 1 -
+	       CONFIG_NUM_COOP_PRIORITIES;
 }
 
 /*
@@ -321,6 +353,7 @@ static inline struct k_thread *_unpend_first_thread(_wait_q_t *wait_q)
 
 	if (thread) {
 		_mark_thread_as_not_pending(thread);
+		_k_trace_unpend(thread, wait_q);
 	}
 
 	return thread;
@@ -334,6 +367,7 @@ static inline void _unpend_thread(struct k_thread *thread)
 
 	sys_dlist_remove(&thread->k_q_node);
 	_mark_thread_as_not_pending(thread);
+	_k_trace_unpend(thread, NULL);
 }
 
 #endif /* _ksched__h_ */
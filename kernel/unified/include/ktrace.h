@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Kernel trace stream hooks
+ *
+ * Hooks recording kernel events in the binary trace stream. They compile to
+ * nothing when CONFIG_KERNEL_TRACE is disabled.
+ */
+
+#ifndef _ktrace__h_
+#define _ktrace__h_
+
+#include <stdint.h>
+#include <misc/kernel_trace.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef CONFIG_KERNEL_TRACE
+
+extern void _sys_k_trace_put(uint32_t hdr, uint32_t d0, uint32_t d1,
+			     uint32_t d2);
+
+#define _K_TRACE_PTR(p) ((uint32_t)(uintptr_t)(p))
+
+#define _k_trace_thread_switch(thread) \
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_THREAD_SWITCH, 3, \
+				     (uint16_t)(thread)->prio), \
+			 _K_TRACE_PTR(thread), 0, 0)
+
+#define _k_trace_pend(thread, wait_q, timeout) \
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_PEND, 5, 0), \
+			 _K_TRACE_PTR(thread), _K_TRACE_PTR(wait_q), \
+			 (uint32_t)(timeout))
+
+#define _k_trace_unpend(thread, wait_q) \
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_UNPEND, 4, 0), \
+			 _K_TRACE_PTR(thread), _K_TRACE_PTR(wait_q), 0)
+
+#define _k_trace_timeout_add(timeout_obj, thread, ticks) \
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_TIMEOUT_ADD, 5, 0), \
+			 _K_TRACE_PTR(timeout_obj), _K_TRACE_PTR(thread), \
+			 (uint32_t)(ticks))
+
+#define _k_trace_timeout_expire(timeout_obj, thread) \
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_TIMEOUT_EXPIRE, 4, 0), \
+			 _K_TRACE_PTR(timeout_obj), _K_TRACE_PTR(thread), 0)
+
+#else
+
+#define _k_trace_thread_switch(thread) do { } while (0)
+#define _k_trace_pend(thread, wait_q, timeout) do { } while (0)
+#define _k_trace_unpend(thread, wait_q) do { } while (0)
+#define _k_trace_timeout_add(timeout_obj, thread, ticks) do { } while (0)
+#define _k_trace_timeout_expire(timeout_obj, thread) do { } while (0)
+
+#endif /* CONFIG_KERNEL_TRACE */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ktrace__h_ */
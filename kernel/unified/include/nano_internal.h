@@ -28,6 +28,12 @@
 #ifdef CONFIG_KERNEL_V2
 #define K_NUM_PRIORITIES \
 	(CONFIG_NUM_COOP_PRIORITIES + CONFIG_NUM_PREEMPT_PRIORITIES + 1)
+
+/*
+ * One bit per priority in the ready queue bitmaps; when there is more than
+ * one bitmap, a summary bitmap has one bit per non-empty bitmap.
+ */
+#define K_NUM_PRIO_BITMAPS ((K_NUM_PRIORITIES + 31) >> 5)
 #endif
 
 #ifndef _ASMLANGUAGE
@@ -24,11 +24,27 @@
 #define _kernel_nanokernel_include_timeout_q__h_
 
 #include <misc/dlist.h>
+#include <ktrace.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * With the tickless kernel, the tick count must be brought up to date before
+ * timeouts are queued or read, and the timer reprogrammed when the next
+ * deadline moves. See sys_clock.c.
+ *
+ * Must be called with interrupts locked.
+ */
+extern void _sys_clock_tick_update(void);
+extern void _sys_clock_deadline_update(void);
+#else
+#define _sys_clock_tick_update() do { } while ((0))
+#define _sys_clock_deadline_update() do { } while ((0))
+#endif
+
 /* initialize the nano timeouts part of k_thread when enabled in the kernel */
 
 static inline void _init_timeout(struct _timeout *t, _timeout_func_t func)
@@ -77,6 +93,11 @@ static inline void _init_thread_timeout(struct k_thread *thread)
 static inline void _nano_timeout_tcs_init(struct tcs *tcs)
 {
 	_init_thread_timeout(tcs);
+
+#ifdef CONFIG_SYS_CLOCK_HIRES
+	/* not queued, so that aborting the thread can check it */
+	tcs->hires_timeout.node.next = NULL;
+#endif
 }
 
 /* remove a thread timing out from kernel object's wait queue */
@@ -90,6 +111,142 @@ static inline void _unpend_thread_timing_out(struct k_thread *thread,
 	}
 }
 
+#ifdef CONFIG_TIMEOUT_QUEUE_PAIRING_HEAP
+
+/*
+ * Pairing heap backend: timeouts are ordered by their absolute expiry tick,
+ * which is compared to the lower 32 bits of the system tick count. The
+ * heap itself is maintained in timeout_q.c.
+ */
+
+extern struct _timeout *_timeout_heap;
+
+extern void _timeout_heap_insert(struct _timeout *t);
+extern void _timeout_heap_remove(struct _timeout *t);
+
+/* number of ticks until a queued timeout expires, <= 0 if it is due */
+
+static inline int32_t _timeout_ticks_left(struct _timeout *t)
+{
+	return (int32_t)(t->expiry_tick - (uint32_t)_sys_clock_tick_count);
+}
+
+/*
+ * Handle one expired timeout.
+ *
+ * This removes the timeout from the heap root, and also removes the thread
+ * from the wait queue it is on if waiting for an object. In that case,
+ * the return value is kept as -EAGAIN, set previously in _Swap().
+ *
+ * Must be called with interrupts locked.
+ */
+
+static inline struct _timeout *_handle_one_timeout(struct _timeout *t)
+{
+	struct k_thread *thread = t->thread;
+
+	_timeout_heap_remove(t);
+	t->delta_ticks_from_prev = 0;
+
+	K_DEBUG("timeout %p\n", t);
+	_k_trace_timeout_expire(t, thread);
+	if (thread != NULL) {
+		_unpend_thread_timing_out(thread, t);
+		_ready_thread(thread);
+	} else if (t->func) {
+		t->func(t);
+	}
+	/*
+	 * Note: t->func() may add timeout again. Make sure that
+	 * delta_ticks_from_prev is set to -1 only if timeout is
+	 * still expired (delta_ticks_from_prev == 0)
+	 */
+	if (t->delta_ticks_from_prev == 0) {
+		t->delta_ticks_from_prev = -1;
+	}
+
+	return _timeout_heap;
+}
+
+/*
+ * Loop over all expired timeouts and handle them one by one.
+ * Must be called with interrupts locked.
+ */
+
+static inline void _handle_timeouts(void)
+{
+	struct _timeout *next = _timeout_heap;
+
+	while (next && _timeout_ticks_left(next) <= 0) {
+		next = _handle_one_timeout(next);
+	}
+}
+
+/* returns 0 in success and -1 if the timer has expired */
+
+static inline int _abort_timeout(struct _timeout *t)
+{
+	if (-1 == t->delta_ticks_from_prev) {
+		return -1;
+	}
+
+	_timeout_heap_remove(t);
+	t->delta_ticks_from_prev = -1;
+
+	return 0;
+}
+
+/*
+ * Add timeout to timeout queue. Record waiting thread and wait queue if any.
+ *
+ * Cannot handle timeout == 0 and timeout == K_FOREVER.
+ */
+
+static inline void _add_timeout(struct k_thread *thread,
+				struct _timeout *timeout_obj,
+				_wait_q_t *wait_q, int32_t timeout)
+{
+	__ASSERT(timeout > 0, "");
+
+	K_DEBUG("thread %p on wait_q %p, for timeout: %d\n",
+		thread, wait_q, timeout);
+	_k_trace_timeout_add(timeout_obj, thread, timeout);
+
+	_sys_clock_tick_update();
+
+	timeout_obj->thread = thread;
+	timeout_obj->delta_ticks_from_prev = timeout;
+	timeout_obj->wait_q = (sys_dlist_t *)wait_q;
+	timeout_obj->expiry_tick = (uint32_t)_sys_clock_tick_count + timeout;
+	_timeout_heap_insert(timeout_obj);
+
+	if (timeout_obj == _timeout_heap) {
+		_sys_clock_deadline_update();
+	}
+}
+
+/* find the number of ticks before a queued timeout expires */
+
+static inline int32_t _get_timeout_remaining_ticks(struct _timeout *t)
+{
+	_sys_clock_tick_update();
+
+	int32_t ticks = _timeout_ticks_left(t);
+
+	return ticks > 0 ? ticks : 0;
+}
+
+/* find the closest deadline in the timeout queue */
+
+static inline int32_t _get_next_timeout_expiry(void)
+{
+	struct _timeout *t = _timeout_heap;
+
+	return t ? _get_timeout_remaining_ticks(t) : K_FOREVER;
+}
+
+#else /* CONFIG_TIMEOUT_QUEUE_DLIST */
+
 /*
  * Handle one expired timeout.
  *
@@ -107,6 +264,7 @@ static inline struct _timeout *_handle_one_timeout(
 	struct k_thread *thread = t->thread;
 
 	K_DEBUG("timeout %p\n", t);
+	_k_trace_timeout_expire(t, thread);
 	if (thread != NULL) {
 		_unpend_thread_timing_out(thread, t);
 		_ready_thread(thread);
@@ -163,11 +321,6 @@ static inline int _abort_timeout(struct _timeout *t)
 	return 0;
 }
 
-static inline int _abort_thread_timeout(struct k_thread *thread)
-{
-	return _abort_timeout(&thread->timeout);
-}
-
 /*
  * callback for sys_dlist_insert_at():
  *
@@ -209,9 +362,12 @@ static inline void _add_timeout(struct k_thread *thread,
 
 	K_DEBUG("thread %p on wait_q %p, for timeout: %d\n",
 		thread, wait_q, timeout);
+	_k_trace_timeout_add(timeout_obj, thread, timeout);
 
 	sys_dlist_t *timeout_q = &_nanokernel.timeout_q;
 
+	_sys_clock_tick_update();
+
 	K_DEBUG("timeout_q %p before: head: %p, tail: %p\n",
 		&_nanokernel.timeout_q,
 		sys_dlist_peek_head(&_nanokernel.timeout_q),
@@ -227,6 +383,10 @@ static inline void _add_timeout(struct k_thread *thread,
 			    _is_timeout_insert_point,
 			    &timeout_obj->delta_ticks_from_prev);
 
+	if (sys_dlist_is_head(timeout_q, &timeout_obj->node)) {
+		_sys_clock_deadline_update();
+	}
+
 	K_DEBUG("timeout_q %p after:  head: %p, tail: %p\n",
 		&_nanokernel.timeout_q,
 		sys_dlist_peek_head(&_nanokernel.timeout_q),
@@ -236,6 +396,45 @@ static inline void _add_timeout(struct k_thread *thread,
 		timeout_obj, timeout_obj->node.next, timeout_obj->node.prev);
 }
 
+/*
+ * Find the number of ticks before a queued timeout expires, by walking the
+ * timeout queue and summing up the various tick deltas involved.
+ */
+
+static inline int32_t _get_timeout_remaining_ticks(struct _timeout *timeout)
+{
+	sys_dlist_t *timeout_q = &_nanokernel.timeout_q;
+
+	_sys_clock_tick_update();
+
+	struct _timeout *t = (struct _timeout *)sys_dlist_peek_head(timeout_q);
+	int32_t remaining_ticks = t->delta_ticks_from_prev;
+
+	while (t != timeout) {
+		t = (struct _timeout *)sys_dlist_peek_next(timeout_q, &t->node);
+		remaining_ticks += t->delta_ticks_from_prev;
+	}
+
+	return remaining_ticks;
+}
+
+/* find the closest deadline in the timeout queue */
+
+static inline int32_t _get_next_timeout_expiry(void)
+{
+	struct _timeout *t = (struct _timeout *)
+			     sys_dlist_peek_head(&_timeout_q);
+
+	return t ? t->delta_ticks_from_prev : K_FOREVER;
+}
+
+#endif /* CONFIG_TIMEOUT_QUEUE_PAIRING_HEAP */
+
+static inline int _abort_thread_timeout(struct k_thread *thread)
+{
+	return _abort_timeout(&thread->timeout);
+}
+
 /*
  * Put thread on timeout queue. Record wait queue if any.
  *
@@ -248,16 +447,36 @@ static inline void _add_thread_timeout(struct k_thread *thread,
 	_add_timeout(thread, &thread->timeout, wait_q, timeout);
 }
 
-/* find the closest deadline in the timeout queue */
+#ifdef CONFIG_SYS_CLOCK_HIRES
 
-static inline int32_t _get_next_timeout_expiry(void)
+/*
+ * High-resolution timeouts are kept in their own queue, sorted by expiry
+ * cycle, and are handled from the high-resolution timer interrupt. See
+ * hires_timeout.c.
+ *
+ * Must be called with interrupts locked.
+ */
+
+extern void _hires_timeout_add(struct _hires_timeout *t,
+			       uint32_t expiry_cycle);
+
+/* returns 0 in success and -1 if the timeout is not queued */
+extern int _hires_timeout_abort(struct _hires_timeout *t);
+
+static inline void _init_hires_timeout(struct _hires_timeout *t,
+				       _hires_timeout_func_t func)
 {
-	struct _timeout *t = (struct _timeout *)
-			     sys_dlist_peek_head(&_timeout_q);
+	t->node.next = NULL;
+	t->func = func;
+}
 
-	return t ? t->delta_ticks_from_prev : K_FOREVER;
+static inline int _is_hires_timeout_queued(struct _hires_timeout *t)
+{
+	return t->node.next != NULL;
 }
 
+#endif /* CONFIG_SYS_CLOCK_HIRES */
+
 #ifdef __cplusplus
 }
 #endif
@@ -185,8 +185,11 @@ static void _main(void *unused1, void *unused2, void *unused3)
 	_sys_device_do_config_level(_SYS_INIT_LEVEL_MICROKERNEL);
 	_sys_device_do_config_level(_SYS_INIT_LEVEL_APPLICATION);
 
-#ifdef CONFIG_CPLUSPLUS
-	/* Process the .ctors and .init_array sections */
+#if defined(CONFIG_CPLUSPLUS) && !defined(CONFIG_ARCH_POSIX)
+	/*
+	 * Process the .ctors and .init_array sections; on the POSIX
+	 * architecture, the host C runtime did it before starting the kernel.
+	 */
 	extern void __do_global_ctors_aux(void);
 	extern void __do_init_array_aux(void);
 	__do_global_ctors_aux();
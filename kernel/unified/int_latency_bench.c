@@ -23,6 +23,9 @@
 #include <misc/printk.h> /* printk */
 #include <sys_clock.h>
 #include <drivers/system_timer.h>
+#include <misc/debug/int_latency.h>
+#include <arch/cpu.h>
+#include <string.h>
 
 #define NB_CACHE_WARMING_DRY_RUN 7
 
@@ -50,6 +53,208 @@ static uint32_t int_latency_bench_ready;
 /* min amount of time it takes from HW interrupt generation to 'C' handler */
 uint32_t _hw_irq_to_c_handler_latency = ULONG_MAX;
 
+#ifdef CONFIG_INT_LATENCY_HISTOGRAM
+
+#define NUM_SITES CONFIG_INT_LATENCY_HISTOGRAM_SITES
+#define SITE_MASK (NUM_SITES - 1)
+
+#if (NUM_SITES & SITE_MASK) != 0
+#error "CONFIG_INT_LATENCY_HISTOGRAM_SITES must be a power of 2"
+#endif
+
+/* caller of the outermost irq_lock() when interrupts got locked */
+static void *int_locked_pc;
+
+/* distribution of all interrupt locking durations */
+static struct int_latency_stats int_latency_all;
+
+/*
+ * Distribution per caller of irq_lock(), hashed on the caller address and
+ * using linear probing. Entries are never freed until the next reset, so an
+ * empty entry ends a search.
+ */
+static struct int_latency_site int_latency_sites[NUM_SITES];
+
+/* durations not accounted to any site, because the table was full */
+static uint32_t int_latency_sites_dropped;
+
+static inline int hist_bucket(uint32_t delta)
+{
+	int bucket = 31 - __builtin_clz(delta | 1);
+
+	return bucket < INT_LATENCY_HIST_BUCKETS ?
+	       bucket : INT_LATENCY_HIST_BUCKETS - 1;
+}
+
+static inline void stats_add(struct int_latency_stats *stats,
+			     uint32_t delta, int bucket)
+{
+	stats->count++;
+	stats->total += delta;
+	if (delta > stats->max) {
+		stats->max = delta;
+	}
+	stats->hist[bucket]++;
+}
+
+/*
+ * Find the entry of a caller, adding it if needed. When the table is full,
+ * the entry with the shortest maximum duration is replaced if the current
+ * duration is longer, so that the top offenders are always tracked.
+ */
+static struct int_latency_site *site_get(void *pc, uint32_t delta)
+{
+	uint32_t index = ((uint32_t)pc * 2654435761U) >> 16;
+	struct int_latency_site *site;
+	struct int_latency_site *victim;
+
+	for (int i = 0; i < NUM_SITES; i++) {
+		site = &int_latency_sites[(index + i) & SITE_MASK];
+
+		if (site->pc == pc) {
+			return site;
+		}
+
+		if (!site->pc) {
+			site->pc = pc;
+			return site;
+		}
+	}
+
+	victim = &int_latency_sites[0];
+	for (int i = 1; i < NUM_SITES; i++) {
+		if (int_latency_sites[i].stats.max < victim->stats.max) {
+			victim = &int_latency_sites[i];
+		}
+	}
+
+	if (victim->stats.max >= delta) {
+		int_latency_sites_dropped++;
+		return NULL;
+	}
+
+	memset(victim, 0, sizeof(*victim));
+	victim->pc = pc;
+
+	return victim;
+}
+
+/* must be called with interrupts locked */
+static void int_latency_record(uint32_t delta)
+{
+	struct int_latency_site *site = site_get(int_locked_pc, delta);
+	int bucket = hist_bucket(delta);
+
+	stats_add(&int_latency_all, delta, bucket);
+	if (site) {
+		stats_add(&site->stats, delta, bucket);
+	}
+}
+
+void int_latency_histogram_get(struct int_latency_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	*stats = int_latency_all;
+
+	irq_unlock(key);
+}
+
+int int_latency_top_sites_get(struct int_latency_site *sites, int num)
+{
+	unsigned int key = irq_lock();
+	int found = 0;
+
+	/* insertion sort of the tracked sites, longest maximum first */
+	for (int i = 0; i < NUM_SITES; i++) {
+		struct int_latency_site *site = &int_latency_sites[i];
+		int j;
+
+		if (!site->pc) {
+			continue;
+		}
+
+		for (j = found; j > 0; j--) {
+			if (sites[j - 1].stats.max >= site->stats.max) {
+				break;
+			}
+			if (j < num) {
+				sites[j] = sites[j - 1];
+			}
+		}
+
+		if (j < num) {
+			sites[j] = *site;
+			if (found < num) {
+				found++;
+			}
+		}
+	}
+
+	irq_unlock(key);
+
+	return found;
+}
+
+void int_latency_histogram_reset(void)
+{
+	unsigned int key = irq_lock();
+
+	memset(&int_latency_all, 0, sizeof(int_latency_all));
+	memset(int_latency_sites, 0, sizeof(int_latency_sites));
+	int_latency_sites_dropped = 0;
+
+	irq_unlock(key);
+}
+
+static void int_latency_stats_show(struct int_latency_stats *stats)
+{
+	printk("max %d tcs = %d nsec, avg %d nsec, count %d\n",
+	       stats->max, SYS_CLOCK_HW_CYCLES_TO_NS(stats->max),
+	       stats->count ?
+	       SYS_CLOCK_HW_CYCLES_TO_NS_AVG(stats->total, stats->count) : 0,
+	       stats->count);
+}
+
+static void int_latency_histogram_show(void)
+{
+	static struct int_latency_site sites[NUM_SITES];
+	struct int_latency_stats all;
+	int num;
+
+	int_latency_histogram_get(&all);
+	num = int_latency_top_sites_get(sites, NUM_SITES);
+
+	printk(" Interrupt lock durations: ");
+	int_latency_stats_show(&all);
+
+	for (int i = 0; i < INT_LATENCY_HIST_BUCKETS; i++) {
+		if (!all.hist[i]) {
+			continue;
+		}
+
+		if (i == INT_LATENCY_HIST_BUCKETS - 1) {
+			printk("  >= %d tcs: %d\n", 1 << i, all.hist[i]);
+		} else {
+			printk("  %d-%d tcs: %d\n",
+			       i ? 1 << i : 0, (2 << i) - 1, all.hist[i]);
+		}
+	}
+
+	printk(" Longest interrupt locks by caller:\n");
+	for (int i = 0; i < num; i++) {
+		printk("  %p: ", sites[i].pc);
+		int_latency_stats_show(&sites[i].stats);
+	}
+
+	if (int_latency_sites_dropped) {
+		printk("  (%d not accounted to a caller)\n",
+		       int_latency_sites_dropped);
+	}
+}
+
+#endif /* CONFIG_INT_LATENCY_HISTOGRAM */
+
 /**
  *
  * @brief Start tracking time spent with interrupts locked
@@ -66,6 +271,9 @@ void _int_latency_start(void)
 	if (!int_locked_timestamp && int_latency_bench_ready) {
 		int_locked_timestamp = sys_cycle_get_32();
 		int_lock_unlock_nest = 0;
+#ifdef CONFIG_INT_LATENCY_HISTOGRAM
+		int_locked_pc = __builtin_return_address(0);
+#endif
 	}
 	int_lock_unlock_nest++;
 }
@@ -116,6 +324,10 @@ void _int_latency_stop(void)
 		if (delta < int_locked_latency_min)
 			int_locked_latency_min = delta;
 
+#ifdef CONFIG_INT_LATENCY_HISTOGRAM
+		int_latency_record(delta);
+#endif
+
 		/* interrupts are now enabled, get ready for next interrupt lock
 		 */
 		int_locked_timestamp = 0;
@@ -171,6 +383,11 @@ void int_latency_init(void)
 
 		cacheWarming--;
 	}
+
+#ifdef CONFIG_INT_LATENCY_HISTOGRAM
+	/* forget the samples of the calibration */
+	int_latency_histogram_reset();
+#endif
 }
 
 /**
@@ -222,6 +439,10 @@ void int_latency_show(void)
 		       SYS_CLOCK_HW_CYCLES_TO_NS(nesting_delay),
 		       stop_delay,
 		       SYS_CLOCK_HW_CYCLES_TO_NS(stop_delay));
+
+#ifdef CONFIG_INT_LATENCY_HISTOGRAM
+		int_latency_histogram_show();
+#endif
 	} else {
 		printk("interrupts were not locked and unlocked yet\n");
 	}
@@ -232,4 +453,7 @@ void int_latency_show(void)
 	 */
 	int_locked_latency_min = ULONG_MAX;
 	int_locked_latency_max = 0;
+#ifdef CONFIG_INT_LATENCY_HISTOGRAM
+	int_latency_histogram_reset();
+#endif
 }
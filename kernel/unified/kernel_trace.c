@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Binary kernel trace stream.
+ *
+ * Records are written to a power-of-two ring buffer of 32-bit words. A writer
+ * reserves the words of its record by advancing the head index with a
+ * compare-and-swap, writes the record data, then writes the header word last:
+ * a zero header word means the record is not complete yet. Since the
+ * timestamp is taken right before the compare-and-swap succeeds, a writer
+ * interrupted between the two retries with a new timestamp, so the records
+ * are always in timestamp order.
+ *
+ * The reader consumes complete records from the tail index, clearing the
+ * words it consumes, so that the header of a record reserved later reads as
+ * zero until it is written. When the buffer is full, new events are dropped
+ * and counted.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <atomic.h>
+#include <init.h>
+#include <misc/util.h>
+#include <ktrace.h>
+#include <kernel_event_logger_arch.h>
+
+#define TRACE_BUF_SIZE CONFIG_KERNEL_TRACE_BUFFER_SIZE
+#define TRACE_BUF_MASK (TRACE_BUF_SIZE - 1)
+
+#if (TRACE_BUF_SIZE & TRACE_BUF_MASK) != 0
+#error "CONFIG_KERNEL_TRACE_BUFFER_SIZE must be a power of 2"
+#endif
+
+/*
+ * The trace buffer, with the information needed to decode a dump of it: the
+ * whole structure can be saved with a debugger and fed to the decoder.
+ */
+struct _k_trace_buf {
+	uint32_t magic;
+	uint32_t size;
+	uint32_t cycles_per_sec;
+	atomic_t head;
+	atomic_t tail;
+	atomic_t dropped;
+	uint32_t buf[TRACE_BUF_SIZE];
+};
+
+struct _k_trace_buf _k_trace_buf = {
+	.magic = K_TRACE_MAGIC,
+	.size = TRACE_BUF_SIZE,
+};
+
+void _sys_k_trace_put(uint32_t hdr, uint32_t d0, uint32_t d1, uint32_t d2)
+{
+	struct _k_trace_buf *tb = &_k_trace_buf;
+	uint32_t len = K_TRACE_HDR_LEN(hdr);
+	uint32_t *buf = tb->buf;
+	atomic_val_t head;
+	uint32_t timestamp;
+
+	do {
+		head = atomic_get(&tb->head);
+
+		if ((uint32_t)(head + len - atomic_get(&tb->tail)) >
+		    TRACE_BUF_SIZE) {
+			atomic_inc(&tb->dropped);
+			return;
+		}
+
+		timestamp = k_cycle_get_32();
+	} while (!atomic_cas(&tb->head, head, head + len));
+
+	buf[(head + 1) & TRACE_BUF_MASK] = timestamp;
+	if (len > 2) {
+		buf[(head + 2) & TRACE_BUF_MASK] = d0;
+	}
+	if (len > 3) {
+		buf[(head + 3) & TRACE_BUF_MASK] = d1;
+	}
+	if (len > 4) {
+		buf[(head + 4) & TRACE_BUF_MASK] = d2;
+	}
+
+	/* the header must be written last: it marks the record as complete */
+	compiler_barrier();
+	buf[head & TRACE_BUF_MASK] = hdr;
+}
+
+void sys_k_trace_user(uint16_t id, uint32_t value)
+{
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_USER, 3, id), value, 0, 0);
+}
+
+/* called from the interrupt entry and exit code */
+void _sys_k_trace_isr_enter(void)
+{
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_ISR_ENTER, 2,
+				     _sys_current_irq_key_get()), 0, 0, 0);
+}
+
+void _sys_k_trace_isr_exit(void)
+{
+	_sys_k_trace_put(K_TRACE_HDR(K_TRACE_ISR_EXIT, 2, 0), 0, 0, 0);
+}
+
+int sys_k_trace_read(void *buf, int size)
+{
+	struct _k_trace_buf *tb = &_k_trace_buf;
+	uint32_t *out = buf;
+	int max = size / sizeof(uint32_t);
+	int num = 0;
+	atomic_val_t dropped = atomic_set(&tb->dropped, 0);
+	atomic_val_t tail = atomic_get(&tb->tail);
+	atomic_val_t head = atomic_get(&tb->head);
+
+	if (dropped) {
+		if (max < 3) {
+			atomic_add(&tb->dropped, dropped);
+			return 0;
+		}
+
+		out[num++] = K_TRACE_HDR(K_TRACE_DROPPED, 3, 0);
+		out[num++] = k_cycle_get_32();
+		out[num++] = dropped;
+	}
+
+	while (tail != head) {
+		uint32_t hdr = tb->buf[tail & TRACE_BUF_MASK];
+		uint32_t len = K_TRACE_HDR_LEN(hdr);
+
+		if (!hdr || num + (int)len > max) {
+			/* record not complete yet, or no room left */
+			break;
+		}
+
+		for (uint32_t i = 0; i < len; i++) {
+			out[num++] = tb->buf[(tail + i) & TRACE_BUF_MASK];
+			tb->buf[(tail + i) & TRACE_BUF_MASK] = 0;
+		}
+
+		tail += len;
+	}
+
+	/* the words are cleared before being handed back to the writers */
+	compiler_barrier();
+	atomic_set(&tb->tail, tail);
+
+	return num * sizeof(uint32_t);
+}
+
+static int _sys_k_trace_init(struct device *arg)
+{
+	ARG_UNUSED(arg);
+
+	_k_trace_buf.cycles_per_sec = sys_clock_hw_cycles_per_sec;
+
+	return 0;
+}
+SYS_INIT(_sys_k_trace_init, NANOKERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+#ifdef CONFIG_KERNEL_TRACE_SINK_UART
+
+#include <uart.h>
+
+#define SINK_STACK_SIZE 512
+#define SINK_CHUNK_SIZE 64
+
+static void trace_sink_write(struct device *dev, uint32_t *words, int bytes)
+{
+	uint8_t *data = (uint8_t *)words;
+
+	/* words are sent in native order: the decoder expects little-endian */
+	for (int i = 0; i < bytes; i++) {
+		uart_poll_out(dev, data[i]);
+	}
+}
+
+static void trace_sink_main(void *p1, void *p2, void *p3)
+{
+	static uint32_t chunk[SINK_CHUNK_SIZE];
+	struct device *dev =
+		device_get_binding(CONFIG_KERNEL_TRACE_UART_ON_DEV_NAME);
+	int bytes;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	if (!dev) {
+		return;
+	}
+
+	chunk[0] = K_TRACE_HDR(K_TRACE_STREAM_START, 4, 0);
+	chunk[1] = k_cycle_get_32();
+	chunk[2] = K_TRACE_MAGIC;
+	chunk[3] = sys_clock_hw_cycles_per_sec;
+	trace_sink_write(dev, chunk, 4 * sizeof(uint32_t));
+
+	while (1) {
+		bytes = sys_k_trace_read(chunk, sizeof(chunk));
+		if (bytes) {
+			trace_sink_write(dev, chunk, bytes);
+		} else {
+			k_sleep(CONFIG_KERNEL_TRACE_UART_FLUSH_PERIOD);
+		}
+	}
+}
+
+K_THREAD_DEFINE(_k_trace_sink, SINK_STACK_SIZE, trace_sink_main,
+		NULL, NULL, NULL, K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
+#endif /* CONFIG_KERNEL_TRACE_SINK_UART */
@@ -538,71 +538,3 @@ void k_mem_pool_free(struct k_mem_block *block)
 	block_waiters_check(pool);
 	k_sched_unlock();
 }
-
-
-/*
- * Heap memory pool support
- */
-
-#if (CONFIG_HEAP_MEM_POOL_SIZE > 0)
-
-/*
- * Case 1: Heap is defined using HEAP_MEM_POOL_SIZE configuration option.
- *
- * This module defines the heap memory pool and the _HEAP_MEM_POOL symbol
- * that has the address of the associated memory pool struct.
- */
-
-K_MEM_POOL_DEFINE(_heap_mem_pool, 64, CONFIG_HEAP_MEM_POOL_SIZE, 1, 4);
-#define _HEAP_MEM_POOL (&_heap_mem_pool)
-
-#else
-
-/*
- * Case 2: Heap is defined using HEAP_SIZE item type in MDEF.
- *
- * Sysgen defines the heap memory pool and the _heap_mem_pool_ptr variable
- * that has the address of the associated memory pool struct. This module
- * defines the _HEAP_MEM_POOL symbol as an alias for _heap_mem_pool_ptr.
- *
- * Note: If the MDEF does not define the heap memory pool k_malloc() will
- * compile successfully, but will trigger a link error if it is used.
- */
-
-extern struct k_mem_pool * const _heap_mem_pool_ptr;
-#define _HEAP_MEM_POOL _heap_mem_pool_ptr
-
-#endif /* CONFIG_HEAP_MEM_POOL_SIZE */
-
-
-void *k_malloc(size_t size)
-{
-	struct k_mem_block block;
-
-	/*
-	 * get a block large enough to hold an initial (hidden) block
-	 * descriptor, as well as the space the caller requested
-	 */
-	size += sizeof(struct k_mem_block);
-	if (k_mem_pool_alloc(_HEAP_MEM_POOL, &block, size, K_NO_WAIT) != 0) {
-		return NULL;
-	}
-
-	/* save the block descriptor info at the start of the actual block */
-	memcpy(block.data, &block, sizeof(struct k_mem_block));
-
-	/* return address of the user area part of the block to the caller */
-	return (char *)block.data + sizeof(struct k_mem_block);
-}
-
-
-void k_free(void *ptr)
-{
-	if (ptr != NULL) {
-		/* point to hidden block descriptor at start of block */
-		ptr = (char *)ptr - sizeof(struct k_mem_block);
-
-		/* return block to the heap memory pool */
-		k_mem_pool_free(ptr);
-	}
-}
@@ -0,0 +1,367 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @brief Memory pools, buddy allocator implementation.
+ *
+ * Each level of a pool holds the blocks of one size, from the maximum block
+ * size (level 0) down to the minimum one, each size being 4 times smaller
+ * than the previous one. A block of level l is split into 4 sibling blocks of
+ * level l + 1, which are at consecutive indexes starting at a multiple of 4.
+ *
+ * A level keeps its free blocks in a list, linked through the free blocks
+ * themselves, and in a bitmap with a bit set for each free block. Allocating
+ * a block takes the first free block of the smallest level large enough,
+ * splitting it down as needed; freeing a block merges it with its siblings,
+ * up as many levels as possible, whenever they are all free. Both operations
+ * are thus O(number of levels), and the pool never needs defragmenting.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <misc/debug/object_tracing_common.h>
+#include <ksched.h>
+#include <wait_q.h>
+#include <init.h>
+#include <string.h>
+
+extern struct k_mem_pool _k_mem_pool_start[];
+extern struct k_mem_pool _k_mem_pool_end[];
+
+static void init_one_memory_pool(struct k_mem_pool *pool);
+
+/**
+ *
+ * @brief Initialize kernel memory pool subsystem
+ *
+ * Perform any initialization of memory pool that wasn't done at build time.
+ *
+ * @return N/A
+ */
+static int init_static_pools(struct device *unused)
+{
+	ARG_UNUSED(unused);
+	struct k_mem_pool *pool;
+
+	/* perform initialization for each memory pool */
+
+	for (pool = _k_mem_pool_start;
+	     pool < _k_mem_pool_end;
+	     pool++) {
+		init_one_memory_pool(pool);
+	}
+	return 0;
+}
+
+SYS_INIT(init_static_pools, PRIMARY, CONFIG_KERNEL_INIT_PRIORITY_OBJECTS);
+
+static inline size_t block_size(struct k_mem_pool *pool, int level)
+{
+	return pool->max_block_size >> (2 * level);
+}
+
+static inline uint32_t block_index(struct k_mem_pool *pool, int level,
+				   char *block)
+{
+	return (block - pool->bufblock) / block_size(pool, level);
+}
+
+static inline char *block_ptr(struct k_mem_pool *pool, int level,
+			      uint32_t index)
+{
+	return pool->bufblock + index * block_size(pool, level);
+}
+
+static void add_free_block(struct k_mem_pool *pool, int level, char *block)
+{
+	uint32_t index = block_index(pool, level, block);
+
+	pool->levels[level].free_bits[index >> 5] |= 1U << (index & 0x1f);
+	sys_dlist_prepend(&pool->levels[level].free_list,
+			  (sys_dnode_t *)block);
+}
+
+/**
+ *
+ * @brief Initialize the memory pool
+ *
+ * Initialize the internal memory accounting structures of the memory pool:
+ * all the maximum sized blocks are free, and no smaller block exists.
+ *
+ * @param pool memory pool descriptor
+ *
+ * @return N/A
+ */
+static void init_one_memory_pool(struct k_mem_pool *pool)
+{
+	uint32_t *bits = pool->bitmap;
+	int last = pool->nr_of_levels - 1;
+	int level;
+	int i;
+
+	__ASSERT(block_size(pool, last) >= sizeof(sys_dnode_t),
+		 "minimum block size too small\n");
+	__ASSERT((block_size(pool, last) << (2 * last)) ==
+		 pool->max_block_size,
+		 "maximum block size not a multiple of smaller sizes\n");
+
+	for (level = 0; level <= last; level++) {
+		uint32_t num_words =
+			((pool->nr_of_maxblocks << (2 * level)) + 31) >> 5;
+
+		pool->levels[level].free_bits = bits;
+		memset(bits, 0, num_words * sizeof(uint32_t));
+		sys_dlist_init(&pool->levels[level].free_list);
+		bits += num_words;
+	}
+
+	/* free the maximum sized blocks, so that the first one is used first */
+	for (i = pool->nr_of_maxblocks - 1; i >= 0; i--) {
+		add_free_block(pool, 0, block_ptr(pool, 0, i));
+	}
+
+	sys_dlist_init(&pool->wait_q);
+	SYS_TRACING_OBJ_INIT(memory_pool, pool);
+}
+
+/**
+ *
+ * @brief Determines which level corresponds to the specified data size
+ *
+ * Finds the level with the smallest blocks that can hold the specified
+ * amount of data.
+ *
+ * @return level index, or -1 if the data does not fit in any block
+ */
+static int compute_level(struct k_mem_pool *pool, size_t data_size)
+{
+	int level = pool->nr_of_levels - 1;
+
+	while (level >= 0 && data_size > block_size(pool, level)) {
+		level--;
+	}
+
+	return level;
+}
+
+/**
+ *
+ * @brief Allocate a block, splitting a larger block if necessary
+ *
+ * @param pool memory pool descriptor
+ * @param level level of the block to allocate
+ *
+ * @return pointer to allocated block, or NULL if none available
+ */
+static char *get_block(struct k_mem_pool *pool, int level)
+{
+	int l = level;
+	char *block;
+	uint32_t index;
+	int i;
+
+	if (level < 0) {
+		return NULL;
+	}
+
+	/* find the smallest free block at least as large as requested */
+	while (sys_dlist_is_empty(&pool->levels[l].free_list)) {
+		if (--l < 0) {
+			return NULL;
+		}
+	}
+
+	block = (char *)sys_dlist_get(&pool->levels[l].free_list);
+	index = block_index(pool, l, block);
+	pool->levels[l].free_bits[index >> 5] &= ~(1U << (index & 0x1f));
+
+	/* split it down to the requested size, freeing the upper quarters */
+	while (l < level) {
+		l++;
+		for (i = 3; i > 0; i--) {
+			add_free_block(pool, l,
+				       block + i * block_size(pool, l));
+		}
+	}
+
+	return block;
+}
+
+/**
+ *
+ * @brief Return an allocated block to the pool
+ *
+ * The block is merged with its siblings into a block of the previous level,
+ * and so on, for as long as all the siblings are free.
+ *
+ * @param pool memory pool descriptor
+ * @param block pointer to start of block
+ * @param level level of the block
+ *
+ * @return N/A
+ */
+static void free_block(struct k_mem_pool *pool, char *block, int level)
+{
+	uint32_t index, first, *word, siblings;
+	int i;
+
+	__ASSERT(block >= pool->bufblock &&
+		 block < block_ptr(pool, 0, pool->nr_of_maxblocks),
+		 "Attempt to free block not in memory pool\n");
+
+	while (level > 0) {
+		index = block_index(pool, level, block);
+
+		__ASSERT(!(pool->levels[level].free_bits[index >> 5] &
+			   (1U << (index & 0x1f))),
+			 "Attempt to free unallocated memory pool block\n");
+
+		/* the 4 siblings' bits are in the same word */
+		first = index & ~0x3;
+		word = &pool->levels[level].free_bits[first >> 5];
+		siblings = (*word >> (first & 0x1f)) & 0xf;
+
+		if ((siblings | (1U << (index & 0x3))) != 0xf) {
+			break;
+		}
+
+		/* all the siblings are free: merge them into their parent */
+		for (i = 0; i < 4; i++) {
+			if (first + i != index) {
+				sys_dlist_remove((sys_dnode_t *)
+					block_ptr(pool, level, first + i));
+			}
+		}
+		*word &= ~(0xfU << (first & 0x1f));
+
+		block = block_ptr(pool, level, first);
+		level--;
+	}
+
+	add_free_block(pool, level, block);
+}
+
+/**
+ *
+ * @brief Examine threads that are waiting for memory pool blocks.
+ *
+ * This routine attempts to satisfy any incomplete block allocation requests for
+ * the specified memory pool. It is invoked by the explicit freeing of a used
+ * block.
+ *
+ * @return N/A
+ */
+static void block_waiters_check(struct k_mem_pool *pool)
+{
+	char *found_block;
+	struct k_thread *waiter;
+	struct k_thread *next_waiter;
+
+	unsigned int key = irq_lock();
+	waiter = (struct k_thread *)sys_dlist_peek_head(&pool->wait_q);
+
+	/* loop all waiters */
+	while (waiter != NULL) {
+		uint32_t req_size = (uint32_t)(waiter->swap_data);
+
+		/* allocate block (splitting a larger block, if needed) */
+		found_block = get_block(pool, compute_level(pool, req_size));
+
+		next_waiter = (struct k_thread *)sys_dlist_peek_next(
+			&pool->wait_q, &waiter->k_q_node);
+
+		/* if success : remove task from list and reschedule */
+		if (found_block != NULL) {
+			/* return found block */
+			_set_thread_return_value_with_data(waiter, 0,
+							   found_block);
+
+			/*
+			 * Schedule the thread. Threads will be rescheduled
+			 * outside the function by k_sched_unlock()
+			 */
+			_unpend_thread(waiter);
+			_abort_thread_timeout(waiter);
+			_ready_thread(waiter);
+		}
+		waiter = next_waiter;
+	}
+	irq_unlock(key);
+}
+
+void k_mem_pool_defrag(struct k_mem_pool *pool)
+{
+	/* free blocks are merged as soon as they are freed: nothing to do */
+	ARG_UNUSED(pool);
+}
+
+int k_mem_pool_alloc(struct k_mem_pool *pool, struct k_mem_block *block,
+		     size_t size, int32_t timeout)
+{
+	char *found_block;
+
+	k_sched_lock();
+
+	/* allocate block (splitting a larger block, if needed) */
+	found_block = get_block(pool, compute_level(pool, size));
+
+	if (found_block != NULL) {
+		k_sched_unlock();
+		block->pool_id = pool;
+		block->addr_in_pool = found_block;
+		block->data = found_block;
+		block->req_size = size;
+		return 0;
+	}
+
+	/*
+	 * no suitable block is currently available,
+	 * so either wait for one to appear or indicate failure
+	 */
+	if (likely(timeout != K_NO_WAIT)) {
+		int result;
+		unsigned int key = irq_lock();
+		_sched_unlock_no_reschedule();
+
+		_current->swap_data = (void *)size;
+		_pend_current_thread(&pool->wait_q, timeout);
+		result = _Swap(key);
+		if (result == 0) {
+			block->pool_id = pool;
+			block->addr_in_pool = _current->swap_data;
+			block->data = _current->swap_data;
+			block->req_size = size;
+		}
+		return result;
+	}
+	k_sched_unlock();
+	return -ENOMEM;
+}
+
+void k_mem_pool_free(struct k_mem_block *block)
+{
+	struct k_mem_pool *pool = block->pool_id;
+
+	k_sched_lock();
+
+	/* the block's level is the one its size was allocated from */
+	free_block(pool, block->addr_in_pool,
+		   compute_level(pool, block->req_size));
+
+	/* reschedule anybody waiting for a block */
+	block_waiters_check(pool);
+	k_sched_unlock();
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Memory slab caches
+ *
+ * A memory slab cache (or magazine) holds free blocks of a memory slab on
+ * behalf of a single thread. Since nothing else ever accesses the cache, the
+ * thread can allocate and free blocks through it without locking interrupts.
+ * Interrupts are only locked when the cache is empty or full, to move half a
+ * cache of blocks from or to the memory slab in a single batch.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <wait_q.h>
+#include <ksched.h>
+#include <string.h>
+
+static inline void cache_push(struct k_mem_slab_cache *cache, char *block)
+{
+	*(char **)block = cache->free_list;
+	cache->free_list = block;
+	cache->num_free++;
+}
+
+static inline char *cache_pop(struct k_mem_slab_cache *cache)
+{
+	char *block = cache->free_list;
+
+	cache->free_list = *(char **)block;
+	cache->num_free--;
+
+	return block;
+}
+
+/* move up to half a cache of free blocks from the slab to the cache */
+static void cache_refill(struct k_mem_slab_cache *cache)
+{
+	struct k_mem_slab *slab = cache->slab;
+	uint32_t batch = cache->capacity / 2;
+	unsigned int key = irq_lock();
+	char *block;
+
+	while (batch-- > 0 && slab->free_list != NULL) {
+		block = slab->free_list;
+		slab->free_list = *(char **)block;
+		slab->num_used++;
+		cache_push(cache, block);
+	}
+
+	irq_unlock(key);
+}
+
+/* give @a count blocks of the cache back to waiting threads or to the slab */
+static void cache_drain(struct k_mem_slab_cache *cache, uint32_t count)
+{
+	struct k_mem_slab *slab = cache->slab;
+	struct k_thread *pending_thread;
+	unsigned int key = irq_lock();
+	char *block;
+
+	while (count-- > 0) {
+		block = cache_pop(cache);
+		pending_thread = _unpend_first_thread(&slab->wait_q);
+
+		if (pending_thread) {
+			_set_thread_return_value_with_data(pending_thread, 0,
+							   block);
+			_abort_thread_timeout(pending_thread);
+			_ready_thread(pending_thread);
+		} else {
+			*(char **)block = slab->free_list;
+			slab->free_list = block;
+			slab->num_used--;
+		}
+	}
+
+	_reschedule_threads(key);
+}
+
+void k_mem_slab_cache_init(struct k_mem_slab_cache *cache,
+			   struct k_mem_slab *slab, uint32_t capacity)
+{
+	__ASSERT(capacity >= 2, "cache capacity must be at least 2\n");
+
+	cache->slab = slab;
+	cache->free_list = NULL;
+	cache->num_free = 0;
+	cache->capacity = capacity;
+	memset(&cache->stats, 0, sizeof(cache->stats));
+}
+
+int k_mem_slab_cache_alloc(struct k_mem_slab_cache *cache, void **mem,
+			   int32_t timeout)
+{
+	__ASSERT(!_is_in_isr(), "");
+
+	if (cache->free_list != NULL) {
+		cache->stats.alloc_hits++;
+	} else {
+		cache->stats.alloc_misses++;
+		cache_refill(cache);
+
+		if (cache->free_list == NULL) {
+			/* the slab is exhausted too: wait for a block */
+			return k_mem_slab_alloc(cache->slab, mem, timeout);
+		}
+	}
+
+	*mem = cache_pop(cache);
+
+	return 0;
+}
+
+void k_mem_slab_cache_free(struct k_mem_slab_cache *cache, void **mem)
+{
+	__ASSERT(!_is_in_isr(), "");
+
+	if (cache->num_free < cache->capacity) {
+		cache->stats.free_hits++;
+	} else {
+		cache->stats.free_misses++;
+		cache_drain(cache, cache->capacity / 2);
+	}
+
+	cache_push(cache, *mem);
+}
+
+void k_mem_slab_cache_flush(struct k_mem_slab_cache *cache)
+{
+	__ASSERT(!_is_in_isr(), "");
+
+	if (cache->num_free > 0) {
+		cache_drain(cache, cache->num_free);
+	}
+}
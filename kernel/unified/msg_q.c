@@ -28,6 +28,7 @@
 #include <string.h>
 #include <wait_q.h>
 #include <misc/dlist.h>
+#include <misc/util.h>
 
 void k_msgq_init(struct k_msgq *q, char *buffer,
 		 size_t msg_size, uint32_t max_msgs)
@@ -40,9 +41,29 @@ void k_msgq_init(struct k_msgq *q, char *buffer,
 	q->write_ptr = buffer;
 	q->used_msgs = 0;
 	sys_dlist_init(&q->wait_q);
+#ifdef CONFIG_POLL
+	q->poll_event = NULL;
+#endif
 	SYS_TRACING_OBJ_INIT(msgq, q);
 }
 
+/*
+ * Notify the thread polling the message queue, if any, that a message is
+ * available.
+ *
+ * Returns 1 if a thread was readied, 0 otherwise.
+ */
+static inline int handle_poll_event(struct k_msgq *q)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_MSGQ_DATA_AVAILABLE;
+
+	return _handle_obj_poll_event(&q->poll_event, state);
+#else
+	return 0;
+#endif
+}
+
 int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout)
 {
 	unsigned int key = irq_lock();
@@ -71,6 +92,11 @@ int k_msgq_put(struct k_msgq *q, void *data, int32_t timeout)
 				q->write_ptr = q->buffer_start;
 			}
 			q->used_msgs++;
+			if (handle_poll_event(q) &&
+			    !_is_in_isr() && _must_switch_threads()) {
+				_Swap(key);
+				return 0;
+			}
 		}
 		result = 0;
 	} else if (timeout == K_NO_WAIT) {
@@ -140,6 +166,198 @@ int k_msgq_get(struct k_msgq *q, void *data, int32_t timeout)
 	return result;
 }
 
+/*
+ * Copy messages to the queue buffer, after the newest message. Wrap-around is
+ * handled with at most two calls to memcpy(). The caller must have checked
+ * that there is enough room in the buffer.
+ */
+static void copy_to_buffer(struct k_msgq *q, char *data, uint32_t num_msgs)
+{
+	size_t size = num_msgs * q->msg_size;
+	size_t first = min(size, (size_t)(q->buffer_end - q->write_ptr));
+
+	memcpy(q->write_ptr, data, first);
+	if (size > first) {
+		memcpy(q->buffer_start, data + first, size - first);
+		q->write_ptr = q->buffer_start + (size - first);
+	} else {
+		q->write_ptr += size;
+	}
+
+	if (q->write_ptr == q->buffer_end) {
+		q->write_ptr = q->buffer_start;
+	}
+
+	q->used_msgs += num_msgs;
+}
+
+/*
+ * Copy messages from the queue buffer, starting with the oldest one.
+ * Wrap-around is handled with at most two calls to memcpy(). The caller must
+ * have checked that there are enough messages in the buffer.
+ */
+static void copy_from_buffer(struct k_msgq *q, char *data, uint32_t num_msgs)
+{
+	size_t size = num_msgs * q->msg_size;
+	size_t first = min(size, (size_t)(q->buffer_end - q->read_ptr));
+
+	memcpy(data, q->read_ptr, first);
+	if (size > first) {
+		memcpy(data + first, q->buffer_start, size - first);
+		q->read_ptr = q->buffer_start + (size - first);
+	} else {
+		q->read_ptr += size;
+	}
+
+	if (q->read_ptr == q->buffer_end) {
+		q->read_ptr = q->buffer_start;
+	}
+
+	q->used_msgs -= num_msgs;
+}
+
+/* wake up a thread whose message has been transferred */
+static inline void wake_up_pending_thread(struct k_thread *thread)
+{
+	_set_thread_return_value(thread, 0);
+	_abort_thread_timeout(thread);
+	_ready_thread(thread);
+}
+
+int k_msgq_put_many(struct k_msgq *q, void *data, uint32_t num_msgs)
+{
+	unsigned int key = irq_lock();
+	struct k_thread *pending_thread;
+	char *msg = data;
+	uint32_t num_put = 0;
+	uint32_t num_copied;
+	int readied = 0;
+
+	/* threads only wait to read when the queue is empty */
+	if (q->used_msgs == 0) {
+		while (num_put < num_msgs) {
+			pending_thread = _unpend_first_thread(&q->wait_q);
+			if (!pending_thread) {
+				break;
+			}
+
+			memcpy(pending_thread->swap_data, msg, q->msg_size);
+			wake_up_pending_thread(pending_thread);
+			readied = 1;
+
+			msg += q->msg_size;
+			num_put++;
+		}
+	}
+
+	num_copied = min(num_msgs - num_put, q->max_msgs - q->used_msgs);
+	if (num_copied > 0) {
+		copy_to_buffer(q, msg, num_copied);
+		num_put += num_copied;
+		readied |= handle_poll_event(q);
+	}
+
+	if (readied && !_is_in_isr()) {
+		_reschedule_threads(key);
+	} else {
+		irq_unlock(key);
+	}
+
+	return num_put;
+}
+
+int k_msgq_get_many(struct k_msgq *q, void *data, uint32_t num_msgs)
+{
+	unsigned int key = irq_lock();
+	struct k_thread *pending_thread;
+	uint32_t num_got = min(num_msgs, q->used_msgs);
+	int readied = 0;
+
+	if (num_got == 0) {
+		irq_unlock(key);
+		return 0;
+	}
+
+	copy_from_buffer(q, data, num_got);
+
+	/* threads only wait to write when the queue is full */
+	while (q->used_msgs < q->max_msgs) {
+		pending_thread = _unpend_first_thread(&q->wait_q);
+		if (!pending_thread) {
+			break;
+		}
+
+		copy_to_buffer(q, pending_thread->swap_data, 1);
+		wake_up_pending_thread(pending_thread);
+		readied = 1;
+	}
+
+	if (readied && !_is_in_isr()) {
+		_reschedule_threads(key);
+	} else {
+		irq_unlock(key);
+	}
+
+	return num_got;
+}
+
+/*
+ * The single-producer/single-consumer routines do not lock interrupts: the
+ * write pointer is only modified by the producer and the read pointer by the
+ * consumer, each one only after the message it covers has been copied. One
+ * slot is kept empty to tell a full queue from an empty one.
+ */
+int k_msgq_spsc_put(struct k_msgq *q, void *data)
+{
+	char *write_ptr = q->write_ptr;
+	char *next = write_ptr + q->msg_size;
+
+	if (next == q->buffer_end) {
+		next = q->buffer_start;
+	}
+
+	/* get the latest read pointer from the consumer */
+	compiler_barrier();
+
+	if (next == q->read_ptr) {
+		return -ENOMSG;
+	}
+
+	memcpy(write_ptr, data, q->msg_size);
+
+	/* publish the message only once it has been written */
+	compiler_barrier();
+	q->write_ptr = next;
+
+	return 0;
+}
+
+int k_msgq_spsc_get(struct k_msgq *q, void *data)
+{
+	char *read_ptr = q->read_ptr;
+	char *next;
+
+	/* get the latest write pointer from the producer */
+	compiler_barrier();
+
+	if (read_ptr == q->write_ptr) {
+		return -ENOMSG;
+	}
+
+	memcpy(data, read_ptr, q->msg_size);
+
+	next = read_ptr + q->msg_size;
+	if (next == q->buffer_end) {
+		next = q->buffer_start;
+	}
+
+	/* free the slot only once the message has been read */
+	compiler_barrier();
+	q->read_ptr = next;
+
+	return 0;
+}
+
 void k_msgq_purge(struct k_msgq *q)
 {
 	unsigned int key = irq_lock();
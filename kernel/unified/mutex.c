@@ -34,6 +34,11 @@
  * When releasing the mutex, thread A must release M2 before it releases M1.
  * Failure to follow this nested model may result in threads running at
  * unexpected priority levels (too high, or too low).
+ *
+ * Priority inheritance is transitive: if the owner of a mutex is itself
+ * waiting on another mutex, the boost is passed on to the owner of that
+ * mutex, and so on down the chain, up to CONFIG_PRIORITY_INHERITANCE_DEPTH
+ * owners deep.
  */
 
 #include <kernel.h>
@@ -41,6 +46,7 @@
 #include <toolchain.h>
 #include <sections.h>
 #include <wait_q.h>
+#include <ksched.h>
 #include <misc/dlist.h>
 #include <errno.h>
 
@@ -107,6 +113,59 @@ static void adjust_owner_prio(struct k_mutex *mutex, int new_prio)
 	}
 }
 
+/*
+ * Priority the owner of a mutex inherits from the threads waiting on it, on
+ * top of the one it had when it took the mutex.
+ */
+static int inherited_prio(struct k_mutex *mutex)
+{
+	struct k_thread *waiter = _peek_first_pending_thread(&mutex->wait_q);
+
+	return waiter ?
+		new_prio_for_inheritance(waiter->prio, mutex->owner_orig_prio) :
+		mutex->owner_orig_prio;
+}
+
+/*
+ * Set the priority of the owner of a mutex, and pass the change on through
+ * the chain of mutexes the owners are themselves waiting on. The chain is
+ * followed at most CONFIG_PRIORITY_INHERITANCE_DEPTH owners deep, which bounds
+ * the time spent with interrupts locked, including on a deadlock cycle.
+ *
+ * When boosting, priorities down the chain are only raised; otherwise, each
+ * owner gets back the priority it inherits from its remaining waiters.
+ *
+ * Must be called with interrupts locked.
+ */
+static void adjust_owner_chain_prio(struct k_mutex *mutex, int new_prio,
+				    int boost)
+{
+	int depth = CONFIG_PRIORITY_INHERITANCE_DEPTH;
+	struct k_thread *owner;
+
+	for (;;) {
+		owner = mutex->owner;
+
+		if (owner->prio == new_prio) {
+			return;
+		}
+
+		adjust_owner_prio(mutex, new_prio);
+
+		mutex = owner->pended_mutex;
+		if (--depth == 0 || !mutex || !_is_thread_pending(owner)) {
+			return;
+		}
+
+		/* the wait queue is priority-based */
+		_reorder_pended_thread(owner, &mutex->wait_q);
+
+		new_prio = boost ?
+			new_prio_for_inheritance(new_prio, mutex->owner->prio) :
+			inherited_prio(mutex);
+	}
+}
+
 int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 {
 	int new_prio, key;
@@ -152,12 +211,15 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 
 	K_DEBUG("adjusting prio up on mutex %p\n", mutex);
 
-	adjust_owner_prio(mutex, new_prio);
+	adjust_owner_chain_prio(mutex, new_prio, 1);
 
+	_current->pended_mutex = mutex;
 	_pend_current_thread(&mutex->wait_q, timeout);
 
 	int got_mutex = _Swap(key);
 
+	_current->pended_mutex = NULL;
+
 	K_DEBUG("on mutex %p got_mutex value: %d\n", mutex, got_mutex);
 
 	K_DEBUG("%p got mutex %p (y/n): %c\n", _current, mutex,
@@ -172,17 +234,15 @@ int k_mutex_lock(struct k_mutex *mutex, int32_t timeout)
 
 	K_DEBUG("%p timeout on mutex %p\n", _current, mutex);
 
-	struct k_thread *waiter =
-		(struct k_thread *)sys_dlist_peek_head(&mutex->wait_q);
-
-	new_prio = mutex->owner_orig_prio;
-	new_prio = waiter ? new_prio_for_inheritance(waiter->prio, new_prio) :
-			    new_prio;
-
 	K_DEBUG("adjusting prio down on mutex %p\n", mutex);
 
 	key = irq_lock();
-	adjust_owner_prio(mutex, new_prio);
+
+	/* the owner may have released the mutex since the timeout */
+	if (mutex->owner) {
+		adjust_owner_chain_prio(mutex, inherited_prio(mutex), 0);
+	}
+
 	irq_unlock(key);
 
 	k_sched_unlock();
@@ -219,6 +279,7 @@ void k_mutex_unlock(struct k_mutex *mutex)
 		mutex, new_owner, new_owner ? new_owner->prio : -1000);
 
 	if (new_owner) {
+		new_owner->pended_mutex = NULL;
 		_abort_thread_timeout(new_owner);
 		_ready_thread(new_owner);
 
@@ -28,6 +28,7 @@
 #include <wait_q.h>
 #include <misc/dlist.h>
 #include <init.h>
+#include <string.h>
 
 struct k_pipe_desc {
 	unsigned char *buffer;           /* Position in src/dest buffer */
@@ -138,18 +139,18 @@ static void _pipe_async_finish(struct k_pipe_async *async_desc)
 /**
  * @brief Copy bytes from @a src to @a dest
  *
+ * The copy is done with memcpy(), which moves whole words when the source
+ * and destination share the same alignment, rather than one byte at a time.
+ *
  * @return Number of bytes copied
  */
 static size_t _pipe_xfer(unsigned char *dest, size_t dest_size,
 			 const unsigned char *src, size_t src_size)
 {
 	size_t num_bytes = min(dest_size, src_size);
-	const unsigned char *end = src + num_bytes;
 
-	while (src != end) {
-		*dest = *src;
-		dest++;
-		src++;
+	if (num_bytes != 0) {
+		memcpy(dest, src, num_bytes);
 	}
 
 	return num_bytes;
@@ -677,6 +678,157 @@ int k_pipe_put(struct k_pipe *pipe, void *data, size_t bytes_to_write,
 				    min_xfer, timeout);
 }
 
+size_t k_pipe_get_claim(struct k_pipe *pipe, unsigned char **data,
+			 size_t bytes_max)
+{
+	unsigned int key;
+	size_t       num_bytes;
+
+	__ASSERT(data != NULL, "");
+
+	key = irq_lock();
+	num_bytes = min(pipe->bytes_used, pipe->size - pipe->read_index);
+	*data = pipe->buffer + pipe->read_index;
+	irq_unlock(key);
+
+	return min(num_bytes, bytes_max);
+}
+
+void k_pipe_get_finish(struct k_pipe *pipe, size_t bytes_read)
+{
+	struct k_thread    *writer;
+	struct k_pipe_desc *desc;
+	sys_dlist_t    xfer_list;
+	unsigned int   key;
+	size_t         bytes_copied;
+
+	__ASSERT(bytes_read <= min(pipe->bytes_used,
+				   pipe->size - pipe->read_index), "");
+
+	key = irq_lock();
+
+	pipe->bytes_used -= bytes_read;
+	pipe->read_index += bytes_read;
+	if (pipe->read_index == pipe->size) {
+		pipe->read_index = 0;
+	}
+
+	/*
+	 * Writers can only be waiting if the buffer was full: gather the ones
+	 * whose data now fits entirely into the space just released.
+	 */
+	(void)_pipe_xfer_prepare(&xfer_list, &writer, &pipe->wait_q.writers,
+				 0, pipe->size - pipe->bytes_used, 0,
+				 K_FOREVER);
+
+	k_sched_lock();
+	irq_unlock(key);
+
+	struct k_thread *thread = (struct k_thread *)
+				  sys_dlist_get(&xfer_list);
+	while (thread) {
+		desc = (struct k_pipe_desc *)thread->swap_data;
+		bytes_copied = _pipe_buffer_put(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer         += bytes_copied;
+		desc->bytes_to_xfer  -= bytes_copied;
+
+		/* Write request has been satisfied */
+		_pipe_thread_ready(thread);
+
+		thread = (struct k_thread *)sys_dlist_get(&xfer_list);
+	}
+
+	if (writer) {
+		desc = (struct k_pipe_desc *)writer->swap_data;
+		bytes_copied = _pipe_buffer_put(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer         += bytes_copied;
+		desc->bytes_to_xfer  -= bytes_copied;
+	}
+
+	k_sched_unlock();
+}
+
+size_t k_pipe_put_claim(struct k_pipe *pipe, unsigned char **data,
+			size_t bytes_max)
+{
+	unsigned int key;
+	size_t       num_bytes;
+
+	__ASSERT(data != NULL, "");
+
+	key = irq_lock();
+	num_bytes = min(pipe->size - pipe->bytes_used,
+			pipe->size - pipe->write_index);
+	*data = pipe->buffer + pipe->write_index;
+	irq_unlock(key);
+
+	return min(num_bytes, bytes_max);
+}
+
+void k_pipe_put_finish(struct k_pipe *pipe, size_t bytes_written)
+{
+	struct k_thread    *reader;
+	struct k_pipe_desc *desc;
+	sys_dlist_t    xfer_list;
+	unsigned int   key;
+	size_t         bytes_copied;
+
+	__ASSERT(bytes_written <= min(pipe->size - pipe->bytes_used,
+				      pipe->size - pipe->write_index), "");
+
+	key = irq_lock();
+
+	pipe->bytes_used += bytes_written;
+	pipe->write_index += bytes_written;
+	if (pipe->write_index == pipe->size) {
+		pipe->write_index = 0;
+	}
+
+	/*
+	 * Readers can only be waiting if the buffer was empty: gather the ones
+	 * whose request can be entirely satisfied by the data just committed.
+	 */
+	(void)_pipe_xfer_prepare(&xfer_list, &reader, &pipe->wait_q.readers,
+				 0, pipe->bytes_used, 0, K_FOREVER);
+
+	k_sched_lock();
+	irq_unlock(key);
+
+	struct k_thread *thread = (struct k_thread *)
+				  sys_dlist_get(&xfer_list);
+	while (thread) {
+		desc = (struct k_pipe_desc *)thread->swap_data;
+		bytes_copied = _pipe_buffer_get(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer        += bytes_copied;
+		desc->bytes_to_xfer -= bytes_copied;
+
+		/* The thread's read request has been satisfied. Ready it. */
+		key = irq_lock();
+		_ready_thread(thread);
+		irq_unlock(key);
+
+		thread = (struct k_thread *)sys_dlist_get(&xfer_list);
+	}
+
+	/* Give whatever data is left to a partially satisfied reader */
+	if (reader) {
+		desc = (struct k_pipe_desc *)reader->swap_data;
+		bytes_copied = _pipe_buffer_get(pipe, desc->buffer,
+						desc->bytes_to_xfer);
+
+		desc->buffer        += bytes_copied;
+		desc->bytes_to_xfer -= bytes_copied;
+	}
+
+	k_sched_unlock();
+}
+
 #if (CONFIG_NUM_PIPE_ASYNC_MSGS > 0)
 void k_pipe_block_put(struct k_pipe *pipe, struct k_mem_block *block,
 		      size_t bytes_to_write, struct k_sem *sem)
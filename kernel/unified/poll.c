@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ *
+ * @brief Kernel asynchronous event polling interface.
+ *
+ * This polling mechanism allows waiting on multiple events concurrently,
+ * either events triggered directly, or from kernel objects or other kernel
+ * constructs.
+ *
+ * Each pollable object holds a pointer to the (single) event registered on it,
+ * so that signaling the poller does not require searching for it.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <wait_q.h>
+#include <ksched.h>
+#include <misc/__assert.h>
+
+void k_poll_event_init(struct k_poll_event *event, uint32_t type, void *obj)
+{
+	__ASSERT(type < K_POLL_NUM_TYPES, "invalid type\n");
+	__ASSERT(obj || type == K_POLL_TYPE_IGNORE,
+		 "must provide an object\n");
+
+	event->poller = NULL;
+	event->type = type;
+	event->state = K_POLL_STATE_NOT_READY;
+	event->obj = obj;
+}
+
+/*
+ * Get the address of the poll event pointer embedded in the polled object.
+ */
+static struct k_poll_event **obj_poll_event_get(struct k_poll_event *event)
+{
+	switch (event->type) {
+	case K_POLL_TYPE_SEM_AVAILABLE:
+		return &event->sem->poll_event;
+	case K_POLL_TYPE_FIFO_DATA_AVAILABLE:
+		return &event->fifo->poll_event;
+	case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+		return &event->msgq->poll_event;
+	case K_POLL_TYPE_TIMER_EXPIRED:
+		return &event->timer->poll_event;
+	default:
+		__ASSERT(0, "invalid event type (0x%x)\n", event->type);
+		return NULL;
+	}
+}
+
+/*
+ * Check if the condition of an event is already fulfilled; the state
+ * corresponding to the condition is returned in *state.
+ *
+ * Must be called with interrupts locked.
+ */
+static int is_condition_met(struct k_poll_event *event, uint32_t *state)
+{
+	switch (event->type) {
+	case K_POLL_TYPE_SEM_AVAILABLE:
+		*state = K_POLL_STATE_SEM_AVAILABLE;
+		return k_sem_count_get(event->sem) > 0;
+	case K_POLL_TYPE_FIFO_DATA_AVAILABLE:
+		*state = K_POLL_STATE_FIFO_DATA_AVAILABLE;
+		return !sys_slist_is_empty(&event->fifo->data_q);
+	case K_POLL_TYPE_MSGQ_DATA_AVAILABLE:
+		*state = K_POLL_STATE_MSGQ_DATA_AVAILABLE;
+		return event->msgq->used_msgs > 0;
+	case K_POLL_TYPE_TIMER_EXPIRED:
+		*state = K_POLL_STATE_TIMER_EXPIRED;
+		return event->timer->status > 0;
+	case K_POLL_TYPE_IGNORE:
+		return 0;
+	default:
+		__ASSERT(0, "invalid event type (0x%x)\n", event->type);
+		return 0;
+	}
+}
+
+/* must be called with interrupts locked */
+static inline int register_event(struct k_poll_event *event,
+				 struct _poller *poller)
+{
+	struct k_poll_event **obj_poll_event = obj_poll_event_get(event);
+
+	if (*obj_poll_event) {
+		return -EADDRINUSE;
+	}
+
+	*obj_poll_event = event;
+	event->poller = poller;
+
+	return 0;
+}
+
+/* must be called with interrupts locked */
+static inline void clear_event_registration(struct k_poll_event *event)
+{
+	struct k_poll_event **obj_poll_event;
+
+	if (!event->poller) {
+		/* never registered, or already signaled by its object */
+		return;
+	}
+
+	obj_poll_event = obj_poll_event_get(event);
+	__ASSERT(*obj_poll_event == event, "");
+
+	*obj_poll_event = NULL;
+	event->poller = NULL;
+}
+
+/*
+ * Clear the registrations of events [0, last_registered]. Interrupts are
+ * unlocked between each event to bound the interrupt latency.
+ *
+ * Must be called with interrupts locked; interrupts are still locked when the
+ * function returns, with the same key.
+ */
+static inline void clear_event_registrations(struct k_poll_event *events,
+					     int last_registered,
+					     unsigned int key)
+{
+	for (; last_registered >= 0; last_registered--) {
+		clear_event_registration(&events[last_registered]);
+		irq_unlock(key);
+		key = irq_lock();
+	}
+}
+
+static inline void set_event_ready(struct k_poll_event *event, uint32_t state)
+{
+	event->poller = NULL;
+	event->state = state;
+}
+
+int k_poll(struct k_poll_event *events, int num_events, int32_t timeout)
+{
+	__ASSERT(!_is_in_isr(), "");
+	__ASSERT(events, "NULL events\n");
+	__ASSERT(num_events > 0, "zero events\n");
+
+	int last_registered = -1, rc = 0;
+	struct _poller poller = { .is_polling = 1, .thread = _current };
+	unsigned int key;
+
+	/* find events whose condition is already fulfilled */
+	for (int ii = 0; ii < num_events; ii++) {
+		uint32_t state;
+
+		key = irq_lock();
+
+		events[ii].poller = NULL;
+		events[ii].state = K_POLL_STATE_NOT_READY;
+
+		if (is_condition_met(&events[ii], &state)) {
+			set_event_ready(&events[ii], state);
+			poller.is_polling = 0;
+		} else if (timeout != K_NO_WAIT && poller.is_polling &&
+			   events[ii].type != K_POLL_TYPE_IGNORE) {
+			rc = register_event(&events[ii], &poller);
+			if (rc == 0) {
+				last_registered = ii;
+			} else {
+				irq_unlock(key);
+				break;
+			}
+		}
+
+		irq_unlock(key);
+	}
+
+	key = irq_lock();
+
+	/*
+	 * If we're not polling anymore, it means that at least one event
+	 * condition is met, either when looping through the events here or
+	 * because one of the events registered has had its state changed.
+	 */
+	if (!poller.is_polling) {
+		clear_event_registrations(events, last_registered, key);
+		irq_unlock(key);
+		return 0;
+	}
+
+	if (rc != 0 || timeout == K_NO_WAIT) {
+		clear_event_registrations(events, last_registered, key);
+		irq_unlock(key);
+		return rc ? rc : -EAGAIN;
+	}
+
+	_wait_q_t wait_q = SYS_DLIST_STATIC_INIT(&wait_q);
+
+	_pend_current_thread(&wait_q, timeout);
+
+	int swap_rc = _Swap(key);
+
+	/*
+	 * Clear all event registrations. If events happen while we're in this
+	 * loop, and we already had one that triggered, that's OK: they will
+	 * end up in the list of events that are ready; if we timed out, and
+	 * events happen while we're in this loop, that is OK as well since
+	 * we did not react to the timeout yet.
+	 */
+	key = irq_lock();
+	clear_event_registrations(events, last_registered, key);
+	irq_unlock(key);
+
+	return swap_rc;
+}
+
+/*
+ * Signal the event registered on an object, waking up its poller if it is
+ * still waiting. Returns 1 if a thread was readied, 0 otherwise.
+ *
+ * Must be called with interrupts locked.
+ */
+int _handle_obj_poll_event(struct k_poll_event **obj_poll_event,
+			   uint32_t state)
+{
+	struct k_poll_event *event = *obj_poll_event;
+	struct _poller *poller;
+	struct k_thread *thread;
+
+	if (!event) {
+		return 0;
+	}
+
+	poller = event->poller;
+	thread = poller->thread;
+
+	*obj_poll_event = NULL;
+	set_event_ready(event, state);
+
+	if (!poller->is_polling) {
+		return 0;
+	}
+
+	poller->is_polling = 0;
+
+	if (!_is_thread_pending(thread)) {
+		/* still looping through the events in k_poll() */
+		return 0;
+	}
+
+	_unpend_thread(thread);
+	_abort_thread_timeout(thread);
+	_set_thread_return_value(thread, 0);
+	_ready_thread(thread);
+
+	return 1;
+}
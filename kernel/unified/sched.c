@@ -27,6 +27,10 @@ static void _set_ready_q_prio_bit(int prio)
 	uint32_t *bmap = &_nanokernel.ready_q.prio_bmap[bmap_index];
 
 	*bmap |= _get_ready_q_prio_bit(prio);
+
+#if (K_NUM_PRIO_BITMAPS > 1)
+	_nanokernel.ready_q.prio_bmap_summary |= (1U << bmap_index);
+#endif
 }
 
 /* clear the bit corresponding to prio in ready q bitmap */
@@ -36,8 +40,55 @@ static void _clear_ready_q_prio_bit(int prio)
 	uint32_t *bmap = &_nanokernel.ready_q.prio_bmap[bmap_index];
 
 	*bmap &= ~_get_ready_q_prio_bit(prio);
+
+#if (K_NUM_PRIO_BITMAPS > 1)
+	if (!*bmap) {
+		_nanokernel.ready_q.prio_bmap_summary &= ~(1U << bmap_index);
+	}
+#endif
 }
 
+#ifdef CONFIG_SCHED_DEADLINE
+/*
+ * Callback for sys_dlist_insert_at() to find the correct insert point in a
+ * ready queue list: threads of equal priority are sorted by deadline, and
+ * threads with equal deadlines are kept in FIFO order.
+ */
+static int _is_ready_q_insert_point(sys_dnode_t *dnode_info, void *thread)
+{
+	struct k_thread *readyq_node =
+		CONTAINER_OF(dnode_info, struct k_thread, k_q_node);
+
+	return _is_deadline_earlier((struct k_thread *)thread, readyq_node);
+}
+
+static inline void _insert_in_prio_q(sys_dlist_t *q, struct k_thread *thread)
+{
+	sys_dlist_insert_at(q, &thread->k_q_node,
+			    _is_ready_q_insert_point, thread);
+}
+
+/* once inserted in the ready queue, does thread run before the cached one ? */
+static inline int _is_inserted_ahead_of(struct k_thread *thread,
+					struct k_thread *head)
+{
+	return _is_prio_higher(thread->prio, head->prio) ||
+	       (thread->prio == head->prio &&
+		_is_deadline_earlier(thread, head));
+}
+#else
+static inline void _insert_in_prio_q(sys_dlist_t *q, struct k_thread *thread)
+{
+	sys_dlist_append(q, &thread->k_q_node);
+}
+
+static inline int _is_inserted_ahead_of(struct k_thread *thread,
+					struct k_thread *head)
+{
+	return _is_prio_higher(thread->prio, head->prio);
+}
+#endif /* CONFIG_SCHED_DEADLINE */
+
 /*
  * Add thread to the ready queue, in the slot for its priority; the thread
  * must not be on a wait queue.
@@ -54,11 +105,11 @@ void _add_thread_to_ready_q(struct k_thread *thread)
 	sys_dlist_t *q = &_nanokernel.ready_q.q[q_index];
 
 	_set_ready_q_prio_bit(thread->prio);
-	sys_dlist_append(q, &thread->k_q_node);
+	_insert_in_prio_q(q, thread);
 
 	struct k_thread **cache = &_nanokernel.ready_q.cache;
 
-	*cache = *cache && _is_prio_higher(thread->prio, (*cache)->prio) ?
+	*cache = *cache && _is_inserted_ahead_of(thread, *cache) ?
 		 thread : *cache;
 }
 
@@ -149,6 +200,7 @@ void _pend_thread(struct k_thread *thread, _wait_q_t *wait_q, int32_t timeout)
 			    _is_wait_q_insert_point, (void *)thread->prio);
 
 	_mark_thread_as_pending(thread);
+	_k_trace_pend(thread, wait_q, timeout);
 
 	if (timeout != K_FOREVER) {
 		_mark_thread_as_timing(thread);
@@ -165,6 +217,18 @@ void _pend_current_thread(_wait_q_t *wait_q, int32_t timeout)
 	_pend_thread(_current, wait_q, timeout);
 }
 
+/*
+ * Move a pended thread to its place in the wait queue it is pending on, after
+ * its priority has changed.
+ */
+/* must be called with interrupts locked */
+void _reorder_pended_thread(struct k_thread *thread, _wait_q_t *wait_q)
+{
+	sys_dlist_remove(&thread->k_q_node);
+	sys_dlist_insert_at((sys_dlist_t *)wait_q, &thread->k_q_node,
+			    _is_wait_q_insert_point, (void *)thread->prio);
+}
+
 /*
  * Find the next thread to run when there is no thread in the cache and update
  * the cache.
@@ -189,13 +253,136 @@ static struct k_thread *__get_next_ready_thread(void)
 
 /* find which one is the next thread to run */
 /* must be called with interrupts locked */
-struct k_thread *_get_next_ready_thread(void)
+static inline struct k_thread *_peek_next_ready_thread(void)
 {
 	struct k_thread *cache = _nanokernel.ready_q.cache;
 
 	return cache ? cache : __get_next_ready_thread();
 }
 
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+/* cycle count when the runtime of the current thread was last updated */
+static uint32_t _runtime_stamp;
+
+/* cycles the current thread has been running for since it was switched in */
+static uint32_t _runtime_slice_cycles;
+
+static uint64_t _runtime_total_cycles;
+
+/*
+ * Charge the cycles elapsed since the last update to the current thread.
+ *
+ * This is also called on every tick announcement. Tickless idle periods, and
+ * the timer programming of the tickless kernel, are bounded with
+ * _thread_runtime_bound_ticks(), so that the 32-bit cycle counter cannot wrap
+ * between two updates.
+ *
+ * Must be called with interrupts locked.
+ */
+void _thread_runtime_update(void)
+{
+	uint32_t now = k_cycle_get_32();
+	uint32_t delta = now - _runtime_stamp;
+
+	_runtime_stamp = now;
+	_runtime_slice_cycles += delta;
+	_runtime_total_cycles += delta;
+	_current->runtime_stats.total_cycles += delta;
+}
+
+/*
+ * Bound a number of ticks without tick announcement (K_FOREVER included) to
+ * half a wrap of the cycle counter.
+ */
+int32_t _thread_runtime_bound_ticks(int32_t ticks)
+{
+	int32_t max_ticks = (int32_t)(0x80000000U /
+				      (uint32_t)sys_clock_hw_cycles_per_tick);
+
+	if (ticks == K_FOREVER || ticks > max_ticks) {
+		return max_ticks;
+	}
+
+	return ticks;
+}
+
+/*
+ * Close the slice of the current thread and open the one of the next thread.
+ * Does a constant amount of work, regardless of the number of threads.
+ *
+ * Must be called with interrupts locked.
+ */
+static inline void _thread_runtime_switch(struct k_thread *next)
+{
+	_thread_runtime_update();
+
+	if (next == _current) {
+		return;
+	}
+
+	_current->runtime_stats.last_slice_cycles = _runtime_slice_cycles;
+	if (_is_thread_ready(_current)) {
+		_current->runtime_stats.preemptions++;
+	}
+
+	next->runtime_stats.switches++;
+	_runtime_slice_cycles = 0;
+}
+#else
+#define _thread_runtime_switch(next) do { } while (0)
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
+
+#ifdef CONFIG_TIMESLICING
+extern int32_t _time_slice_duration;    /* Measured in ms */
+extern int32_t _time_slice_elapsed;     /* Measured in ms */
+extern int _time_slice_prio_ceiling;
+
+/*
+ * A thread gets a full time slice each time it is switched in. With the
+ * tickless kernel, the timer interrupt is also reprogrammed for the end of
+ * that slice, since it may have been programmed for a later one.
+ */
+static inline void _time_slice_switch(struct k_thread *next)
+{
+	if (next == _current) {
+		return;
+	}
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	if (_time_slice_duration != 0) {
+		_sys_clock_tick_update();
+		_time_slice_elapsed = 0;
+		_sys_clock_deadline_update();
+		return;
+	}
+#endif
+
+	_time_slice_elapsed = 0;
+}
+#else
+#define _time_slice_switch(next) do { } while (0)
+#endif /* CONFIG_TIMESLICING */
+
+/*
+ * Find which one is the next thread to run, on behalf of the architecture
+ * context switch code: the thread returned becomes the current thread.
+ *
+ * Must be called with interrupts locked.
+ */
+struct k_thread *_get_next_ready_thread(void)
+{
+	struct k_thread *thread = _peek_next_ready_thread();
+
+	if (thread != _current) {
+		_k_trace_thread_switch(thread);
+	}
+
+	_time_slice_switch(thread);
+	_thread_runtime_switch(thread);
+
+	return thread;
+}
+
 /*
  * Check if there is a thread of higher prio than the current one. Should only
  * be called if we already know that the current thread is preemptible.
@@ -208,12 +395,20 @@ int __must_switch_threads(void)
 	extern void _dump_ready_q(void);
 	_dump_ready_q();
 
-	return _is_prio_higher(_get_highest_ready_prio(), _current->prio);
+	int prio = _get_highest_ready_prio();
+
+#ifdef CONFIG_SCHED_DEADLINE
+	if (prio == _current->prio) {
+		return _is_deadline_earlier(_peek_next_ready_thread(), _current);
+	}
+#endif
+
+	return _is_prio_higher(prio, _current->prio);
 }
 
 int _is_next_thread_current(void)
 {
-	return _get_next_ready_thread() == _current;
+	return _peek_next_ready_thread() == _current;
 }
 
 /* application API: get a thread's priority */
@@ -240,6 +435,9 @@ void k_thread_priority_set(k_tid_t tid, int prio)
  * This function, along with _add_thread_to_ready_q() and
  * _remove_thread_from_ready_q(), are the _only_ places where a thread is
  * taken off or put on the ready queue.
+ *
+ * With CONFIG_SCHED_DEADLINE, the thread is only moved behind the threads of
+ * equal priority whose deadline is not later than its own.
  */
 void _move_thread_to_end_of_prio_q(struct k_thread *thread)
 {
@@ -251,7 +449,7 @@ void _move_thread_to_end_of_prio_q(struct k_thread *thread)
 	}
 
 	sys_dlist_remove(&thread->k_q_node);
-	sys_dlist_append(q, &thread->k_q_node);
+	_insert_in_prio_q(q, thread);
 
 	struct k_thread **cache = &_nanokernel.ready_q.cache;
 
@@ -272,7 +470,7 @@ void k_yield(void)
 
 	_move_thread_to_end_of_prio_q(_current);
 
-	if (_current == _get_next_ready_thread()) {
+	if (_current == _peek_next_ready_thread()) {
 		irq_unlock(key);
 	} else {
 		_Swap(key);
@@ -337,7 +535,12 @@ k_tid_t k_current_get(void)
 /* debug aid */
 void _dump_ready_q(void)
 {
-	K_DEBUG("bitmap: %x\n", _ready_q.prio_bmap[0]);
+#if (K_NUM_PRIO_BITMAPS > 1)
+	K_DEBUG("summary bitmap: %x\n", _ready_q.prio_bmap_summary);
+#endif
+	for (int bmap = 0; bmap < K_NUM_PRIO_BITMAPS; bmap++) {
+		K_DEBUG("bitmap[%d]: %x\n", bmap, _ready_q.prio_bmap[bmap]);
+	}
 	for (int prio = 0; prio < K_NUM_PRIORITIES; prio++) {
 		K_DEBUG("prio: %d, head: %p\n",
 			prio - CONFIG_NUM_COOP_PRIORITIES,
@@ -345,18 +548,74 @@ void _dump_ready_q(void)
 	}
 }
 
-#ifdef CONFIG_TIMESLICING
-extern int32_t _time_slice_duration;    /* Measured in ms */
-extern int32_t _time_slice_elapsed;     /* Measured in ms */
-extern int _time_slice_prio_ceiling;
+#ifdef CONFIG_SCHED_DEADLINE
+void k_thread_deadline_set(k_tid_t tid, int deadline)
+{
+	__ASSERT(deadline >= 0, "");
+
+	struct k_thread *thread = (struct k_thread *)tid;
+	int key = irq_lock();
+
+	thread->deadline = k_cycle_get_32() + deadline;
+
+	/* move the thread to its new position in the ready queue */
+	if (_is_thread_ready(thread)) {
+		_remove_thread_from_ready_q(thread);
+		_add_thread_to_ready_q(thread);
+	}
 
+	if (_is_in_isr()) {
+		irq_unlock(key);
+	} else {
+		_reschedule_threads(key);
+	}
+}
+#endif /* CONFIG_SCHED_DEADLINE */
+
+#ifdef CONFIG_TIMESLICING
 void k_sched_time_slice_set(int32_t duration_in_ms, int prio)
 {
 	__ASSERT(duration_in_ms >= 0, "");
 	__ASSERT((prio >= 0) && (prio < CONFIG_NUM_PREEMPT_PRIORITIES), "");
 
+	unsigned int key = irq_lock();
+
+	_sys_clock_tick_update();
+
 	_time_slice_duration = duration_in_ms;
 	_time_slice_elapsed = 0;
 	_time_slice_prio_ceiling = prio;
+
+	_sys_clock_deadline_update();
+
+	irq_unlock(key);
 }
 #endif /* CONFIG_TIMESLICING */
+
+#ifdef CONFIG_THREAD_RUNTIME_STATS
+void k_thread_runtime_stats_get(k_tid_t thread,
+				struct k_thread_runtime_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	if (thread == _current) {
+		_thread_runtime_update();
+	}
+
+	*stats = thread->runtime_stats;
+
+	irq_unlock(key);
+}
+
+void k_sys_runtime_stats_get(struct k_sys_runtime_stats *stats)
+{
+	unsigned int key = irq_lock();
+
+	_thread_runtime_update();
+
+	stats->total_cycles = _runtime_total_cycles;
+	stats->idle_cycles = _idle_thread->runtime_stats.total_cycles;
+
+	irq_unlock(key);
+}
+#endif /* CONFIG_THREAD_RUNTIME_STATS */
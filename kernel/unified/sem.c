@@ -56,6 +56,9 @@ void k_sem_init(struct k_sem *sem, unsigned int initial_count,
 	sem->count = initial_count;
 	sem->limit = limit;
 	sys_dlist_init(&sem->wait_q);
+#ifdef CONFIG_POLL
+	sem->poll_event = NULL;
+#endif
 	SYS_TRACING_OBJ_INIT(nano_sem, sem);
 }
 
@@ -212,6 +215,22 @@ static int handle_sem_group(struct k_sem *sem, struct k_thread *thread)
 #define handle_sem_group(sem, thread) 0
 #endif
 
+/*
+ * Notify the thread polling the semaphore, if any, that it is available.
+ *
+ * Returns 1 if a thread was readied, 0 otherwise.
+ */
+static inline int handle_poll_event(struct k_sem *sem)
+{
+#ifdef CONFIG_POLL
+	uint32_t state = K_POLL_STATE_SEM_AVAILABLE;
+
+	return _handle_obj_poll_event(&sem->poll_event, state);
+#else
+	return 0;
+#endif
+}
+
 /**
  * @brief Common semaphore give code
  *
@@ -229,7 +248,8 @@ static bool sem_give_common(struct k_sem *sem)
 		 * its limit has already been reached.
 		 */
 		sem->count += (sem->count != sem->limit);
-		return false;
+		return handle_poll_event(sem) &&
+		       !_is_in_isr() && _must_switch_threads();
 	}
 
 	_abort_thread_timeout(thread);
@@ -261,6 +281,7 @@ void _sem_give_non_preemptible(struct k_sem *sem)
 	if (!thread) {
 		/* increment semaphore's count unless limit is reached */
 		sem->count += (sem->count != sem->limit);
+		handle_poll_event(sem);
 		return;
 	}
 
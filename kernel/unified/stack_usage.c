@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Thread stack usage analysis
+ *
+ * Stacks grow down from the end of their area, the thread control structure
+ * sitting at its base. They are painted with 0xaa when created
+ * (CONFIG_INIT_STACKS), so the bytes above the thread control structure
+ * still holding the pattern have never been used.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <ksched.h>
+#include <misc/printk.h>
+#include <misc/shell.h>
+
+#define STACK_PAINT_BYTE 0xaa
+#define STACK_PAINT_WORD 0xaaaaaaaa
+
+extern char _interrupt_stack[];
+
+/* count the painted bytes from the base of a stack area */
+static size_t stack_unused_get(const char *start, size_t size)
+{
+	const char *p = start;
+	const char *end = start + size;
+
+	while (p < end && ((uintptr_t)p & (sizeof(uint32_t) - 1))) {
+		if ((unsigned char)*p != STACK_PAINT_BYTE) {
+			return p - start;
+		}
+		p++;
+	}
+
+	while (p + sizeof(uint32_t) <= end &&
+	       *(const uint32_t *)p == STACK_PAINT_WORD) {
+		p += sizeof(uint32_t);
+	}
+
+	while (p < end && (unsigned char)*p == STACK_PAINT_BYTE) {
+		p++;
+	}
+
+	return p - start;
+}
+
+void k_thread_stack_usage_get(k_tid_t thread, struct k_stack_usage *usage)
+{
+	usage->size = thread->stack_size - sizeof(struct k_thread);
+	usage->unused = stack_unused_get((char *)thread + sizeof(struct k_thread),
+					 usage->size);
+}
+
+void k_isr_stack_usage_get(struct k_stack_usage *usage)
+{
+	usage->size = CONFIG_ISR_STACK_SIZE;
+	usage->unused = stack_unused_get(_interrupt_stack, usage->size);
+}
+
+void k_stack_usage_foreach(k_stack_usage_cb_t cb, void *user_data)
+{
+	struct k_stack_usage usage;
+	struct k_thread *thread;
+
+	/* no other thread can run, and exit, while walking the list */
+	k_sched_lock();
+
+	for (thread = _nanokernel.threads; thread;
+	     thread = thread->next_thread) {
+		k_thread_stack_usage_get(thread, &usage);
+		cb(thread, &usage, user_data);
+	}
+
+	k_sched_unlock();
+
+	k_isr_stack_usage_get(&usage);
+	cb(NULL, &usage, user_data);
+}
+
+static void stack_usage_print(k_tid_t thread,
+			      const struct k_stack_usage *usage,
+			      void *user_data)
+{
+	size_t used = usage->size - usage->unused;
+	const char *name;
+
+	ARG_UNUSED(user_data);
+
+	if (!thread) {
+		name = " (interrupts)";
+	} else if (thread == _main_thread) {
+		name = " (main)";
+	} else if (thread == _idle_thread) {
+		name = " (idle)";
+	} else {
+		name = "";
+	}
+
+	printk("%p%s: size %u, unused %u, usage %u%%\n", thread, name,
+	       usage->size, usage->unused,
+	       usage->size ? used * 100 / usage->size : 0);
+}
+
+void k_stack_usage_print(void)
+{
+	k_stack_usage_foreach(stack_usage_print, NULL);
+}
+
+int shell_cmd_stacks(int argc, char *argv[])
+{
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+	k_stack_usage_print();
+
+	return 0;
+}
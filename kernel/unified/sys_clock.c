@@ -53,6 +53,12 @@ int64_t _sys_clock_tick_count;
  */
 uint32_t sys_tick_get_32(void)
 {
+#ifdef CONFIG_TICKLESS_KERNEL
+	unsigned int imask = irq_lock();
+
+	_sys_clock_tick_update();
+	irq_unlock(imask);
+#endif
 	return (uint32_t)_sys_clock_tick_count;
 }
 
@@ -79,6 +85,7 @@ int64_t sys_tick_get(void)
 	 */
 	unsigned int imask = irq_lock();
 
+	_sys_clock_tick_update();
 	tmp_sys_clock_tick_count = _sys_clock_tick_count;
 	irq_unlock(imask);
 	return tmp_sys_clock_tick_count;
@@ -130,6 +137,7 @@ static ALWAYS_INLINE int64_t _nano_tick_delta(int64_t *reftime)
 	 */
 	unsigned int imask = irq_lock();
 
+	_sys_clock_tick_update();
 	saved = _sys_clock_tick_count;
 	irq_unlock(imask);
 	delta = saved - (*reftime);
@@ -176,6 +184,15 @@ uint32_t k_uptime_delta_32(int64_t *reftime)
 #ifdef CONFIG_SYS_CLOCK_EXISTS
 #include <wait_q.h>
 
+#ifdef CONFIG_TIMEOUT_QUEUE_PAIRING_HEAP
+/* the heap is keyed on the tick count, which has already been updated */
+static inline void handle_expired_timeouts(int32_t ticks)
+{
+	ARG_UNUSED(ticks);
+
+	_handle_timeouts();
+}
+#else
 static inline void handle_expired_timeouts(int32_t ticks)
 {
 	struct _timeout *head =
@@ -189,15 +206,29 @@ static inline void handle_expired_timeouts(int32_t ticks)
 		_handle_timeouts();
 	}
 }
+#endif /* CONFIG_TIMEOUT_QUEUE_PAIRING_HEAP */
 #else
 	#define handle_expired_timeouts(ticks) do { } while ((0))
 #endif
 
 #ifdef CONFIG_TIMESLICING
+/*
+ * Time the current thread has been running for since it was switched in,
+ * reset by the scheduler on each context switch.
+ */
 int32_t _time_slice_elapsed;
 int32_t _time_slice_duration = CONFIG_TIMESLICE_SIZE;
 int  _time_slice_prio_ceiling = CONFIG_TIMESLICE_PRIORITY;
 
+/*
+ * When the slice of the current thread is used up, put it at the end of the
+ * queue for its priority: the interrupt exit code then switches to the next
+ * thread of the same priority, if any.
+ *
+ * Ticks are only suppressed by tickless idle while the idle thread runs, and
+ * the slice is reset when a thread is switched in, so the ticks announced
+ * when exiting tickless idle are not charged to the thread that gets to run.
+ */
 static void handle_time_slicing(int32_t ticks)
 {
 	if (_time_slice_duration == 0) {
@@ -209,7 +240,10 @@ static void handle_time_slicing(int32_t ticks)
 	}
 
 	_time_slice_elapsed += _ticks_to_ms(ticks);
-	if (_time_slice_elapsed >= _time_slice_duration) {
+
+	/* a thread that locked the scheduler is sliced once it unlocks it */
+	if (_time_slice_elapsed >= _time_slice_duration &&
+	    _is_preempt(_current)) {
 		_time_slice_elapsed = 0;
 		_move_thread_to_end_of_prio_q(_current);
 	}
@@ -217,6 +251,65 @@ static void handle_time_slicing(int32_t ticks)
 #else
 #define handle_time_slicing(ticks) do { } while (0)
 #endif
+
+#ifdef CONFIG_TICKLESS_KERNEL
+/*
+ * Account for the ticks elapsed since the last timer interrupt. The timer is
+ * programmed for the next deadline, so none of these ticks can expire a
+ * timeout or end a time slice: they only have to be counted.
+ *
+ * Must be called with interrupts locked.
+ */
+void _sys_clock_tick_update(void)
+{
+	int32_t ticks = _timer_tickless_catch_up();
+
+	if (ticks == 0) {
+		return;
+	}
+
+	_sys_clock_tick_count += ticks;
+
+#ifndef CONFIG_TIMEOUT_QUEUE_PAIRING_HEAP
+	struct _timeout *head =
+		(struct _timeout *)sys_dlist_peek_head(&_timeout_q);
+
+	if (head) {
+		head->delta_ticks_from_prev -= ticks;
+	}
+#endif
+
+#ifdef CONFIG_TIMESLICING
+	_time_slice_elapsed += _ticks_to_ms(ticks);
+#endif
+}
+
+/*
+ * Program the timer interrupt for the next timeout to expire, or for the end
+ * of the time slice of the current thread if earlier. This is also done when
+ * a thread is switched in, so that it runs for at most one time slice.
+ *
+ * Must be called with interrupts locked, right after the tick count has been
+ * brought up to date.
+ */
+void _sys_clock_deadline_update(void)
+{
+	int32_t ticks = _get_next_timeout_expiry();
+
+#ifdef CONFIG_TIMESLICING
+	if (_time_slice_duration != 0) {
+		int32_t left = _time_slice_duration - _time_slice_elapsed;
+		int32_t slice_ticks = left > 0 ? _ms_to_ticks(left) : 1;
+
+		if (ticks == K_FOREVER || slice_ticks < ticks) {
+			ticks = slice_ticks;
+		}
+	}
+#endif
+
+	_timer_tickless_deadline_set(_thread_runtime_bound_ticks(ticks));
+}
+#endif /* CONFIG_TICKLESS_KERNEL */
 /**
  *
  * @brief Announce a tick to the nanokernel
@@ -239,5 +332,11 @@ void _nano_sys_clock_tick_announce(int32_t ticks)
 
 	handle_time_slicing(ticks);
 
+	_thread_runtime_update();
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	_sys_clock_deadline_update();
+#endif
+
 	irq_unlock(key);
 }
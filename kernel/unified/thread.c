@@ -372,6 +372,9 @@ void _k_thread_single_abort(struct k_thread *thread)
 		}
 		if (_is_thread_timing(thread)) {
 			_abort_thread_timeout(thread);
+#ifdef CONFIG_SYS_CLOCK_HIRES
+			_hires_timeout_abort(&thread->hires_timeout);
+#endif
 			_mark_thread_as_not_timing(thread);
 		}
 	}
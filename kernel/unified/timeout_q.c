@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief pairing heap timeout queue
+ *
+ * The heap is kept as a multiway tree where each node points to its leftmost
+ * child and to its right sibling. The 'prev' link points to the left sibling,
+ * or to the parent for a leftmost child, which allows removing any node from
+ * the heap without searching for it.
+ *
+ * All routines must be called with interrupts locked.
+ */
+
+#include <kernel.h>
+#include <nano_private.h>
+#include <wait_q.h>
+
+/* root of the heap: the timeout expiring first */
+struct _timeout *_timeout_heap;
+
+static inline int _is_timeout_earlier(struct _timeout *t1,
+				      struct _timeout *t2)
+{
+	return (int32_t)(t1->expiry_tick - t2->expiry_tick) < 0;
+}
+
+/*
+ * Merge two heaps, whose roots must not have any siblings. Returns the root of
+ * the resulting heap, the other root becoming its leftmost child.
+ */
+static struct _timeout *heap_meld(struct _timeout *a, struct _timeout *b)
+{
+	struct _timeout *tmp;
+
+	if (!a) {
+		return b;
+	}
+
+	if (!b) {
+		return a;
+	}
+
+	if (_is_timeout_earlier(b, a)) {
+		tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	b->heap_prev = a;
+	b->heap_next = a->heap_child;
+	if (a->heap_child) {
+		a->heap_child->heap_prev = b;
+	}
+	a->heap_child = b;
+
+	return a;
+}
+
+/*
+ * Merge a list of sibling sub-heaps into one heap, using the standard
+ * two-pass method: meld siblings pairwise from left to right, then meld the
+ * resulting heaps from right to left. This is what provides the amortized
+ * O(log n) bound on removals.
+ */
+static struct _timeout *heap_merge_pairs(struct _timeout *first)
+{
+	struct _timeout *pairs = NULL;
+	struct _timeout *root = NULL;
+	struct _timeout *a, *b, *next;
+
+	/* first pass: the melded pairs are pushed on a list in reverse order */
+	while (first) {
+		a = first;
+		b = a->heap_next;
+		first = b ? b->heap_next : NULL;
+
+		a->heap_next = a->heap_prev = NULL;
+		if (b) {
+			b->heap_next = b->heap_prev = NULL;
+		}
+
+		a = heap_meld(a, b);
+		a->heap_next = pairs;
+		pairs = a;
+	}
+
+	/* second pass: meld the pairs, starting from the rightmost one */
+	while (pairs) {
+		next = pairs->heap_next;
+		pairs->heap_next = NULL;
+		root = heap_meld(root, pairs);
+		pairs = next;
+	}
+
+	return root;
+}
+
+void _timeout_heap_insert(struct _timeout *t)
+{
+	t->heap_child = t->heap_next = t->heap_prev = NULL;
+
+	_timeout_heap = heap_meld(_timeout_heap, t);
+}
+
+void _timeout_heap_remove(struct _timeout *t)
+{
+	struct _timeout *sub = heap_merge_pairs(t->heap_child);
+
+	if (t == _timeout_heap) {
+		_timeout_heap = sub;
+	} else {
+		/* unlink from the parent's list of children */
+		if (t->heap_prev->heap_child == t) {
+			t->heap_prev->heap_child = t->heap_next;
+		} else {
+			t->heap_prev->heap_next = t->heap_next;
+		}
+
+		if (t->heap_next) {
+			t->heap_next->heap_prev = t->heap_prev;
+		}
+
+		_timeout_heap = heap_meld(_timeout_heap, sub);
+	}
+
+	t->heap_child = t->heap_next = t->heap_prev = NULL;
+}
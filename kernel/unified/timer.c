@@ -18,6 +18,39 @@
 #include <misc/debug/object_tracing_common.h>
 #include <wait_q.h>
 
+/*
+ * Update the status of an expired timer, invoke its expiry function and wake
+ * up the thread waiting on it, if any.
+ *
+ * Must be called with interrupts locked.
+ */
+static void timer_expired(struct k_timer *timer)
+{
+	struct k_thread *pending_thread;
+
+	/* update timer's status */
+	timer->status += 1;
+
+	/* invoke timer expiry function */
+	if (timer->expiry_fn) {
+		timer->expiry_fn(timer);
+	}
+
+#ifdef CONFIG_POLL
+	/* notify the thread polling the timer, if any */
+	_handle_obj_poll_event(&timer->poll_event, K_POLL_STATE_TIMER_EXPIRED);
+#endif
+	/*
+	 * wake up the (only) thread waiting on the timer, if there is one;
+	 * don't invoke _Swap() since the timeout ISR called us, not a thread
+	 */
+	pending_thread = _unpend_first_thread(&timer->wait_q);
+	if (pending_thread) {
+		_ready_thread(pending_thread);
+		_set_thread_return_value(pending_thread, 0);
+	}
+}
+
 /**
  * @brief Handle expiration of a kernel timer object.
  *
@@ -29,7 +62,6 @@ static void timer_expiration_handler(struct _timeout *t)
 {
 	int key = irq_lock();
 	struct k_timer *timer = CONTAINER_OF(t, struct k_timer, timeout);
-	struct k_thread *pending_thread;
 
 	/*
 	 * if the timer is periodic, start it again; don't add _TICK_ALIGN
@@ -40,26 +72,51 @@ static void timer_expiration_handler(struct _timeout *t)
 				timer->period);
 	}
 
-	/* update timer's status */
-	timer->status += 1;
+	timer_expired(timer);
 
-	/* invoke timer expiry function */
-	if (timer->expiry_fn) {
-		timer->expiry_fn(timer);
-	}
-	/*
-	 * wake up the (only) thread waiting on the timer, if there is one;
-	 * don't invoke _Swap() since the timeout ISR called us, not a thread
-	 */
-	pending_thread = _unpend_first_thread(&timer->wait_q);
-	if (pending_thread) {
-		_ready_thread(pending_thread);
-		_set_thread_return_value(pending_thread, 0);
+	irq_unlock(key);
+}
+
+#ifdef CONFIG_SYS_CLOCK_HIRES
+/**
+ * @brief Handle expiration of a kernel timer object started in cycles.
+ *
+ * @param t  High-resolution timeout used by the timer.
+ *
+ * @return N/A
+ */
+static void timer_hires_expiration_handler(struct _hires_timeout *t)
+{
+	struct k_timer *timer = CONTAINER_OF(t, struct k_timer,
+					     hires_timeout);
+
+	/* restart from the expiry point, so that the period does not drift */
+	if (timer->hires_period > 0) {
+		_hires_timeout_add(&timer->hires_timeout,
+				   t->expiry_cycle + timer->hires_period);
 	}
 
-	irq_unlock(key);
+	timer_expired(timer);
 }
 
+/* returns 0 if the timer was running, -1 otherwise */
+static inline int timer_abort(struct k_timer *timer)
+{
+	int hires_stopped = _hires_timeout_abort(&timer->hires_timeout);
+
+	return (_abort_timeout(&timer->timeout) == 0) ? 0 : hires_stopped;
+}
+
+static inline int timer_is_running(struct k_timer *timer)
+{
+	return timer->timeout.delta_ticks_from_prev != -1 ||
+	       _is_hires_timeout_queued(&timer->hires_timeout);
+}
+#else
+#define timer_abort(timer) _abort_timeout(&(timer)->timeout)
+#define timer_is_running(timer) ((timer)->timeout.delta_ticks_from_prev != -1)
+#endif
+
 
 void k_timer_init(struct k_timer *timer,
 		  void (*expiry_fn)(struct k_timer *),
@@ -70,7 +127,14 @@ void k_timer_init(struct k_timer *timer,
 	timer->status = 0;
 
 	sys_dlist_init(&timer->wait_q);
+#ifdef CONFIG_POLL
+	timer->poll_event = NULL;
+#endif
 	_init_timeout(&timer->timeout, timer_expiration_handler);
+#ifdef CONFIG_SYS_CLOCK_HIRES
+	_init_hires_timeout(&timer->hires_timeout,
+			    timer_hires_expiration_handler);
+#endif
 	SYS_TRACING_OBJ_INIT(micro_timer, timer);
 
 	timer->_legacy_data = NULL;
@@ -84,9 +148,7 @@ void k_timer_start(struct k_timer *timer, int32_t duration, int32_t period)
 
 	unsigned int key = irq_lock();
 
-	if (timer->timeout.delta_ticks_from_prev != -1) {
-		_abort_timeout(&timer->timeout);
-	}
+	timer_abort(timer);
 
 	timer->period = _ms_to_ticks(period);
 	_add_timeout(NULL, &timer->timeout, &timer->wait_q,
@@ -95,13 +157,31 @@ void k_timer_start(struct k_timer *timer, int32_t duration, int32_t period)
 	irq_unlock(key);
 }
 
+#ifdef CONFIG_SYS_CLOCK_HIRES
+void k_timer_start_cycles(struct k_timer *timer,
+			  uint32_t duration, uint32_t period)
+{
+	__ASSERT((int32_t)duration >= 0 && (int32_t)period >= 0 &&
+		 (duration != 0 || period != 0), "invalid parameters\n");
+
+	unsigned int key = irq_lock();
+
+	timer_abort(timer);
+
+	timer->hires_period = period;
+	_hires_timeout_add(&timer->hires_timeout, k_cycle_get_32() + duration);
+	timer->status = 0;
+	irq_unlock(key);
+}
+#endif
+
 
 void k_timer_stop(struct k_timer *timer)
 {
 	__ASSERT(!_is_in_isr(), "");
 
 	int key = irq_lock();
-	int stopped = _abort_timeout(&timer->timeout);
+	int stopped = timer_abort(timer);
 
 	irq_unlock(key);
 
@@ -148,7 +228,7 @@ uint32_t k_timer_status_sync(struct k_timer *timer)
 	uint32_t result = timer->status;
 
 	if (result == 0) {
-		if (timer->timeout.delta_ticks_from_prev != -1) {
+		if (timer_is_running(timer)) {
 			/* wait for timer to expire or stop */
 			_pend_current_thread(&timer->wait_q, K_FOREVER);
 			_Swap(key);
@@ -174,24 +254,22 @@ int32_t k_timer_remaining_get(struct k_timer *timer)
 {
 	unsigned int key = irq_lock();
 	int32_t remaining_ticks;
-	sys_dlist_t *timeout_q = &_nanokernel.timeout_q;
+
+#ifdef CONFIG_SYS_CLOCK_HIRES
+	if (_is_hires_timeout_queued(&timer->hires_timeout)) {
+		int32_t cycles = timer->hires_timeout.expiry_cycle -
+				 k_cycle_get_32();
+
+		irq_unlock(key);
+		return cycles > 0 ? (int32_t)(((uint64_t)cycles * MSEC_PER_SEC) /
+					      sys_clock_hw_cycles_per_sec) : 0;
+	}
+#endif
 
 	if (timer->timeout.delta_ticks_from_prev == -1) {
 		remaining_ticks = 0;
 	} else {
-		/*
-		 * compute remaining ticks by walking the timeout list
-		 * and summing up the various tick deltas involved
-		 */
-		struct _timeout *t =
-			(struct _timeout *)sys_dlist_peek_head(timeout_q);
-
-		remaining_ticks = t->delta_ticks_from_prev;
-		while (t != &timer->timeout) {
-			t = (struct _timeout *)sys_dlist_peek_next(timeout_q,
-								   &t->node);
-			remaining_ticks += t->delta_ticks_from_prev;
-		}
+		remaining_ticks = _get_timeout_remaining_ticks(&timer->timeout);
 	}
 
 	irq_unlock(key);
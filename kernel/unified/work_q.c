@@ -22,7 +22,67 @@
 
 #include <nano_private.h>
 #include <wait_q.h>
+#include <ksched.h>
 #include <errno.h>
+#include <misc/util.h>
+
+/* get the next work item to process, waiting for one if needed */
+static struct k_work *work_q_get(struct k_work_q *work_q)
+{
+	unsigned int key = irq_lock();
+	struct k_work *work;
+	int prio;
+
+	if (work_q->pending_prios == 0) {
+		_pend_current_thread(&work_q->wait_q, K_FOREVER);
+		_Swap(key);
+		return _current->swap_data;
+	}
+
+	prio = find_lsb_set(work_q->pending_prios) - 1;
+	work = (struct k_work *)
+		sys_slist_get_not_empty(&work_q->queues[prio]);
+	if (sys_slist_is_empty(&work_q->queues[prio])) {
+		work_q->pending_prios &= ~(1U << prio);
+	}
+
+	irq_unlock(key);
+
+	return work;
+}
+
+void k_work_submit_to_queue_prio(struct k_work_q *work_q,
+				 struct k_work *work, int prio)
+{
+	struct k_thread *worker;
+	unsigned int key;
+
+	__ASSERT(prio >= 0 && prio < CONFIG_NUM_WORK_PRIORITIES,
+		 "invalid work priority %d\n", prio);
+
+	if (atomic_test_and_set_bit(work->flags, K_WORK_STATE_PENDING)) {
+		return;
+	}
+
+	key = irq_lock();
+
+	/* an idle worker means that no work item is queued */
+	worker = _unpend_first_thread(&work_q->wait_q);
+
+	if (worker) {
+		_ready_thread(worker);
+		_set_thread_return_value_with_data(worker, 0, work);
+		if (!_is_in_isr() && _must_switch_threads()) {
+			(void)_Swap(key);
+			return;
+		}
+	} else {
+		sys_slist_append(&work_q->queues[prio], (sys_snode_t *)work);
+		work_q->pending_prios |= 1U << prio;
+	}
+
+	irq_unlock(key);
+}
 
 static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 {
@@ -35,7 +95,7 @@ static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 		struct k_work *work;
 		k_work_handler_t handler;
 
-		work = k_fifo_get(&work_q->fifo, K_FOREVER);
+		work = work_q_get(work_q);
 
 		handler = work->handler;
 
@@ -45,21 +105,34 @@ static void work_q_main(void *work_q_ptr, void *p2, void *p3)
 			handler(work);
 		}
 
-		/* Make sure we don't hog up the CPU if the FIFO never (or
+		/* Make sure we don't hog up the CPU if the queue never (or
 		 * very rarely) gets empty.
 		 */
 		k_yield();
 	}
 }
 
+void k_work_q_start_pool(struct k_work_q *work_q, char *stacks,
+			 unsigned stack_size, unsigned num_workers,
+			 unsigned prio)
+{
+	sys_dlist_init(&work_q->wait_q);
+	work_q->pending_prios = 0;
+	for (int i = 0; i < CONFIG_NUM_WORK_PRIORITIES; i++) {
+		sys_slist_init(&work_q->queues[i]);
+	}
+
+	for (unsigned i = 0; i < num_workers; i++) {
+		k_thread_spawn(stacks + i * stack_size, stack_size,
+			       work_q_main, work_q, 0, 0,
+			       prio, 0, 0);
+	}
+}
+
 void k_work_q_start(struct k_work_q *work_q, char *stack,
 		    unsigned stack_size, unsigned prio)
 {
-	k_fifo_init(&work_q->fifo);
-
-	k_thread_spawn(stack, stack_size,
-		       work_q_main, work_q, 0, 0,
-		       prio, 0, 0);
+	k_work_q_start_pool(work_q, stack, stack_size, 1, prio);
 }
 
 #ifdef CONFIG_SYS_CLOCK_EXISTS
@@ -150,7 +223,8 @@ int k_delayed_work_cancel(struct k_delayed_work *work)
 
 #include <init.h>
 
-static char __stack sys_work_q_stack[CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
+static char __stack sys_work_q_stacks[CONFIG_SYSTEM_WORKQUEUE_NUM_WORKERS]
+				     [CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE];
 
 struct k_work_q k_sys_work_q;
 
@@ -158,10 +232,11 @@ static int k_sys_work_q_init(struct device *dev)
 {
 	ARG_UNUSED(dev);
 
-	k_work_q_start(&k_sys_work_q,
-		       sys_work_q_stack,
-		       sizeof(sys_work_q_stack),
-		       CONFIG_SYSTEM_WORKQUEUE_PRIORITY);
+	k_work_q_start_pool(&k_sys_work_q,
+			    (char *)sys_work_q_stacks,
+			    CONFIG_SYSTEM_WORKQUEUE_STACK_SIZE,
+			    CONFIG_SYSTEM_WORKQUEUE_NUM_WORKERS,
+			    CONFIG_SYSTEM_WORKQUEUE_PRIORITY);
 
 	return 0;
 }
@@ -23,6 +23,7 @@
 #include <string.h>
 #include <ctype.h>
 
+/* limit of the field width, precision and string length */
 #ifndef MAXFLD
 #define	MAXFLD	200
 #endif
@@ -31,358 +32,592 @@
 #define EOF  -1
 #endif
 
-static void _uc(char *buf)
-{
-	for (/**/; *buf; buf++) {
-		if (*buf >= 'a' && *buf <= 'z') {
-			*buf += 'A' - 'a';
-		}
-	}
-}
+#define HIGHBIT64 (1ull<<63)
 
-/* Convention note: "end" as passed in is the standard "byte after
- * last character" style, but...
+/* the decimal digits of 0 to 99, two characters per number */
+static const char _dec_pairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static const char _hex_lower[] = "0123456789abcdef";
+static const char _hex_upper[] = "0123456789ABCDEF";
+
+/* Writes the decimal digits of the specified number backwards from "end",
+ * two digits at a time, and returns the address of the first digit.
  */
-static int _reverse_and_pad(char *start, char *end, int minlen)
+static char *_utoa_dec(char *end, uint32_t n)
 {
-	int len;
+	while (n >= 100) {
+		uint32_t r = n % 100;
 
-	while (end - start < minlen) {
-		*end++ = '0';
+		n /= 100;
+		end -= 2;
+		end[0] = _dec_pairs[2 * r];
+		end[1] = _dec_pairs[2 * r + 1];
 	}
 
-	*end = 0;
-	len = end - start;
-	for (end--; end > start; end--, start++) {
-		char tmp = *end;
-		*end = *start;
-		*start = tmp;
+	if (n >= 10) {
+		end -= 2;
+		end[0] = _dec_pairs[2 * n];
+		end[1] = _dec_pairs[2 * n + 1];
+	} else {
+		*--end = '0' + n;
 	}
-	return len;
+
+	return end;
 }
 
-/* Writes the specified number into the buffer in the given base,
- * using the digit characters 0-9a-z (i.e. base>36 will start writing
- * odd bytes), padding with leading zeros up to the minimum length.
- */
-static int _to_x(char *buf, uint32_t n, int base, int minlen)
+/* Same as _utoa_dec(), for the power of two base 1 << "shift". */
+static char *_utoa_pow2(char *end, uint32_t n, int shift, const char *digits)
 {
-	char *buf0 = buf;
+	uint32_t mask = (1 << shift) - 1;
 
 	do {
-		int d = n % base;
-
-		n /= base;
-		*buf++ = '0' + d + (d > 9 ? ('a' - '0' - 10) : 0);
+		*--end = digits[n & mask];
+		n >>= shift;
 	} while (n);
-	return _reverse_and_pad(buf0, buf, minlen);
+
+	return end;
 }
 
-static int _to_hex(char *buf, uint32_t value,
-		   int alt_form, int precision, int prefix)
-{
-	int len;
-	char *buf0 = buf;
+/*
+ * Floating point conversion.
+ *
+ * The value is scaled by a power of ten into [0.1, 1) in a single pass, using
+ * two 64-bit multiplications with precomputed powers of ten, instead of one
+ * division or multiplication by five per decimal order of magnitude. The
+ * significant digits are then pulled out of the 64-bit binary fraction by
+ * multiplying it by ten.
+ *
+ * Up to 17 digits, enough to identify any double, are produced; digits beyond
+ * these are output as zeros. The scaled fraction is off by a few units in its
+ * last bit, which only matters when the digits that follow the last one
+ * produced are close to one half: the value is then compared exactly with
+ * the halfway point, in multiple precision, so the result is always rounded
+ * correctly, with ties to even as the C library does.
+ */
+
+#define FLOAT_DIGITS_MAX 17
+
+/* bound of the error of the scaled fraction, in units of its last bit */
+#define FRACT_ERROR 8
+
+/* 32-bit words of the multiple precision numbers, for up to 5^340 times a
+ * 53-bit mantissa
+ */
+#define BIG_WORDS 28
 
-	if (alt_form) {
-		*buf++ = '0';
-		*buf++ = 'x';
+/* powers of ten, as a 64-bit mantissa with its top bit set and the
+ * corresponding binary exponent
+ */
+struct _pow10 {
+	uint64_t m;
+	int16_t e;
+};
+
+/* 1e-320 to 1e320, by steps of 1e16 */
+static const struct _pow10 _pow10_coarse[] = {
+	{ 0xfd00b897478238d1ull, -1127 }, { 0x8c71dcd9ba0b4926ull, -1073 },
+	{ 0x9becce62836ac577ull, -1020 }, { 0xad1c8eab5ee43b67ull, -967 },
+	{ 0xc0314325637a193aull, -914 }, { 0xd5605fcdcf32e1d7ull, -861 },
+	{ 0xece53cec4a314ebeull, -808 }, { 0x8380dea93da4bc60ull, -754 },
+	{ 0x91ff83775423cc06ull, -701 }, { 0xa21727db38cb0030ull, -648 },
+	{ 0xb3f4e093db73a093ull, -595 }, { 0xc7caba6e7c5382c9ull, -542 },
+	{ 0xddd0467c64bce4a1ull, -489 }, { 0xf64335bcf065d37dull, -436 },
+	{ 0x88b402f7fd75539bull, -382 }, { 0x97c560ba6b0919a6ull, -329 },
+	{ 0xa87fea27a539e9a5ull, -276 }, { 0xbb127c53b17ec159ull, -223 },
+	{ 0xcfb11ead453994baull, -170 }, { 0xe69594bec44de15bull, -117 },
+	{ 0x8000000000000000ull, -63 }, { 0x8e1bc9bf04000000ull, -10 },
+	{ 0x9dc5ada82b70b59eull, 43 }, { 0xaf298d050e4395d7ull, 96 },
+	{ 0xc2781f49ffcfa6d5ull, 149 }, { 0xd7e77a8f87daf7fcull, 202 },
+	{ 0xefb3ab16c59b14a3ull, 255 }, { 0x850fadc09923329eull, 309 },
+	{ 0x93ba47c980e98ce0ull, 362 }, { 0xa402b9c5a8d3a6e7ull, 415 },
+	{ 0xb616a12b7fe617aaull, 468 }, { 0xca28a291859bbf93ull, 521 },
+	{ 0xe070f78d3927556bull, 574 }, { 0xf92e0c3537826146ull, 627 },
+	{ 0x8a5296ffe33cc930ull, 681 }, { 0x9991a6f3d6bf1766ull, 734 },
+	{ 0xaa7eebfb9df9de8eull, 787 }, { 0xbd49d14aa79dbc82ull, 840 },
+	{ 0xd226fc195c6a2f8cull, 893 }, { 0xe950df20247c83fdull, 946 },
+	{ 0x81842f29f2cce376ull, 1000 },
+};
+
+#define POW10_COARSE_MIN (-20)
+
+/* 1e0 to 1e15 */
+static const struct _pow10 _pow10_fine[] = {
+	{ 0x8000000000000000ull, -63 }, { 0xa000000000000000ull, -60 },
+	{ 0xc800000000000000ull, -57 }, { 0xfa00000000000000ull, -54 },
+	{ 0x9c40000000000000ull, -50 }, { 0xc350000000000000ull, -47 },
+	{ 0xf424000000000000ull, -44 }, { 0x9896800000000000ull, -40 },
+	{ 0xbebc200000000000ull, -37 }, { 0xee6b280000000000ull, -34 },
+	{ 0x9502f90000000000ull, -30 }, { 0xba43b74000000000ull, -27 },
+	{ 0xe8d4a51000000000ull, -24 }, { 0x9184e72a00000000ull, -20 },
+	{ 0xb5e620f480000000ull, -17 }, { 0xe35fa931a0000000ull, -14 },
+};
+
+static const struct _pow10 _tenth = { 0xcccccccccccccccdull, -67 };
+static const struct _pow10 _ten = { 0xa000000000000000ull, -60 };
+
+/* 0.1 as a 64-bit binary fraction, rounded up */
+#define FRACT_TENTH 0x199999999999999aull
+
+/* Multiplies the number "*m" times 2 to the "*e", which has the top bit of
+ * its mantissa set, by the power of ten "p", keeping the result in the same
+ * form, rounded to 64 bits. Only 32-bit multiplications are used, as 64-bit
+ * arithmetic is done in library routines on most targets.
+ */
+static void _mul_pow10(uint64_t *m, int *e, const struct _pow10 *p)
+{
+	uint64_t a_lo = (uint32_t)*m, a_hi = *m >> 32;
+	uint64_t b_lo = (uint32_t)p->m, b_hi = p->m >> 32;
+	uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+	uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+	uint64_t mid = (lo_lo >> 32) + (uint32_t)hi_lo + (uint32_t)lo_hi;
+	uint64_t hi = hi_hi + (hi_lo >> 32) + (lo_hi >> 32) + (mid >> 32);
+	uint32_t lo = mid;
+
+	*e += p->e + 64;
+
+	if (!(hi >> 63)) {
+		hi = (hi << 1) | (lo >> 31);
+		lo <<= 1;
+		*e -= 1;
 	}
 
-	len = _to_x(buf, value, 16, precision);
-	if (prefix == 'X') {
-		_uc(buf0);
+	if (lo >> 31) {
+		hi++;
+		if (!hi) {
+			hi = HIGHBIT64;
+			*e += 1;
+		}
 	}
 
-	return len + (buf - buf0);
+	*m = hi;
 }
 
-static int _to_octal(char *buf, uint32_t value, int alt_form, int precision)
+/* Multiplies the multiple precision number "b" by "k". */
+static void _big_mul(uint32_t *b, uint32_t k)
 {
-	char *buf0 = buf;
-
-	if (alt_form) {
-		*buf++ = '0';
-		if (!value) {
-			/* So we don't return "00" for a value == 0. */
-			*buf++ = 0;
-			return 1;
-		}
+	uint64_t carry = 0;
+	int i;
+
+	for (i = 0; i < BIG_WORDS; i++) {
+		carry += (uint64_t)b[i] * k;
+		b[i] = carry;
+		carry >>= 32;
 	}
-	return (buf - buf0) + _to_x(buf, value, 8, precision);
 }
 
-static int _to_udec(char *buf, uint32_t value, int precision)
+/* Multiplies the multiple precision number "b" by 2 to the "s". */
+static void _big_shl(uint32_t *b, int s)
 {
-	return _to_x(buf, value, 10, precision);
+	int words = s >> 5, bits = s & 31, i;
+
+	for (i = BIG_WORDS - 1; i >= 0; i--) {
+		uint32_t w = i >= words ? b[i - words] << bits : 0;
+
+		if (bits && i > words) {
+			w |= b[i - words - 1] >> (32 - bits);
+		}
+		b[i] = w;
+	}
 }
 
-static int _to_dec(char *buf, int32_t value, int fplus, int fspace, int precision)
+/* Sets "b" to "v" times 5 to the "p", and 2 to the "s". */
+static void _big_set(uint32_t *b, uint64_t v, int p, int s)
 {
-	char *start = buf;
+	memset(b, 0, BIG_WORDS * sizeof(*b));
+	b[0] = v;
+	b[1] = v >> 32;
 
-#if (MAXFLD < 10)
-  #error buffer size MAXFLD is too small
-#endif
+	for (; p >= 13; p -= 13) {
+		_big_mul(b, 1220703125);	/* 5^13 */
+	}
+	for (; p > 0; p--) {
+		_big_mul(b, 5);
+	}
+	_big_shl(b, s);
+}
 
-	if (value < 0) {
-		*buf++ = '-';
-		if (value != 0x80000000)
-			value = -value;
-	} else if (fplus)
-		*buf++ = '+';
-	else if (fspace)
-		*buf++ = ' ';
+/*
+ * Compares "m" times 2 to the "e" with the decimal value halfway between "d"
+ * and "d" + 1, times 10 to the "q": (2 * d + 1) times 5 to the "q" and 2 to
+ * the "q" - 1. Returns a negative value, zero or a positive value if the
+ * former is smaller, equal or larger.
+ */
+static int _cmp_half(uint64_t m, int e, uint64_t d, int q)
+{
+	uint32_t a[BIG_WORDS], b[BIG_WORDS];
+	int s = e - (q - 1), i;
 
-	return (buf + _to_udec(buf, (uint32_t) value, precision)) - start;
+	_big_set(a, m, q < 0 ? -q : 0, s > 0 ? s : 0);
+	_big_set(b, 2 * d + 1, q > 0 ? q : 0, s < 0 ? -s : 0);
+
+	for (i = BIG_WORDS - 1; i >= 0; i--) {
+		if (a[i] != b[i]) {
+			return a[i] > b[i] ? 1 : -1;
+		}
+	}
+	return 0;
 }
 
-static	void _rlrshift(uint64_t *v)
+/* Returns the next decimal digit of the binary fraction "*fr". */
+static int _next_digit(uint64_t *fr)
 {
-	*v = (*v & 1) + (*v >> 1);
+	uint64_t lo = (uint64_t)(uint32_t)*fr * 10;
+	uint64_t hi = (*fr >> 32) * 10 + (lo >> 32);
+
+	*fr = (hi << 32) | (uint32_t)lo;
+	return hi >> 32;
 }
 
-/* Tiny integer divide-by-five routine.  The full 64 bit division
- * implementations in libgcc are very large on some architectures, and
- * currently nothing in Zephyr pulls it into the link.  So it makes
- * sense to define this much smaller special case here to avoid
- * including it just for printf.
+/*
+ *	_float_digits
+ *
+ *	Convert a non-zero floating point # to decimal digits, rounded.
+ *
+ *	Parameters:
+ *		"buf"		Buffer to write the digits into, holding at
+ *				least FLOAT_DIGITS_MAX characters.
+ *		"m", "e"	The # is "m" times 2 to the "e".
+ *		"ndigits"	Number of digits wanted: significant digits,
+ *				or digits after the decimal point if "fixed".
+ *		"decexp"	Returns the number of digits before the
+ *				decimal point: the # is 0.<digits> times 10 to
+ *				the "decexp".
  *
- * It works by iteratively dividing the most significant 32 bits of
- * the 64 bit value by 5.  This will leave a remainder of 0-4
- * (i.e. three significant bits), ensuring that the top 29 bits of the
- * remainder are zero for the next iteration.  Thus in the second
- * iteration only 35 significant bits remain, and in the third only
- * six.  This was tested exhaustively through the first ~10B values in
- * the input space, and for ~2e12 (4 hours runtime) random inputs
- * taken from the full 64 bit space.
+ *	Returns the number of digits written; the following ones are zeros.
  */
-static void _ldiv5(uint64_t *v)
+static int _float_digits(char *buf, uint64_t m, int e, int ndigits,
+			 bool fixed, int *decexp)
 {
-	uint32_t i, hi;
-	uint64_t rem = *v, quot = 0, q;
-	static const char shifts[] = { 32, 3, 0 };
+	uint64_t f = m, fract = 0, err = FRACT_ERROR, d;
+	int e2 = e, k, n, p, t, i, shift, cmp;
+	bool round_up;
+
+	/* normalize the mantissa */
+	if (f >> 52) {
+		f <<= 11;
+		e2 -= 11;
+	}
+	while (!(f & HIGHBIT64)) {
+		f <<= 1;
+		e2--;
+	}
+
+	/* about floor(log10(#)), from its binary exponent */
+	k = ((e2 + 63) * 1233) >> 12;
+
+	/* scale the # into [0.1, 1): multiply by 10 to the -(k + 1) */
+	i = -(k + 1);
+	if (i >> 4) {
+		_mul_pow10(&f, &e2,
+			   &_pow10_coarse[(i >> 4) - POW10_COARSE_MIN]);
+	}
+	if (i & 15) {
+		_mul_pow10(&f, &e2, &_pow10_fine[i & 15]);
+	}
+
+	/* the estimate of k may be off by one */
+	for (;;) {
+		shift = -(e2 + 64);
+		if (shift < 0) {
+			_mul_pow10(&f, &e2, &_tenth);
+			k++;
+			continue;
+		}
+
+		if (shift < 64) {
+			fract = shift ?
+				(f >> shift) + ((f >> (shift - 1)) & 1) : f;
+			if (fract >= FRACT_TENTH) {
+				break;
+			}
+		}
+
+		_mul_pow10(&f, &e2, &_ten);
+		k--;
+	}
 
-	/* Usage in this file wants rounded behavior, not truncation.  So add
-	 * two to get the threshold right.
+	*decexp = k + 1;
+
+	n = fixed ? *decexp + ndigits : ndigits;
+	if (n > FLOAT_DIGITS_MAX) {
+		n = FLOAT_DIGITS_MAX;
+	}
+	if (n < 0) {
+		/* rounds to zero */
+		return 0;
+	}
+
+	for (i = 0; i < n; i++) {
+		buf[i] = '0' + _next_digit(&fract);
+		err *= 10;
+	}
+
+	round_up = fract >= HIGHBIT64;
+
+	/*
+	 * Too close to halfway to tell from the fraction. The # is exactly
+	 * halfway between two decimal values with "p" digits after the decimal
+	 * point when 2 * 10^p times the # is an odd integer: that is
+	 * m * 5^p * 2^(e + 1 + p), so m must have exactly -(e + 1 + p)
+	 * trailing zeros. Otherwise it is compared exactly with halfway.
 	 */
-	rem += 2;
+	if ((round_up ? fract - HIGHBIT64 : HIGHBIT64 - fract) <= err) {
+		for (d = 0, i = 0; i < n; i++) {
+			d = d * 10 + (buf[i] - '0');
+		}
 
-	for (i = 0; i < 3; i++) {
-		hi = rem >> shifts[i];
-		q = (uint64_t)(hi / 5) << shifts[i];
-		rem -= q * 5;
-		quot += q;
+		p = n - *decexp;
+		t = -(e + 1 + p);
+		if (p >= 0 && t >= 0 && t < 53 &&
+		    !(m & ((1ull << t) - 1)) && ((m >> t) & 1)) {
+			cmp = 0;
+		} else {
+			cmp = _cmp_half(m, e, d, -p);
+		}
+		round_up = cmp > 0 || (cmp == 0 && (d & 1));
 	}
 
-	*v = quot;
+	if (round_up) {
+		for (i = n - 1; i >= 0 && buf[i] == '9'; i--) {
+			buf[i] = '0';
+		}
+
+		if (i >= 0) {
+			buf[i]++;
+		} else {
+			/* 99...9 became 100...0 */
+			buf[0] = '1';
+			*decexp += 1;
+			if (n == 0) {
+				n = 1;
+			}
+		}
+	}
+
+	return n;
 }
 
-static	char _get_digit(uint64_t *fr, int *digit_count)
+/* Outputs "n" times the character "c"; returns 0, or EOF on error. */
+static int _out_fill(int (*func)(), void *dest, int c, int n)
 {
-	int		rval;
-
-	if (*digit_count > 0) {
-		*digit_count -= 1;
-		*fr = *fr * 10;
-		rval = ((*fr >> 60) & 0xF) + '0';
-		*fr &= 0x0FFFFFFFFFFFFFFFull;
-	} else
-		rval = '0';
-	return (char) (rval);
+	for (; n > 0; n--) {
+		if ((*func)(c, dest) == EOF) {
+			return EOF;
+		}
+	}
+	return 0;
+}
+
+/* Outputs "n" characters of "s"; returns 0, or EOF on error. */
+static int _out_str(int (*func)(), void *dest, const char *s, int n)
+{
+	for (; n > 0; n--, s++) {
+		if ((*func)(*s, dest) == EOF) {
+			return EOF;
+		}
+	}
+	return 0;
 }
 
 /*
- *	_to_float
+ *	_out_field
+ *
+ *	Output a conversion: "prefix" (sign or radix prefix), "zeros" leading
+ *	zeros, then "body", justified in a field of "width" characters.
+ *	Padding zeros go between the prefix and the body.
  *
- *	Convert a floating point # to ASCII.
+ *	Returns the number of characters output, or EOF on error.
+ */
+static int _out_field(int (*func)(), void *dest,
+		      const char *prefix, int prefix_len, int zeros,
+		      const char *body, int body_len,
+		      int width, int fminus, char pad)
+{
+	int len = prefix_len + zeros + body_len;
+	int fill = width > len ? width - len : 0;
+
+	if (!fminus && pad == ' ' && _out_fill(func, dest, ' ', fill) == EOF) {
+		return EOF;
+	}
+	if (_out_str(func, dest, prefix, prefix_len) == EOF) {
+		return EOF;
+	}
+	if (!fminus && pad == '0') {
+		zeros += fill;
+	}
+	if (_out_fill(func, dest, '0', zeros) == EOF ||
+	    _out_str(func, dest, body, body_len) == EOF) {
+		return EOF;
+	}
+	if (fminus && _out_fill(func, dest, ' ', fill) == EOF) {
+		return EOF;
+	}
+	return len + fill;
+}
+
+#define PUT(c) \
+	do { \
+		if ((*func)((c), dest) == EOF) { \
+			return EOF; \
+		} \
+	} while (0)
+
+/* digit "i" of a converted #, leading and trailing zeros included */
+#define DIGIT(i) ((i) >= 0 && (i) < nd ? digits[i] : '0')
+
+/*
+ *	_prf_float
+ *
+ *	Output a floating point # (IEEE double).
  *
  *	Parameters:
- *		"buf"		Buffer to write result into.
- *		"double_temp"	# to convert (either IEEE single or double).
+ *		"double_temp"	# to convert.
  *		"c"		The conversion type (one of e,E,f,g,G).
  *		"falt"		TRUE if "#" conversion flag in effect.
  *		"fplus"		TRUE if "+" conversion flag in effect.
  *		"fspace"	TRUE if " " conversion flag in effect.
+ *		"fminus"	TRUE if "-" conversion flag in effect.
+ *		"pad"		Padding character, '0' or ' '.
+ *		"width"		Minimum field width.
  *		"precision"	Desired precision (negative if undefined).
+ *
+ *	Returns the number of characters output, or EOF on error.
  */
-
-/*
- *	The following two constants define the simulated binary floating
- *	point limit for the first stage of the conversion (fraction times
- *	power of two becomes fraction times power of 10), and the second
- *	stage (pulling the resulting decimal digits outs).
- */
-
-#define	MAXFP1	0xFFFFFFFF	/* Largest # if first fp format */
-#define HIGHBIT64 (1ull<<63)
-
-static int _to_float(char *buf, uint64_t double_temp, int c,
-					 int falt, int fplus, int fspace, int precision)
+static int _prf_float(int (*func)(), void *dest, uint64_t double_temp, int c,
+		      int falt, int fplus, int fspace, int fminus, char pad,
+		      int width, int precision)
 {
-	register int    decexp;
-	register int    exp;
-	int             sign;
-	int             digit_count;
-	uint64_t        fract;
-	uint64_t        ltemp;
-	int             prune_zero;
-	char           *start = buf;
-
-	exp = double_temp >> 52 & 0x7ff;
-	fract = (double_temp << 11) & ~HIGHBIT64;
-	sign = !!(double_temp & HIGHBIT64);
-
+	char digits[FLOAT_DIGITS_MAX];
+	char sign = 0;
+	uint64_t m = double_temp & ((1ull << 52) - 1);
+	int exp = (double_temp >> 52) & 0x7ff;
+	int nd = 0, decexp = 1;
+	int dot, len, fill, i;
 
 	if (exp == 0x7ff) {
-		if (!fract) {
-			*buf++ = sign ? '-' : '+';
-			*buf++ = 'I';
-			*buf++ = 'N';
-			*buf++ = 'F';
-		} else {
-			*buf++ = 'N';
-			*buf++ = 'a';
-			*buf++ = 'N';
+		if (m) {
+			return _out_field(func, dest, NULL, 0, 0, "NaN", 3,
+					  width, fminus, ' ');
 		}
-		*buf = 0;
-		return buf - start;
+		return _out_field(func, dest, NULL, 0, 0,
+				  (double_temp & HIGHBIT64) ? "-INF" : "+INF",
+				  4, width, fminus, ' ');
 	}
 
-	if ((exp | fract) != 0) {
-		exp -= (1023 - 1);	/* +1 since .1 vs 1. */
-		fract |= HIGHBIT64;
-		decexp = true;		/* Wasn't zero */
-	} else
-		decexp = false;		/* It was zero */
-
-	if (decexp && sign) {
-		*buf++ = '-';
+	if (double_temp & HIGHBIT64) {
+		sign = '-';
 	} else if (fplus) {
-		*buf++ = '+';
+		sign = '+';
 	} else if (fspace) {
-		*buf++ = ' ';
+		sign = ' ';
 	}
 
-	decexp = 0;
-	while (exp <= -3) {
-		while ((fract >> 32) >= (MAXFP1 / 5)) {
-			_rlrshift(&fract);
-			exp++;
-		}
-		fract *= 5;
-		exp++;
-		decexp--;
-
-		while ((fract >> 32) <= (MAXFP1 / 2)) {
-			fract <<= 1;
-			exp--;
-		}
-	}
-
-	while (exp > 0) {
-		_ldiv5(&fract);
-		exp--;
-		decexp++;
-		while ((fract >> 32) <= (MAXFP1 / 2)) {
-			fract <<= 1;
-			exp--;
-		}
+	if (exp) {
+		m |= 1ull << 52;
+		exp -= 1075;
+	} else {
+		exp = -1074;
 	}
 
-	while (exp < (0 + 4)) {
-		_rlrshift(&fract);
-		exp++;
+	if (precision < 0) {
+		precision = 6;		/* Default precision if none given */
 	}
 
-	if (precision < 0)
-		precision = 6;		/* Default precision if none given */
-	prune_zero = false;		/* Assume trailing 0's allowed     */
 	if ((c == 'g') || (c == 'G')) {
-		if (!falt && (precision > 0))
-			prune_zero = true;
-		if ((decexp < (-4 + 1)) || (decexp > (precision + 1))) {
-			if (c == 'g')
-				c = 'e';
-			else
-				c = 'E';
-		} else
+		int p = precision ? precision : 1;
+
+		if (m) {
+			nd = _float_digits(digits, m, exp, p, false, &decexp);
+		}
+
+		/* %e if the exponent is less than -4 or at least p */
+		if ((decexp - 1 < -4) || (decexp - 1 >= p)) {
+			c = (c == 'g') ? 'e' : 'E';
+			precision = p - 1;
+		} else {
 			c = 'f';
+			precision = p - decexp;
+		}
+
+		if (!falt) {
+			/* prune the trailing zeros */
+			while (nd > 0 && digits[nd - 1] == '0') {
+				nd--;
+			}
+			i = (c == 'f') ? nd - decexp : nd - 1;
+			precision = i > 0 ? i : 0;
+		}
+	} else if (m) {
+		nd = _float_digits(digits, m, exp,
+				   (c == 'f') ? precision : precision + 1,
+				   c == 'f', &decexp);
 	}
 
+	dot = falt || (precision > 0);
 	if (c == 'f') {
-		exp = precision + decexp;
-		if (exp < 0)
-			exp = 0;
-	} else
-		exp = precision + 1;
-	digit_count = 16;
-	if (exp > 16)
-		exp = 16;
-
-	ltemp = 0x0800000000000000;
-	while (exp--) {
-		_ldiv5(&ltemp);
-		_rlrshift(&ltemp);
+		len = (decexp > 0 ? decexp : 1) + dot + precision;
+	} else {
+		len = 1 + dot + precision + 5;
 	}
+	len += (sign != 0);
+	fill = width > len ? width - len : 0;
 
-	fract += ltemp;
-	if ((fract >> 32) & 0xF0000000) {
-		_ldiv5(&fract);
-		_rlrshift(&fract);
-		decexp++;
+	if (!fminus && pad == ' ' && _out_fill(func, dest, ' ', fill) == EOF) {
+		return EOF;
+	}
+	if (sign) {
+		PUT(sign);
+	}
+	if (!fminus && pad == '0' && _out_fill(func, dest, '0', fill) == EOF) {
+		return EOF;
 	}
 
 	if (c == 'f') {
 		if (decexp > 0) {
-			while (decexp > 0) {
-				*buf++ = _get_digit(&fract, &digit_count);
-				decexp--;
+			for (i = 0; i < decexp; i++) {
+				PUT(DIGIT(i));
 			}
-		} else
-			*buf++ = '0';
-		if (falt || (precision > 0))
-			*buf++ = '.';
-		while (precision-- > 0) {
-			if (decexp < 0) {
-				*buf++ = '0';
-				decexp++;
-			} else
-				*buf++ = _get_digit(&fract, &digit_count);
+		} else {
+			PUT('0');
+		}
+		if (dot) {
+			PUT('.');
+		}
+		for (i = 0; i < precision; i++) {
+			PUT(DIGIT(decexp + i));
 		}
 	} else {
-		*buf = _get_digit(&fract, &digit_count);
-		if (*buf++ != '0')
-			decexp--;
-		if (falt || (precision > 0))
-			*buf++ = '.';
-		while (precision-- > 0)
-			*buf++ = _get_digit(&fract, &digit_count);
-	}
-
-	if (prune_zero) {
-		while (*--buf == '0')
-			;
-		if (*buf != '.')
-			buf++;
-	}
-
-	if ((c == 'e') || (c == 'E')) {
-		*buf++ = (char) c;
-		if (decexp < 0) {
-			decexp = -decexp;
-			*buf++ = '-';
-		} else
-			*buf++ = '+';
-		*buf++ = (char) ((decexp / 100) + '0');
-		decexp %= 100;
-		*buf++ = (char) ((decexp / 10) + '0');
-		decexp %= 10;
-		*buf++ = (char) (decexp + '0');
-	}
-	*buf = 0;
-
-	return buf - start;
+		PUT(DIGIT(0));
+		if (dot) {
+			PUT('.');
+		}
+		for (i = 1; i <= precision; i++) {
+			PUT(DIGIT(i));
+		}
+
+		exp = decexp - 1;
+		PUT(c);
+		if (exp < 0) {
+			exp = -exp;
+			PUT('-');
+		} else {
+			PUT('+');
+		}
+		PUT('0' + exp / 100);
+		PUT('0' + exp / 10 % 10);
+		PUT('0' + exp % 10);
+	}
+
+	if (fminus && _out_fill(func, dest, ' ', fill) == EOF) {
+		return EOF;
+	}
+
+	return len + fill;
 }
 
 static int _atoi(char **sptr)
@@ -402,12 +637,11 @@ static int _atoi(char **sptr)
 int _prf(int (*func)(), void *dest, char *format, va_list vargs)
 {
 	/*
-	 * Due the fact that buffer is passed to functions in this file,
-	 * they assume that it's size if MAXFLD + 1. In need of change
-	 * the buffer size, either MAXFLD should be changed or the change
-	 * has to be propagated across the file
+	 * Digits of integer conversions are written backwards from the end
+	 * of the buffer; padding and precision zeros are output directly.
 	 */
-	char			buf[MAXFLD + 1];
+	char			buf[12];
+	char			*end = buf + sizeof(buf);
 	register int	c;
 	int				count;
 	register char	*cptr;
@@ -416,11 +650,13 @@ int _prf(int (*func)(), void *dest, char *format, va_list vargs)
 	int				fplus;
 	int				fspace;
 	register int	i;
-	int				need_justifying;
+	int				is_integer;
+	int				len;
 	char			pad;
 	int				precision;
-	int				prefix;
+	const char		*prefix;
 	int				width;
+	int				zeros;
 	char			*cptr_temp;
 	int32_t			*int32ptr_temp;
 	int32_t			int32_temp;
@@ -544,25 +780,32 @@ int _prf(int (*func)(), void *dest, char *format, va_list vargs)
 				}
 			}
 
-			need_justifying = false;
-			prefix = 0;
+			is_integer = false;
+			prefix = NULL;
+			len = 0;
+			uint32_temp = 0;
 			switch (c) {
 			case 'c':
 				buf[0] = (char) ((int32_t) va_arg(vargs, int32_t));
-				buf[1] = '\0';
-				need_justifying = true;
-				c = 1;
+				len = _out_field(func, dest, NULL, 0, 0, buf, 1,
+						 width, fminus, pad);
 				break;
 
 			case 'd':
 			case 'i':
 				int32_temp = (int32_t) va_arg(vargs, int32_t);
-				c = _to_dec(buf, int32_temp, fplus, fspace, precision);
-				if (fplus || fspace || (int32_temp < 0))
-					prefix = 1;
-				need_justifying = true;
-				if (precision != -1)
-					pad = ' ';
+				if (int32_temp < 0) {
+					prefix = "-";
+					uint32_temp = -(uint32_t) int32_temp;
+				} else {
+					if (fplus)
+						prefix = "+";
+					else if (fspace)
+						prefix = " ";
+					uint32_temp = int32_temp;
+				}
+				cptr = _utoa_dec(end, uint32_temp);
+				is_integer = true;
 				break;
 
 			case 'e':
@@ -581,11 +824,9 @@ int _prf(int (*func)(), void *dest, char *format, va_list vargs)
 				double_temp = u.i;
 			}
 
-				c = _to_float(buf, double_temp, c, falt, fplus,
-					      fspace, precision);
-				if (fplus || fspace || (buf[0] == '-'))
-					prefix = 1;
-				need_justifying = true;
+				len = _prf_float(func, dest, double_temp, c, falt,
+						 fplus, fspace, fminus, pad, width,
+						 precision);
 				break;
 
 			case 'n':
@@ -595,53 +836,46 @@ int _prf(int (*func)(), void *dest, char *format, va_list vargs)
 
 			case 'o':
 				uint32_temp = (uint32_t) va_arg(vargs, uint32_t);
-				c = _to_octal(buf, uint32_temp, falt, precision);
-				need_justifying = true;
-				if (precision != -1)
-					pad = ' ';
+				cptr = _utoa_pow2(end, uint32_temp, 3, _hex_lower);
+				is_integer = true;
 				break;
 
 			case 'p':
 				uint32_temp = (uint32_t) va_arg(vargs, uint32_t);
-				c = _to_hex(buf, uint32_temp, true, 8, (int) 'x');
-				need_justifying = true;
-				if (precision != -1)
-					pad = ' ';
+				cptr = _utoa_pow2(end, uint32_temp, 4, _hex_lower);
+				prefix = "0x";
+				precision = 8;
+				is_integer = true;
 				break;
 
 			case 's':
 				cptr_temp = (char *) va_arg(vargs, char *);
 				/* Get the string length */
-				for (c = 0; c < MAXFLD; c++) {
+				i = ((precision >= 0) && (precision < MAXFLD)) ?
+					precision : MAXFLD;
+				for (c = 0; c < i; c++) {
 					if (cptr_temp[c] == '\0') {
 						break;
 					}
 				}
-				if ((precision >= 0) && (precision < c))
-					c = precision;
-				if (c > 0) {
-					memcpy(buf, cptr_temp, (size_t) c);
-					need_justifying = true;
-				}
+				len = _out_field(func, dest, NULL, 0, 0, cptr_temp,
+						 c, width, fminus, pad);
 				break;
 
 			case 'u':
 				uint32_temp = (uint32_t) va_arg(vargs, uint32_t);
-				c = _to_udec(buf, uint32_temp, precision);
-				need_justifying = true;
-				if (precision != -1)
-					pad = ' ';
+				cptr = _utoa_dec(end, uint32_temp);
+				is_integer = true;
 				break;
 
 			case 'x':
 			case 'X':
 				uint32_temp = (uint32_t) va_arg(vargs, uint32_t);
-				c = _to_hex(buf, uint32_temp, falt, precision, c);
-				if (falt)
-					prefix = 2;
-				need_justifying = true;
-				if (precision != -1)
-					pad = ' ';
+				cptr = _utoa_pow2(end, uint32_temp, 4,
+						  c == 'x' ? _hex_lower : _hex_upper);
+				if (falt && uint32_temp)
+					prefix = (c == 'x') ? "0x" : "0X";
+				is_integer = true;
 				break;
 
 			case '%':
@@ -656,33 +890,31 @@ int _prf(int (*func)(), void *dest, char *format, va_list vargs)
 				return count;
 			}
 
-			if (c >= MAXFLD + 1)
-				return EOF;
-
-			if (need_justifying) {
-				if (c < width) {
-					if (fminus)	{
-						/* Left justify? */
-						for (i = c; i < width; i++)
-							buf[i] = ' ';
-					} else {
-						/* Right justify */
-						(void) memmove((buf + (width - c)), buf, (size_t) (c
-										+ 1));
-						if (pad == ' ')
-							prefix = 0;
-						c = width - c + prefix;
-						for (i = prefix; i < c; i++)
-							buf[i] = pad;
+			if (is_integer) {
+				zeros = 0;
+				if (precision >= 0) {
+					pad = ' ';
+					if (precision == 0 && uint32_temp == 0) {
+						/* no digits at all */
+						cptr = end;
 					}
-					c = width;
+					zeros = precision - (end - cptr);
+					if (zeros < 0)
+						zeros = 0;
 				}
-
-				for (cptr = buf; c > 0; c--, cptr++, count++) {
-					if ((*func)(*cptr, dest) == EOF)
-						return EOF;
+				if (c == 'o' && falt && zeros == 0 &&
+				    (cptr == end || *cptr != '0')) {
+					/* octal numbers start with a 0 */
+					zeros = 1;
 				}
+				len = _out_field(func, dest, prefix,
+						 prefix ? strlen(prefix) : 0, zeros,
+						 cptr, end - cptr, width, fminus, pad);
 			}
+
+			if (len == EOF)
+				return EOF;
+			count += len;
 		}
 	}
 	return count;
@@ -17,6 +17,7 @@
  */
 
 #include <string.h>
+#include <stdint.h>
 
 /**
  *
@@ -180,87 +181,273 @@ int memcmp(const void *m1, const void *m2, size_t n)
 	return *c1 - *c2;
 }
 
-/**
+/*
+ * Word-oriented helpers for memcpy(), memmove() and memset().
  *
- * @brief Copy bytes in memory with overlapping areas
+ * Copies are done a word at a time once the destination is word-aligned. If
+ * the source then has the same alignment, the words are copied as is, with
+ * the fastest block copy available on the architecture. Otherwise each
+ * destination word is merged from two aligned source words with shifts, so
+ * that misaligned buffers do not fall back to byte copies.
  *
- * @return pointer to destination buffer <d>
+ * The merge reads the whole aligned words that contain the source bytes, and
+ * can thus read up to three bytes before or after the source buffer, but never
+ * outside of the words the buffer occupies. AddressSanitizer reports these
+ * reads, so sanitized builds copy misaligned buffers a byte at a time instead.
  */
 
-void *memmove(void *d, const void *s, size_t n)
+typedef unsigned int mem_word_t;
+
+#define WORD_SIZE sizeof(mem_word_t)
+#define WORD_MASK (WORD_SIZE - 1)
+#define WORD_BITS (8 * WORD_SIZE)
+
+/* number of bytes to copy before switching to word copies */
+#define SHORT_COPY_SIZE (2 * WORD_SIZE)
+
+#if defined(__SANITIZE_ADDRESS__)
+#define MERGE_COPIES 0
+#else
+#define MERGE_COPIES 1
+#endif
+
+/* true if word copies can be used between <d> and <s> */
+#define CAN_COPY_WORDS(d, s) \
+	(MERGE_COPIES || ((((uintptr_t)(d) - (uintptr_t)(s)) & WORD_MASK) == 0))
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define MERGE_WORDS(lo, hi, shift) \
+	(((lo) << (shift)) | ((hi) >> (WORD_BITS - (shift))))
+#else
+#define MERGE_WORDS(lo, hi, shift) \
+	(((lo) >> (shift)) | ((hi) << (WORD_BITS - (shift))))
+#endif
+
+/*
+ * Copy aligned words forward. Source words are always read before the
+ * destination words that could overlap them are written, so this can be used
+ * by memmove() when the destination is below the source.
+ */
+static inline void copy_words_forward(mem_word_t *d, const mem_word_t *s,
+				      size_t nwords)
 {
-	char *dest = d;
-	const char *src  = s;
+#if defined(CONFIG_X86)
+	__asm__ volatile("cld\n\t"
+			 "rep movsl"
+			 : "+D" (d), "+S" (s), "+c" (nwords)
+			 :
+			 : "memory");
+#else
+#if defined(CONFIG_ARM)
+	while (nwords >= 4) {
+		__asm__ volatile("ldmia %1!, {r3-r6}\n\t"
+				 "stmia %0!, {r3-r6}"
+				 : "+r" (d), "+r" (s)
+				 :
+				 : "r3", "r4", "r5", "r6", "memory");
+		nwords -= 4;
+	}
+#else
+	mem_word_t w0, w1, w2, w3;
+
+	while (nwords >= 4) {
+		w0 = s[0];
+		w1 = s[1];
+		w2 = s[2];
+		w3 = s[3];
+		d[0] = w0;
+		d[1] = w1;
+		d[2] = w2;
+		d[3] = w3;
+		d += 4;
+		s += 4;
+		nwords -= 4;
+	}
+#endif /* CONFIG_ARM */
 
-	if ((size_t) (d - s) < n) {
-		/*
-		 * The <src> buffer overlaps with the start of the <dest> buffer.
-		 * Copy backwards to prevent the premature corruption of <src>.
-		 */
+	while (nwords > 0) {
+		*(d++) = *(s++);
+		nwords--;
+	}
+#endif /* CONFIG_X86 */
+}
+
+/* copy aligned words backward, for memmove() when <d> is above <s> */
+static inline void copy_words_backward(mem_word_t *d_end,
+				       const mem_word_t *s_end, size_t nwords)
+{
+	mem_word_t w0, w1, w2, w3;
+
+	while (nwords >= 4) {
+		w0 = s_end[-1];
+		w1 = s_end[-2];
+		w2 = s_end[-3];
+		w3 = s_end[-4];
+		d_end[-1] = w0;
+		d_end[-2] = w1;
+		d_end[-3] = w2;
+		d_end[-4] = w3;
+		d_end -= 4;
+		s_end -= 4;
+		nwords -= 4;
+	}
+
+	while (nwords > 0) {
+		*(--d_end) = *(--s_end);
+		nwords--;
+	}
+}
 
-		while (n > 0) {
+/*
+ * Copy <n> bytes forward. Safe for overlapping buffers if <d> is below <s>.
+ */
+static void copy_forward(unsigned char *d_byte, const unsigned char *s_byte,
+			 size_t n)
+{
+	if (n >= SHORT_COPY_SIZE && CAN_COPY_WORDS(d_byte, s_byte)) {
+		mem_word_t *d_word;
+		const mem_word_t *s_word;
+		size_t nwords;
+		unsigned int shift;
+
+		/* do byte-sized copying until the destination is aligned */
+
+		while ((uintptr_t)d_byte & WORD_MASK) {
+			*(d_byte++) = *(s_byte++);
 			n--;
-			dest[n] = src[n];
 		}
-	} else {
-		/* It is safe to perform a forward-copy */
-		while (n > 0) {
-			*dest = *src;
-			dest++;
-			src++;
-			n--;
+
+		d_word = (mem_word_t *)d_byte;
+		nwords = n / WORD_SIZE;
+		shift = ((uintptr_t)s_byte & WORD_MASK) * 8;
+
+		if (shift == 0) {
+			copy_words_forward(d_word, (const mem_word_t *)s_byte,
+					   nwords);
+		} else {
+			/* merge each destination word from two source words */
+
+			mem_word_t lo, hi;
+
+			s_word = (const mem_word_t *)((uintptr_t)s_byte &
+						      ~(uintptr_t)WORD_MASK);
+			lo = *(s_word++);
+
+			while (nwords > 0) {
+				hi = *(s_word++);
+				*(d_word++) = MERGE_WORDS(lo, hi, shift);
+				lo = hi;
+				nwords--;
+			}
 		}
+
+		d_byte += n & ~WORD_MASK;
+		s_byte += n & ~WORD_MASK;
+		n &= WORD_MASK;
 	}
 
-	return d;
+	/* do byte-sized copying until finished */
+
+	while (n > 0) {
+		*(d_byte++) = *(s_byte++);
+		n--;
+	}
 }
 
-/**
- *
- * @brief Copy bytes in memory
- *
- * @return pointer to start of destination buffer
+/*
+ * Copy <n> bytes backward, from the end of the buffers. Safe for overlapping
+ * buffers if <d> is above <s>.
  */
-
-void *memcpy(void *_Restrict d, const void *_Restrict s, size_t n)
+static void copy_backward(unsigned char *d_end, const unsigned char *s_end,
+			  size_t n)
 {
-	/* attempt word-sized copying only if buffers have identical alignment */
+	if (n >= SHORT_COPY_SIZE && CAN_COPY_WORDS(d_end, s_end)) {
+		mem_word_t *d_word;
+		const mem_word_t *s_word;
+		size_t nwords;
+		unsigned int shift;
 
-	unsigned char *d_byte = (unsigned char *)d;
-	const unsigned char *s_byte = (const unsigned char *)s;
+		/* do byte-sized copying until the destination end is aligned */
 
-	if ((((unsigned int)d ^ (unsigned int)s_byte) & 0x3) == 0) {
+		while ((uintptr_t)d_end & WORD_MASK) {
+			*(--d_end) = *(--s_end);
+			n--;
+		}
 
-		/* do byte-sized copying until word-aligned or finished */
+		d_word = (mem_word_t *)d_end;
+		nwords = n / WORD_SIZE;
+		shift = ((uintptr_t)s_end & WORD_MASK) * 8;
 
-		while (((unsigned int)d_byte) & 0x3) {
-			if (n == 0) {
-				return d;
-			}
-			*(d_byte++) = *(s_byte++);
-			n--;
-		};
+		if (shift == 0) {
+			copy_words_backward(d_word, (const mem_word_t *)s_end,
+					    nwords);
+		} else {
+			/* merge each destination word from two source words */
 
-		/* do word-sized copying as long as possible */
+			mem_word_t lo, hi;
 
-		unsigned int *d_word = (unsigned int *)d_byte;
-		const unsigned int *s_word = (const unsigned int *)s_byte;
+			s_word = (const mem_word_t *)((uintptr_t)s_end &
+						      ~(uintptr_t)WORD_MASK);
+			hi = *s_word;
 
-		while (n >= sizeof(unsigned int)) {
-			*(d_word++) = *(s_word++);
-			n -= sizeof(unsigned int);
+			while (nwords > 0) {
+				lo = *(--s_word);
+				*(--d_word) = MERGE_WORDS(lo, hi, shift);
+				hi = lo;
+				nwords--;
+			}
 		}
 
-		d_byte = (unsigned char *)d_word;
-		s_byte = (unsigned char *)s_word;
+		d_end -= n & ~WORD_MASK;
+		s_end -= n & ~WORD_MASK;
+		n &= WORD_MASK;
 	}
 
 	/* do byte-sized copying until finished */
 
 	while (n > 0) {
-		*(d_byte++) = *(s_byte++);
+		*(--d_end) = *(--s_end);
 		n--;
 	}
+}
+
+/**
+ *
+ * @brief Copy bytes in memory with overlapping areas
+ *
+ * @return pointer to destination buffer <d>
+ */
+
+void *memmove(void *d, const void *s, size_t n)
+{
+	unsigned char *dest = d;
+	const unsigned char *src = s;
+
+	if ((size_t) (dest - src) < n) {
+		/*
+		 * The <src> buffer overlaps with the start of the <dest> buffer.
+		 * Copy backwards to prevent the premature corruption of <src>.
+		 */
+
+		copy_backward(dest + n, src + n, n);
+	} else {
+		/* It is safe to perform a forward-copy */
+		copy_forward(dest, src, n);
+	}
+
+	return d;
+}
+
+/**
+ *
+ * @brief Copy bytes in memory
+ *
+ * @return pointer to start of destination buffer
+ */
+
+void *memcpy(void *_Restrict d, const void *_Restrict s, size_t n)
+{
+	copy_forward(d, s, n);
 
 	return d;
 }
@@ -274,36 +461,57 @@ void *memcpy(void *_Restrict d, const void *_Restrict s, size_t n)
 
 void *memset(void *buf, int c, size_t n)
 {
-	/* do byte-sized initialization until word-aligned or finished */
-
 	unsigned char *d_byte = (unsigned char *)buf;
 	unsigned char c_byte = (unsigned char)c;
 
-	while (((unsigned int)d_byte) & 0x3) {
-		if (n == 0) {
-			return buf;
-		}
-		*(d_byte++) = c_byte;
-		n--;
-	};
+	if (n >= SHORT_COPY_SIZE) {
+		mem_word_t *d_word;
+		mem_word_t c_word = (mem_word_t)c_byte;
+		size_t nwords;
 
-	/* do word-sized initialization as long as possible */
+		/* do byte-sized initialization until word-aligned */
 
-	unsigned int *d_word = (unsigned int *)d_byte;
-	unsigned int c_word = (unsigned int)(unsigned char)c;
+		while ((uintptr_t)d_byte & WORD_MASK) {
+			*(d_byte++) = c_byte;
+			n--;
+		}
+
+		/* do word-sized initialization as long as possible */
+
+		d_word = (mem_word_t *)d_byte;
+		nwords = n / WORD_SIZE;
+
+		c_word |= c_word << 8;
+		c_word |= c_word << 16;
+
+#if defined(CONFIG_X86)
+		__asm__ volatile("cld\n\t"
+				 "rep stosl"
+				 : "+D" (d_word), "+c" (nwords)
+				 : "a" (c_word)
+				 : "memory");
+#else
+		while (nwords >= 4) {
+			d_word[0] = c_word;
+			d_word[1] = c_word;
+			d_word[2] = c_word;
+			d_word[3] = c_word;
+			d_word += 4;
+			nwords -= 4;
+		}
 
-	c_word |= c_word << 8;
-	c_word |= c_word << 16;
+		while (nwords > 0) {
+			*(d_word++) = c_word;
+			nwords--;
+		}
+#endif
 
-	while (n >= sizeof(unsigned int)) {
-		*(d_word++) = c_word;
-		n -= sizeof(unsigned int);
+		d_byte += n & ~WORD_MASK;
+		n &= WORD_MASK;
 	}
 
 	/* do byte-sized initialization until finished */
 
-	d_byte = (unsigned char *)d_word;
-
 	while (n > 0) {
 		*(d_byte++) = c_byte;
 		n--;
@@ -24,12 +24,18 @@
 
 #include <misc/printk.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <toolchain.h>
 #include <sections.h>
 
 static void _printk_dec_ulong(const unsigned long num);
 static void _printk_hex_ulong(const unsigned long num);
 
+#ifdef CONFIG_PRINTK_DEFERRED
+extern void _printk_deferred_put(const char *fmt, va_list ap);
+extern void _printk_deferred_flush(void);
+#endif
+
 /**
  * @brief Default character output routine that does nothing
  * @param c Character to swallow
@@ -61,16 +67,69 @@ void __printk_hook_install(int (*fn)(int))
 	_char_out = fn;
 }
 
+static void _nop_flush(void)
+{
+	/* do nothing */
+}
+
+static void (*_char_out_flush)(void) = _nop_flush;
+
+/**
+ * @brief Install the output flush routine for printk
+ *
+ * To be called by console drivers that buffer their output. The routine must
+ * send the buffered output synchronously, and not buffer any further output.
+ * @param fn flush routine to install
+ *
+ * @return N/A
+ */
+void __printk_flush_hook_install(void (*fn)(void))
+{
+	_char_out_flush = fn;
+}
+
+void printk_flush(void)
+{
+#ifdef CONFIG_PRINTK_DEFERRED
+	_printk_deferred_flush();
+#endif
+	_char_out_flush();
+}
+
+/*
+ * Source of the printk() arguments: either a variable argument list, or an
+ * array of words captured by a deferred printk().
+ */
+struct _printk_args {
+	const uint32_t *words;
+	int num_words;
+	va_list ap;
+};
+
+#define _PRINTK_ARG(args, type)                                        \
+	((args)->words ? (type)(uintptr_t)_printk_next_word(args)      \
+		       : va_arg((args)->ap, type))
+
+static inline uint32_t _printk_next_word(struct _printk_args *args)
+{
+	if (args->num_words == 0) {
+		return 0;
+	}
+
+	args->num_words--;
+	return *(args->words++);
+}
+
 /**
  * @brief Printk internals
  *
  * See printk() for description.
  * @param fmt Format string
- * @param ap Variable parameters
+ * @param args Arguments
  *
  * @return N/A
  */
-static inline void _vprintk(const char *fmt, va_list ap)
+static inline void _vprintk(const char *fmt, struct _printk_args *args)
 {
 	int might_format = 0; /* 1 if encountered a '%' */
 
@@ -92,7 +151,7 @@ static inline void _vprintk(const char *fmt, va_list ap)
 				goto still_might_format;
 			case 'd':
 			case 'i': {
-				long d = va_arg(ap, long);
+				long d = _PRINTK_ARG(args, long);
 
 				if (d < 0) {
 					_char_out((int)'-');
@@ -102,8 +161,8 @@ static inline void _vprintk(const char *fmt, va_list ap)
 				break;
 			}
 			case 'u': {
-				unsigned long u = va_arg(
-					ap, unsigned long);
+				unsigned long u = _PRINTK_ARG(
+					args, unsigned long);
 				_printk_dec_ulong(u);
 				break;
 			}
@@ -113,20 +172,20 @@ static inline void _vprintk(const char *fmt, va_list ap)
 				  /* Fall through */
 			case 'x':
 			case 'X': {
-				unsigned long x = va_arg(
-					ap, unsigned long);
+				unsigned long x = _PRINTK_ARG(
+					args, unsigned long);
 				_printk_hex_ulong(x);
 				break;
 			}
 			case 's': {
-				char *s = va_arg(ap, char *);
+				char *s = _PRINTK_ARG(args, char *);
 
 				while (*s)
 					_char_out((int)(*s++));
 				break;
 			}
 			case 'c': {
-				int c = va_arg(ap, int);
+				int c = _PRINTK_ARG(args, int);
 
 				_char_out(c);
 				break;
@@ -147,6 +206,27 @@ still_might_format:
 	}
 }
 
+#ifdef CONFIG_PRINTK_DEFERRED
+/**
+ * @brief Output a message captured by a deferred printk()
+ *
+ * @param fmt Format string
+ * @param words Arguments, one word each; strings are pointers
+ * @param num_words Number of words in @a words
+ *
+ * @return N/A
+ */
+void _printk_words(const char *fmt, const uint32_t *words, int num_words)
+{
+	struct _printk_args args = {
+		.words = words,
+		.num_words = num_words,
+	};
+
+	_vprintk(fmt, &args);
+}
+#endif /* CONFIG_PRINTK_DEFERRED */
+
 /**
  * @brief Output a string
  *
@@ -167,11 +247,15 @@ still_might_format:
  */
 void printk(const char *fmt, ...)
 {
-	va_list ap;
+	struct _printk_args args = { .num_words = 0 };
 
-	va_start(ap, fmt);
-	_vprintk(fmt, ap);
-	va_end(ap);
+	va_start(args.ap, fmt);
+#ifdef CONFIG_PRINTK_DEFERRED
+	_printk_deferred_put(fmt, args.ap);
+#else
+	_vprintk(fmt, &args);
+#endif
+	va_end(args.ap);
 }
 
 /**
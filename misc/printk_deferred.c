@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Deferred printk() output
+ *
+ * printk() records its format string pointer and its raw arguments in a
+ * power-of-two ring buffer of 32-bit words, and returns without formatting
+ * anything. A thread at the lowest application priority later formats the
+ * messages to the console, or sends the records as they are, to be decoded
+ * on the host by scripts/log_decode.py.
+ *
+ * Writers reserve the space of their record with a compare-and-swap on the
+ * head index and never lock interrupts; the header word is written last and
+ * marks the record as complete. This is the same scheme as the kernel trace
+ * stream. When the buffer is full, messages are dropped and counted.
+ *
+ * Each record is made of little-endian words:
+ *
+ * - a header word: the record type in bits 0-7, the length of the record in
+ *   words, header included, in bits 8-15, and a type-specific argument in
+ *   bits 16-31;
+ * - the hardware cycle count when the record was written;
+ * - the record data.
+ *
+ * For a message, the header argument holds the number of argument words in
+ * bits 16-23, and in bits 24-31 a mask of the arguments that are strings
+ * copied in the record. The data is the format string pointer, the argument
+ * words, then the copied strings, NUL-terminated and padded to a word. Strings
+ * that are part of the read-only image are recorded as pointers; the others,
+ * which could be gone by the time the message is output, are copied, up to
+ * CONFIG_PRINTK_DEFERRED_STRING_BYTES bytes per message. The word of a copied
+ * string argument is its byte offset from the start of the copied strings.
+ */
+
+#include <kernel.h>
+#include <atomic.h>
+#include <misc/printk.h>
+#include <misc/util.h>
+#include <linker-defs.h>
+#include <stdarg.h>
+
+#define LOG_MESSAGE      0x01
+#define LOG_DROPPED      0xfe
+#define LOG_STREAM_START 0xff
+
+/* "ZLOG": identifies a binary log stream or a log buffer RAM dump */
+#define LOG_MAGIC 0x474f4c5a
+
+#define LOG_HDR(type, len, arg) \
+	((uint32_t)(type) | ((uint32_t)(len) << 8) | ((uint32_t)(arg) << 16))
+#define LOG_HDR_LEN(hdr) (((hdr) >> 8) & 0xff)
+#define LOG_HDR_ARG(hdr) ((hdr) >> 16)
+
+#define LOG_BUF_SIZE CONFIG_PRINTK_DEFERRED_BUFFER_SIZE
+#define LOG_BUF_MASK (LOG_BUF_SIZE - 1)
+
+#if (LOG_BUF_SIZE & LOG_BUF_MASK) != 0
+#error "CONFIG_PRINTK_DEFERRED_BUFFER_SIZE must be a power of 2"
+#endif
+
+/* arguments beyond this number are output as zero */
+#define MAX_ARGS 8
+
+#define STRING_BYTES CONFIG_PRINTK_DEFERRED_STRING_BYTES
+#define STRING_WORDS ((STRING_BYTES + 3) / 4)
+
+/* header, timestamp, format string, arguments and copied strings */
+#define MAX_RECORD_WORDS (3 + MAX_ARGS + STRING_WORDS)
+
+extern int (*_char_out)(int);
+extern void _printk_words(const char *fmt, const uint32_t *words,
+			  int num_words);
+
+/*
+ * The log buffer, with the information needed to decode a dump of it: the
+ * whole structure can be saved with a debugger and fed to the decoder.
+ */
+struct _printk_log_buf {
+	uint32_t magic;
+	uint32_t size;
+	uint32_t cycles_per_sec;
+	atomic_t head;
+	atomic_t tail;
+	atomic_t dropped;
+	uint32_t buf[LOG_BUF_SIZE];
+};
+
+struct _printk_log_buf _printk_log_buf = {
+	.magic = LOG_MAGIC,
+	.size = LOG_BUF_SIZE,
+};
+
+/* replaces the strings that do not fit in a record */
+static const char no_room[] = "...";
+
+static inline int is_in_image(const char *s)
+{
+	return s >= _image_rom_start && s < _image_rom_end;
+}
+
+void _printk_deferred_put(const char *fmt, va_list ap)
+{
+	struct _printk_log_buf *lb = &_printk_log_buf;
+	uint32_t args[MAX_ARGS];
+	const char *strings[MAX_ARGS];
+	uint32_t num_args = 0, str_mask = 0, str_bytes = 0;
+	uint32_t len, hdr, timestamp, index;
+	int might_format = 0;
+	atomic_val_t head;
+
+	/* capture the arguments, following the conversions of the format */
+
+	for (const char *p = fmt; *p; p++) {
+		uint32_t arg;
+
+		if (!might_format) {
+			might_format = (*p == '%');
+			continue;
+		}
+
+		switch (*p) {
+		case 'z':
+		case 'l':
+		case 'h':
+			continue;
+		case 'd':
+		case 'i':
+			arg = (uint32_t)va_arg(ap, long);
+			break;
+		case 'u':
+		case 'p':
+		case 'x':
+		case 'X':
+			arg = (uint32_t)va_arg(ap, unsigned long);
+			break;
+		case 'c':
+			arg = (uint32_t)va_arg(ap, int);
+			break;
+		case 's': {
+			const char *s = va_arg(ap, char *);
+			uint32_t n;
+
+			arg = (uint32_t)(uintptr_t)s;
+			if (is_in_image(s) || num_args == MAX_ARGS) {
+				break;
+			}
+
+			if (str_bytes == STRING_BYTES) {
+				arg = (uint32_t)(uintptr_t)no_room;
+				break;
+			}
+
+			/* copy the string, truncated if there is no room */
+			for (n = 0; s[n] && str_bytes + n + 1 < STRING_BYTES;
+			     n++) {
+			}
+
+			strings[num_args] = s;
+			str_mask |= BIT(num_args);
+			arg = (str_bytes << 8) | n;
+			str_bytes += n + 1;
+			break;
+		}
+		default:
+			might_format = 0;
+			continue;
+		}
+
+		might_format = 0;
+		if (num_args < MAX_ARGS) {
+			args[num_args++] = arg;
+		}
+	}
+
+	len = 3 + num_args + (str_bytes + 3) / 4;
+	hdr = LOG_HDR(LOG_MESSAGE, len, num_args | (str_mask << 8));
+
+	do {
+		head = atomic_get(&lb->head);
+
+		if ((uint32_t)(head + len - atomic_get(&lb->tail)) >
+		    LOG_BUF_SIZE) {
+			atomic_inc(&lb->dropped);
+			return;
+		}
+
+		timestamp = k_cycle_get_32();
+	} while (!atomic_cas(&lb->head, head, head + len));
+
+	lb->buf[(head + 1) & LOG_BUF_MASK] = timestamp;
+	lb->buf[(head + 2) & LOG_BUF_MASK] = (uint32_t)(uintptr_t)fmt;
+
+	index = head + 3;
+	for (uint32_t i = 0; i < num_args; i++) {
+		/* copied strings are recorded with their offset only */
+		lb->buf[index++ & LOG_BUF_MASK] =
+			(str_mask & BIT(i)) ? args[i] >> 8 : args[i];
+	}
+
+	if (str_mask) {
+		uint32_t word = 0, byte = 0;
+
+		for (uint32_t i = 0; i < num_args; i++) {
+			if (!(str_mask & BIT(i))) {
+				continue;
+			}
+
+			for (uint32_t n = 0; n <= (args[i] & 0xff); n++) {
+				((char *)&word)[byte] = n < (args[i] & 0xff) ?
+							strings[i][n] : '\0';
+
+				if (++byte == 4) {
+					lb->buf[index++ & LOG_BUF_MASK] = word;
+					word = byte = 0;
+				}
+			}
+		}
+
+		if (byte) {
+			lb->buf[index & LOG_BUF_MASK] = word;
+		}
+	}
+
+	/* the header must be written last: it marks the record as complete */
+	compiler_barrier();
+	lb->buf[head & LOG_BUF_MASK] = hdr;
+}
+
+/*
+ * Copy the next complete record to <rec> and free its space in the log
+ * buffer; a dropped messages record is produced first if messages were dropped.
+ * Returns the length of the record in words, or 0 if there is none.
+ *
+ * The printk thread and printk_flush() both read records: interrupts are
+ * locked while a record is taken, so that a reader preempted in the middle
+ * cannot hand the same record to another one, then move the tail back. Each
+ * reader outputs the records it took, so messages can be output out of order
+ * when printk_flush() preempts the printk thread.
+ */
+static int log_read(uint32_t *rec)
+{
+	struct _printk_log_buf *lb = &_printk_log_buf;
+	atomic_val_t dropped = atomic_set(&lb->dropped, 0);
+	unsigned int key;
+	atomic_val_t tail;
+	uint32_t hdr, len;
+
+	if (dropped) {
+		rec[0] = LOG_HDR(LOG_DROPPED, 3, 0);
+		rec[1] = k_cycle_get_32();
+		rec[2] = dropped;
+		return 3;
+	}
+
+	key = irq_lock();
+
+	tail = atomic_get(&lb->tail);
+	if (tail == atomic_get(&lb->head)) {
+		irq_unlock(key);
+		return 0;
+	}
+
+	hdr = lb->buf[tail & LOG_BUF_MASK];
+	if (!hdr) {
+		/* record not complete yet */
+		irq_unlock(key);
+		return 0;
+	}
+
+	len = LOG_HDR_LEN(hdr);
+	for (uint32_t i = 0; i < len; i++) {
+		rec[i] = lb->buf[(tail + i) & LOG_BUF_MASK];
+		lb->buf[(tail + i) & LOG_BUF_MASK] = 0;
+	}
+
+	/* the words are cleared before being handed back to the writers */
+	compiler_barrier();
+	atomic_set(&lb->tail, tail + len);
+
+	irq_unlock(key);
+
+	return len;
+}
+
+#ifdef CONFIG_PRINTK_DEFERRED_OUTPUT_TEXT
+
+static void log_output(uint32_t *rec, int len)
+{
+	uint32_t arg = LOG_HDR_ARG(rec[0]);
+	uint32_t num_args = arg & 0xff;
+	uint32_t str_mask = arg >> 8;
+	char *strings = (char *)&rec[3 + num_args];
+
+	ARG_UNUSED(len);
+
+	if ((rec[0] & 0xff) == LOG_DROPPED) {
+		_printk_words("<%u messages dropped>\n", &rec[2], 1);
+		return;
+	}
+
+	/* point the copied string arguments to their copy in the record */
+	for (uint32_t i = 0; i < num_args; i++) {
+		if (str_mask & BIT(i)) {
+			rec[3 + i] = (uint32_t)(uintptr_t)(strings + rec[3 + i]);
+		}
+	}
+
+	_printk_words((const char *)(uintptr_t)rec[2], &rec[3], num_args);
+}
+
+static void log_stream_start(void)
+{
+}
+
+#else
+
+static void log_output(uint32_t *rec, int len)
+{
+	uint8_t *data = (uint8_t *)rec;
+
+	/* words are sent in native order: the decoder expects little-endian */
+	for (int i = 0; i < len * sizeof(uint32_t); i++) {
+		_char_out(data[i]);
+	}
+}
+
+static void log_stream_start(void)
+{
+	uint32_t rec[4] = {
+		LOG_HDR(LOG_STREAM_START, 4, 0), k_cycle_get_32(),
+		LOG_MAGIC, sys_clock_hw_cycles_per_sec
+	};
+
+	log_output(rec, ARRAY_SIZE(rec));
+}
+
+#endif /* CONFIG_PRINTK_DEFERRED_OUTPUT_TEXT */
+
+/* output the pending messages from the calling context */
+void _printk_deferred_flush(void)
+{
+	static uint32_t rec[MAX_RECORD_WORDS];
+	int len;
+
+	while ((len = log_read(rec)) != 0) {
+		log_output(rec, len);
+	}
+}
+
+static void printk_thread_main(void *p1, void *p2, void *p3)
+{
+	static uint32_t rec[MAX_RECORD_WORDS];
+	int len;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	_printk_log_buf.cycles_per_sec = sys_clock_hw_cycles_per_sec;
+	log_stream_start();
+
+	while (1) {
+		len = log_read(rec);
+		if (len) {
+			log_output(rec, len);
+		} else {
+			k_sleep(CONFIG_PRINTK_DEFERRED_FLUSH_PERIOD);
+		}
+	}
+}
+
+K_THREAD_DEFINE(_printk_thread, 512, printk_thread_main, NULL, NULL, NULL,
+		K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
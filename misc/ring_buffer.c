@@ -17,6 +17,7 @@
  */
 
 #include <misc/ring_buffer.h>
+#include <string.h>
 
 /**
  * Internal data structure for a buffer header.
@@ -33,29 +34,31 @@ struct ring_element {
 int sys_ring_buf_put(struct ring_buf *buf, uint16_t type, uint8_t value,
 		     uint32_t *data, uint8_t size32)
 {
-	uint32_t i, space, index, rc;
+	uint32_t i, space, index, rc, tail;
 
 	space = sys_ring_buf_space_get(buf);
+	tail = buf->tail;
 	if (space >= (size32 + 1)) {
 		struct ring_element *header =
-				(struct ring_element *)&buf->buf[buf->tail];
+				(struct ring_element *)&buf->buf[tail];
 		header->type = type;
 		header->length = size32;
 		header->value = value;
 
 		if (likely(buf->mask)) {
 			for (i = 0; i < size32; ++i) {
-				index = (i + buf->tail + 1) & buf->mask;
+				index = (i + tail + 1) & buf->mask;
 				buf->buf[index] = data[i];
 			}
-			buf->tail = (buf->tail + size32 + 1) & buf->mask;
+			tail = (tail + size32 + 1) & buf->mask;
 		} else {
 			for (i = 0; i < size32; ++i) {
-				index = (i + buf->tail + 1) % buf->size;
+				index = (i + tail + 1) % buf->size;
 				buf->buf[index] = data[i];
 			}
-			buf->tail = (buf->tail + size32 + 1) % buf->size;
+			tail = (tail + size32 + 1) % buf->size;
 		}
+		_ring_buf_index_release(&buf->tail, tail);
 		rc = 0;
 	} else {
 		buf->dropped_put_count++;
@@ -69,13 +72,13 @@ int sys_ring_buf_get(struct ring_buf *buf, uint16_t *type, uint8_t *value,
 		     uint32_t *data, uint8_t *size32)
 {
 	struct ring_element *header;
-	uint32_t i, index;
+	uint32_t i, index, head = buf->head;
 
-	if (sys_ring_buf_is_empty(buf)) {
+	if (head == _ring_buf_index_acquire(&buf->tail)) {
 		return -EAGAIN;
 	}
 
-	header = (struct ring_element *) &buf->buf[buf->head];
+	header = (struct ring_element *) &buf->buf[head];
 
 	if (header->length > *size32) {
 		*size32 = header->length;
@@ -88,17 +91,148 @@ int sys_ring_buf_get(struct ring_buf *buf, uint16_t *type, uint8_t *value,
 
 	if (likely(buf->mask)) {
 		for (i = 0; i < header->length; ++i) {
-			index = (i + buf->head + 1) & buf->mask;
+			index = (i + head + 1) & buf->mask;
 			data[i] = buf->buf[index];
 		}
-		buf->head = (buf->head + header->length + 1) & buf->mask;
+		head = (head + header->length + 1) & buf->mask;
 	} else {
 		for (i = 0; i < header->length; ++i) {
-			index = (i + buf->head + 1) % buf->size;
+			index = (i + head + 1) % buf->size;
 			data[i] = buf->buf[index];
 		}
-		buf->head = (buf->head + header->length + 1) % buf->size;
+		head = (head + header->length + 1) % buf->size;
 	}
+	_ring_buf_index_release(&buf->head, head);
 
 	return 0;
 }
+
+/*
+ * In byte stream mode, the head and tail indexes count bytes, and wrap around
+ * at the size of the data area in bytes.
+ */
+static inline uint32_t byte_size(struct ring_buf *buf)
+{
+	return buf->size * sizeof(uint32_t);
+}
+
+static inline uint32_t byte_wrap(struct ring_buf *buf, uint32_t index)
+{
+	if (likely(buf->mask)) {
+		return index & ((buf->mask << 2) | 3);
+	}
+
+	return index % byte_size(buf);
+}
+
+uint32_t sys_ring_buf_byte_put_claim(struct ring_buf *buf, uint8_t **data,
+				     uint32_t size)
+{
+	uint32_t head = _ring_buf_index_acquire(&buf->head);
+	uint32_t tail = buf->tail;
+	uint32_t space;
+
+	if (tail < head) {
+		space = head - tail - 1;
+	} else {
+		/* up to the end of the buffer, keeping a byte empty */
+		space = byte_size(buf) - tail - (head == 0);
+	}
+
+	*data = (uint8_t *)buf->buf + tail;
+
+	return min(size, space);
+}
+
+int sys_ring_buf_byte_put_finish(struct ring_buf *buf, uint32_t size)
+{
+	uint32_t head = _ring_buf_index_acquire(&buf->head);
+	uint32_t tail = buf->tail;
+
+	if (size > byte_wrap(buf, head - tail - 1 + byte_size(buf))) {
+		return -EINVAL;
+	}
+
+	_ring_buf_index_release(&buf->tail, byte_wrap(buf, tail + size));
+
+	return 0;
+}
+
+uint32_t sys_ring_buf_byte_put(struct ring_buf *buf, const uint8_t *data,
+			       uint32_t size)
+{
+	uint32_t total = 0;
+
+	/* the free space is in at most two parts */
+	for (int i = 0; i < 2 && total < size; i++) {
+		uint8_t *dst;
+		uint32_t len;
+
+		len = sys_ring_buf_byte_put_claim(buf, &dst, size - total);
+		if (!len) {
+			break;
+		}
+
+		memcpy(dst, data + total, len);
+		sys_ring_buf_byte_put_finish(buf, len);
+		total += len;
+	}
+
+	return total;
+}
+
+uint32_t sys_ring_buf_byte_get_claim(struct ring_buf *buf, uint8_t **data,
+				     uint32_t size)
+{
+	uint32_t tail = _ring_buf_index_acquire(&buf->tail);
+	uint32_t head = buf->head;
+	uint32_t avail;
+
+	if (head <= tail) {
+		avail = tail - head;
+	} else {
+		/* up to the end of the buffer */
+		avail = byte_size(buf) - head;
+	}
+
+	*data = (uint8_t *)buf->buf + head;
+
+	return min(size, avail);
+}
+
+int sys_ring_buf_byte_get_finish(struct ring_buf *buf, uint32_t size)
+{
+	uint32_t tail = _ring_buf_index_acquire(&buf->tail);
+	uint32_t head = buf->head;
+
+	if (size > byte_wrap(buf, tail - head + byte_size(buf))) {
+		return -EINVAL;
+	}
+
+	_ring_buf_index_release(&buf->head, byte_wrap(buf, head + size));
+
+	return 0;
+}
+
+uint32_t sys_ring_buf_byte_get(struct ring_buf *buf, uint8_t *data,
+			       uint32_t size)
+{
+	uint32_t total = 0;
+
+	/* the data is in at most two parts */
+	for (int i = 0; i < 2 && total < size; i++) {
+		uint8_t *src;
+		uint32_t len;
+
+		len = sys_ring_buf_byte_get_claim(buf, &src, size - total);
+		if (!len) {
+			break;
+		}
+
+		memcpy(data + total, src, len);
+		sys_ring_buf_byte_get_finish(buf, len);
+		total += len;
+	}
+
+	return total;
+}
@@ -45,6 +45,9 @@ const struct shell_cmd commands[] = {
 	{ "ping", shell_cmd_ping },
 	{ "uptime", shell_cmd_uptime },
 	{ "cycles", shell_cmd_cycles },
+#ifdef CONFIG_THREAD_STACK_USAGE
+	SHELL_CMD_STACKS,
+#endif
 	{ NULL, NULL }
 };
 
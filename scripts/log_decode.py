@@ -0,0 +1,270 @@
+#!/usr/bin/env python
+#
+# log_decode.py - deferred printk() binary log decoder
+#
+# Copyright (c) 2016 Wind River Systems, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Decodes the binary printk() records produced with
+# CONFIG_PRINTK_DEFERRED_OUTPUT_BINARY, either captured from the console or
+# dumped from RAM with:
+#
+#   (gdb) dump binary value log.bin _printk_log_buf
+#
+# The records only hold the addresses of the format strings, and of the string
+# arguments that are part of the image, so the ELF file of the image is needed
+# to format the messages.
+#
+# See misc/printk_deferred.c for the record format.
+
+import argparse
+import struct
+import sys
+
+LOG_MAGIC = 0x474f4c5a
+
+MESSAGE = 0x01
+DROPPED = 0xfe
+STREAM_START = 0xff
+
+
+class Record(object):
+    def __init__(self, type, arg, timestamp, data):
+        self.type = type
+        self.arg = arg
+        self.timestamp = timestamp
+        self.data = data
+        self.cycles = 0
+
+
+def parse_records(words, start, end, mask=None):
+    """Parse the records in words[start:end], with indexes wrapping around
+    with mask when reading a ring buffer."""
+    records = []
+    index = start
+
+    def word(i):
+        return words[i & mask] if mask is not None else words[i]
+
+    while index < end:
+        hdr = word(index)
+        length = (hdr >> 8) & 0xff
+
+        if hdr == 0:
+            # incomplete record: the writer was interrupted
+            break
+
+        if length < 2 or index + length > end:
+            sys.stderr.write("invalid record header 0x%08x at word %d, "
+                             "skipping a word\n" % (hdr, index))
+            index += 1
+            continue
+
+        data = [word(index + i) for i in range(2, length)]
+        records.append(Record(hdr & 0xff, hdr >> 16, word(index + 1), data))
+        index += length
+
+    return records
+
+
+def parse_file(raw):
+    """Parse a RAM dump of _printk_log_buf, or a console capture. Returns the
+    number of cycles per second and the list of records."""
+    raw = bytearray(raw)
+    magic = struct.pack("<I", LOG_MAGIC)
+
+    if len(raw) < 4:
+        sys.exit("empty log")
+
+    if raw[:4] == magic:
+        # RAM dump: magic, size, cycles_per_sec, head, tail, dropped, buf
+        words = struct.unpack_from("<%dI" % (len(raw) // 4), raw)
+        size, cycles_per_sec, head, tail, dropped = words[1:6]
+        buf = words[6:6 + size]
+        if len(buf) != size:
+            sys.exit("truncated RAM dump")
+
+        if head < tail:
+            head += 1 << 32
+
+        records = parse_records(buf, tail, head, size - 1)
+        if dropped:
+            records.append(Record(DROPPED, 0, records[-1].timestamp
+                                  if records else 0, [dropped]))
+
+        return cycles_per_sec, records
+
+    # console capture: the stream begins with a stream start record, which
+    # may be preceded by other console output
+    offset = raw.find(magic)
+    while offset >= 8:
+        start = offset - 8
+        if struct.unpack_from("<I", raw, start)[0] == STREAM_START | 4 << 8:
+            num = (len(raw) - start) // 4
+            words = struct.unpack_from("<%dI" % num, raw, start)
+            records = parse_records(words, 0, num)
+            return records[0].data[1], records[1:]
+        offset = raw.find(magic, offset + 1)
+
+    sys.exit("no stream start record: not a deferred printk() log?")
+
+
+class Image(object):
+    """Reads the contents of the allocated sections of an ELF file."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = bytearray(f.read())
+
+        if self.data[:4] != b"\x7fELF":
+            sys.exit("%s: not an ELF file" % path)
+
+        is64 = self.data[4] == 2
+        endian = "<" if self.data[5] == 1 else ">"
+        self.sections = []
+
+        if is64:
+            shoff, = struct.unpack_from(endian + "Q", self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data,
+                                                  0x3a)
+            fmt = endian + "IIQQQQ"
+        else:
+            shoff, = struct.unpack_from(endian + "I", self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", self.data,
+                                                  0x2e)
+            fmt = endian + "IIIIII"
+
+        SHT_NOBITS = 8
+        SHF_ALLOC = 0x2
+
+        for i in range(shnum):
+            _, type, flags, addr, offset, size = struct.unpack_from(
+                fmt, self.data, shoff + i * shentsize)
+            if flags & SHF_ALLOC and type != SHT_NOBITS and size:
+                self.sections.append((addr, offset, size))
+
+    def string(self, addr):
+        for start, offset, size in self.sections:
+            if start <= addr < start + size:
+                pos = offset + addr - start
+                end = self.data.find(b"\0", pos, offset + size)
+                if end < 0:
+                    end = offset + size
+                return self.data[pos:end].decode("latin-1")
+        return "<bad string 0x%08x>" % addr
+
+
+def format_message(record, image):
+    """Format a message the way printk() does."""
+    num_args = record.arg & 0xff
+    str_mask = record.arg >> 8
+    fmt = image.string(record.data[0])
+    args = record.data[1:1 + num_args]
+    strings = struct.pack("<%dI" % (len(record.data) - 1 - num_args),
+                          *record.data[1 + num_args:])
+
+    out = []
+    index = 0
+    might_format = False
+
+    def next_arg():
+        return args[index] if index < len(args) else 0
+
+    for c in fmt:
+        if not might_format:
+            if c == "%":
+                might_format = True
+            else:
+                out.append(c)
+            continue
+
+        if c in "zlh":
+            continue
+
+        might_format = False
+
+        if c in "diupxXcs":
+            value = next_arg()
+            if c in "di":
+                out.append("%d" % struct.unpack("<i",
+                                                struct.pack("<I", value))[0])
+            elif c == "u":
+                out.append("%d" % value)
+            elif c == "p":
+                out.append("0x%08x" % value)
+            elif c in "xX":
+                out.append("%08x" % value)
+            elif c == "c":
+                out.append(chr(value & 0xff))
+            elif str_mask & (1 << index):
+                end = strings.find(b"\0", value)
+                out.append(strings[value:end].decode("latin-1"))
+            else:
+                out.append(image.string(value))
+            index += 1
+        elif c == "%":
+            out.append("%")
+        else:
+            out.append("%" + c)
+
+    return "".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode a binary deferred printk() log "
+                    "(CONFIG_PRINTK_DEFERRED_OUTPUT_BINARY).")
+    parser.add_argument("log", help="console capture or RAM dump of "
+                        "_printk_log_buf")
+    parser.add_argument("elf", help="ELF file of the image")
+    parser.add_argument("-o", "--output", help="output file (default: "
+                        "standard output)")
+    parser.add_argument("-t", "--timestamps", action="store_true",
+                        help="prefix the messages with the time they were "
+                        "logged, in microseconds")
+    args = parser.parse_args()
+
+    with open(args.log, "rb") as f:
+        cycles_per_sec, records = parse_file(f.read())
+
+    image = Image(args.elf)
+    out = open(args.output, "w") if args.output else sys.stdout
+
+    # the messages do not necessarily end with a newline
+    first = records[0].timestamp if records else 0
+    at_line_start = True
+
+    for record in records:
+        if record.type == MESSAGE:
+            text = format_message(record, image)
+        elif record.type == DROPPED:
+            text = "<%d messages dropped>\n" % record.data[0]
+        else:
+            continue
+
+        if args.timestamps and at_line_start and cycles_per_sec:
+            cycles = (record.timestamp - first) & 0xffffffff
+            out.write("[%14.3f] " % (cycles * 1000000.0 / cycles_per_sec))
+
+        out.write(text)
+        if text:
+            at_line_start = text.endswith("\n")
+
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,339 @@
+#!/usr/bin/env python
+#
+# trace_decode.py - kernel trace stream decoder
+#
+# Copyright (c) 2016 Wind River Systems, Inc.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Decodes the binary kernel trace produced with CONFIG_KERNEL_TRACE, either
+# captured from the trace UART or dumped from RAM with:
+#
+#   (gdb) dump binary value trace.bin _k_trace_buf
+#
+# The default output is a JSON file in the Trace Event Format, which can be
+# loaded in chrome://tracing or in the Perfetto UI: each thread gets a track
+# showing when it runs, and interrupt handlers get their own track. The text
+# output lists the events one per line.
+#
+# See include/misc/kernel_trace.h for the record format.
+
+import argparse
+import json
+import struct
+import subprocess
+import sys
+
+K_TRACE_MAGIC = 0x4352545a
+
+THREAD_SWITCH = 0x01
+ISR_ENTER = 0x02
+ISR_EXIT = 0x03
+PEND = 0x04
+UNPEND = 0x05
+TIMEOUT_ADD = 0x06
+TIMEOUT_EXPIRE = 0x07
+USER = 0x08
+DROPPED = 0xfe
+STREAM_START = 0xff
+
+EVENT_NAMES = {
+    THREAD_SWITCH: "switch",
+    ISR_ENTER: "isr_enter",
+    ISR_EXIT: "isr_exit",
+    PEND: "pend",
+    UNPEND: "unpend",
+    TIMEOUT_ADD: "timeout_add",
+    TIMEOUT_EXPIRE: "timeout_expire",
+    USER: "user",
+    DROPPED: "dropped",
+    STREAM_START: "stream_start",
+}
+
+# track of the interrupt handlers, and of the timeouts not tied to a thread
+ISR_TID = 0
+TIMEOUT_TID = 1
+
+PID = 1
+
+
+class Record(object):
+    def __init__(self, type, arg, timestamp, data):
+        self.type = type
+        self.arg = arg
+        self.timestamp = timestamp
+        self.data = data
+        self.cycles = 0
+
+
+def parse_records(words, start, end, mask=None):
+    """Parse the records in words[start:end], with indexes wrapping around
+    with mask when reading a ring buffer."""
+    records = []
+    index = start
+
+    def word(i):
+        return words[i & mask] if mask is not None else words[i]
+
+    while index < end:
+        hdr = word(index)
+        length = (hdr >> 8) & 0xff
+
+        if hdr == 0:
+            # incomplete record: the writer was interrupted
+            break
+
+        if length < 2 or index + length > end:
+            sys.stderr.write("invalid record header 0x%08x at word %d, "
+                             "skipping a word\n" % (hdr, index))
+            index += 1
+            continue
+
+        data = [word(index + i) for i in range(2, length)]
+        records.append(Record(hdr & 0xff, hdr >> 16, word(index + 1), data))
+        index += length
+
+    return records
+
+
+def parse_file(raw):
+    """Parse a RAM dump of _k_trace_buf, or a UART stream. Returns the number
+    of cycles per second and the list of records."""
+    raw = raw[:len(raw) - len(raw) % 4]
+    words = list(struct.unpack("<%dI" % (len(raw) // 4), raw))
+
+    if not words:
+        sys.exit("empty trace")
+
+    if words[0] == K_TRACE_MAGIC:
+        # RAM dump: magic, size, cycles_per_sec, head, tail, dropped, buf
+        size, cycles_per_sec, head, tail, dropped = words[1:6]
+        buf = words[6:6 + size]
+        if len(buf) != size:
+            sys.exit("truncated RAM dump")
+
+        if head < tail:
+            head += 1 << 32
+
+        records = parse_records(buf, tail, head, size - 1)
+        if dropped:
+            records.append(Record(DROPPED, 0, records[-1].timestamp
+                                  if records else 0, [dropped]))
+
+        return cycles_per_sec, records
+
+    records = parse_records(words, 0, len(words))
+    for record in records:
+        if record.type == STREAM_START and record.data[0] == K_TRACE_MAGIC:
+            return record.data[1], records
+
+    sys.exit("no stream start record: not a kernel trace?")
+
+
+def unwrap_timestamps(records):
+    """Convert the 32-bit cycle counts to cycles since the first record.
+    Records are in timestamp order, except for the stream start and dropped
+    event markers, which carry the time they were produced by the reader."""
+    last = None
+    cycles = 0
+
+    for record in records:
+        if record.type in (DROPPED, STREAM_START):
+            record.cycles = cycles
+            continue
+
+        if last is not None:
+            cycles += (record.timestamp - last) & 0xffffffff
+        last = record.timestamp
+        record.cycles = cycles
+
+
+def load_symbols(elf, nm):
+    """Map addresses to symbol names, using nm on the kernel ELF file."""
+    symbols = {}
+
+    try:
+        output = subprocess.check_output([nm, elf])
+    except (OSError, subprocess.CalledProcessError) as e:
+        sys.exit("cannot run %s: %s" % (nm, e))
+
+    for line in output.decode().splitlines():
+        fields = line.split()
+        if len(fields) == 3:
+            symbols[int(fields[0], 16)] = fields[2]
+
+    return symbols
+
+
+class Namer(object):
+    def __init__(self, symbols):
+        self.symbols = symbols
+
+    def __call__(self, addr):
+        name = self.symbols.get(addr)
+        if name:
+            # threads defined with K_THREAD_DEFINE
+            return name.replace("_k_thread_obj_", "")
+        return "0x%08x" % addr
+
+
+def describe(record, name):
+    d = record.data
+
+    if record.type == THREAD_SWITCH:
+        return "to %s (prio %d)" % (name(d[0]), struct.unpack(
+            "<h", struct.pack("<H", record.arg))[0])
+    if record.type == ISR_ENTER:
+        return "vector %d" % record.arg
+    if record.type == PEND:
+        timeout = struct.unpack("<i", struct.pack("<I", d[2]))[0]
+        return "%s on %s, timeout %s" % (name(d[0]), name(d[1]),
+                                          "forever" if timeout < 0 else
+                                          "%d ms" % timeout)
+    if record.type == UNPEND:
+        return "%s from %s" % (name(d[0]), name(d[1]) if d[1] else "?")
+    if record.type == TIMEOUT_ADD:
+        return "%s for %s, %d ticks" % (name(d[0]), name(d[1]) if d[1]
+                                        else "-", d[2])
+    if record.type == TIMEOUT_EXPIRE:
+        return "%s for %s" % (name(d[0]), name(d[1]) if d[1] else "-")
+    if record.type == USER:
+        return "id %d value 0x%08x" % (record.arg, d[0])
+    if record.type == DROPPED:
+        return "%d events lost" % d[0]
+    return ""
+
+
+def emit_text(records, to_us, name, out):
+    for record in records:
+        if record.type == STREAM_START:
+            continue
+        out.write("%14.3f %-15s %s\n" % (
+            to_us(record.cycles),
+            EVENT_NAMES.get(record.type, "0x%02x" % record.type),
+            describe(record, name)))
+
+
+def emit_chrome(records, to_us, name, out):
+    events = []
+    threads = set()
+    current = None
+    current_start = 0
+    isr_stack = []
+
+    def instant(record, tid, scope="t"):
+        events.append({"name": EVENT_NAMES[record.type], "ph": "i",
+                       "s": scope, "ts": to_us(record.cycles),
+                       "pid": PID, "tid": tid,
+                       "args": {"info": describe(record, name)}})
+
+    def thread_tid(addr):
+        threads.add(addr)
+        return addr
+
+    for record in records:
+        t = record.type
+
+        if t == THREAD_SWITCH:
+            if current is not None:
+                events.append({"name": "running", "ph": "X",
+                               "ts": to_us(current_start),
+                               "dur": to_us(record.cycles - current_start),
+                               "pid": PID, "tid": thread_tid(current)})
+            current = record.data[0]
+            current_start = record.cycles
+            thread_tid(current)
+        elif t == ISR_ENTER:
+            isr_stack.append(record)
+        elif t == ISR_EXIT:
+            if isr_stack:
+                enter = isr_stack.pop()
+                events.append({"name": "irq %d" % enter.arg, "ph": "X",
+                               "ts": to_us(enter.cycles),
+                               "dur": to_us(record.cycles - enter.cycles),
+                               "pid": PID, "tid": ISR_TID})
+        elif t in (PEND, UNPEND):
+            instant(record, thread_tid(record.data[0]))
+        elif t in (TIMEOUT_ADD, TIMEOUT_EXPIRE):
+            tid = thread_tid(record.data[1]) if record.data[1] \
+                else TIMEOUT_TID
+            instant(record, tid)
+        elif t == USER:
+            tid = thread_tid(current) if current is not None else ISR_TID
+            events.append({"name": "user %d" % record.arg, "ph": "i",
+                           "s": "t", "ts": to_us(record.cycles),
+                           "pid": PID, "tid": tid,
+                           "args": {"value": record.data[0]}})
+        elif t == DROPPED:
+            instant(record, ISR_TID, "g")
+
+    if current is not None and records:
+        events.append({"name": "running", "ph": "X",
+                       "ts": to_us(current_start),
+                       "dur": to_us(records[-1].cycles - current_start),
+                       "pid": PID, "tid": current})
+
+    events.append({"name": "process_name", "ph": "M", "pid": PID,
+                   "args": {"name": "kernel"}})
+    for tid, tname in [(ISR_TID, "interrupts"), (TIMEOUT_TID, "timeouts")] + \
+            [(addr, "thread %s" % name(addr)) for addr in sorted(threads)]:
+        events.append({"name": "thread_name", "ph": "M", "pid": PID,
+                       "tid": tid, "args": {"name": tname}})
+
+    json.dump({"traceEvents": events, "displayTimeUnit": "ns"}, out,
+              indent=1)
+    out.write("\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Decode a binary kernel trace (CONFIG_KERNEL_TRACE).")
+    parser.add_argument("trace",
+                        help="UART capture or RAM dump of _k_trace_buf")
+    parser.add_argument("-o", "--output", help="output file (default: "
+                        "standard output)")
+    parser.add_argument("-f", "--format", choices=["chrome", "text"],
+                        default="chrome", help="output format: Trace Event "
+                        "Format JSON (default), or text")
+    parser.add_argument("-e", "--elf", help="kernel ELF file, to name "
+                        "threads and kernel objects")
+    parser.add_argument("--nm", default="nm", help="nm command to use with "
+                        "--elf (default: nm)")
+    args = parser.parse_args()
+
+    with open(args.trace, "rb") as f:
+        cycles_per_sec, records = parse_file(f.read())
+
+    if not cycles_per_sec:
+        sys.exit("unknown clock frequency")
+
+    unwrap_timestamps(records)
+
+    def to_us(cycles):
+        return cycles * 1000000.0 / cycles_per_sec
+
+    name = Namer(load_symbols(args.elf, args.nm) if args.elf else {})
+    out = open(args.output, "w") if args.output else sys.stdout
+
+    if args.format == "text":
+        emit_text(records, to_us, name, out)
+    else:
+        emit_chrome(records, to_us, name, out)
+
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
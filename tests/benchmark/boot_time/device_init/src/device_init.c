@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Measure the boot time with asynchronous device initialization
+ *
+ * Devices whose init functions sleep are registered at the APPLICATION level,
+ * some of them depending on others. The start and the end of each init
+ * function are recorded relative to __start, to show which ones run
+ * concurrently and to check that dependencies are honoured.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <init.h>
+#include <misc/util.h>
+#include <tc_util.h>
+
+extern uint64_t __start_tsc; /* timestamp when kernel begins executing */
+extern uint64_t __main_tsc;  /* timestamp when main() begins executing */
+
+struct dev_timing {
+	uint32_t sleep_ms;
+	uint64_t start;
+	uint64_t end;
+};
+
+static const int dev_api;
+
+static int dev_init(struct device *dev)
+{
+	struct dev_timing *timing = dev->driver_data;
+
+	timing->start = _NanoTscRead();
+	k_sleep(timing->sleep_ms);
+	timing->end = _NanoTscRead();
+
+	return 0;
+}
+
+#define DEV_TIMING(name, ms) \
+	static struct dev_timing name##_timing = { .sleep_ms = ms }
+
+DEV_TIMING(bus, 10);
+DEV_TIMING(sensor_0, 20);
+DEV_TIMING(sensor_1, 20);
+DEV_TIMING(sensor_2, 20);
+DEV_TIMING(sensor_3, 20);
+DEV_TIMING(flash, 30);
+DEV_TIMING(logger, 50);
+
+DEVICE_AND_API_INIT_ASYNC(bus, "bus", dev_init, &bus_timing, NULL,
+			  APPLICATION, 40, &dev_api, 0);
+DEVICE_AND_API_INIT_ASYNC(sensor_0, "sensor_0", dev_init, &sensor_0_timing,
+			  NULL, APPLICATION, 41, &dev_api, 0, "bus");
+DEVICE_AND_API_INIT_ASYNC(sensor_1, "sensor_1", dev_init, &sensor_1_timing,
+			  NULL, APPLICATION, 41, &dev_api, 0, "bus");
+DEVICE_AND_API_INIT_ASYNC(sensor_2, "sensor_2", dev_init, &sensor_2_timing,
+			  NULL, APPLICATION, 41, &dev_api, 0, "bus");
+DEVICE_AND_API_INIT_ASYNC(sensor_3, "sensor_3", dev_init, &sensor_3_timing,
+			  NULL, APPLICATION, 41, &dev_api, 0, "bus");
+DEVICE_AND_API_INIT_ASYNC(flash, "flash", dev_init, &flash_timing, NULL,
+			  APPLICATION, 42, &dev_api, 0);
+DEVICE_AND_API_INIT_ASYNC(logger, "logger", dev_init, &logger_timing, NULL,
+			  APPLICATION, 43, &dev_api, DEVICE_INIT_DEFERRED,
+			  "flash");
+
+static const struct {
+	const char *name;
+	struct dev_timing *timing;
+	struct dev_timing *dep;
+} devices[] = {
+	{ "bus", &bus_timing, NULL },
+	{ "sensor_0", &sensor_0_timing, &bus_timing },
+	{ "sensor_1", &sensor_1_timing, &bus_timing },
+	{ "sensor_2", &sensor_2_timing, &bus_timing },
+	{ "sensor_3", &sensor_3_timing, &bus_timing },
+	{ "flash", &flash_timing, NULL },
+	{ "logger", &logger_timing, &flash_timing },
+};
+
+static uint32_t tsc_to_us(uint64_t tsc)
+{
+	return (uint32_t)((tsc - __start_tsc) / CONFIG_CPU_CLOCK_FREQ_MHZ);
+}
+
+void main(void)
+{
+	uint64_t main_tsc = __main_tsc;
+	uint64_t ready_tsc;
+	int rc = TC_PASS;
+
+	TC_START("Device Init Boot Time");
+
+	/* wait for the deferred device */
+	if (!device_get_binding("logger")) {
+		TC_ERROR("cannot find the logger device\n");
+		rc = TC_FAIL;
+	}
+	ready_tsc = _NanoTscRead();
+
+#ifdef CONFIG_DEVICE_ASYNC_INIT
+	TC_PRINT("Device init: asynchronous, %d threads\n",
+		 CONFIG_DEVICE_ASYNC_INIT_THREADS);
+#else
+	TC_PRINT("Device init: synchronous\n");
+#endif
+
+	for (int i = 0; i < ARRAY_SIZE(devices); i++) {
+		struct dev_timing *timing = devices[i].timing;
+
+		TC_PRINT("%s: start %u us, duration %u us\n",
+			 devices[i].name, tsc_to_us(timing->start),
+			 (uint32_t)((timing->end - timing->start) /
+				    CONFIG_CPU_CLOCK_FREQ_MHZ));
+
+		if (!timing->end) {
+			TC_ERROR("%s was not initialized\n", devices[i].name);
+			rc = TC_FAIL;
+		} else if (devices[i].dep &&
+			   devices[i].dep->end > timing->start) {
+			TC_ERROR("%s started before its dependency\n",
+				 devices[i].name);
+			rc = TC_FAIL;
+		}
+	}
+
+	TC_PRINT("_start->main()     : %u us\n", tsc_to_us(main_tsc));
+	TC_PRINT("_start->logger bind: %u us\n", tsc_to_us(ready_tsc));
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
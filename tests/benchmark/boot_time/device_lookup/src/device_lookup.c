@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file
+ * @brief Measure the cost of device lookups at boot time
+ *
+ * 256 devices are registered at the APPLICATION level, each of which looks up
+ * a device by name from its init function, like drivers binding to their bus
+ * controller do. The boot time then includes all these lookups.
+ */
+
+#include <zephyr.h>
+#include <device.h>
+#include <init.h>
+#include <tc_util.h>
+
+#define NUM_DEVICES 256
+#define NUM_LOOKUPS 1000
+
+extern uint64_t __start_tsc; /* timestamp when kernel begins executing */
+extern uint64_t __main_tsc;  /* timestamp when main() begins executing */
+
+static const int dev_api;
+static int bind_failures;
+
+static int dev_init(struct device *dev)
+{
+	/* each device binds to the device whose name is its config info */
+	if (!device_get_binding(dev->config->config_info)) {
+		bind_failures++;
+	}
+
+	return 0;
+}
+
+#define DEV(n) \
+	DEVICE_AND_API_INIT(n, #n, dev_init, NULL, #n, APPLICATION, \
+			    CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &dev_api);
+#define DEV4(n) DEV(n##0) DEV(n##1) DEV(n##2) DEV(n##3)
+#define DEV16(n) DEV4(n##0) DEV4(n##1) DEV4(n##2) DEV4(n##3)
+#define DEV64(n) DEV16(n##0) DEV16(n##1) DEV16(n##2) DEV16(n##3)
+#define DEV256(n) DEV64(n##0) DEV64(n##1) DEV64(n##2) DEV64(n##3)
+
+DEV256(dev_)
+
+static uint32_t lookup_cycles(const char *name)
+{
+	uint64_t start;
+	int i;
+
+	start = _NanoTscRead();
+	for (i = 0; i < NUM_LOOKUPS; i++) {
+		device_get_binding(name);
+	}
+
+	return (uint32_t)(_NanoTscRead() - start) / NUM_LOOKUPS;
+}
+
+static uint32_t handle_cycles(device_handle_t handle)
+{
+	uint64_t start;
+	int i;
+
+	start = _NanoTscRead();
+	for (i = 0; i < NUM_LOOKUPS; i++) {
+		device_from_handle(handle);
+	}
+
+	return (uint32_t)(_NanoTscRead() - start) / NUM_LOOKUPS;
+}
+
+void main(void)
+{
+	uint64_t s_main_tsc = __main_tsc - __start_tsc;
+	int rc = TC_PASS;
+	struct device *last;
+
+	TC_START("Device Lookup Boot Time");
+
+#ifdef CONFIG_DEVICE_LOOKUP_HASH
+	TC_PRINT("Lookup: hash table of %d slots\n",
+		 CONFIG_DEVICE_LOOKUP_HASH_SIZE);
+#else
+	TC_PRINT("Lookup: linear search\n");
+#endif
+	TC_PRINT("Devices: %d\n", NUM_DEVICES);
+
+	if (bind_failures) {
+		TC_ERROR("%d devices failed to bind\n", bind_failures);
+		rc = TC_FAIL;
+	}
+
+	last = device_get_binding("dev_3333");
+	if (!last || device_from_handle(device_handle_get(last)) != last) {
+		TC_ERROR("cannot find the last device\n");
+		rc = TC_FAIL;
+	}
+
+	if (device_get_binding("dev_missing")) {
+		TC_ERROR("found a device that does not exist\n");
+		rc = TC_FAIL;
+	}
+
+	TC_PRINT("_start->main()    : %u cycles, %u us\n",
+		 (uint32_t)s_main_tsc,
+		 (uint32_t)(s_main_tsc / CONFIG_CPU_CLOCK_FREQ_MHZ));
+	TC_PRINT("lookup first      : %u cycles\n", lookup_cycles("dev_0000"));
+	TC_PRINT("lookup last       : %u cycles\n", lookup_cycles("dev_3333"));
+	TC_PRINT("lookup missing    : %u cycles\n",
+		 lookup_cycles("dev_missing"));
+	if (last) {
+		TC_PRINT("handle to device  : %u cycles\n",
+			 handle_cycles(device_handle_get(last)));
+	}
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures how long printk() blocks its caller with the console output sent
+ * by polling the UART, or buffered and sent from the UART transmit interrupt.
+ *
+ * - A high priority thread prints lines of 64 characters, pausing between
+ *   lines so that the output buffer never fills up; the cycles spent in each
+ *   printk() call are measured.
+ * - A high priority thread wakes up every tick while a low priority thread
+ *   prints continuously; the intervals between its wake-ups are measured.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define STACKSIZE 1024
+#define NUM_LINES 16
+#define NUM_WAKEUPS 64
+
+/* long enough for a line to be sent between two samples */
+#define PAUSE_MS 50
+
+#define LINE "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ-\n"
+
+static char __stack printer_stack[STACKSIZE];
+static volatile int printer_stop;
+
+static void printer(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (int i = 0; !printer_stop; i++) {
+		printk("background line %d: " LINE, i);
+	}
+}
+
+static void measure_printk(void)
+{
+	uint32_t total = 0, worst = 0;
+
+	for (int i = 0; i < NUM_LINES; i++) {
+		uint32_t start = k_cycle_get_32();
+		uint32_t cycles;
+
+		printk(LINE);
+
+		cycles = k_cycle_get_32() - start;
+		total += cycles;
+		worst = max(worst, cycles);
+
+		k_sleep(PAUSE_MS);
+	}
+
+	TC_PRINT("printk of %u characters: %u cycles average, %u worst\n",
+		 sizeof(LINE) - 1, total / NUM_LINES, worst);
+}
+
+static void measure_wakeups(void)
+{
+	uint32_t total = 0, worst = 0;
+	uint32_t last;
+	k_tid_t tid;
+
+	printer_stop = 0;
+	tid = k_thread_spawn(printer_stack, STACKSIZE, printer,
+			     NULL, NULL, NULL,
+			     K_LOWEST_APPLICATION_THREAD_PRIO, 0, 0);
+
+	/* let the printer fill the output buffer */
+	k_sleep(PAUSE_MS);
+
+	last = k_cycle_get_32();
+	for (int i = 0; i < NUM_WAKEUPS; i++) {
+		uint32_t now;
+
+		k_sleep(1);
+
+		now = k_cycle_get_32();
+		total += now - last;
+		worst = max(worst, now - last);
+		last = now;
+	}
+
+	printer_stop = 1;
+	k_thread_abort(tid);
+
+	/* flush the rest of the background output */
+	k_sleep(10 * PAUSE_MS);
+
+	TC_PRINT("\nwake-ups every 1 ms under console load: "
+		 "%u cycles average interval, %u worst\n",
+		 total / NUM_WAKEUPS, worst);
+}
+
+void main(void)
+{
+	TC_START("Console output blocking time");
+
+	k_thread_priority_set(k_current_get(), 0);
+
+#if defined(CONFIG_UART_CONSOLE_TX_OVERFLOW_DROP)
+	TC_PRINT("console output: buffered, drop on overflow\n");
+#elif defined(CONFIG_UART_CONSOLE_TX_BUFFERED)
+	TC_PRINT("console output: buffered, block on overflow\n");
+#else
+	TC_PRINT("console output: polled\n");
+#endif
+	TC_PRINT("1000 cycles = %u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(1000));
+
+	measure_printk();
+	measure_wakeups();
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the time taken by context switches:
+ *  - between two threads of the same priority yielding to each other
+ *  - to a higher priority thread pending on a semaphore, and back
+ *
+ * Building with CONFIG_THREAD_RUNTIME_STATS=y measures the overhead of the
+ * runtime accounting, which is done on every context switch.
+ *
+ * The threads run at the lowest application priorities, so that finding the
+ * next thread to run has to go through the last ready queue bitmap. Building
+ * with different numbers of priorities shows that the cost does not depend on
+ * it.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define STACKSIZE 512
+#define NUM_SAMPLES 1000
+
+static K_SEM_DEFINE(sem, 0, 1);
+static char __stack helper_stack[STACKSIZE];
+
+static void yield_helper(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_yield();
+	}
+}
+
+static void sem_helper(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&sem, K_FOREVER);
+	}
+}
+
+/* returns the average time of one yield, from one thread to the other */
+static uint32_t measure_yield(void)
+{
+	k_tid_t tid;
+	uint32_t start, end;
+
+	tid = k_thread_spawn(helper_stack, STACKSIZE, yield_helper,
+			     NULL, NULL, NULL,
+			     k_thread_priority_get(k_current_get()), 0, 0);
+
+	/* let the helper start */
+	k_yield();
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		k_yield();
+	}
+	end = k_cycle_get_32();
+
+	k_thread_abort(tid);
+
+	/* each iteration switches to the helper and back */
+	return (end - start) / (2 * NUM_SAMPLES);
+}
+
+/* returns the average time of one semaphore round trip */
+static uint32_t measure_sem_round_trip(void)
+{
+	k_tid_t tid;
+	uint32_t start, end;
+
+	tid = k_thread_spawn(helper_stack, STACKSIZE, sem_helper,
+			     NULL, NULL, NULL,
+			     k_thread_priority_get(k_current_get()) - 1, 0, 0);
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		k_sem_give(&sem);
+	}
+	end = k_cycle_get_32();
+
+	k_thread_abort(tid);
+
+	return (end - start) / NUM_SAMPLES;
+}
+
+void main(void)
+{
+	TC_START("Context switch time");
+
+	k_thread_priority_set(k_current_get(), K_LOWEST_APPLICATION_THREAD_PRIO);
+
+#if defined(CONFIG_THREAD_RUNTIME_STATS)
+	TC_PRINT("runtime statistics: enabled\n");
+#else
+	TC_PRINT("runtime statistics: disabled\n");
+#endif
+	TC_PRINT("priorities: %d coop, %d preemptible\n",
+		 CONFIG_NUM_COOP_PRIORITIES, CONFIG_NUM_PREEMPT_PRIORITIES);
+	TC_PRINT("1000 cycles = %u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(1000));
+
+	TC_PRINT("yield to thread of same priority: %u cycles\n",
+		 measure_yield());
+	TC_PRINT("semaphore round trip to higher priority thread: %u cycles\n",
+		 measure_sem_round_trip());
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the cost of recording events in the kernel trace stream: directly
+ * with sys_k_trace_user(), and through the kernel hooks with a semaphore
+ * round trip to a higher priority thread. The trace buffer is drained between
+ * batches of samples, so that events are never dropped.
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/kernel_trace.h>
+
+#define STACKSIZE 512
+#define NUM_SAMPLES 1000
+
+/* small enough for a batch of round trips to fit in the trace buffer */
+#define BATCH_SIZE 100
+
+static K_SEM_DEFINE(sem, 0, 1);
+static char __stack helper_stack[STACKSIZE];
+
+#ifdef CONFIG_KERNEL_TRACE_SINK_RAM
+static uint32_t records[CONFIG_KERNEL_TRACE_BUFFER_SIZE];
+static int num_user_events;
+static uint32_t read_cycles;
+static int num_records;
+
+/*
+ * Read all the records in the trace buffer, checking that they are well
+ * formed and in timestamp order.
+ */
+static void drain(void)
+{
+	uint32_t start = k_cycle_get_32();
+	int words = sys_k_trace_read(records, sizeof(records)) / 4;
+	uint32_t last = 0;
+
+	read_cycles += k_cycle_get_32() - start;
+
+	for (int i = 0; i < words; ) {
+		uint32_t hdr = records[i];
+		uint32_t len = K_TRACE_HDR_LEN(hdr);
+
+		if (len < 2 || i + len > words) {
+			CHECK(0, "invalid record header 0x%x\n", hdr);
+			return;
+		}
+
+		CHECK(K_TRACE_HDR_TYPE(hdr) != K_TRACE_DROPPED,
+		      "events dropped\n");
+		CHECK(i == 0 || (int32_t)(records[i + 1] - last) >= 0,
+		      "records not in timestamp order\n");
+
+		if (K_TRACE_HDR_TYPE(hdr) == K_TRACE_USER) {
+			num_user_events++;
+		}
+
+		last = records[i + 1];
+		num_records++;
+		i += len;
+	}
+}
+#else
+#define drain() do { } while (0)
+#endif
+
+static void sem_helper(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&sem, K_FOREVER);
+	}
+}
+
+#ifdef CONFIG_KERNEL_TRACE
+/* returns the average time to record an application event */
+static uint32_t measure_user_event(void)
+{
+	uint32_t cycles = 0;
+
+	drain();
+
+	for (int i = 0; i < NUM_SAMPLES; i += BATCH_SIZE) {
+		uint32_t start = k_cycle_get_32();
+
+		for (int j = 0; j < BATCH_SIZE; j++) {
+			sys_k_trace_user(1, j);
+		}
+
+		cycles += k_cycle_get_32() - start;
+		drain();
+	}
+
+	return cycles / NUM_SAMPLES;
+}
+#endif
+
+/* returns the average time of one semaphore round trip */
+static uint32_t measure_sem_round_trip(void)
+{
+	uint32_t cycles = 0;
+	k_tid_t tid;
+
+	tid = k_thread_spawn(helper_stack, STACKSIZE, sem_helper,
+			     NULL, NULL, NULL,
+			     k_thread_priority_get(k_current_get()) - 1, 0, 0);
+
+	drain();
+
+	for (int i = 0; i < NUM_SAMPLES; i += BATCH_SIZE) {
+		uint32_t start = k_cycle_get_32();
+
+		for (int j = 0; j < BATCH_SIZE; j++) {
+			k_sem_give(&sem);
+		}
+
+		cycles += k_cycle_get_32() - start;
+		drain();
+	}
+
+	k_thread_abort(tid);
+
+	return cycles / NUM_SAMPLES;
+}
+
+void main(void)
+{
+	TC_START("Kernel trace stream overhead");
+
+	k_thread_priority_set(k_current_get(), K_LOWEST_APPLICATION_THREAD_PRIO);
+
+#if defined(CONFIG_KERNEL_TRACE_SINK_RAM)
+	TC_PRINT("kernel trace: RAM\n");
+#elif defined(CONFIG_KERNEL_TRACE_SINK_UART)
+	TC_PRINT("kernel trace: UART\n");
+#else
+	TC_PRINT("kernel trace: disabled\n");
+#endif
+	TC_PRINT("1000 cycles = %u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(1000));
+
+#ifdef CONFIG_KERNEL_TRACE
+	TC_PRINT("record application event: %u cycles\n",
+		 measure_user_event());
+#endif
+	TC_PRINT("semaphore round trip to higher priority thread: %u cycles\n",
+		 measure_sem_round_trip());
+
+#ifdef CONFIG_KERNEL_TRACE_SINK_RAM
+	TC_PRINT("read back: %u cycles per record\n",
+		 num_records ? read_cycles / num_records : 0);
+	CHECK(num_user_events == NUM_SAMPLES,
+	      "%d application events read back, expected %d\n",
+	      num_user_events, NUM_SAMPLES);
+#endif
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the latency of memory pool allocations and frees, for a simple
+ * workload and for a fragmentation-heavy one.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+#include <string.h>
+
+#define MIN_SIZE 16
+#define MAX_SIZE 4096
+#define NUM_MAX_BLOCKS 4
+
+#define NUM_SLOTS 64
+#define NUM_OPS 20000
+
+#ifdef CONFIG_MEM_POOL_BUDDY
+#define POOL_TYPE "buddy"
+#else
+#define POOL_TYPE "quad-block"
+#endif
+
+K_MEM_POOL_DEFINE(pool, MIN_SIZE, MAX_SIZE, NUM_MAX_BLOCKS, 4);
+
+static struct k_mem_block blocks[NUM_SLOTS];
+static uint8_t allocated[NUM_SLOTS];
+
+struct stats {
+	uint32_t count;
+	uint32_t failures;
+	uint64_t total;
+	uint32_t max;
+};
+
+static uint32_t seed = 12345;
+
+/* deterministic pseudo-random numbers, so that both builds do the same work */
+static uint32_t rand32(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+
+/* mostly small blocks, with some large ones to break up the pool */
+static size_t random_size(void)
+{
+	uint32_t r = rand32();
+
+	if ((r & 0x7) == 0) {
+		return MIN_SIZE + (r >> 3) % (MAX_SIZE / 2);
+	}
+
+	return MIN_SIZE / 2 + (r >> 3) % (MIN_SIZE * 8);
+}
+
+static void record(struct stats *stats, uint32_t cycles)
+{
+	stats->count++;
+	stats->total += cycles;
+	if (cycles > stats->max) {
+		stats->max = cycles;
+	}
+}
+
+static void print_stats(const char *name, struct stats *stats)
+{
+	TC_PRINT("%-8s | %10u %10u %10u %10u\n", name, stats->count,
+		 stats->failures,
+		 stats->count ? (uint32_t)(stats->total / stats->count) : 0,
+		 stats->max);
+}
+
+static void measure_simple(struct stats *alloc_stats, struct stats *free_stats)
+{
+	uint32_t start;
+
+	for (int i = 0; i < NUM_OPS / 2; i++) {
+		start = k_cycle_get_32();
+		k_mem_pool_alloc(&pool, &blocks[0], MIN_SIZE, K_NO_WAIT);
+		record(alloc_stats, k_cycle_get_32() - start);
+
+		start = k_cycle_get_32();
+		k_mem_pool_free(&blocks[0]);
+		record(free_stats, k_cycle_get_32() - start);
+	}
+}
+
+static void measure_fragmented(struct stats *alloc_stats, struct stats *free_stats)
+{
+	uint32_t start, cycles;
+	int slot, rc;
+
+	for (int i = 0; i < NUM_OPS; i++) {
+		slot = rand32() % NUM_SLOTS;
+
+		if (allocated[slot]) {
+			start = k_cycle_get_32();
+			k_mem_pool_free(&blocks[slot]);
+			record(free_stats, k_cycle_get_32() - start);
+			allocated[slot] = 0;
+			continue;
+		}
+
+		start = k_cycle_get_32();
+		rc = k_mem_pool_alloc(&pool, &blocks[slot], random_size(),
+				      K_NO_WAIT);
+		cycles = k_cycle_get_32() - start;
+
+		if (rc == 0) {
+			record(alloc_stats, cycles);
+			allocated[slot] = 1;
+		} else {
+			alloc_stats->failures++;
+		}
+	}
+
+	for (slot = 0; slot < NUM_SLOTS; slot++) {
+		if (allocated[slot]) {
+			k_mem_pool_free(&blocks[slot]);
+		}
+	}
+}
+
+void main(void)
+{
+	struct stats alloc_stats = { 0 }, free_stats = { 0 };
+
+	TC_START("Memory pool allocation latency");
+
+	TC_PRINT("%s memory pool, %d byte to %d byte blocks\n",
+		 POOL_TYPE, MIN_SIZE, MAX_SIZE);
+
+	TC_PRINT("%-8s | %10s %10s %10s %10s\n", "cycles", "count", "failures",
+		 "average", "max");
+
+	measure_simple(&alloc_stats, &free_stats);
+	TC_PRINT("simple workload\n");
+	print_stats("alloc", &alloc_stats);
+	print_stats("free", &free_stats);
+
+	memset(&alloc_stats, 0, sizeof(alloc_stats));
+	memset(&free_stats, 0, sizeof(free_stats));
+
+	measure_fragmented(&alloc_stats, &free_stats);
+	TC_PRINT("fragmentation-heavy workload\n");
+	print_stats("alloc", &alloc_stats);
+	print_stats("free", &free_stats);
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the number of memory slab allocation/free pairs per second, with
+ * and without per-thread caches, for several numbers of threads.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define MAX_THREADS 16
+#define STACKSIZE 512
+#define THREAD_PRIO (CONFIG_MAIN_THREAD_PRIORITY - 1)
+
+#define BLOCK_SIZE 32
+#define BURST 4
+#define CACHE_CAPACITY 8
+#define NUM_BLOCKS (MAX_THREADS * (BURST + CACHE_CAPACITY))
+#define NUM_PAIRS 32768
+
+K_MEM_SLAB_DEFINE(slab, BLOCK_SIZE, NUM_BLOCKS, 4);
+K_SEM_DEFINE(done_sem, 0, MAX_THREADS);
+
+static char __stack stacks[MAX_THREADS][STACKSIZE];
+static struct k_mem_slab_cache caches[MAX_THREADS];
+
+static const int num_threads[] = { 1, 4, 16 };
+
+enum mode {
+	DIRECT,
+	CACHED,
+};
+
+static void worker(void *p1, void *p2, void *p3)
+{
+	enum mode mode = (enum mode)p1;
+	struct k_mem_slab_cache *cache = p2;
+	int num_bursts = (int)p3;
+	void *blocks[BURST];
+	int i;
+
+	while (num_bursts-- > 0) {
+		for (i = 0; i < BURST; i++) {
+			if (mode == CACHED) {
+				k_mem_slab_cache_alloc(cache, &blocks[i],
+						       K_FOREVER);
+			} else {
+				k_mem_slab_alloc(&slab, &blocks[i],
+						 K_FOREVER);
+			}
+		}
+		for (i = 0; i < BURST; i++) {
+			if (mode == CACHED) {
+				k_mem_slab_cache_free(cache, &blocks[i]);
+			} else {
+				k_mem_slab_free(&slab, &blocks[i]);
+			}
+		}
+	}
+
+	if (mode == CACHED) {
+		k_mem_slab_cache_flush(cache);
+	}
+
+	k_sem_give(&done_sem);
+}
+
+/*
+ * Have @a threads threads do NUM_PAIRS allocation/free pairs in total, and
+ * return the number of pairs per second.
+ */
+static uint32_t measure(enum mode mode, int threads)
+{
+	int num_bursts = NUM_PAIRS / BURST / threads;
+	uint32_t start, cycles;
+	int i;
+
+	start = k_cycle_get_32();
+
+	/*
+	 * The threads have a higher priority than main: raise main above them
+	 * while spawning them, so that they only start once they are all
+	 * spawned and share the CPU. Main then only resumes once they have
+	 * all finished.
+	 */
+	k_thread_priority_set(k_current_get(), THREAD_PRIO - 1);
+	for (i = 0; i < threads; i++) {
+		k_mem_slab_cache_init(&caches[i], &slab, CACHE_CAPACITY);
+		k_thread_spawn(stacks[i], STACKSIZE, worker, (void *)mode,
+			       &caches[i], (void *)num_bursts, THREAD_PRIO,
+			       0, 0);
+	}
+	k_thread_priority_set(k_current_get(), CONFIG_MAIN_THREAD_PRIORITY);
+
+	for (i = 0; i < threads; i++) {
+		k_sem_take(&done_sem, K_FOREVER);
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (uint32_t)(((uint64_t)NUM_PAIRS *
+			   sys_clock_hw_cycles_per_tick *
+			   sys_clock_ticks_per_sec) / cycles);
+}
+
+/* hit rate of the caches' allocations, in percent */
+static uint32_t hit_rate(int threads)
+{
+	struct k_mem_slab_cache_stats stats;
+	uint32_t hits = 0, total = 0;
+
+	for (int i = 0; i < threads; i++) {
+		k_mem_slab_cache_stats_get(&caches[i], &stats);
+		hits += stats.alloc_hits;
+		total += stats.alloc_hits + stats.alloc_misses;
+	}
+
+	return total ? hits * 100 / total : 0;
+}
+
+void main(void)
+{
+	uint32_t direct, cached;
+
+	TC_START("Memory slab cache throughput");
+
+	TC_PRINT("alloc/free pairs per second, bursts of %d blocks, "
+		 "caches of %d blocks\n", BURST, CACHE_CAPACITY);
+	TC_PRINT("%7s | %10s %10s %8s\n", "threads", "direct", "cached",
+		 "hit rate");
+
+	for (int i = 0; i < ARRAY_SIZE(num_threads); i++) {
+		direct = measure(DIRECT, num_threads[i]);
+		cached = measure(CACHED, num_threads[i]);
+		TC_PRINT("%7d | %10u %10u %7u%%\n", num_threads[i], direct,
+			 cached, hit_rate(num_threads[i]));
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
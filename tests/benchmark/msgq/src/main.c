@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the message queue throughput, in messages per second, of the
+ * per-message, batch and single-producer/single-consumer routines.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define MAX_MSGS 64
+#define MAX_MSG_SIZE 32
+#define BATCH_SIZE 16
+#define NUM_ROUNDS 100
+
+static char __aligned(4) buffer[MAX_MSGS * MAX_MSG_SIZE];
+static char __aligned(4) msgs[BATCH_SIZE * MAX_MSG_SIZE];
+static struct k_msgq msgq;
+
+static const size_t msg_sizes[] = { 4, 8, 16, 32 };
+
+enum mode {
+	SINGLE,
+	BATCH,
+	SPSC,
+};
+
+/*
+ * Transfer NUM_ROUNDS * BATCH_SIZE messages, BATCH_SIZE at a time, and
+ * return the number of messages transferred per second.
+ */
+static uint32_t measure(enum mode mode, size_t msg_size)
+{
+	uint32_t start, cycles;
+
+	k_msgq_init(&msgq, buffer, msg_size, MAX_MSGS);
+
+	start = k_cycle_get_32();
+
+	for (int round = 0; round < NUM_ROUNDS; round++) {
+		switch (mode) {
+		case SINGLE:
+			for (int i = 0; i < BATCH_SIZE; i++) {
+				k_msgq_put(&msgq, &msgs[i * msg_size],
+					   K_NO_WAIT);
+			}
+			for (int i = 0; i < BATCH_SIZE; i++) {
+				k_msgq_get(&msgq, &msgs[i * msg_size],
+					   K_NO_WAIT);
+			}
+			break;
+		case BATCH:
+			k_msgq_put_many(&msgq, msgs, BATCH_SIZE);
+			k_msgq_get_many(&msgq, msgs, BATCH_SIZE);
+			break;
+		case SPSC:
+			for (int i = 0; i < BATCH_SIZE; i++) {
+				k_msgq_spsc_put(&msgq, &msgs[i * msg_size]);
+			}
+			for (int i = 0; i < BATCH_SIZE; i++) {
+				k_msgq_spsc_get(&msgq, &msgs[i * msg_size]);
+			}
+			break;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (uint32_t)(((uint64_t)NUM_ROUNDS * BATCH_SIZE *
+			   sys_clock_hw_cycles_per_tick *
+			   sys_clock_ticks_per_sec) / cycles);
+}
+
+void main(void)
+{
+	TC_START("Message queue throughput");
+
+	TC_PRINT("messages per second, %d messages per batch\n", BATCH_SIZE);
+	TC_PRINT("%8s | %10s %10s %10s\n", "msg size", "single", "batch",
+		 "spsc");
+
+	for (int i = 0; i < ARRAY_SIZE(msg_sizes); i++) {
+		TC_PRINT("%8u | %10u %10u %10u\n", msg_sizes[i],
+			 measure(SINGLE, msg_sizes[i]),
+			 measure(BATCH, msg_sizes[i]),
+			 measure(SPSC, msg_sizes[i]));
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
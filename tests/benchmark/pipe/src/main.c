@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the pipe throughput, in kilobytes per second, of the copying
+ * routines and of the zero-copy claim routines, for several chunk sizes.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define PIPE_SIZE 1024
+#define MAX_CHUNK_SIZE 512
+#define BYTES_PER_SIZE (64 * 1024)
+
+K_PIPE_DEFINE(pipe, PIPE_SIZE, 4);
+
+static unsigned char __aligned(4) chunk[MAX_CHUNK_SIZE];
+
+static const size_t chunk_sizes[] = { 16, 64, 256, 512 };
+
+enum mode {
+	COPY,
+	CLAIM,
+};
+
+static void put_chunk(enum mode mode, size_t chunk_size)
+{
+	unsigned char *data;
+	size_t bytes;
+
+	if (mode == COPY) {
+		k_pipe_put(&pipe, chunk, chunk_size, &bytes, chunk_size,
+			   K_NO_WAIT);
+		return;
+	}
+
+	while (chunk_size > 0) {
+		bytes = k_pipe_put_claim(&pipe, &data, chunk_size);
+		/* a producer would build its data in place here */
+		data[0] = (unsigned char)bytes;
+		k_pipe_put_finish(&pipe, bytes);
+		chunk_size -= bytes;
+	}
+}
+
+static void get_chunk(enum mode mode, size_t chunk_size)
+{
+	unsigned char *data;
+	size_t bytes;
+
+	if (mode == COPY) {
+		k_pipe_get(&pipe, chunk, chunk_size, &bytes, chunk_size,
+			   K_NO_WAIT);
+		return;
+	}
+
+	while (chunk_size > 0) {
+		bytes = k_pipe_get_claim(&pipe, &data, chunk_size);
+		/* a consumer would process its data in place here */
+		chunk[0] = data[0];
+		k_pipe_get_finish(&pipe, bytes);
+		chunk_size -= bytes;
+	}
+}
+
+/*
+ * Transfer BYTES_PER_SIZE bytes through the pipe, one chunk at a time, and
+ * return the number of kilobytes transferred per second.
+ */
+static uint32_t measure(enum mode mode, size_t chunk_size)
+{
+	uint32_t start, cycles;
+
+	start = k_cycle_get_32();
+
+	for (size_t i = 0; i < BYTES_PER_SIZE / chunk_size; i++) {
+		put_chunk(mode, chunk_size);
+		get_chunk(mode, chunk_size);
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	return (uint32_t)(((uint64_t)(BYTES_PER_SIZE / 1024) *
+			   sys_clock_hw_cycles_per_tick *
+			   sys_clock_ticks_per_sec) / cycles);
+}
+
+void main(void)
+{
+	TC_START("Pipe throughput");
+
+	/* offset the indexes, so that some chunks wrap around the buffer */
+	put_chunk(COPY, 8);
+	get_chunk(COPY, 8);
+
+	TC_PRINT("kilobytes per second, %d byte ring buffer\n", PIPE_SIZE);
+	TC_PRINT("%10s | %10s %10s\n", "chunk size", "copy", "claim");
+
+	for (int i = 0; i < ARRAY_SIZE(chunk_sizes); i++) {
+		TC_PRINT("%10u | %10u %10u\n", chunk_sizes[i],
+			 measure(COPY, chunk_sizes[i]),
+			 measure(CLAIM, chunk_sizes[i]));
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Compares waiting on several kernel objects with a polling loop against
+ * waiting with k_poll(): wake-up latency, and number of times the consumer
+ * thread runs per event received.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define STACKSIZE 1024
+#define CONSUMER_PRIO 1
+#define PRODUCER_PRIO 2
+
+#define NUM_EVENTS 60
+#define PRODUCER_PERIOD_MS 20
+#define POLLING_PERIOD_MS 1
+
+struct fifo_msg {
+	void *private;
+	uint32_t msg;
+};
+
+static K_SEM_DEFINE(sem, 0, NUM_EVENTS);
+static K_FIFO_DEFINE(fifo);
+K_MSGQ_DEFINE(msgq, sizeof(uint32_t), NUM_EVENTS, 4);
+static K_SEM_DEFINE(done, 0, 1);
+
+static struct fifo_msg fifo_msgs[NUM_EVENTS];
+
+static char __stack producer_stack[STACKSIZE];
+static char __stack consumer_stack[STACKSIZE];
+
+/* time at which the last event was produced */
+static volatile uint32_t produced_at;
+
+struct result {
+	uint32_t wakeups;
+	uint32_t latency_total;
+	uint32_t latency_max;
+};
+
+static void producer(void *p1, void *p2, void *p3)
+{
+	uint32_t msg = 0;
+
+	for (int i = 0; i < NUM_EVENTS; i++) {
+		k_sleep(PRODUCER_PERIOD_MS);
+
+		produced_at = k_cycle_get_32();
+
+		switch (i % 3) {
+		case 0:
+			k_sem_give(&sem);
+			break;
+		case 1:
+			k_fifo_put(&fifo, &fifo_msgs[i]);
+			break;
+		default:
+			k_msgq_put(&msgq, &msg, K_NO_WAIT);
+			break;
+		}
+	}
+}
+
+/* take whatever is available; returns the number of events consumed */
+static int consume(void)
+{
+	uint32_t msg;
+	int num = 0;
+
+	num += k_sem_take(&sem, K_NO_WAIT) == 0;
+	num += k_fifo_get(&fifo, K_NO_WAIT) != NULL;
+	num += k_msgq_get(&msgq, &msg, K_NO_WAIT) == 0;
+
+	return num;
+}
+
+static void record(struct result *result)
+{
+	uint32_t latency = k_cycle_get_32() - produced_at;
+
+	result->latency_total += latency;
+	result->latency_max = max(result->latency_max, latency);
+}
+
+static void polling_loop_consumer(void *p1, void *p2, void *p3)
+{
+	struct result *result = p1;
+	int received = 0;
+
+	while (received < NUM_EVENTS) {
+		int num = consume();
+
+		result->wakeups++;
+
+		if (num) {
+			record(result);
+			received += num;
+		} else {
+			k_sleep(POLLING_PERIOD_MS);
+		}
+	}
+
+	k_sem_give(&done);
+}
+
+static void k_poll_consumer(void *p1, void *p2, void *p3)
+{
+	struct result *result = p1;
+	int received = 0;
+	struct k_poll_event events[] = {
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SEM_AVAILABLE, &sem),
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_FIFO_DATA_AVAILABLE,
+					 &fifo),
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_MSGQ_DATA_AVAILABLE,
+					 &msgq),
+	};
+
+	while (received < NUM_EVENTS) {
+		k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+
+		result->wakeups++;
+
+		int num = consume();
+
+		if (num) {
+			record(result);
+			received += num;
+		}
+	}
+
+	k_sem_give(&done);
+}
+
+static void run(const char *name, k_thread_entry_t consumer)
+{
+	struct result result = { 0 };
+
+	k_thread_spawn(consumer_stack, STACKSIZE, consumer,
+		       &result, NULL, NULL, CONSUMER_PRIO, 0, K_NO_WAIT);
+	k_thread_spawn(producer_stack, STACKSIZE, producer,
+		       NULL, NULL, NULL, PRODUCER_PRIO, 0, K_NO_WAIT);
+
+	k_sem_take(&done, K_FOREVER);
+
+	TC_PRINT("%-14s | %10u %10u | %10u\n", name,
+		 result.latency_total / NUM_EVENTS, result.latency_max,
+		 result.wakeups);
+}
+
+void main(void)
+{
+	TC_START("Multi-object wait");
+
+	TC_PRINT("%d events, 1000 cycles = %u ns\n", NUM_EVENTS,
+		 SYS_CLOCK_HW_CYCLES_TO_NS(1000));
+	TC_PRINT("%-14s | %10s %10s | %10s\n", "method",
+		 "lat. avg", "lat. max", "wakeups");
+
+	run("polling loop", polling_loop_consumer);
+
+	/* let the producer thread of the previous run terminate */
+	k_sleep(PRODUCER_PERIOD_MS);
+
+	run("k_poll", k_poll_consumer);
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
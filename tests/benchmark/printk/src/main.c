@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the number of cycles the calling thread spends in printk() and in
+ * the SYS_LOG macros, for a few kinds of messages. With the synchronous
+ * printk(), this includes formatting the message and sending it to the
+ * console; with CONFIG_PRINTK_DEFERRED, it is only the cost of recording the
+ * message. The calls are made in batches, with a pause in between for the
+ * deferred output thread to empty the buffer.
+ */
+
+#define SYS_LOG_DOMAIN "bench"
+#define SYS_LOG_LEVEL SYS_LOG_LEVEL_INFO
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/printk.h>
+#include <misc/sys_log.h>
+#include <misc/util.h>
+
+#define NUM_SAMPLES 64
+
+/* small enough for a batch of messages to fit in the deferred buffer */
+#define BATCH_SIZE 16
+
+/* long enough for the deferred output thread to output a batch */
+#define PAUSE_MS 100
+
+enum {
+	MSG_CONSTANT,
+	MSG_INTEGERS,
+	MSG_STRINGS,
+	MSG_SYS_LOG,
+	NUM_MSGS
+};
+
+static const char * const msg_names[NUM_MSGS] = {
+	"printk, no argument",
+	"printk, 3 integers",
+	"printk, 2 strings",
+	"SYS_LOG_INF, 1 integer",
+};
+
+static void log_message(int msg, int i)
+{
+	/* not part of the image: copied with a deferred printk() */
+	char name[] = "stack";
+
+	switch (msg) {
+	case MSG_CONSTANT:
+		printk("benchmark message\n");
+		break;
+	case MSG_INTEGERS:
+		printk("%d %u %x\n", -i, i, i);
+		break;
+	case MSG_STRINGS:
+		printk("%s %s\n", "image", name);
+		break;
+	case MSG_SYS_LOG:
+		SYS_LOG_INF("value %d", i);
+		break;
+	}
+}
+
+/* returns the average number of cycles per message */
+static uint32_t measure(int msg)
+{
+	uint32_t cycles = 0;
+
+	for (int i = 0; i < NUM_SAMPLES; i += BATCH_SIZE) {
+		uint32_t start = k_cycle_get_32();
+
+		for (int j = 0; j < BATCH_SIZE; j++) {
+			log_message(msg, i + j);
+		}
+
+		cycles += k_cycle_get_32() - start;
+		k_sleep(PAUSE_MS);
+	}
+
+	return cycles / NUM_SAMPLES;
+}
+
+void main(void)
+{
+	uint32_t results[NUM_MSGS];
+
+	TC_START("printk cost per call");
+
+	for (int i = 0; i < NUM_MSGS; i++) {
+		results[i] = measure(i);
+	}
+
+#ifdef CONFIG_PRINTK_DEFERRED
+	TC_PRINT("printk: deferred\n");
+#else
+	TC_PRINT("printk: synchronous\n");
+#endif
+	TC_PRINT("1000 cycles = %u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(1000));
+
+	for (int i = 0; i < NUM_MSGS; i++) {
+		TC_PRINT("%s: %u cycles\n", msg_names[i], results[i]);
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the number of cycles taken by memcpy(), memmove() and memset() for
+ * sizes from 1 byte to 4 KiB, at every combination of source and destination
+ * offset within a word. memmove() is measured both on disjoint buffers and
+ * with the destination overlapping the end of the source, which forces a
+ * backward copy.
+ *
+ * The results of each copy are checked, so that the benchmark also catches
+ * gross errors in the routines.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+#include <string.h>
+
+#define MAX_SIZE 4096
+#define WORD_SIZE sizeof(unsigned int)
+
+/* total number of bytes copied for each measurement */
+#define BYTES_PER_SAMPLE (16 * 1024)
+
+static const size_t sizes[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+
+/* large enough for the overlapping memmove() */
+static unsigned char src[2 * MAX_SIZE + 2 * WORD_SIZE];
+static unsigned char dst[MAX_SIZE + WORD_SIZE];
+
+static int tc_rc = TC_PASS;
+
+static void check_copy(const char *name, const unsigned char *d,
+		       const unsigned char *expected, size_t n)
+{
+	if (memcmp(d, expected, n) != 0) {
+		TC_ERROR("%s() of %u bytes is incorrect\n", name, n);
+		tc_rc = TC_FAIL;
+	}
+}
+
+static void fill_source(void)
+{
+	for (int i = 0; i < sizeof(src); i++) {
+		src[i] = (unsigned char)(i * 13 + 1);
+	}
+}
+
+/* average number of cycles per call of <fn> */
+#define MEASURE(n, fn)						\
+	({							\
+		int _iter = max(BYTES_PER_SAMPLE / (n), 1);	\
+		uint32_t _start = k_cycle_get_32();		\
+								\
+		for (int _i = 0; _i < _iter; _i++) {		\
+			fn;					\
+		}						\
+		(k_cycle_get_32() - _start) / _iter;		\
+	})
+
+static void bench_size(size_t n)
+{
+	uint32_t copy, move, move_back, set;
+
+	for (int d_off = 0; d_off < WORD_SIZE; d_off++) {
+		for (int s_off = 0; s_off < WORD_SIZE; s_off++) {
+			unsigned char *d = dst + d_off;
+			unsigned char *s = src + s_off;
+			unsigned char *back = src + WORD_SIZE + d_off;
+
+			fill_source();
+
+			copy = MEASURE(n, memcpy(d, s, n));
+			check_copy("memcpy", d, s, n);
+
+			move = MEASURE(n, memmove(d, s, n));
+			check_copy("memmove", d, s, n);
+
+			/* overlapping: the source moves up with each call */
+			move_back = MEASURE(n, memmove(back + n / 2, back, n));
+
+			if (s_off == 0) {
+				set = MEASURE(n, memset(d, 0x5a, n));
+
+				TC_PRINT("%6u   %d/%d %10u %10u %10u %10u\n",
+					 n, d_off, s_off, copy, move,
+					 move_back, set);
+			} else {
+				TC_PRINT("%6u   %d/%d %10u %10u %10u\n",
+					 n, d_off, s_off, copy, move,
+					 move_back);
+			}
+		}
+	}
+}
+
+void main(void)
+{
+	TC_START("memcpy/memmove/memset performance");
+
+	TC_PRINT("1000 cycles = %u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(1000));
+	TC_PRINT("average cycles per call, offsets are destination/source\n");
+	TC_PRINT("%6s %5s %10s %10s %10s %10s\n", "size", "align",
+		 "memcpy", "memmove", "overlap", "memset");
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		bench_size(sizes[i]);
+	}
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the cost of arming and cancelling a kernel timer, as a function
+ * of the number of timeouts already pending in the timeout queue. Since the
+ * timeout queue is manipulated with interrupts locked, this is a direct
+ * measure of the interrupt latency added by timeouts.
+ *
+ * The probe timer always expires last, which is the worst case for the delta
+ * list implementation.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define MAX_PENDING 512
+#define NUM_SAMPLES 64
+
+/* long enough that none of the pending timers expire during the test */
+#define PENDING_DURATION_MS 100000
+#define PROBE_DURATION_MS (2 * PENDING_DURATION_MS)
+
+static const int sweep[] = { 0, 1, 16, 64, 128, 256, 512 };
+
+static struct k_timer pending_timers[MAX_PENDING];
+static struct k_timer probe_timer;
+
+struct result {
+	uint32_t avg;
+	uint32_t max;
+};
+
+static void arm_pending_timers(int num)
+{
+	for (int i = 0; i < num; i++) {
+		k_timer_init(&pending_timers[i], NULL, NULL);
+
+		/* spread the expiries so the queue has distinct entries */
+		k_timer_start(&pending_timers[i],
+			      PENDING_DURATION_MS + (i * 7) % 1000, 0);
+	}
+}
+
+static void cancel_pending_timers(int num)
+{
+	for (int i = 0; i < num; i++) {
+		k_timer_stop(&pending_timers[i]);
+	}
+}
+
+static void measure(struct result *start, struct result *stop)
+{
+	uint32_t start_total = 0, stop_total = 0;
+	uint32_t t0, t1, t2;
+
+	start->max = 0;
+	stop->max = 0;
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		t0 = k_cycle_get_32();
+		k_timer_start(&probe_timer, PROBE_DURATION_MS, 0);
+		t1 = k_cycle_get_32();
+		k_timer_stop(&probe_timer);
+		t2 = k_cycle_get_32();
+
+		start_total += t1 - t0;
+		stop_total += t2 - t1;
+
+		start->max = max(start->max, t1 - t0);
+		stop->max = max(stop->max, t2 - t1);
+	}
+
+	start->avg = start_total / NUM_SAMPLES;
+	stop->avg = stop_total / NUM_SAMPLES;
+}
+
+void main(void)
+{
+	struct result start, stop;
+
+	TC_START("Timeout queue latency");
+
+#if defined(CONFIG_TIMEOUT_QUEUE_PAIRING_HEAP)
+	TC_PRINT("timeout queue: pairing heap\n");
+#else
+	TC_PRINT("timeout queue: delta list\n");
+#endif
+	TC_PRINT("1000 cycles = %u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(1000));
+	TC_PRINT("%8s | %10s %10s | %10s %10s\n", "pending",
+		 "start avg", "start max", "stop avg", "stop max");
+
+	k_timer_init(&probe_timer, NULL, NULL);
+
+	for (int i = 0; i < ARRAY_SIZE(sweep); i++) {
+		arm_pending_timers(sweep[i]);
+		measure(&start, &stop);
+		cancel_pending_timers(sweep[i]);
+
+		TC_PRINT("%8d | %10u %10u | %10u %10u\n", sweep[i],
+			 start.avg, start.max, stop.avg, stop.max);
+	}
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
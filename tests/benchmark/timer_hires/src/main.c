@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures how late high-resolution timers expire, how regular a periodic
+ * high-resolution timer is, and the cost of starting and stopping one.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define NUM_SAMPLES 32
+
+struct result {
+	uint32_t min;
+	uint32_t avg;
+	uint32_t max;
+};
+
+static struct k_timer timer;
+static volatile uint32_t last_expiry;
+static volatile uint32_t periods[NUM_SAMPLES];
+static volatile int num_periods;
+
+static void result_init(struct result *r)
+{
+	r->min = UINT32_MAX;
+	r->avg = 0;
+	r->max = 0;
+}
+
+static void result_add(struct result *r, uint32_t sample)
+{
+	r->min = min(r->min, sample);
+	r->max = max(r->max, sample);
+	r->avg += sample;
+}
+
+static void result_print(const char *what, struct result *r)
+{
+	TC_PRINT("%s: min %u avg %u max %u cycles\n",
+		 what, r->min, r->avg / NUM_SAMPLES, r->max);
+}
+
+static void measure_lateness(const char *what, uint32_t us, int ms)
+{
+	uint32_t duration = ms ? k_us_to_cycles(ms * 1000) :
+			    k_us_to_cycles(us);
+	struct result r;
+
+	result_init(&r);
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		uint32_t start;
+
+		/* start right after a tick, as a thread woken by one would */
+		k_sleep(1);
+		start = k_cycle_get_32();
+
+		if (ms) {
+			k_timer_start(&timer, ms, 0);
+		} else {
+			k_timer_start_cycles(&timer, duration, 0);
+		}
+		k_timer_status_sync(&timer);
+
+		result_add(&r, k_cycle_get_32() - start - duration);
+	}
+
+	result_print(what, &r);
+}
+
+static void periodic_expiry(struct k_timer *t)
+{
+	uint32_t now = k_cycle_get_32();
+
+	if (num_periods > 0 && num_periods <= NUM_SAMPLES) {
+		periods[num_periods - 1] = now - last_expiry;
+	}
+	last_expiry = now;
+	num_periods++;
+}
+
+static void measure_period(void)
+{
+	struct result r;
+
+	result_init(&r);
+	num_periods = 0;
+
+	k_timer_init(&timer, periodic_expiry, NULL);
+	k_timer_start_cycles(&timer, k_us_to_cycles(100), k_us_to_cycles(100));
+	while (num_periods <= NUM_SAMPLES) {
+		k_sleep_cycles(k_us_to_cycles(1000));
+	}
+	k_timer_stop(&timer);
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		result_add(&r, periods[i]);
+	}
+
+	TC_PRINT("100 us periodic timer (%u cycles):\n", k_us_to_cycles(100));
+	result_print("  period", &r);
+}
+
+static void measure_overhead(void)
+{
+	uint32_t start_cycles = 0;
+	uint32_t stop_cycles = 0;
+
+	k_timer_init(&timer, NULL, NULL);
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		uint32_t t0, t1, t2;
+
+		t0 = k_cycle_get_32();
+		k_timer_start_cycles(&timer, k_us_to_cycles(100000), 0);
+		t1 = k_cycle_get_32();
+		k_timer_stop(&timer);
+		t2 = k_cycle_get_32();
+
+		start_cycles += t1 - t0;
+		stop_cycles += t2 - t1;
+	}
+
+	TC_PRINT("k_timer_start_cycles(): %u cycles\n",
+		 start_cycles / NUM_SAMPLES);
+	TC_PRINT("k_timer_stop(): %u cycles\n", stop_cycles / NUM_SAMPLES);
+}
+
+void main(void)
+{
+	TC_START("High-resolution timer benchmark");
+
+	TC_PRINT("tick: %d cycles\n", sys_clock_hw_cycles_per_tick);
+
+	k_timer_init(&timer, NULL, NULL);
+
+	TC_PRINT("lateness:\n");
+	measure_lateness("  50 us timer", 50, 0);
+	measure_lateness("  100 us timer", 100, 0);
+	measure_lateness("  1 ms timer", 1000, 0);
+	measure_lateness("  1 ms timer, started in ms", 0, 1);
+
+	measure_period();
+	measure_overhead();
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
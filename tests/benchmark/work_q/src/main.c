@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * Measures the latency percentiles of fast work items mixed with slow ones,
+ * for workqueues with one or several fibers, with and without priority
+ * classes.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+#include <misc/util.h>
+
+#define STACKSIZE 512
+#define WORKER_PRIO (CONFIG_MAIN_THREAD_PRIORITY - 1)
+#define POOL_SIZE 4
+
+#define NUM_FAST 200
+#define SLOW_EVERY 10            /* one slow item every SLOW_EVERY fast ones */
+#define NUM_SLOW 4               /* slow items that can be pending at once */
+#define SUBMIT_PERIOD_US 500
+#define SLOW_DURATION 20         /* milliseconds */
+
+static char __stack stacks[1 + POOL_SIZE][STACKSIZE];
+static struct k_work_q single_work_q;
+static struct k_work_q pool_work_q;
+
+struct fast_item {
+	struct k_work work;
+	uint32_t submitted;
+};
+
+static struct fast_item fast_items[NUM_FAST];
+static struct k_work slow_items[NUM_SLOW];
+static uint32_t latencies[NUM_FAST];
+
+static void fast_handler(struct k_work *work)
+{
+	struct fast_item *item = CONTAINER_OF(work, struct fast_item, work);
+
+	latencies[item - fast_items] = k_cycle_get_32() - item->submitted;
+}
+
+static void slow_handler(struct k_work *work)
+{
+	k_sleep(SLOW_DURATION);
+}
+
+static void sort(uint32_t *values, int num)
+{
+	for (int i = 1; i < num; i++) {
+		uint32_t value = values[i];
+		int j;
+
+		for (j = i; j > 0 && values[j - 1] > value; j--) {
+			values[j] = values[j - 1];
+		}
+		values[j] = value;
+	}
+}
+
+static uint32_t cycles_to_us(uint32_t cycles)
+{
+	return (uint32_t)(((uint64_t)cycles * USEC_PER_SEC) /
+			  (sys_clock_hw_cycles_per_tick *
+			   sys_clock_ticks_per_sec));
+}
+
+static void measure(const char *name, struct k_work_q *work_q, int fast_prio)
+{
+	int i;
+
+	for (i = 0; i < NUM_FAST; i++) {
+		if (i % SLOW_EVERY == 0) {
+			k_work_submit_to_queue(work_q,
+				&slow_items[(i / SLOW_EVERY) % NUM_SLOW]);
+		}
+
+		fast_items[i].submitted = k_cycle_get_32();
+		k_work_submit_to_queue_prio(work_q, &fast_items[i].work,
+					    fast_prio);
+
+		k_busy_wait(SUBMIT_PERIOD_US);
+	}
+
+	/* let the workqueue drain */
+	k_sleep(SLOW_DURATION * NUM_SLOW * 2);
+
+	sort(latencies, NUM_FAST);
+
+	TC_PRINT("%-20s | %8u %8u %8u %8u\n", name,
+		 cycles_to_us(latencies[NUM_FAST / 2]),
+		 cycles_to_us(latencies[NUM_FAST * 9 / 10]),
+		 cycles_to_us(latencies[NUM_FAST * 99 / 100]),
+		 cycles_to_us(latencies[NUM_FAST - 1]));
+}
+
+void main(void)
+{
+	int i;
+
+	TC_START("Workqueue latency");
+
+	for (i = 0; i < NUM_FAST; i++) {
+		k_work_init(&fast_items[i].work, fast_handler);
+	}
+	for (i = 0; i < NUM_SLOW; i++) {
+		k_work_init(&slow_items[i], slow_handler);
+	}
+
+	k_work_q_start(&single_work_q, stacks[0], STACKSIZE, WORKER_PRIO);
+	k_work_q_start_pool(&pool_work_q, stacks[1], STACKSIZE, POOL_SIZE,
+			    WORKER_PRIO);
+
+	TC_PRINT("fast item latency (us), one slow (%d ms) item every %d\n",
+		 SLOW_DURATION, SLOW_EVERY);
+	TC_PRINT("%-20s | %8s %8s %8s %8s\n", "workqueue", "50%", "90%",
+		 "99%", "max");
+
+	measure("1 fiber", &single_work_q, K_WORK_PRIO_DEFAULT);
+	measure("1 fiber, prio", &single_work_q, 0);
+	measure("4 fibers", &pool_work_q, K_WORK_PRIO_DEFAULT);
+	measure("4 fibers, prio", &pool_work_q, 0);
+
+	TC_END_RESULT(TC_PASS);
+	TC_END_REPORT(TC_PASS);
+}
@@ -0,0 +1,48 @@
+/* tc_check.h - non-fatal checks for testcases */
+
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __TC_CHECK_H__
+#define __TC_CHECK_H__
+
+#include <tc_util.h>
+
+/* result of the testcase, to be reported with TC_END_REPORT(tc_rc) */
+static int tc_rc = TC_PASS;
+
+/**
+ * @def CHECK
+ * @brief Report a failed condition and mark the testcase as failed
+ *
+ * Unlike an assertion, the testcase keeps running, so that a single run
+ * reports all the failed conditions.
+ */
+#define CHECK(cond, fmt, ...) do { \
+	if (!(cond)) { \
+		TC_ERROR(fmt, ##__VA_ARGS__); \
+		tc_rc = TC_FAIL; \
+	} \
+} while ((0))
+
+/* convert a duration in milliseconds to hardware clock cycles */
+static inline uint32_t ms_to_cycles(uint32_t ms)
+{
+	return (uint32_t)(((uint64_t)sys_clock_hw_cycles_per_tick *
+			   sys_clock_ticks_per_sec * ms) / MSEC_PER_SEC);
+}
+
+#endif /* __TC_CHECK_H__ */
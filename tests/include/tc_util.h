@@ -31,6 +31,19 @@
 #define PRINT_DATA(fmt, ...) printk(fmt, ##__VA_ARGS__)
 #endif /* CONFIG_STDOUT_CONSOLE */
 
+#if defined(CONFIG_ARCH_POSIX)
+#include <misc/printk.h>
+#include <posix_core.h>
+/* the test runs as a host process: exit with the result of the test */
+#define TC_END_POST(result)		\
+	do {				\
+		printk_flush();		\
+		posix_exit(result);	\
+	} while (0)
+#else
+#define TC_END_POST(result)
+#endif /* CONFIG_ARCH_POSIX */
+
 /**
  * @def TC_PRINT_RUN_ID
  * @brief Report a Run ID
@@ -96,6 +109,7 @@
 		TC_END(result,                                      \
 		       "PROJECT EXECUTION %s\n",               \
 		       (result) == TC_PASS ? "SUCCESSFUL" : "FAILED");	\
+		TC_END_POST(result);                                \
 	} while (0)
 
 #endif /* __TC_UTIL_H__ */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests the interrupt latency histogram: interrupt locking
+ * durations must be accounted to the function that locked interrupts, the
+ * longest ones first, and must show up in the global distribution.
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+#include <misc/debug/int_latency.h>
+
+#define NUM_LONG 5
+#define NUM_SHORT 10
+
+/* a function's code is assumed to fit in this many bytes */
+#define FUNC_SIZE 256
+
+static struct int_latency_site sites[CONFIG_INT_LATENCY_HISTOGRAM_SITES];
+static uint32_t long_cycles;
+
+static void __attribute__((noinline)) long_section(void)
+{
+	unsigned int key = irq_lock();
+	uint32_t start = k_cycle_get_32();
+
+	while (k_cycle_get_32() - start < long_cycles) {
+		/* keep interrupts locked */
+	}
+
+	irq_unlock(key);
+}
+
+static void __attribute__((noinline)) short_section(void)
+{
+	unsigned int key = irq_lock();
+
+	irq_unlock(key);
+}
+
+static int is_in_func(void *pc, void (*func)(void))
+{
+	return (char *)pc >= (char *)func &&
+	       (char *)pc < (char *)func + FUNC_SIZE;
+}
+
+static struct int_latency_site *site_find(int num, void (*func)(void))
+{
+	for (int i = 0; i < num; i++) {
+		if (is_in_func(sites[i].pc, func)) {
+			return &sites[i];
+		}
+	}
+
+	return NULL;
+}
+
+void main(void)
+{
+	struct int_latency_stats all;
+	struct int_latency_site *site;
+	uint32_t bucket_count = 0;
+	int bucket;
+	int num;
+
+	TC_START("Test interrupt latency histogram");
+
+	long_cycles = sys_clock_hw_cycles_per_tick / 10;
+
+	int_latency_init();
+
+	for (int i = 0; i < NUM_LONG; i++) {
+		long_section();
+	}
+
+	for (int i = 0; i < NUM_SHORT; i++) {
+		short_section();
+	}
+
+	num = int_latency_top_sites_get(sites, ARRAY_SIZE(sites));
+	CHECK(num > 0, "no caller tracked\n");
+
+	/* the longest offender is reported first */
+	CHECK(num > 0 && is_in_func(sites[0].pc, long_section),
+	      "longest caller is %p, not long_section() (%p)\n",
+	      sites[0].pc, long_section);
+
+	for (int i = 1; i < num; i++) {
+		CHECK(sites[i].stats.max <= sites[i - 1].stats.max,
+		      "callers not sorted by duration\n");
+	}
+
+	site = site_find(num, long_section);
+	CHECK(site && site->stats.count == NUM_LONG,
+	      "long_section() not accounted properly\n");
+	CHECK(site && site->stats.max >= long_cycles / 2,
+	      "long_section() duration too short\n");
+
+	site = site_find(num, short_section);
+	CHECK(site && site->stats.count == NUM_SHORT,
+	      "short_section() not accounted properly\n");
+	CHECK(site && site->stats.max < long_cycles / 2,
+	      "short_section() duration too long\n");
+
+	int_latency_histogram_get(&all);
+	CHECK(all.count >= NUM_LONG + NUM_SHORT, "samples missing\n");
+	CHECK(all.max >= sites[0].stats.max, "global max too short\n");
+
+	/* the long sections are in the buckets of long_cycles / 2 and above */
+	bucket = 31 - __builtin_clz(long_cycles / 2);
+	for (int i = bucket; i < INT_LATENCY_HIST_BUCKETS; i++) {
+		bucket_count += all.hist[i];
+	}
+	CHECK(bucket_count >= NUM_LONG,
+	      "long sections missing from histogram\n");
+
+	int_latency_show();
+
+	/* showing the metrics starts a new sampling interval */
+	num = int_latency_top_sites_get(sites, ARRAY_SIZE(sites));
+	CHECK(!site_find(num, long_section),
+	      "long_section() still tracked after reset\n");
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
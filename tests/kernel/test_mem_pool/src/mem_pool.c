@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests memory pool block handling, with either implementation:
+ *  - block sizes, and requests larger than the maximum block size
+ *  - exhausting the pool with minimum sized blocks, then getting maximum
+ *    sized blocks back once they are all freed
+ *  - a thread waiting for a block that is freed by another thread
+ *  - heap allocations
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+#include <string.h>
+
+#define STACKSIZE 512
+#define HELPER_PRIO (CONFIG_MAIN_THREAD_PRIORITY - 1)
+
+#define MIN_SIZE 64
+#define MAX_SIZE 4096
+#define NUM_MAX_BLOCKS 2
+#define NUM_MIN_BLOCKS (NUM_MAX_BLOCKS * (MAX_SIZE / MIN_SIZE))
+
+K_MEM_POOL_DEFINE(pool, MIN_SIZE, MAX_SIZE, NUM_MAX_BLOCKS, 4);
+
+static struct k_mem_block blocks[NUM_MIN_BLOCKS];
+static char __stack helper_stack[STACKSIZE];
+
+static void test_block_sizes(void)
+{
+	static const size_t sizes[] = { 1, 64, 65, 256, 1000, 4096 };
+	struct k_mem_block block;
+	int rc;
+
+	TC_PRINT("Testing block sizes\n");
+
+	for (int i = 0; i < ARRAY_SIZE(sizes); i++) {
+		rc = k_mem_pool_alloc(&pool, &block, sizes[i], K_NO_WAIT);
+		CHECK(rc == 0, "failed to allocate %u bytes\n", sizes[i]);
+		if (rc != 0) {
+			continue;
+		}
+
+		CHECK(block.req_size == sizes[i] &&
+		      ((uint32_t)block.data & 0x3) == 0,
+		      "bad block for %u bytes\n", sizes[i]);
+
+		/* the whole block must be usable */
+		memset(block.data, 0xaa, sizes[i]);
+		k_mem_pool_free(&block);
+	}
+
+	rc = k_mem_pool_alloc(&pool, &block, MAX_SIZE + 1, K_NO_WAIT);
+	CHECK(rc == -ENOMEM, "allocated more than the maximum block size\n");
+}
+
+static void test_fragmentation(void)
+{
+	struct k_mem_block block;
+	int i, rc;
+
+	TC_PRINT("Testing fragmentation\n");
+
+	for (i = 0; i < NUM_MIN_BLOCKS; i++) {
+		rc = k_mem_pool_alloc(&pool, &blocks[i], MIN_SIZE, K_NO_WAIT);
+		CHECK(rc == 0, "failed to allocate block %d\n", i);
+	}
+
+	rc = k_mem_pool_alloc(&pool, &block, MIN_SIZE, K_NO_WAIT);
+	CHECK(rc == -ENOMEM, "allocated a block from an exhausted pool\n");
+
+	/* every other block freed: no larger block can be formed */
+	for (i = 0; i < NUM_MIN_BLOCKS; i += 2) {
+		k_mem_pool_free(&blocks[i]);
+	}
+
+	rc = k_mem_pool_alloc(&pool, &block, MIN_SIZE * 2, K_NO_WAIT);
+	CHECK(rc == -ENOMEM, "allocated a block from a fragmented pool\n");
+
+	for (i = 1; i < NUM_MIN_BLOCKS; i += 2) {
+		k_mem_pool_free(&blocks[i]);
+	}
+
+	/* the whole pool is available again as maximum sized blocks */
+	for (i = 0; i < NUM_MAX_BLOCKS; i++) {
+		rc = k_mem_pool_alloc(&pool, &blocks[i], MAX_SIZE, K_NO_WAIT);
+		CHECK(rc == 0, "failed to allocate maximum block %d\n", i);
+	}
+
+	for (i = 0; i < NUM_MAX_BLOCKS; i++) {
+		k_mem_pool_free(&blocks[i]);
+	}
+}
+
+static void helper(void *p1, void *p2, void *p3)
+{
+	struct k_mem_block *block = p1;
+
+	/* let main wait for the block, then free it */
+	k_sleep(50);
+	k_mem_pool_free(block);
+}
+
+static void test_waiting_thread(void)
+{
+	struct k_mem_block block;
+	int i, rc;
+
+	TC_PRINT("Testing a thread waiting for a block\n");
+
+	for (i = 0; i < NUM_MAX_BLOCKS; i++) {
+		rc = k_mem_pool_alloc(&pool, &blocks[i], MAX_SIZE, K_NO_WAIT);
+		CHECK(rc == 0, "failed to allocate maximum block %d\n", i);
+	}
+
+	rc = k_mem_pool_alloc(&pool, &block, MIN_SIZE, 10);
+	CHECK(rc == -EAGAIN, "allocation did not time out (%d)\n", rc);
+
+	k_thread_spawn(helper_stack, STACKSIZE, helper, &blocks[0], NULL, NULL,
+		       HELPER_PRIO, 0, 0);
+
+	rc = k_mem_pool_alloc(&pool, &block, MAX_SIZE, K_FOREVER);
+	CHECK(rc == 0 && block.data == blocks[0].data,
+	      "did not get the freed block\n");
+
+	k_mem_pool_free(&block);
+	k_mem_pool_free(&blocks[1]);
+}
+
+static void test_heap(void)
+{
+	char *ptr[4];
+	int i;
+
+	TC_PRINT("Testing heap allocations\n");
+
+	for (i = 0; i < ARRAY_SIZE(ptr); i++) {
+		ptr[i] = k_malloc(100);
+		CHECK(ptr[i] != NULL, "failed to allocate heap memory %d\n", i);
+	}
+
+	CHECK(k_malloc(100) == NULL, "allocated from an exhausted heap\n");
+
+	for (i = 0; i < ARRAY_SIZE(ptr); i++) {
+		k_free(ptr[i]);
+	}
+
+	ptr[0] = k_malloc(900);
+	CHECK(ptr[0] != NULL, "heap not merged back\n");
+	k_free(ptr[0]);
+}
+
+void main(void)
+{
+	TC_START("Test memory pools");
+
+	test_block_sizes();
+	test_fragmentation();
+	test_waiting_thread();
+	test_heap();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests memory slab caches:
+ *  - allocations refilling the cache from the slab in batches
+ *  - frees draining half of a full cache back to the slab
+ *  - allocations falling back to the slab when it has no free block left
+ *  - a thread waiting on the slab getting a block drained from a cache
+ *  - hit and miss statistics
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+
+#define STACKSIZE 512
+#define HELPER_PRIO (CONFIG_MAIN_THREAD_PRIORITY - 1)
+
+#define NUM_BLOCKS 8
+#define BLOCK_SIZE 16
+#define CACHE_CAPACITY 4
+
+K_MEM_SLAB_DEFINE(slab, BLOCK_SIZE, NUM_BLOCKS, 4);
+K_MEM_SLAB_CACHE_DEFINE(cache, &slab, CACHE_CAPACITY);
+
+static void *blocks[NUM_BLOCKS];
+static char __stack helper_stack[STACKSIZE];
+
+static void check_stats(uint32_t alloc_hits, uint32_t alloc_misses,
+			uint32_t free_hits, uint32_t free_misses)
+{
+	struct k_mem_slab_cache_stats stats;
+
+	k_mem_slab_cache_stats_get(&cache, &stats);
+	CHECK(stats.alloc_hits == alloc_hits &&
+	      stats.alloc_misses == alloc_misses &&
+	      stats.free_hits == free_hits &&
+	      stats.free_misses == free_misses,
+	      "stats: alloc %u/%u free %u/%u, expected %u/%u %u/%u\n",
+	      stats.alloc_hits, stats.alloc_misses, stats.free_hits,
+	      stats.free_misses, alloc_hits, alloc_misses, free_hits,
+	      free_misses);
+}
+
+static void test_batches(void)
+{
+	void *block;
+	int i, rc;
+
+	TC_PRINT("Testing refills and drains\n");
+
+	/* the first allocation refills half a cache */
+	rc = k_mem_slab_cache_alloc(&cache, &blocks[0], K_NO_WAIT);
+	CHECK(rc == 0, "first allocation failed\n");
+	CHECK(cache.num_free == CACHE_CAPACITY / 2 - 1,
+	      "%u blocks in cache\n", cache.num_free);
+	CHECK(k_mem_slab_num_used_get(&slab) == CACHE_CAPACITY / 2,
+	      "%u blocks used in slab\n", k_mem_slab_num_used_get(&slab));
+
+	/* exhaust the slab, through the cache */
+	for (i = 1; i < NUM_BLOCKS; i++) {
+		rc = k_mem_slab_cache_alloc(&cache, &blocks[i], K_NO_WAIT);
+		CHECK(rc == 0, "allocation %d failed\n", i);
+	}
+	check_stats(NUM_BLOCKS / 2, NUM_BLOCKS / 2, 0, 0);
+
+	rc = k_mem_slab_cache_alloc(&cache, &block, K_NO_WAIT);
+	CHECK(rc == -ENOMEM, "allocated from an exhausted slab\n");
+
+	/* fill the cache, then drain half of it */
+	for (i = 0; i <= CACHE_CAPACITY; i++) {
+		k_mem_slab_cache_free(&cache, &blocks[i]);
+	}
+	check_stats(NUM_BLOCKS / 2, NUM_BLOCKS / 2 + 1, CACHE_CAPACITY, 1);
+	CHECK(cache.num_free == CACHE_CAPACITY / 2 + 1,
+	      "%u blocks in cache\n", cache.num_free);
+	CHECK(k_mem_slab_num_free_get(&slab) == CACHE_CAPACITY / 2,
+	      "%u blocks free in slab\n", k_mem_slab_num_free_get(&slab));
+
+	for (; i < NUM_BLOCKS; i++) {
+		k_mem_slab_cache_free(&cache, &blocks[i]);
+	}
+
+	k_mem_slab_cache_flush(&cache);
+	CHECK(cache.num_free == 0, "cache not flushed\n");
+	CHECK(k_mem_slab_num_used_get(&slab) == 0,
+	      "%u blocks still used\n", k_mem_slab_num_used_get(&slab));
+}
+
+static void helper(void *p1, void *p2, void *p3)
+{
+	void *block;
+	int rc;
+
+	rc = k_mem_slab_alloc(&slab, &block, K_FOREVER);
+	CHECK(rc == 0 && block == blocks[0], "helper got a bad block\n");
+}
+
+static void test_waiting_thread(void)
+{
+	int i, rc;
+
+	TC_PRINT("Testing a thread waiting for a cached block\n");
+
+	k_mem_slab_cache_init(&cache, &slab, CACHE_CAPACITY);
+
+	for (i = 0; i < NUM_BLOCKS; i++) {
+		rc = k_mem_slab_cache_alloc(&cache, &blocks[i], K_NO_WAIT);
+		CHECK(rc == 0, "allocation %d failed\n", i);
+	}
+
+	/* the helper pends on the exhausted slab */
+	k_thread_spawn(helper_stack, STACKSIZE, helper, NULL, NULL, NULL,
+		       HELPER_PRIO, 0, 0);
+
+	/* a block freed to the cache is not seen by the slab... */
+	k_mem_slab_cache_free(&cache, &blocks[0]);
+	CHECK(k_mem_slab_num_used_get(&slab) == NUM_BLOCKS,
+	      "block returned to the slab\n");
+
+	/* ...until the cache is flushed */
+	k_mem_slab_cache_flush(&cache);
+	CHECK(k_mem_slab_num_used_get(&slab) == NUM_BLOCKS,
+	      "block not given to the helper\n");
+
+	k_mem_slab_free(&slab, &blocks[0]);
+	for (i = 1; i < NUM_BLOCKS; i++) {
+		k_mem_slab_free(&slab, &blocks[i]);
+	}
+	CHECK(k_mem_slab_num_used_get(&slab) == 0,
+	      "%u blocks still used\n", k_mem_slab_num_used_get(&slab));
+}
+
+void main(void)
+{
+	TC_START("Test memory slab caches");
+
+	test_batches();
+	test_waiting_thread();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
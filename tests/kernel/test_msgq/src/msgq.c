@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests the batch and single-producer/single-consumer message
+ * queue routines:
+ *  - batches that wrap around the end of the queue buffer
+ *  - partial batches when the queue is full or empty
+ *  - messages handed directly to waiting readers, or taken from waiting
+ *    writers
+ *  - an ISR producer and a thread consumer on a SPSC queue
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+
+#define STACKSIZE 512
+#define HELPER_PRIO (CONFIG_MAIN_THREAD_PRIORITY - 1)
+
+#define MAX_MSGS 8
+#define NUM_SPSC_MSGS 100
+
+K_MSGQ_DEFINE(msgq, sizeof(uint32_t), MAX_MSGS, 4);
+K_MSGQ_DEFINE(spsc_msgq, sizeof(uint32_t), MAX_MSGS, 4);
+
+static char __stack helper_stack[STACKSIZE];
+
+static void fill(uint32_t *msgs, int num, uint32_t first)
+{
+	for (int i = 0; i < num; i++) {
+		msgs[i] = first + i;
+	}
+}
+
+static int check(uint32_t *msgs, int num, uint32_t first)
+{
+	for (int i = 0; i < num; i++) {
+		if (msgs[i] != first + i) {
+			TC_ERROR("message %d: got %u, expected %u\n",
+				 i, msgs[i], first + i);
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static void test_batches(void)
+{
+	uint32_t msgs[MAX_MSGS + 2];
+	int rc;
+
+	TC_PRINT("Testing batches\n");
+
+	/* move the read and write pointers near the end of the buffer */
+	fill(msgs, MAX_MSGS - 2, 0);
+	rc = k_msgq_put_many(&msgq, msgs, MAX_MSGS - 2);
+	CHECK(rc == MAX_MSGS - 2, "put %d messages\n", rc);
+	rc = k_msgq_get_many(&msgq, msgs, MAX_MSGS - 2);
+	CHECK(rc == MAX_MSGS - 2, "got %d messages\n", rc);
+
+	/* a full batch wraps around, and the extra messages are not put */
+	fill(msgs, MAX_MSGS + 2, 100);
+	rc = k_msgq_put_many(&msgq, msgs, MAX_MSGS + 2);
+	CHECK(rc == MAX_MSGS, "put %d messages\n", rc);
+	CHECK(k_msgq_num_used_get(&msgq) == MAX_MSGS, "queue not full\n");
+
+	/* get a partial batch, then the rest, and more than available */
+	rc = k_msgq_get_many(&msgq, msgs, 3);
+	CHECK(rc == 3 && check(msgs, 3, 100), "bad first batch\n");
+	rc = k_msgq_get_many(&msgq, msgs, MAX_MSGS + 2);
+	CHECK(rc == MAX_MSGS - 3 && check(msgs, rc, 103),
+	      "bad second batch\n");
+
+	rc = k_msgq_get_many(&msgq, msgs, 1);
+	CHECK(rc == 0, "got %d messages from an empty queue\n", rc);
+}
+
+static void reader(void *p1, void *p2, void *p3)
+{
+	uint32_t msg;
+
+	k_msgq_get(&msgq, &msg, K_FOREVER);
+	CHECK(msg == 200, "reader got %u\n", msg);
+}
+
+static void writer(void *p1, void *p2, void *p3)
+{
+	uint32_t msg = 300;
+
+	k_msgq_put(&msgq, &msg, K_FOREVER);
+}
+
+static void test_waiting_threads(void)
+{
+	uint32_t msgs[MAX_MSGS];
+	int rc;
+
+	TC_PRINT("Testing batches with waiting threads\n");
+
+	/* the reader pends on the empty queue, and gets the first message */
+	k_thread_spawn(helper_stack, STACKSIZE, reader, NULL, NULL, NULL,
+		       HELPER_PRIO, 0, 0);
+
+	fill(msgs, 2, 200);
+	rc = k_msgq_put_many(&msgq, msgs, 2);
+	CHECK(rc == 2, "put %d messages\n", rc);
+	CHECK(k_msgq_num_used_get(&msgq) == 1, "first message was queued\n");
+
+	/* fill the queue: the writer pends, and its message fills the hole */
+	fill(msgs, MAX_MSGS - 1, 202);
+	rc = k_msgq_put_many(&msgq, msgs, MAX_MSGS - 1);
+	CHECK(rc == MAX_MSGS - 1, "put %d messages\n", rc);
+
+	k_thread_spawn(helper_stack, STACKSIZE, writer, NULL, NULL, NULL,
+		       HELPER_PRIO, 0, 0);
+
+	rc = k_msgq_get_many(&msgq, msgs, 1);
+	CHECK(rc == 1 && msgs[0] == 201, "bad message %u\n", msgs[0]);
+	CHECK(k_msgq_num_used_get(&msgq) == MAX_MSGS,
+	      "writer message not queued\n");
+
+	rc = k_msgq_get_many(&msgq, msgs, MAX_MSGS);
+	CHECK(rc == MAX_MSGS && check(msgs, MAX_MSGS - 1, 202) &&
+	      msgs[MAX_MSGS - 1] == 300, "bad last batch\n");
+}
+
+static struct k_timer spsc_timer;
+static uint32_t spsc_next;
+
+/* ISR producer: put as many messages as possible on each expiry */
+static void spsc_produce(struct k_timer *timer)
+{
+	while (spsc_next < NUM_SPSC_MSGS &&
+	       k_msgq_spsc_put(&spsc_msgq, &spsc_next) == 0) {
+		spsc_next++;
+	}
+}
+
+static void test_spsc(void)
+{
+	uint32_t msg, expected = 0;
+
+	TC_PRINT("Testing single-producer/single-consumer queue\n");
+
+	k_timer_init(&spsc_timer, spsc_produce, NULL);
+	k_timer_start(&spsc_timer, 10, 10);
+
+	while (expected < NUM_SPSC_MSGS) {
+		if (k_msgq_spsc_get(&spsc_msgq, &msg) != 0) {
+			k_sleep(5);
+			continue;
+		}
+
+		if (msg != expected) {
+			TC_ERROR("got message %u, expected %u\n", msg,
+				 expected);
+			tc_rc = TC_FAIL;
+			break;
+		}
+		expected++;
+	}
+
+	k_timer_stop(&spsc_timer);
+
+	CHECK(spsc_next == NUM_SPSC_MSGS, "producer stopped at %u\n",
+	      spsc_next);
+}
+
+void main(void)
+{
+	TC_START("Test message queue batches and SPSC routines");
+
+	test_batches();
+	test_waiting_threads();
+	test_spsc();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
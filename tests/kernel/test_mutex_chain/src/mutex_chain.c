@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests transitive priority inheritance through a 3-deep chain
+ * of mutexes, and measures the worst-case time a high priority thread stays
+ * blocked on the chain.
+ *
+ * The low thread holds mutex 1; mid1 holds mutex 2 and waits on mutex 1;
+ * mid2 holds mutex 3 and waits on mutex 2; then the high thread waits on
+ * mutex 3, while a hog thread of intermediate priority wants the CPU. The
+ * high thread's priority must reach the low thread through the chain, so
+ * that the hog cannot delay the release of the mutexes: the high thread is
+ * then only blocked for the time the three critical sections take.
+ */
+
+#include <zephyr.h>
+#include <tc_util.h>
+
+#define STACK_SIZE 1024
+
+#define HIGH_PRIO 5
+#define HOG_PRIO 7
+#define MID2_PRIO 8
+#define MID1_PRIO 9
+#define LOW_PRIO 10
+
+#define NUM_ITERATIONS 10
+
+/* length of each critical section, and of the hog's busy loop */
+#define CRITICAL_TICKS_DIVISOR 4
+#define HOG_TICKS 5
+
+static char __stack low_stack[STACK_SIZE];
+static char __stack mid1_stack[STACK_SIZE];
+static char __stack mid2_stack[STACK_SIZE];
+static char __stack high_stack[STACK_SIZE];
+static char __stack hog_stack[STACK_SIZE];
+
+K_MUTEX_DEFINE(mutex1);
+K_MUTEX_DEFINE(mutex2);
+K_MUTEX_DEFINE(mutex3);
+
+K_SEM_DEFINE(go_low, 0, 1);
+K_SEM_DEFINE(go_mid1, 0, 1);
+K_SEM_DEFINE(go_mid2, 0, 1);
+K_SEM_DEFINE(go_high, 0, 1);
+K_SEM_DEFINE(go_hog, 0, 1);
+K_SEM_DEFINE(release_low, 0, 1);
+K_SEM_DEFINE(locked, 0, 1);
+K_SEM_DEFINE(done, 0, 1);
+
+static uint32_t critical_cycles;
+static uint32_t hog_cycles;
+
+static int low_prio_seen;
+static uint32_t blocked_cycles;
+
+static void busy_wait(uint32_t cycles)
+{
+	uint32_t start = k_cycle_get_32();
+
+	while (k_cycle_get_32() - start < cycles) {
+		/* spin */
+	}
+}
+
+static void low_thread(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&go_low, K_FOREVER);
+
+		k_mutex_lock(&mutex1, K_FOREVER);
+		k_sem_give(&locked);
+
+		k_sem_take(&release_low, K_FOREVER);
+		low_prio_seen = k_thread_priority_get(k_current_get());
+		busy_wait(critical_cycles);
+		k_mutex_unlock(&mutex1);
+	}
+}
+
+static void mid1_thread(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&go_mid1, K_FOREVER);
+
+		k_mutex_lock(&mutex2, K_FOREVER);
+		k_sem_give(&locked);
+
+		k_mutex_lock(&mutex1, K_FOREVER);
+		busy_wait(critical_cycles);
+		k_mutex_unlock(&mutex1);
+		k_mutex_unlock(&mutex2);
+	}
+}
+
+static void mid2_thread(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&go_mid2, K_FOREVER);
+
+		k_mutex_lock(&mutex3, K_FOREVER);
+		k_sem_give(&locked);
+
+		k_mutex_lock(&mutex2, K_FOREVER);
+		busy_wait(critical_cycles);
+		k_mutex_unlock(&mutex2);
+		k_mutex_unlock(&mutex3);
+	}
+}
+
+static void high_thread(void *p1, void *p2, void *p3)
+{
+	uint32_t start;
+
+	for (;;) {
+		k_sem_take(&go_high, K_FOREVER);
+
+		start = k_cycle_get_32();
+		k_sem_give(&release_low);
+
+		k_mutex_lock(&mutex3, K_FOREVER);
+		blocked_cycles = k_cycle_get_32() - start;
+		k_mutex_unlock(&mutex3);
+
+		k_sem_give(&done);
+	}
+}
+
+static void hog_thread(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&go_hog, K_FOREVER);
+		busy_wait(hog_cycles);
+	}
+}
+
+void main(void)
+{
+	uint32_t worst = 0;
+	uint64_t total = 0;
+	int rc = TC_PASS;
+
+	TC_START("Test transitive mutex priority inheritance");
+
+	critical_cycles = sys_clock_hw_cycles_per_tick / CRITICAL_TICKS_DIVISOR;
+	hog_cycles = sys_clock_hw_cycles_per_tick * HOG_TICKS;
+
+	k_thread_spawn(low_stack, STACK_SIZE, low_thread, NULL, NULL, NULL,
+		       LOW_PRIO, 0, K_NO_WAIT);
+	k_thread_spawn(mid1_stack, STACK_SIZE, mid1_thread, NULL, NULL, NULL,
+		       MID1_PRIO, 0, K_NO_WAIT);
+	k_thread_spawn(mid2_stack, STACK_SIZE, mid2_thread, NULL, NULL, NULL,
+		       MID2_PRIO, 0, K_NO_WAIT);
+	k_thread_spawn(high_stack, STACK_SIZE, high_thread, NULL, NULL, NULL,
+		       HIGH_PRIO, 0, K_NO_WAIT);
+	k_thread_spawn(hog_stack, STACK_SIZE, hog_thread, NULL, NULL, NULL,
+		       HOG_PRIO, 0, K_NO_WAIT);
+
+	for (int i = 0; i < NUM_ITERATIONS; i++) {
+		/* build the chain, from the bottom */
+		k_sem_give(&go_low);
+		k_sem_take(&locked, K_FOREVER);
+		k_sem_give(&go_mid1);
+		k_sem_take(&locked, K_FOREVER);
+		k_sem_give(&go_mid2);
+		k_sem_take(&locked, K_FOREVER);
+
+		/* let mid2, then mid1, block on the next mutex */
+		k_sleep(10);
+
+		k_sem_give(&go_hog);
+		k_sem_give(&go_high);
+		k_sem_take(&done, K_FOREVER);
+
+		if (low_prio_seen != HIGH_PRIO) {
+			TC_ERROR("low thread ran at priority %d, not %d\n",
+				 low_prio_seen, HIGH_PRIO);
+			rc = TC_FAIL;
+		}
+
+		if (blocked_cycles > worst) {
+			worst = blocked_cycles;
+		}
+		total += blocked_cycles;
+	}
+
+	TC_PRINT("blocking time through 3 mutexes: worst %u ns, "
+		 "average %u ns\n", SYS_CLOCK_HW_CYCLES_TO_NS(worst),
+		 SYS_CLOCK_HW_CYCLES_TO_NS_AVG(total, NUM_ITERATIONS));
+	TC_PRINT("critical sections: 3 x %u ns\n",
+		 SYS_CLOCK_HW_CYCLES_TO_NS(critical_cycles));
+
+	/* the hog must not have been able to run while the chain held */
+	if (worst >= hog_cycles) {
+		TC_ERROR("high thread blocked for %u cycles, hog ran for %u\n",
+			 worst, hog_cycles);
+		rc = TC_FAIL;
+	}
+
+	TC_END_RESULT(rc);
+	TC_END_REPORT(rc);
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests the zero-copy pipe routines:
+ *  - claims limited to the contiguous part of the ring buffer
+ *  - data written through a claim read back through a claim, across the
+ *    end of the ring buffer
+ *  - committed data handed directly to a waiting reader
+ *  - released space refilled from a waiting writer
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+#include <string.h>
+
+#define STACKSIZE 512
+#define HELPER_PRIO (CONFIG_MAIN_THREAD_PRIORITY - 1)
+
+#define PIPE_SIZE 16
+
+K_PIPE_DEFINE(pipe, PIPE_SIZE, 4);
+
+static char __stack helper_stack[STACKSIZE];
+
+static void fill(unsigned char *data, size_t size, unsigned char first)
+{
+	for (size_t i = 0; i < size; i++) {
+		data[i] = first + i;
+	}
+}
+
+static int check(unsigned char *data, size_t size, unsigned char first)
+{
+	for (size_t i = 0; i < size; i++) {
+		if (data[i] != (unsigned char)(first + i)) {
+			TC_ERROR("byte %u: got %u, expected %u\n",
+				 i, data[i], (unsigned char)(first + i));
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static void test_claims(void)
+{
+	unsigned char *data;
+	unsigned char buf[PIPE_SIZE];
+	size_t size, bytes;
+	int rc;
+
+	TC_PRINT("Testing claims\n");
+
+	size = k_pipe_get_claim(&pipe, &data, PIPE_SIZE);
+	CHECK(size == 0, "claimed %u bytes from an empty pipe\n", size);
+
+	/* move the read and write indexes near the end of the buffer */
+	fill(buf, PIPE_SIZE - 4, 0);
+	rc = k_pipe_put(&pipe, buf, PIPE_SIZE - 4, &bytes, 0, K_NO_WAIT);
+	CHECK(rc == 0 && bytes == PIPE_SIZE - 4, "put %u bytes\n", bytes);
+	rc = k_pipe_get(&pipe, buf, PIPE_SIZE - 4, &bytes, 0, K_NO_WAIT);
+	CHECK(rc == 0 && bytes == PIPE_SIZE - 4, "got %u bytes\n", bytes);
+
+	/* the space claimed stops at the end of the buffer */
+	size = k_pipe_put_claim(&pipe, &data, PIPE_SIZE);
+	CHECK(size == 4, "claimed %u bytes of space\n", size);
+	fill(data, size, 10);
+
+	/* nothing can be read before the data is committed */
+	CHECK(k_pipe_get_claim(&pipe, &data, PIPE_SIZE) == 0,
+	      "uncommitted data claimed\n");
+	k_pipe_put_finish(&pipe, size);
+
+	/* the space wrapped around, and is limited by bytes_max */
+	size = k_pipe_put_claim(&pipe, &data, 6);
+	CHECK(size == 6, "claimed %u bytes of space\n", size);
+	fill(data, size, 14);
+	k_pipe_put_finish(&pipe, size);
+
+	/* read the data back in two claims, then with a regular read */
+	size = k_pipe_get_claim(&pipe, &data, PIPE_SIZE);
+	CHECK(size == 4 && check(data, size, 10), "bad first claim\n");
+	k_pipe_get_finish(&pipe, size);
+
+	size = k_pipe_get_claim(&pipe, &data, PIPE_SIZE);
+	CHECK(size == 6 && check(data, size, 14), "bad second claim\n");
+	k_pipe_get_finish(&pipe, 2);
+
+	rc = k_pipe_get(&pipe, buf, PIPE_SIZE, &bytes, 0, K_NO_WAIT);
+	CHECK(rc == 0 && bytes == 4 && check(buf, bytes, 16),
+	      "got %u bytes after partial release\n", bytes);
+}
+
+static void reader(void *p1, void *p2, void *p3)
+{
+	unsigned char buf[8];
+	size_t bytes;
+
+	k_pipe_get(&pipe, buf, sizeof(buf), &bytes, sizeof(buf), K_FOREVER);
+	CHECK(bytes == sizeof(buf) && check(buf, bytes, 50),
+	      "reader got %u bytes\n", bytes);
+}
+
+static void writer(void *p1, void *p2, void *p3)
+{
+	unsigned char buf[8];
+	size_t bytes;
+
+	fill(buf, sizeof(buf), 100);
+	k_pipe_put(&pipe, buf, sizeof(buf), &bytes, sizeof(buf), K_FOREVER);
+}
+
+static void test_waiting_threads(void)
+{
+	unsigned char *data;
+	unsigned char buf[PIPE_SIZE];
+	size_t size, bytes;
+
+	TC_PRINT("Testing claims with waiting threads\n");
+
+	/* the reader pends on the empty pipe, and gets the committed data */
+	k_thread_spawn(helper_stack, STACKSIZE, reader, NULL, NULL, NULL,
+		       HELPER_PRIO, 0, 0);
+
+	size = k_pipe_put_claim(&pipe, &data, 10);
+	CHECK(size == 10, "claimed %u bytes of space\n", size);
+	fill(data, size, 50);
+	k_pipe_put_finish(&pipe, size);
+
+	size = k_pipe_get_claim(&pipe, &data, PIPE_SIZE);
+	CHECK(size == 2 && check(data, size, 58),
+	      "%u bytes left for the reader\n", size);
+	k_pipe_get_finish(&pipe, size);
+
+	/* fill the pipe: the writer pends, and refills the released space */
+	fill(buf, PIPE_SIZE, 0);
+	k_pipe_put(&pipe, buf, PIPE_SIZE, &bytes, PIPE_SIZE, K_NO_WAIT);
+	CHECK(bytes == PIPE_SIZE, "put %u bytes\n", bytes);
+
+	k_thread_spawn(helper_stack, STACKSIZE, writer, NULL, NULL, NULL,
+		       HELPER_PRIO, 0, 0);
+
+	size = k_pipe_get_claim(&pipe, &data, 8);
+	CHECK(size == 8 && check(data, size, 0), "bad claim\n");
+	k_pipe_get_finish(&pipe, size);
+
+	memset(buf, 0, sizeof(buf));
+	k_pipe_get(&pipe, buf, PIPE_SIZE, &bytes, PIPE_SIZE, K_NO_WAIT);
+	CHECK(bytes == PIPE_SIZE && check(buf, 8, 8) &&
+	      check(&buf[8], 8, 100), "writer data not in pipe\n");
+}
+
+void main(void)
+{
+	TC_START("Test pipe zero-copy routines");
+
+	test_claims();
+	test_waiting_threads();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
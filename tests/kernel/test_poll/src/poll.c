@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests the k_poll() API:
+ *  - events whose condition is already met when polling
+ *  - waking up on each type of object, from a thread and from a timer
+ *  - timeouts
+ *  - polling an object that is already being polled
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+
+#define STACKSIZE 512
+#define HELPER_PRIO 5
+
+struct fifo_msg {
+	void *private;
+	uint32_t msg;
+};
+
+static K_SEM_DEFINE(sem, 0, 1);
+static K_FIFO_DEFINE(fifo);
+K_MSGQ_DEFINE(msgq, sizeof(uint32_t), 4, 4);
+static struct k_timer timer;
+
+static struct k_poll_event events[] = {
+	K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SEM_AVAILABLE, &sem),
+	K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_FIFO_DATA_AVAILABLE, &fifo),
+	K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_MSGQ_DATA_AVAILABLE, &msgq),
+	K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_TIMER_EXPIRED, &timer),
+};
+
+static char __stack helper_stack[STACKSIZE];
+static struct fifo_msg fifo_msg = { NULL, 0xabcd };
+
+static int num_ready(void)
+{
+	int num = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		num += events[i].state != K_POLL_STATE_NOT_READY;
+	}
+
+	return num;
+}
+
+/* make each object ready in turn, waiting a bit before each one */
+static void helper(void *p1, void *p2, void *p3)
+{
+	uint32_t msg = 0x1234;
+
+	k_sleep(50);
+	k_sem_give(&sem);
+
+	k_sleep(50);
+	k_fifo_put(&fifo, &fifo_msg);
+
+	k_sleep(50);
+	k_msgq_put(&msgq, &msg, K_NO_WAIT);
+
+	/* the timer is started by the main thread */
+}
+
+static void test_no_wait(void)
+{
+	uint32_t msg = 0x5678;
+	int rc;
+
+	TC_PRINT("Testing events already ready\n");
+
+	rc = k_poll(events, ARRAY_SIZE(events), K_NO_WAIT);
+	CHECK(rc == -EAGAIN, "expected -EAGAIN, got %d\n", rc);
+	CHECK(num_ready() == 0, "no event should be ready\n");
+
+	k_sem_give(&sem);
+	k_msgq_put(&msgq, &msg, K_NO_WAIT);
+
+	rc = k_poll(events, ARRAY_SIZE(events), K_NO_WAIT);
+	CHECK(rc == 0, "expected 0, got %d\n", rc);
+	CHECK(events[0].state == K_POLL_STATE_SEM_AVAILABLE, "sem not ready\n");
+	CHECK(events[1].state == K_POLL_STATE_NOT_READY, "fifo ready\n");
+	CHECK(events[2].state == K_POLL_STATE_MSGQ_DATA_AVAILABLE,
+	      "msgq not ready\n");
+	CHECK(events[3].state == K_POLL_STATE_NOT_READY, "timer ready\n");
+
+	/* polling does not consume anything */
+	CHECK(k_sem_take(&sem, K_NO_WAIT) == 0, "sem was taken\n");
+	CHECK(k_msgq_get(&msgq, &msg, K_NO_WAIT) == 0, "msgq was emptied\n");
+	CHECK(msg == 0x5678, "bad message\n");
+}
+
+static void test_wait(void)
+{
+	struct fifo_msg *rx;
+	uint32_t msg;
+	int rc;
+
+	TC_PRINT("Testing waiting on each object type\n");
+
+	k_thread_spawn(helper_stack, STACKSIZE, helper, NULL, NULL, NULL,
+		       HELPER_PRIO, 0, K_NO_WAIT);
+
+	rc = k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+	CHECK(rc == 0 && num_ready() == 1 &&
+	      events[0].state == K_POLL_STATE_SEM_AVAILABLE,
+	      "sem wake up failed\n");
+	CHECK(k_sem_take(&sem, K_NO_WAIT) == 0, "sem not available\n");
+
+	rc = k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+	CHECK(rc == 0 && num_ready() == 1 &&
+	      events[1].state == K_POLL_STATE_FIFO_DATA_AVAILABLE,
+	      "fifo wake up failed\n");
+	rx = k_fifo_get(&fifo, K_NO_WAIT);
+	CHECK(rx == &fifo_msg, "fifo data not available\n");
+
+	rc = k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+	CHECK(rc == 0 && num_ready() == 1 &&
+	      events[2].state == K_POLL_STATE_MSGQ_DATA_AVAILABLE,
+	      "msgq wake up failed\n");
+	CHECK(k_msgq_get(&msgq, &msg, K_NO_WAIT) == 0 && msg == 0x1234,
+	      "msgq data not available\n");
+
+	k_timer_start(&timer, 50, 0);
+	rc = k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+	CHECK(rc == 0 && num_ready() == 1 &&
+	      events[3].state == K_POLL_STATE_TIMER_EXPIRED,
+	      "timer wake up failed\n");
+	CHECK(k_timer_status_get(&timer) == 1, "timer did not expire\n");
+
+	/* objects must be free to be polled again */
+	for (int i = 0; i < ARRAY_SIZE(events); i++) {
+		CHECK(events[i].poller == NULL, "event %d still registered\n",
+		      i);
+	}
+	CHECK(sem.poll_event == NULL && fifo.poll_event == NULL &&
+	      msgq.poll_event == NULL && timer.poll_event == NULL,
+	      "object still has a poller\n");
+}
+
+static void test_timeout(void)
+{
+	int64_t start = k_uptime_get();
+	int rc;
+
+	TC_PRINT("Testing timeout\n");
+
+	rc = k_poll(events, ARRAY_SIZE(events), 100);
+	CHECK(rc == -EAGAIN, "expected -EAGAIN, got %d\n", rc);
+	CHECK(num_ready() == 0, "no event should be ready\n");
+	CHECK(k_uptime_get() - start >= 100, "returned too early\n");
+	CHECK(sem.poll_event == NULL, "registration not cleared\n");
+}
+
+static void busy_poller(void *p1, void *p2, void *p3)
+{
+	struct k_poll_event event =
+		K_POLL_EVENT_INITIALIZER(K_POLL_TYPE_SEM_AVAILABLE, &sem);
+
+	(void)k_poll(&event, 1, 100);
+}
+
+static void test_in_use(void)
+{
+	int rc;
+
+	TC_PRINT("Testing object already polled\n");
+
+	/* higher priority: runs until it pends in k_poll() */
+	k_thread_spawn(helper_stack, STACKSIZE, busy_poller, NULL, NULL, NULL,
+		       K_PRIO_COOP(1), 0, K_NO_WAIT);
+
+	rc = k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+	CHECK(rc == -EADDRINUSE, "expected -EADDRINUSE, got %d\n", rc);
+	CHECK(fifo.poll_event == NULL, "registration not cleared\n");
+
+	/* let the other poller time out */
+	k_sleep(200);
+}
+
+void main(void)
+{
+	TC_START("Test k_poll");
+
+	k_timer_init(&timer, NULL, NULL);
+
+	test_no_wait();
+	test_wait();
+	test_timeout();
+	test_in_use();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests earliest deadline first scheduling:
+ *  - ready threads of equal priority run in deadline order
+ *  - schedulability stress test: a periodic task set that is schedulable
+ *    with EDF, run with and without deadlines, counting deadline misses
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+
+#define STACKSIZE 512
+#define NUM_THREADS 3
+#define THREAD_PRIO 5
+
+#define RUN_MS 1000
+
+static char __stack stacks[NUM_THREADS][STACKSIZE];
+
+static int run_order[NUM_THREADS];
+static int num_run;
+
+static void order_thread(void *id, void *p2, void *p3)
+{
+	run_order[num_run++] = (int)id;
+}
+
+static void test_deadline_order(void)
+{
+	/* thread i gets the deadline of rank ranks[i] */
+	static const int ranks[NUM_THREADS] = { 2, 0, 1 };
+	k_tid_t tids[NUM_THREADS];
+
+	TC_PRINT("Testing deadline ordering\n");
+
+	/* the threads are ready, but do not run before main sleeps */
+	for (int i = 0; i < NUM_THREADS; i++) {
+		tids[i] = k_thread_spawn(stacks[i], STACKSIZE, order_thread,
+					 (void *)i, NULL, NULL,
+					 THREAD_PRIO, 0, 0);
+	}
+
+	for (int i = 0; i < NUM_THREADS; i++) {
+		k_thread_deadline_set(tids[i],
+				      ms_to_cycles(100 * (ranks[i] + 1)));
+	}
+
+	k_sleep(10);
+
+	CHECK(num_run == NUM_THREADS, "%d threads ran\n", num_run);
+	for (int i = 0; i < num_run; i++) {
+		CHECK(ranks[run_order[i]] == i,
+		      "thread %d ran in position %d\n", run_order[i], i);
+	}
+}
+
+/*
+ * Periodic task set, with implicit deadlines (deadline == period), for a
+ * total utilization of 70%: it is schedulable with EDF, but when all tasks
+ * have the same static priority, the jobs of the short period task have to
+ * wait for the long jobs of the other one.
+ */
+struct periodic_task {
+	uint32_t period_ms;
+	uint32_t exec_us;
+
+	struct k_timer timer;
+	struct k_msgq releases;
+	uint32_t release_buf[4];
+	k_tid_t tid;
+
+	int jobs;
+	int misses;
+};
+
+static struct periodic_task tasks[] = {
+	{ .period_ms = 20, .exec_us = 6000 },
+	{ .period_ms = 100, .exec_us = 40000 },
+};
+
+static int use_deadlines;
+
+/* runs in ISR context: release a new job of the task */
+static void release_job(struct k_timer *timer)
+{
+	struct periodic_task *task =
+		CONTAINER_OF(timer, struct periodic_task, timer);
+	uint32_t now = k_cycle_get_32();
+
+	if (use_deadlines) {
+		k_thread_deadline_set(task->tid, ms_to_cycles(task->period_ms));
+	}
+
+	k_msgq_put(&task->releases, &now, K_NO_WAIT);
+}
+
+static void periodic_thread(void *p1, void *p2, void *p3)
+{
+	struct periodic_task *task = p1;
+	uint32_t deadline = ms_to_cycles(task->period_ms);
+	uint32_t release;
+
+	for (;;) {
+		k_msgq_get(&task->releases, &release, K_FOREVER);
+
+		k_busy_wait(task->exec_us);
+
+		task->jobs++;
+		if (k_cycle_get_32() - release > deadline) {
+			task->misses++;
+		}
+	}
+}
+
+static int run_task_set(void)
+{
+	int misses = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(tasks); i++) {
+		struct periodic_task *task = &tasks[i];
+
+		task->jobs = 0;
+		task->misses = 0;
+		k_msgq_init(&task->releases, (char *)task->release_buf,
+			    sizeof(uint32_t), ARRAY_SIZE(task->release_buf));
+		k_timer_init(&task->timer, release_job, NULL);
+		task->tid = k_thread_spawn(stacks[i], STACKSIZE,
+					   periodic_thread, task, NULL, NULL,
+					   THREAD_PRIO, 0, 0);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(tasks); i++) {
+		k_timer_start(&tasks[i].timer, tasks[i].period_ms,
+			      tasks[i].period_ms);
+	}
+
+	k_sleep(RUN_MS);
+
+	for (int i = 0; i < ARRAY_SIZE(tasks); i++) {
+		k_timer_stop(&tasks[i].timer);
+		k_thread_abort(tasks[i].tid);
+
+		TC_PRINT("  task %d (period %u ms): %d jobs, %d misses\n", i,
+			 tasks[i].period_ms, tasks[i].jobs, tasks[i].misses);
+		misses += tasks[i].misses;
+	}
+
+	return misses;
+}
+
+static void test_schedulability(void)
+{
+	int static_misses, edf_misses;
+
+	TC_PRINT("Testing schedulability with static priorities\n");
+	use_deadlines = 0;
+	static_misses = run_task_set();
+
+	TC_PRINT("Testing schedulability with deadlines\n");
+	use_deadlines = 1;
+	edf_misses = run_task_set();
+
+	TC_PRINT("deadline misses: %d with static priorities, %d with EDF\n",
+		 static_misses, edf_misses);
+
+	CHECK(static_misses > 0, "task set should not be schedulable\n");
+	CHECK(edf_misses < static_misses, "EDF did not reduce misses\n");
+}
+
+void main(void)
+{
+	TC_START("Test deadline scheduling");
+
+	/* the test threads must not prevent main from running */
+	k_thread_priority_set(k_current_get(), THREAD_PRIO - 1);
+
+	test_deadline_order();
+	test_schedulability();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
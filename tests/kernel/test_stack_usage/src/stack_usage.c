@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests the thread stack usage analysis: the unused stack space
+ * reported for a thread must reflect how deep it used its stack, and all
+ * threads, the interrupt stack included, must be reported.
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+
+#define STACK_SIZE 1024
+#define PRIORITY 5
+
+/* stack used by the deep thread, beyond its frames */
+#define DEPTH 512
+
+/* stack the thread entry glue and frames are assumed to fit in */
+#define OVERHEAD 256
+
+static char __stack deep_stack[STACK_SIZE];
+static char __stack shallow_stack[STACK_SIZE];
+
+static struct k_sem done_sem;
+
+static void deep_thread(void *p1, void *p2, void *p3)
+{
+	volatile char buf[DEPTH];
+
+	for (int i = 0; i < DEPTH; i++) {
+		buf[i] = 0;
+	}
+
+	k_sem_give(&done_sem);
+}
+
+static void shallow_thread(void *p1, void *p2, void *p3)
+{
+	k_sem_give(&done_sem);
+}
+
+struct found {
+	int deep;
+	int shallow;
+	int main;
+	int isr;
+};
+
+static void check_stack(k_tid_t thread, const struct k_stack_usage *usage,
+			void *user_data)
+{
+	struct found *found = user_data;
+
+	CHECK(usage->unused <= usage->size, "unused space exceeds size\n");
+
+	if (!thread) {
+		found->isr++;
+		CHECK(usage->size == CONFIG_ISR_STACK_SIZE,
+		      "wrong interrupt stack size %u\n", usage->size);
+	} else if (thread == (k_tid_t)deep_stack) {
+		found->deep++;
+	} else if (thread == (k_tid_t)shallow_stack) {
+		found->shallow++;
+	} else if (thread == k_current_get()) {
+		found->main++;
+		/* the main thread is running: it must be using some stack */
+		CHECK(usage->unused < usage->size, "main stack unused\n");
+	}
+}
+
+void main(void)
+{
+	struct k_stack_usage deep, shallow;
+	struct found found = { 0 };
+	k_tid_t tid;
+
+	TC_START("Test thread stack usage");
+
+	k_sem_init(&done_sem, 0, 2);
+
+	tid = k_thread_spawn(deep_stack, STACK_SIZE, deep_thread, NULL, NULL,
+			     NULL, PRIORITY, 0, K_NO_WAIT);
+	k_thread_spawn(shallow_stack, STACK_SIZE, shallow_thread, NULL, NULL,
+		       NULL, PRIORITY, 0, K_NO_WAIT);
+
+	/* a thread that has not run yet has only its initial frame used */
+	k_thread_stack_usage_get(tid, &deep);
+	CHECK(deep.size < STACK_SIZE && deep.size > STACK_SIZE - OVERHEAD,
+	      "wrong stack size %u\n", deep.size);
+	CHECK(deep.unused >= deep.size - OVERHEAD,
+	      "unused stack of new thread too small: %u\n", deep.unused);
+
+	k_sem_take(&done_sem, K_FOREVER);
+	k_sem_take(&done_sem, K_FOREVER);
+
+	k_thread_stack_usage_get((k_tid_t)deep_stack, &deep);
+	k_thread_stack_usage_get((k_tid_t)shallow_stack, &shallow);
+
+	CHECK(deep.unused <= deep.size - DEPTH,
+	      "deep thread unused stack too large: %u\n", deep.unused);
+	CHECK(deep.unused >= deep.size - DEPTH - OVERHEAD,
+	      "deep thread unused stack too small: %u\n", deep.unused);
+	CHECK(shallow.unused >= shallow.size - OVERHEAD,
+	      "shallow thread unused stack too small: %u\n", shallow.unused);
+	CHECK(shallow.unused > deep.unused,
+	      "shallow thread used more stack than deep thread\n");
+
+	k_stack_usage_foreach(check_stack, &found);
+	CHECK(found.deep == 1 && found.shallow == 1 && found.main == 1,
+	      "threads not reported\n");
+	CHECK(found.isr == 1, "interrupt stack not reported\n");
+
+	k_stack_usage_print();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
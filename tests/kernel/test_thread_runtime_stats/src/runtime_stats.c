@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests the thread runtime statistics:
+ *  - the running time of the current thread
+ *  - switch and preemption counts, and the last slice of a thread
+ *  - idle time accounting
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+
+#define STACKSIZE 512
+#define HELPER_PRIO (CONFIG_MAIN_THREAD_PRIORITY - 1)
+#define NUM_WAKEUPS 10
+
+#define BUSY_WAIT_US 10000
+#define SLEEP_MS 50
+
+static K_SEM_DEFINE(sem, 0, 1);
+static char __stack helper_stack[STACKSIZE];
+static k_tid_t helper_tid;
+
+static void helper(void *p1, void *p2, void *p3)
+{
+	for (;;) {
+		k_sem_take(&sem, K_FOREVER);
+		k_busy_wait(BUSY_WAIT_US);
+	}
+}
+
+static void test_running_time(void)
+{
+	struct k_thread_runtime_stats before, after;
+	uint32_t elapsed;
+
+	TC_PRINT("Testing running time of the current thread\n");
+
+	k_thread_runtime_stats_get(k_current_get(), &before);
+	k_busy_wait(BUSY_WAIT_US);
+	k_thread_runtime_stats_get(k_current_get(), &after);
+
+	elapsed = (uint32_t)(after.total_cycles - before.total_cycles);
+	CHECK(elapsed >= ms_to_cycles(BUSY_WAIT_US / USEC_PER_MSEC),
+	      "running time too short: %u cycles\n", elapsed);
+	CHECK(after.switches == before.switches,
+	      "thread switched while busy waiting\n");
+}
+
+static void test_switches(void)
+{
+	struct k_thread_runtime_stats main_before, main_after;
+	struct k_thread_runtime_stats helper_before, helper_after;
+	uint32_t elapsed;
+
+	TC_PRINT("Testing switch and preemption counts\n");
+
+	k_thread_runtime_stats_get(k_current_get(), &main_before);
+	k_thread_runtime_stats_get(helper_tid, &helper_before);
+
+	/* the helper preempts us on each give, then pends again */
+	for (int i = 0; i < NUM_WAKEUPS; i++) {
+		k_sem_give(&sem);
+	}
+
+	k_thread_runtime_stats_get(k_current_get(), &main_after);
+	k_thread_runtime_stats_get(helper_tid, &helper_after);
+
+	CHECK(helper_after.switches - helper_before.switches == NUM_WAKEUPS,
+	      "helper switched in %u times, expected %u\n",
+	      helper_after.switches - helper_before.switches, NUM_WAKEUPS);
+	CHECK(helper_after.preemptions == helper_before.preemptions,
+	      "helper preempted while pending\n");
+	CHECK(main_after.preemptions - main_before.preemptions == NUM_WAKEUPS,
+	      "main preempted %u times, expected %u\n",
+	      main_after.preemptions - main_before.preemptions, NUM_WAKEUPS);
+
+	elapsed = (uint32_t)(helper_after.total_cycles -
+			     helper_before.total_cycles);
+	CHECK(elapsed >= NUM_WAKEUPS *
+			 ms_to_cycles(BUSY_WAIT_US / USEC_PER_MSEC),
+	      "helper running time too short: %u cycles\n", elapsed);
+	CHECK(helper_after.last_slice_cycles >=
+	      ms_to_cycles(BUSY_WAIT_US / USEC_PER_MSEC),
+	      "helper last slice too short: %u cycles\n",
+	      helper_after.last_slice_cycles);
+}
+
+static void test_idle_time(void)
+{
+	struct k_sys_runtime_stats before, after;
+	uint32_t total, idle;
+
+	TC_PRINT("Testing idle time accounting\n");
+
+	k_sys_runtime_stats_get(&before);
+	k_sleep(SLEEP_MS);
+	k_sys_runtime_stats_get(&after);
+
+	total = (uint32_t)(after.total_cycles - before.total_cycles);
+	idle = (uint32_t)(after.idle_cycles - before.idle_cycles);
+
+	TC_PRINT("%u idle cycles out of %u\n", idle, total);
+
+	CHECK(idle <= total, "more idle cycles than total cycles\n");
+	CHECK(total >= ms_to_cycles(SLEEP_MS),
+	      "total time too short: %u cycles\n", total);
+
+	/* only the ticks announced while sleeping were not idle */
+	CHECK(idle >= total / 2, "idle time too short: %u cycles\n", idle);
+}
+
+void main(void)
+{
+	TC_START("Test thread runtime statistics");
+
+	helper_tid = k_thread_spawn(helper_stack, STACKSIZE, helper,
+				    NULL, NULL, NULL, HELPER_PRIO, 0, 0);
+
+	test_running_time();
+	test_switches();
+	test_idle_time();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module counts the system timer interrupts per second while a thread
+ * keeps the CPU busy, so that the kernel never idles, and another thread
+ * sleeps periodically. The interrupts are counted in the kernel trace.
+ *
+ * With the tickless kernel, the timer only interrupts for the sleeping
+ * threads' deadlines, far less often than the tick rate; in periodic mode
+ * (prj_periodic.conf), it interrupts on every tick. In both modes, the
+ * uptime must keep following the hardware clock, and the sleeping thread
+ * must wake up on time.
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/kernel_trace.h>
+#include <drivers/system_timer.h>
+
+#define STACK_SIZE 512
+
+#define SLEEPER_PRIO 5
+#define WORKER_PRIO 10
+
+#define TEST_DURATION_MS 1000
+#define SLEEP_MS 100
+#define DRAIN_MS 200
+
+static char __stack sleeper_stack[STACK_SIZE];
+static char __stack worker_stack[STACK_SIZE];
+
+static uint32_t records[CONFIG_KERNEL_TRACE_BUFFER_SIZE];
+
+static volatile int done;
+static volatile int wakeups;
+static volatile uint32_t work;
+
+static void sleeper_thread(void *p1, void *p2, void *p3)
+{
+	while (!done) {
+		k_sleep(SLEEP_MS);
+		wakeups++;
+	}
+}
+
+static void worker_thread(void *p1, void *p2, void *p3)
+{
+	while (!done) {
+		work++;
+	}
+}
+
+/* count the timer interrupts recorded in the trace since the last call */
+static int timer_irqs_count(void)
+{
+	unsigned int vector = _IRQ_TO_INTERRUPT_VECTOR(CONFIG_HPET_TIMER_IRQ);
+	int words = sys_k_trace_read(records, sizeof(records)) / 4;
+	int count = 0;
+
+	for (int i = 0; i < words; ) {
+		uint32_t hdr = records[i];
+		uint32_t len = K_TRACE_HDR_LEN(hdr);
+
+		if (len < 2 || i + len > words) {
+			CHECK(0, "invalid record header 0x%x\n", hdr);
+			break;
+		}
+
+		CHECK(K_TRACE_HDR_TYPE(hdr) != K_TRACE_DROPPED,
+		      "events dropped\n");
+
+		if (K_TRACE_HDR_TYPE(hdr) == K_TRACE_ISR_ENTER &&
+		    K_TRACE_HDR_ARG(hdr) == vector) {
+			count++;
+		}
+
+		i += len;
+	}
+
+	return count;
+}
+
+void main(void)
+{
+	uint32_t start_cycles, elapsed_us;
+	int64_t start, elapsed_ms;
+	int irqs = 0;
+	int irqs_per_sec;
+
+	TC_START("Test tickless kernel");
+
+	k_thread_spawn(sleeper_stack, STACK_SIZE, sleeper_thread, NULL, NULL,
+		       NULL, SLEEPER_PRIO, 0, K_NO_WAIT);
+	k_thread_spawn(worker_stack, STACK_SIZE, worker_thread, NULL, NULL,
+		       NULL, WORKER_PRIO, 0, K_NO_WAIT);
+
+	/* discard the events of the test setup */
+	k_sleep(DRAIN_MS);
+	timer_irqs_count();
+	wakeups = 0;
+
+	start = k_uptime_get();
+	start_cycles = k_cycle_get_32();
+
+	do {
+		k_sleep(DRAIN_MS);
+		irqs += timer_irqs_count();
+		elapsed_ms = k_uptime_get() - start;
+	} while (elapsed_ms < TEST_DURATION_MS);
+
+	elapsed_us = SYS_CLOCK_HW_CYCLES_TO_NS(k_cycle_get_32() -
+					       start_cycles) / 1000;
+	done = 1;
+
+	irqs_per_sec = irqs * 1000 / (int)elapsed_ms;
+
+	TC_PRINT("%d timer interrupts in %d ms (%d per second), "
+		 "tick rate %d Hz\n", irqs, (int)elapsed_ms, irqs_per_sec,
+		 sys_clock_ticks_per_sec);
+	TC_PRINT("sleeping thread woke up %d times, worker looped %u times\n",
+		 wakeups, work);
+
+#ifdef CONFIG_TICKLESS_KERNEL
+	CHECK(irqs_per_sec < sys_clock_ticks_per_sec / 2,
+	      "too many timer interrupts for a tickless kernel\n");
+#else
+	CHECK(irqs_per_sec >= sys_clock_ticks_per_sec * 9 / 10,
+	      "periodic tick interrupts missing\n");
+#endif
+
+	/* the uptime must follow the hardware clock, within two ticks */
+	CHECK(elapsed_us / 1000 + 2 * sys_clock_us_per_tick / 1000 >=
+	      elapsed_ms &&
+	      elapsed_ms + 2 * sys_clock_us_per_tick / 1000 >=
+	      elapsed_us / 1000,
+	      "uptime %d ms drifted from hardware clock %u ms\n",
+	      (int)elapsed_ms, elapsed_us / 1000);
+
+	CHECK(wakeups >= elapsed_ms / SLEEP_MS - 2 &&
+	      wakeups <= elapsed_ms / SLEEP_MS + 1,
+	      "sleeping thread woke up %d times in %d ms\n",
+	      wakeups, (int)elapsed_ms);
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests the accuracy of the high-resolution timers: one-shot
+ * timers and sleeps must never expire early, and must expire well within a
+ * system tick of their deadline on average; periodic timers must not drift.
+ * It also checks that stopping a timer started in cycles works, that tick
+ * based timers keep working alongside high-resolution ones, and that aborting
+ * a sleeping thread cancels its sleep.
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+
+#define NUM_SAMPLES 20
+#define NUM_PERIODS 50
+#define STACK_SIZE 1024
+
+static struct k_timer timer;
+static struct k_timer tick_timer;
+static volatile uint32_t expiry_cycles[NUM_PERIODS];
+static volatile int num_expiries;
+static char __stack sleeper_stack[STACK_SIZE];
+static volatile int sleeper_woken;
+
+static void periodic_expiry(struct k_timer *t)
+{
+	if (num_expiries < NUM_PERIODS) {
+		expiry_cycles[num_expiries] = k_cycle_get_32();
+	}
+	num_expiries++;
+}
+
+static void test_one_shot(uint32_t us)
+{
+	uint32_t duration = k_us_to_cycles(us);
+	uint32_t total_late = 0;
+
+	k_timer_init(&timer, NULL, NULL);
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		uint32_t start = k_cycle_get_32();
+		uint32_t elapsed;
+
+		k_timer_start_cycles(&timer, duration, 0);
+		CHECK(k_timer_status_sync(&timer) == 1,
+		      "one-shot timer did not expire once\n");
+		elapsed = k_cycle_get_32() - start;
+
+		CHECK(elapsed >= duration, "%u us timer expired early: %u\n",
+		      us, elapsed);
+		total_late += elapsed - duration;
+	}
+
+	TC_PRINT("%u us one-shot timer: %u cycles late on average\n",
+		 us, total_late / NUM_SAMPLES);
+	CHECK(total_late / NUM_SAMPLES < sys_clock_hw_cycles_per_tick / 2,
+	      "%u us timer: not sub-tick accurate\n", us);
+}
+
+static void test_sleep(uint32_t us)
+{
+	uint32_t duration = k_us_to_cycles(us);
+	uint32_t total_late = 0;
+
+	for (int i = 0; i < NUM_SAMPLES; i++) {
+		uint32_t start = k_cycle_get_32();
+		uint32_t elapsed;
+
+		k_sleep_cycles(duration);
+		elapsed = k_cycle_get_32() - start;
+
+		CHECK(elapsed >= duration, "%u us sleep ended early: %u\n",
+		      us, elapsed);
+		total_late += elapsed - duration;
+	}
+
+	TC_PRINT("%u us sleep: %u cycles late on average\n",
+		 us, total_late / NUM_SAMPLES);
+	CHECK(total_late / NUM_SAMPLES < sys_clock_hw_cycles_per_tick / 2,
+	      "%u us sleep: not sub-tick accurate\n", us);
+}
+
+static void test_periodic(uint32_t us)
+{
+	uint32_t period = k_us_to_cycles(us);
+	uint32_t mean;
+
+	num_expiries = 0;
+	k_timer_init(&timer, periodic_expiry, NULL);
+	k_timer_start_cycles(&timer, period, period);
+
+	while (num_expiries < NUM_PERIODS) {
+		k_sleep_cycles(period * NUM_PERIODS / 4);
+	}
+	k_timer_stop(&timer);
+
+	mean = (expiry_cycles[NUM_PERIODS - 1] - expiry_cycles[0]) /
+	       (NUM_PERIODS - 1);
+	TC_PRINT("%u us periodic timer: mean period %u cycles (%u)\n",
+		 us, mean, period);
+
+	/* expiries are computed from the previous one: no drift */
+	CHECK(mean >= period - period / 10 && mean <= period + period / 10,
+	      "%u us periodic timer: mean period %u cycles\n", us, mean);
+}
+
+static void test_stop(void)
+{
+	uint32_t period = k_us_to_cycles(500);
+	int count;
+
+	num_expiries = 0;
+	k_timer_init(&timer, periodic_expiry, NULL);
+	k_timer_start_cycles(&timer, period, period);
+	k_sleep_cycles(period * 4);
+	k_timer_stop(&timer);
+
+	count = num_expiries;
+	CHECK(count > 0, "periodic timer did not expire\n");
+	CHECK(k_timer_remaining_get(&timer) == 0,
+	      "stopped timer has time remaining\n");
+
+	k_sleep_cycles(period * 4);
+	CHECK(num_expiries == count, "stopped timer expired again\n");
+	CHECK(k_timer_status_sync(&timer) == 0,
+	      "stopped timer status not reset\n");
+}
+
+static void test_tick_timer(void)
+{
+	k_timer_init(&tick_timer, NULL, NULL);
+	k_timer_init(&timer, NULL, NULL);
+
+	/* a tick based timer expiring while high-resolution ones run */
+	k_timer_start(&tick_timer, 20, 0);
+	k_timer_start_cycles(&timer, k_us_to_cycles(100),
+			     k_us_to_cycles(100));
+
+	CHECK(k_timer_status_sync(&tick_timer) == 1,
+	      "tick timer did not expire\n");
+	CHECK(k_timer_status_get(&timer) > 0,
+	      "high-resolution timer did not expire\n");
+	k_timer_stop(&timer);
+
+	/* restarting in ms cancels the high-resolution timeout */
+	k_timer_start_cycles(&timer, k_us_to_cycles(100), 0);
+	k_timer_start(&timer, 30, 0);
+	k_sleep_cycles(k_us_to_cycles(1000));
+	CHECK(k_timer_status_get(&timer) == 0,
+	      "high-resolution timeout not cancelled\n");
+	CHECK(k_timer_status_sync(&timer) == 1, "timer did not expire\n");
+}
+
+static void sleeper(void *p1, void *p2, void *p3)
+{
+	k_sleep_cycles(k_us_to_cycles(1000));
+	sleeper_woken = 1;
+}
+
+static void test_abort_sleeping(void)
+{
+	k_tid_t tid;
+
+	/* the sleeper preempts this thread, and sleeps */
+	sleeper_woken = 0;
+	tid = k_thread_spawn(sleeper_stack, STACK_SIZE, sleeper, NULL, NULL,
+			     NULL, K_PRIO_COOP(1), 0, 0);
+	k_thread_abort(tid);
+
+	/* past the end of the aborted sleep, which must not wake it */
+	k_sleep_cycles(k_us_to_cycles(3000));
+	CHECK(!sleeper_woken, "aborted thread woken up\n");
+
+	/* the high-resolution timeout queue is still consistent */
+	test_sleep(100);
+}
+
+void main(void)
+{
+	TC_START("Test high-resolution timers");
+
+	TC_PRINT("tick: %d cycles\n", sys_clock_hw_cycles_per_tick);
+
+	test_one_shot(100);
+	test_one_shot(2500);
+	test_sleep(100);
+	test_sleep(2500);
+	test_periodic(200);
+	test_periodic(1000);
+	test_stop();
+	test_tick_timer();
+	test_abort_sleeping();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
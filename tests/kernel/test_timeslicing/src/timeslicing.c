@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests time slicing between preemptible threads of equal
+ * priority:
+ *  - fairness: N busy threads get a similar share of the CPU
+ *  - throughput: slicing does not noticeably reduce the work done
+ *  - bound: a thread never runs for more than a time slice at a time
+ *  - threads above the priority ceiling are not time-sliced
+ *
+ * The busy threads never yield, so without time slicing only the first one
+ * would ever run.
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+
+#define STACKSIZE 512
+#define NUM_THREADS 4
+#define BUSY_PRIO 5
+
+#define SLICE_MS 10
+#define RUN_MS 500
+
+static char __stack stacks[NUM_THREADS][STACKSIZE];
+static k_tid_t tids[NUM_THREADS];
+static volatile uint32_t counts[NUM_THREADS];
+static volatile uint32_t max_runs[NUM_THREADS];
+
+static void busy_thread(void *p1, void *p2, void *p3)
+{
+	volatile uint32_t *count = p1;
+
+	for (;;) {
+		(*count)++;
+	}
+}
+
+/*
+ * Record the longest time the thread ran without being switched out. A gap of
+ * more than a millisecond between two iterations means that another thread
+ * ran in between.
+ */
+static void timed_thread(void *p1, void *p2, void *p3)
+{
+	volatile uint32_t *max_run = p1;
+	uint32_t gap = ms_to_cycles(1);
+	uint32_t start = k_cycle_get_32();
+	uint32_t last = start;
+
+	for (;;) {
+		uint32_t now = k_cycle_get_32();
+
+		if (now - last > gap) {
+			start = now;
+		} else if (now - start > *max_run) {
+			*max_run = now - start;
+		}
+		last = now;
+	}
+}
+
+/*
+ * Run num threads executing entry for RUN_MS, thread i being passed &data[i]
+ * which is first cleared, and return the sum of data. The main thread has a
+ * higher priority than these threads, so it preempts them when it wakes up.
+ */
+static uint32_t run_busy_threads(int num, k_thread_entry_t entry,
+				 volatile uint32_t *data)
+{
+	uint32_t total = 0;
+
+	for (int i = 0; i < num; i++) {
+		data[i] = 0;
+		tids[i] = k_thread_spawn(stacks[i], STACKSIZE, entry,
+					 (void *)&data[i], NULL, NULL,
+					 BUSY_PRIO, 0, 0);
+	}
+
+	k_sleep(RUN_MS);
+
+	for (int i = 0; i < num; i++) {
+		k_thread_abort(tids[i]);
+		total += data[i];
+	}
+
+	return total;
+}
+
+static void test_fairness(uint32_t *total)
+{
+	uint32_t min = UINT32_MAX, max = 0;
+
+	TC_PRINT("Testing fairness between %d busy threads\n", NUM_THREADS);
+
+	k_sched_time_slice_set(SLICE_MS, BUSY_PRIO);
+	*total = run_busy_threads(NUM_THREADS, busy_thread, counts);
+
+	for (int i = 0; i < NUM_THREADS; i++) {
+		TC_PRINT("thread %d: %u\n", i, counts[i]);
+		min = min(min, counts[i]);
+		max = max(max, counts[i]);
+	}
+
+	/* each thread runs for RUN_MS / (NUM_THREADS * SLICE_MS) slices */
+	CHECK(min > 0, "a thread was starved\n");
+	CHECK(min >= max / 2, "unfair sharing: min %u, max %u\n", min, max);
+}
+
+static void test_throughput(uint32_t sliced_total)
+{
+	uint32_t single_total;
+
+	TC_PRINT("Testing throughput\n");
+
+	/* the same work done by a single thread, without any slicing */
+	k_sched_time_slice_set(0, BUSY_PRIO);
+	single_total = run_busy_threads(1, busy_thread, counts);
+
+	TC_PRINT("single thread: %u, %d sliced threads: %u\n",
+		 single_total, NUM_THREADS, sliced_total);
+
+	/* context switches every SLICE_MS must not cost more than 10% */
+	CHECK(sliced_total >= single_total - single_total / 10,
+	      "time slicing reduced throughput too much\n");
+}
+
+static void test_bound(void)
+{
+	uint32_t slice = ms_to_cycles(SLICE_MS);
+	uint32_t max = 0;
+
+	TC_PRINT("Testing the time slice bound\n");
+
+	k_sched_time_slice_set(SLICE_MS, BUSY_PRIO);
+	run_busy_threads(NUM_THREADS, timed_thread, max_runs);
+
+	for (int i = 0; i < NUM_THREADS; i++) {
+		max = max(max, max_runs[i]);
+	}
+
+	TC_PRINT("longest run: %u cycles, time slice: %u cycles\n",
+		 max, slice);
+
+	/* leave room for the interrupt and context switch latencies */
+	CHECK(max > 0, "no thread ran\n");
+	CHECK(max < slice + slice / 2, "thread ran for %u cycles\n", max);
+}
+
+static void test_prio_ceiling(void)
+{
+	TC_PRINT("Testing priority ceiling\n");
+
+	/* the busy threads have a higher priority than the ceiling */
+	k_sched_time_slice_set(SLICE_MS, BUSY_PRIO + 1);
+	run_busy_threads(2, busy_thread, counts);
+
+	TC_PRINT("thread 0: %u, thread 1: %u\n", counts[0], counts[1]);
+
+	CHECK(counts[0] > 0, "first thread did not run\n");
+	CHECK(counts[1] == 0, "thread above the ceiling was time-sliced\n");
+}
+
+void main(void)
+{
+	uint32_t sliced_total;
+
+	TC_START("Test time slicing");
+
+	/* the busy threads must not prevent main from running */
+	k_thread_priority_set(k_current_get(), BUSY_PRIO - 1);
+
+	test_fairness(&sliced_total);
+	test_throughput(sliced_total);
+	test_bound();
+	test_prio_ceiling();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * DESCRIPTION
+ * This module tests workqueue priority classes and workqueues served by
+ * several fibers:
+ *  - work items processed by priority class, then in submission order
+ *  - a fast work item processed while a slow one holds up another fiber
+ */
+
+#include <zephyr.h>
+#include <tc_check.h>
+#include <misc/util.h>
+
+#define STACKSIZE 512
+#define WORKER_PRIO (CONFIG_MAIN_THREAD_PRIORITY + 1)
+
+#define NUM_ITEMS 6
+#define SLOW_DELAY 100
+
+static char __stack stacks[3][STACKSIZE];
+static struct k_work_q work_q;
+static struct k_work_q pool_work_q;
+
+static struct k_work items[NUM_ITEMS];
+static int order[NUM_ITEMS];
+static int num_done;
+
+K_SEM_DEFINE(fast_sem, 0, 1);
+K_SEM_DEFINE(slow_sem, 0, 1);
+
+static void record_handler(struct k_work *work)
+{
+	order[num_done++] = work - items;
+}
+
+static void test_priorities(void)
+{
+	/* item index of each submission, with its priority class */
+	static const int submitted[NUM_ITEMS][2] = {
+		{ 0, 2 }, { 1, 1 }, { 2, 2 }, { 3, 0 }, { 4, 1 }, { 5, 0 },
+	};
+	static const int expected[NUM_ITEMS] = { 3, 5, 1, 4, 0, 2 };
+	int i;
+
+	TC_PRINT("Testing priority classes\n");
+
+	k_work_q_start(&work_q, stacks[0], STACKSIZE, WORKER_PRIO);
+
+	/* the worker has a lower priority: it only runs when main sleeps */
+	for (i = 0; i < NUM_ITEMS; i++) {
+		k_work_init(&items[i], record_handler);
+		k_work_submit_to_queue_prio(&work_q,
+					    &items[submitted[i][0]],
+					    submitted[i][1]);
+	}
+
+	/* a pending item is not queued twice */
+	k_work_submit_to_queue(&work_q, &items[0]);
+
+	k_sleep(10);
+
+	CHECK(num_done == NUM_ITEMS, "%d items processed\n", num_done);
+	for (i = 0; i < NUM_ITEMS; i++) {
+		CHECK(order[i] == expected[i], "item %d processed at %d\n",
+		      order[i], i);
+	}
+}
+
+static void slow_handler(struct k_work *work)
+{
+	k_sleep(SLOW_DELAY);
+	k_sem_give(&slow_sem);
+}
+
+static void fast_handler(struct k_work *work)
+{
+	k_sem_give(&fast_sem);
+}
+
+static void test_pool(void)
+{
+	int rc;
+
+	TC_PRINT("Testing a workqueue with several fibers\n");
+
+	k_work_q_start_pool(&pool_work_q, stacks[1], STACKSIZE, 2,
+			    WORKER_PRIO);
+
+	k_work_init(&items[0], slow_handler);
+	k_work_init(&items[1], fast_handler);
+	k_work_submit_to_queue(&pool_work_q, &items[0]);
+	k_work_submit_to_queue(&pool_work_q, &items[1]);
+
+	rc = k_sem_take(&fast_sem, SLOW_DELAY / 2);
+	CHECK(rc == 0, "fast item held up by slow item\n");
+
+	rc = k_sem_take(&slow_sem, SLOW_DELAY * 2);
+	CHECK(rc == 0, "slow item not processed\n");
+}
+
+void main(void)
+{
+	TC_START("Test workqueue priorities and fiber pools");
+
+	test_priorities();
+	test_pool();
+
+	TC_END_RESULT(tc_rc);
+	TC_END_REPORT(tc_rc);
+}
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ztest.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <float.h>
+#include <math.h>
+#include <time.h>
+#include <misc/util.h>
+
+/*
+ * The minimal libc formatter is checked against the host libc, except for
+ * its own conventions: exponents of at least three digits, "+INF", "-INF"
+ * and "NaN", "%p" printed as "0x" and eight hex digits, and the h length
+ * modifier being ignored.
+ */
+#include <lib/libc/minimal/source/stdout/prf.c>
+
+#define OUT_SIZE 512
+
+struct out_buf {
+	char *p;
+	int left;
+};
+
+static int out_char(int c, void *dest)
+{
+	struct out_buf *out = dest;
+
+	if (out->left > 1) {
+		*out->p++ = c;
+		out->left--;
+	}
+	return c;
+}
+
+static int min_vsnprintf(char *s, int len, const char *fmt, va_list ap)
+{
+	struct out_buf out = { s, len };
+	int r;
+
+	r = _prf(out_char, &out, (char *)fmt, ap);
+	*out.p = '\0';
+	return r;
+}
+
+static int min_snprintf(char *s, int len, const char *fmt, ...)
+{
+	va_list ap;
+	int r;
+
+	va_start(ap, fmt);
+	r = min_vsnprintf(s, len, fmt, ap);
+	va_end(ap);
+	return r;
+}
+
+/* turn the exponents of two digits of the host output into three digits */
+static void widen_exponents(char *s)
+{
+	for (; *s; s++) {
+		if ((*s == 'e' || *s == 'E') && (s[1] == '+' || s[1] == '-') &&
+		    isdigit((int)s[2]) && isdigit((int)s[3]) &&
+		    !isdigit((int)s[4])) {
+			memmove(s + 3, s + 2, strlen(s + 2) + 1);
+			s[2] = '0';
+		}
+	}
+}
+
+static int mismatches;
+
+static void check(const char *fmt, ...)
+{
+	char min_out[OUT_SIZE], host_out[OUT_SIZE];
+	int min_len, host_len;
+	va_list ap, host_ap;
+
+	va_start(ap, fmt);
+	va_copy(host_ap, ap);
+	min_len = min_vsnprintf(min_out, sizeof(min_out), fmt, ap);
+	vsnprintf(host_out, sizeof(host_out), fmt, host_ap);
+	va_end(host_ap);
+	va_end(ap);
+
+	widen_exponents(host_out);
+	host_len = strlen(host_out);
+
+	if (min_len != host_len || strcmp(min_out, host_out) != 0) {
+		if (mismatches++ < 20) {
+			PRINT("\"%s\": got \"%s\" (%d), expected \"%s\" (%d)\n",
+			      fmt, min_out, min_len, host_out, host_len);
+		}
+	}
+}
+
+static void check_literal(const char *expected, const char *fmt, ...)
+{
+	char out[OUT_SIZE];
+	va_list ap;
+	int len;
+
+	va_start(ap, fmt);
+	len = min_vsnprintf(out, sizeof(out), fmt, ap);
+	va_end(ap);
+
+	if (len != strlen(expected) || strcmp(out, expected) != 0) {
+		PRINT("\"%s\": got \"%s\", expected \"%s\"\n", fmt, out,
+		      expected);
+		mismatches++;
+	}
+}
+
+static const char * const int_formats[] = {
+	"%d", "%i", "%u", "%x", "%X", "%o", "%c",
+	"%#x", "%#X", "%#o", "%5d", "%-5d", "%05d", "%+d", "% d", "%+5d",
+	"%-+6d", "%.3d", "%.0d", "%8.3d", "%-8.3x", "%08.3d", "%+.0d",
+	"%#.0o", "%#5o", "%#08x", "%#-8x", "%012u", "%3u", "%lx",
+	"%zu", "[%*d]", "<%-*d>", "%.*d",
+};
+
+static const int int_values[] = {
+	0, 1, -1, 7, 9, 10, 42, 99, 100, 101, -999, 12345, 65535,
+	1000000000, INT_MAX, INT_MIN, (int)0xdeadbeef, (int)0x80000001,
+};
+
+static void test_integers(void)
+{
+	mismatches = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(int_formats); i++) {
+		for (int j = 0; j < ARRAY_SIZE(int_values); j++) {
+			const char *fmt = int_formats[i];
+			int v = int_values[j];
+
+			if (strchr(fmt, '*')) {
+				check(fmt, 7, v);
+				check(fmt, -7, v);
+			} else if (strcmp(fmt, "%c") == 0) {
+				check(fmt, 'A' + (v & 15));
+			} else {
+				check(fmt, v);
+			}
+		}
+	}
+
+	check_literal("0xdeadbeef", "%p", (void *)0xdeadbeef);
+	check_literal("0x00001234", "%p", (void *)0x1234);
+	check_literal("100%", "%d%%", 100);
+
+	assert_equal(mismatches, 0, "integer conversions differ");
+}
+
+static const char * const str_formats[] = {
+	"%s", "%10s", "%-10s", "%.3s", "%10.3s", "%-10.3s", "%.0s", "%.*s",
+	"%c%s%c",
+};
+
+static const char * const str_values[] = {
+	"", "a", "abc", "hello world", "a somewhat longer string",
+};
+
+static void test_strings(void)
+{
+	char long_string[300];
+	char out[OUT_SIZE];
+
+	mismatches = 0;
+
+	for (int i = 0; i < ARRAY_SIZE(str_formats); i++) {
+		for (int j = 0; j < ARRAY_SIZE(str_values); j++) {
+			const char *fmt = str_formats[i];
+
+			if (strchr(fmt, '*')) {
+				check(fmt, 4, str_values[j]);
+			} else if (fmt[1] == 'c') {
+				check(fmt, '<', str_values[j], '>');
+			} else {
+				check(fmt, str_values[j]);
+			}
+		}
+	}
+
+	check("%d %s %u %x %c %%", -5, "text", 17, 255, 'z');
+	check("no conversion");
+
+	/* strings are limited to MAXFLD characters */
+	memset(long_string, 'x', sizeof(long_string) - 1);
+	long_string[sizeof(long_string) - 1] = '\0';
+	assert_equal(min_snprintf(out, sizeof(out), "%s", long_string),
+		     MAXFLD, "string not limited to MAXFLD characters");
+
+	assert_equal(mismatches, 0, "string conversions differ");
+}
+
+static const char * const fixed_formats[] = {
+	"%f", "%.0f", "%.1f", "%.2f", "%.3f", "%.6f", "%.10f", "%#.0f",
+	"%+f", "% f", "%12.4f", "%-12.4f", "%012.3f", "%+012.3f",
+};
+
+static const char * const exp_formats[] = {
+	"%e", "%E", "%.0e", "%.1e", "%.3e", "%.10e", "%.14e", "%.16e",
+	"%#.0e", "%+e", "% E",
+	"%g", "%G", "%.0g", "%.1g", "%.2g", "%.3g", "%.10g", "%.15g",
+	"%.17g", "%#g", "%#.3g", "%+g",
+};
+
+static const double float_values[] = {
+	0.0, -0.0, 1.0, -1.0, 0.5, 1.5, 2.5, -2.5, 0.125, 0.375, 9.5,
+	0.05, 0.15, 0.25, 0.35, 1.005, 9.995, 99.95, 999.5, 1013.25,
+	0.1, 0.2, 0.3, 1.0 / 3, 2.0 / 3, 3.14159265358979, 2.718281828459045,
+	23.45, -40.0, 36.6, 123456.0, 999999.0, 999999.5, 0.000123,
+	0.00001, 9.9999e-5, 1e-7, 0.0006, 0.00049,
+	1234567.0, 1e15, 1e16, 1e17, 1e21, 1e22, 1e23, 9007199254740993.0,
+	1e100, 1e-100, 1.7976931348623157e308, 2.2250738585072014e-308,
+	4.9406564584124654e-324, 1e-310, 6.02214076e23, 1.602176634e-19,
+};
+
+static void test_floats(void)
+{
+	mismatches = 0;
+
+	for (int j = 0; j < ARRAY_SIZE(float_values); j++) {
+		double v = float_values[j];
+
+		/* %f only prints 17 significant digits */
+		if (fabs(v) < 1e6) {
+			for (int i = 0; i < ARRAY_SIZE(fixed_formats); i++) {
+				check(fixed_formats[i], v);
+			}
+		}
+
+		for (int i = 0; i < ARRAY_SIZE(exp_formats); i++) {
+			/*
+			 * glibc drops the trailing zeros of %#g when rounding
+			 * carries into a new digit, e.g. "1.e+03" for 999.5
+			 */
+			if (strstr(exp_formats[i], "#") && (v == 999.5 ||
+							    v == 999999.5)) {
+				continue;
+			}
+			check(exp_formats[i], v);
+		}
+	}
+
+	check_literal("+INF", "%f", INFINITY);
+	check_literal("-INF", "%e", -INFINITY);
+	check_literal("NaN", "%g", NAN);
+	check_literal("  +INF", "%06f", INFINITY);
+	check_literal("1.234000e+003", "%e", 1234.0);
+	check_literal("1.234E+009", "%G", 1234000000.0);
+	check_literal("     -1.500e+000", "%16.3e", -1.5);
+	check_literal("1.500e-003      ", "%-16.3e", 0.0015);
+	check_literal("+00001.500e+100", "%+015.3e", 1.5e100);
+	check_literal("    1.235e+005", "%14.4g", 123456.0);
+	check_literal("1.00e+003", "%#.3g", 999.5);
+	check_literal("100000000000000000000.000", "%.3f", 1e20);
+	check_literal("2e+001", "%.0e", 25.0);
+	check_literal("-3.3467063575757588e+184", "%.16e",
+		      -3.3467063575757588e+184);
+
+	assert_equal(mismatches, 0, "floating point conversions differ");
+}
+
+/* a xorshift generator, for repeatable random doubles */
+static uint64_t random_state = 0x9e3779b97f4a7c15ull;
+
+static uint64_t random64(void)
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+#define RANDOM_VALUES 20000
+
+static void test_floats_random(void)
+{
+	char fmt[16];
+
+	mismatches = 0;
+
+	for (int j = 0; j < RANDOM_VALUES; j++) {
+		union {
+			double d;
+			uint64_t i;
+		} u;
+		int precision = j % 17;
+
+		u.i = random64();
+		if (isnan(u.d) || isinf(u.d)) {
+			continue;
+		}
+
+		/* up to 17 significant digits, correctly rounded */
+		sprintf(fmt, "%%.%de", precision);
+		check(fmt, u.d);
+		sprintf(fmt, "%%.%dg", precision + 1);
+		check(fmt, u.d);
+
+		/* and values between 2^-12 and 2^20 for %f */
+		u.i &= ~(0x7ffull << 52);
+		u.i |= (uint64_t)(1023 + j % 32 - 12) << 52;
+		sprintf(fmt, "%%.%df", precision % 6);
+		check(fmt, u.d);
+	}
+
+	assert_equal(mismatches, 0, "floating point conversions differ");
+}
+
+/*
+ * Host microbenchmark: not a pass/fail test, but gives a quick way to compare
+ * changes to the formatter without a target. Numbers are in nanoseconds per
+ * call, next to the host libc for reference.
+ */
+
+#define BENCH_CALLS 100000
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#define BENCH(name, ...) \
+	do { \
+		char out[OUT_SIZE]; \
+		uint64_t start = now_ns(); \
+		uint32_t min_ns, host_ns; \
+		for (int i = 0; i < BENCH_CALLS; i++) { \
+			min_snprintf(out, sizeof(out), __VA_ARGS__); \
+		} \
+		min_ns = (now_ns() - start) / BENCH_CALLS; \
+		start = now_ns(); \
+		for (int i = 0; i < BENCH_CALLS; i++) { \
+			snprintf(out, sizeof(out), __VA_ARGS__); \
+		} \
+		host_ns = (now_ns() - start) / BENCH_CALLS; \
+		PRINT("%-28s | %8u %8u\n", name, min_ns, host_ns); \
+	} while (0)
+
+static void test_benchmark(void)
+{
+	volatile int n = 1234567;
+	volatile double temperature = 23.4567, pressure = 101325.25;
+
+	PRINT("%-28s | %8s %8s\n", "format", "prf", "host");
+
+	BENCH("%d", "%d", n);
+	BENCH("%u (small)", "%u", n % 100);
+	BENCH("%08x", "%08x", n);
+	BENCH("%s", "%s", "string argument");
+	BENCH("%.2f", "%.2f", temperature);
+	BENCH("%f (large)", "%f", pressure * 1e6);
+	BENCH("%e", "%e", pressure);
+	BENCH("%g (small)", "%g", temperature * 1e-20);
+	BENCH("JSON object", "{\"id\":%u,\"temp\":%.2f,\"name\":\"%s\"}",
+	      n, temperature, "sensor");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(prf_test,
+		ztest_unit_test(test_integers),
+		ztest_unit_test(test_strings),
+		ztest_unit_test(test_floats),
+		ztest_unit_test(test_floats_random),
+		ztest_unit_test(test_benchmark)
+	);
+
+	ztest_run_test_suite(prf_test);
+}
@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <time.h>
+#include <misc/util.h>
+
+/*
+ * Build the minimal libc string routines under their own names, so that they
+ * can be checked against, and timed along with, the ones of the host libc.
+ */
+#define _Restrict __restrict
+#define strcpy min_strcpy
+#define strncpy min_strncpy
+#define strchr min_strchr
+#define strrchr min_strrchr
+#define strlen min_strlen
+#define strcmp min_strcmp
+#define strncmp min_strncmp
+#define strcat min_strcat
+#define strncat min_strncat
+#define memcmp min_memcmp
+#define memmove min_memmove
+#define memcpy min_memcpy
+#define memset min_memset
+#define memchr min_memchr
+
+#ifdef STRING_TEST_GENERIC
+/* build the portable C paths instead of the x86 ones */
+#undef CONFIG_X86
+#endif
+
+#include <lib/libc/minimal/source/string/string.c>
+
+#undef memcmp
+#undef memmove
+#undef memcpy
+#undef memset
+
+#define BUF_SIZE 8192
+/* all the offsets within a word, on both sides of a copy */
+#define MAX_ALIGN 4
+
+/* margin around the copies, to catch writes out of the destination */
+#define GUARD 64
+
+static unsigned char buf[BUF_SIZE];
+static unsigned char expected[BUF_SIZE];
+static unsigned char pattern[BUF_SIZE];
+
+static const size_t large_sizes[] = {
+	127, 128, 129, 255, 256, 257, 511, 512, 1023, 1024, 1025,
+	2047, 2048, 4095, 4096,
+};
+
+static void fill_buffers(void)
+{
+	for (int i = 0; i < BUF_SIZE; i++) {
+		buf[i] = (unsigned char)(i * 7 + 3);
+		expected[i] = buf[i];
+	}
+}
+
+/* reference copy, correct for any overlap */
+static void ref_move(unsigned char *d, const unsigned char *s, size_t n)
+{
+	static unsigned char tmp[BUF_SIZE];
+
+	for (size_t i = 0; i < n; i++) {
+		tmp[i] = s[i];
+	}
+
+	for (size_t i = 0; i < n; i++) {
+		d[i] = tmp[i];
+	}
+}
+
+/* run <fn> for sizes 0 to 128, and a set of larger sizes up to 4 KiB */
+static void for_each_size(void (*fn)(size_t n))
+{
+	for (size_t n = 0; n <= 128; n++) {
+		fn(n);
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(large_sizes); i++) {
+		fn(large_sizes[i]);
+	}
+}
+
+static void check_memcpy(size_t n)
+{
+	for (int d_off = 0; d_off < MAX_ALIGN; d_off++) {
+		for (int s_off = 0; s_off < MAX_ALIGN; s_off++) {
+			unsigned char *d = buf + GUARD + d_off;
+			void *rv;
+
+			fill_buffers();
+			rv = min_memcpy(d, pattern + GUARD + s_off, n);
+			ref_move(expected + GUARD + d_off,
+				 pattern + GUARD + s_off, n);
+
+			assert_equal_ptr(rv, d, "memcpy() return value");
+			assert_true(memcmp(buf, expected, BUF_SIZE) == 0,
+				    "memcpy() result");
+		}
+	}
+}
+
+static void test_memcpy(void)
+{
+	for_each_size(check_memcpy);
+}
+
+static void check_memmove(size_t n)
+{
+	unsigned char *base = buf + BUF_SIZE / 4;
+
+	for (int d_off = 0; d_off < MAX_ALIGN; d_off++) {
+		for (int s_off = 0; s_off < MAX_ALIGN; s_off++) {
+			/* overlapping both ways, and disjoint */
+			for (int dist = -5; dist <= 5; dist++) {
+				unsigned char *d = base + d_off + dist;
+				void *rv;
+
+				fill_buffers();
+				rv = min_memmove(d, base + s_off, n);
+				ref_move(d - buf + expected,
+					 base - buf + expected + s_off, n);
+
+				assert_equal_ptr(rv, d,
+						 "memmove() return value");
+				assert_true(memcmp(buf, expected,
+						   BUF_SIZE) == 0,
+					    "memmove() result");
+			}
+		}
+	}
+}
+
+static void test_memmove(void)
+{
+	for_each_size(check_memmove);
+}
+
+static void test_memmove_far(void)
+{
+	unsigned char *base = buf + BUF_SIZE / 2 - 1;
+
+	for (int dist = -700; dist <= 700; dist += 37) {
+		fill_buffers();
+		min_memmove(base + dist, base, 2048);
+		ref_move(expected + (base - buf) + dist,
+			 expected + (base - buf), 2048);
+
+		assert_true(memcmp(buf, expected, BUF_SIZE) == 0,
+			    "memmove() result");
+	}
+}
+
+static void check_memset(size_t n)
+{
+	for (int d_off = 0; d_off < MAX_ALIGN; d_off++) {
+		unsigned char *d = buf + GUARD + d_off;
+		void *rv;
+
+		fill_buffers();
+		rv = min_memset(d, 0x1a5, n);
+
+		for (size_t i = 0; i < n; i++) {
+			expected[GUARD + d_off + i] = 0xa5;
+		}
+
+		assert_equal_ptr(rv, d, "memset() return value");
+		assert_true(memcmp(buf, expected, BUF_SIZE) == 0,
+			    "memset() result");
+	}
+}
+
+static void test_memset(void)
+{
+	for_each_size(check_memset);
+}
+
+/*
+ * Host microbenchmark: not a pass/fail test, but gives a quick way to compare
+ * changes to the routines without a target. Numbers are in nanoseconds per
+ * call, next to the host libc for reference.
+ */
+
+#define BENCH_BYTES (64 * 1024)
+
+static const size_t bench_sizes[] = { 1, 4, 16, 64, 256, 1024, 4096 };
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+typedef void *(*copy_fn_t)(void *d, const void *s, size_t n);
+
+static uint32_t bench_copy(copy_fn_t fn, size_t n, int d_off, int s_off)
+{
+	int iterations = BENCH_BYTES / n;
+	uint64_t start = now_ns();
+
+	for (int i = 0; i < iterations; i++) {
+		fn(buf + GUARD + d_off, pattern + GUARD + s_off, n);
+	}
+
+	return (uint32_t)((now_ns() - start) / iterations);
+}
+
+static uint32_t bench_memset(void *(*fn)(void *, int, size_t), size_t n,
+			     int d_off)
+{
+	int iterations = BENCH_BYTES / n;
+	uint64_t start = now_ns();
+
+	for (int i = 0; i < iterations; i++) {
+		fn(buf + GUARD + d_off, i, n);
+	}
+
+	return (uint32_t)((now_ns() - start) / iterations);
+}
+
+static void *host_memcpy(void *d, const void *s, size_t n)
+{
+	return memcpy(d, s, n);
+}
+
+static void *host_memmove(void *d, const void *s, size_t n)
+{
+	return memmove(d, s, n);
+}
+
+static void *host_memset(void *d, int c, size_t n)
+{
+	return memset(d, c, n);
+}
+
+static void test_benchmark(void)
+{
+	PRINT("%6s %5s | %8s %8s | %8s %8s | %8s %8s\n", "size", "align",
+	      "memcpy", "host", "memmove", "host", "memset", "host");
+
+	for (int i = 0; i < ARRAY_SIZE(bench_sizes); i++) {
+		size_t n = bench_sizes[i];
+
+		for (int d_off = 0; d_off < 4; d_off++) {
+			for (int s_off = 0; s_off < 4; s_off++) {
+				PRINT("%6zu   %d/%d | %8u %8u | %8u %8u |",
+				      n, d_off, s_off,
+				      bench_copy(min_memcpy, n, d_off, s_off),
+				      bench_copy(host_memcpy, n, d_off, s_off),
+				      bench_copy(min_memmove, n, d_off, s_off),
+				      bench_copy(host_memmove, n, d_off,
+						 s_off));
+
+				if (s_off == 0) {
+					PRINT(" %8u %8u\n",
+					      bench_memset(min_memset, n, d_off),
+					      bench_memset(host_memset, n,
+							   d_off));
+				} else {
+					PRINT("\n");
+				}
+			}
+		}
+	}
+}
+
+void test_main(void)
+{
+	for (int i = 0; i < BUF_SIZE; i++) {
+		pattern[i] = (unsigned char)(i * 13 + 1);
+	}
+
+	ztest_test_suite(string_test,
+		ztest_unit_test(test_memcpy),
+		ztest_unit_test(test_memmove),
+		ztest_unit_test(test_memmove_far),
+		ztest_unit_test(test_memset),
+		ztest_unit_test(test_benchmark)
+	);
+
+	ztest_run_test_suite(string_test);
+}
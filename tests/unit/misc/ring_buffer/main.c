@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2016 Wind River Systems, Inc.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ztest.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#include <misc/ring_buffer.c>
+
+/* items and bytes passed between the producer and consumer threads */
+#define NUM_ITEMS (256 * 1024)
+#define NUM_BYTES (4 * 1024 * 1024)
+
+#define ITEM_TYPE 0x1234
+#define MAX_ITEM_SIZE32 7
+
+SYS_RING_BUF_DECLARE_POW2(pow2_buf, 6);
+SYS_RING_BUF_DECLARE_SIZE(odd_buf, 37);
+
+/* content of the byte stream at a given offset */
+static inline uint8_t stream_byte(uint32_t offset)
+{
+	return (offset * 7) ^ (offset >> 8);
+}
+
+static double elapsed(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) +
+	       (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void check_bytes_single(struct ring_buf *buf)
+{
+	uint32_t capacity = buf->size * sizeof(uint32_t) - 1;
+	uint32_t put = 0, got = 0;
+	uint8_t data[64];
+	uint8_t *p;
+	uint32_t len;
+
+	sys_ring_buf_init(buf, buf->size, buf->buf);
+
+	assert_equal(sys_ring_buf_byte_get_claim(buf, &p, 1), 0,
+		     "claimed data in an empty buffer");
+	assert_equal(sys_ring_buf_byte_get_finish(buf, 1), -EINVAL,
+		     "released data from an empty buffer");
+
+	/* fill the buffer completely, then check it is full */
+	while (put < capacity) {
+		for (len = 0; len < sizeof(data); len++) {
+			data[len] = stream_byte(put + len);
+		}
+		put += sys_ring_buf_byte_put(buf, data, sizeof(data));
+	}
+	assert_equal(put, capacity, "wrong buffer capacity");
+	assert_equal(sys_ring_buf_byte_put_claim(buf, &p, 1), 0,
+		     "claimed space in a full buffer");
+	assert_equal(sys_ring_buf_byte_put_finish(buf, 1), -EINVAL,
+		     "committed bytes to a full buffer");
+
+	/* move the data around the buffer a few times, in odd sizes */
+	for (int i = 0; i < 1000; i++) {
+		uint32_t size = i % 23 + 1;
+
+		len = sys_ring_buf_byte_get(buf, data, size);
+		for (uint32_t j = 0; j < len; j++) {
+			assert_equal(data[j], stream_byte(got + j),
+				     "corrupted byte");
+		}
+		got += len;
+
+		for (len = 0; len < size; len++) {
+			data[len] = stream_byte(put + len);
+		}
+		len = sys_ring_buf_byte_put(buf, data, size);
+		assert_equal(len, size, "free space not available");
+		put += len;
+	}
+
+	/* drain the buffer with claims */
+	while ((len = sys_ring_buf_byte_get_claim(buf, &p, 1000)) != 0) {
+		for (uint32_t j = 0; j < len; j++) {
+			assert_equal(p[j], stream_byte(got + j),
+				     "corrupted byte");
+		}
+		assert_equal(sys_ring_buf_byte_get_finish(buf, len), 0,
+			     "could not release claimed data");
+		got += len;
+	}
+
+	assert_equal(got, put, "bytes lost");
+	assert_true(sys_ring_buf_is_empty(buf), "buffer not empty");
+}
+
+static void test_bytes_single(void)
+{
+	check_bytes_single(&pow2_buf);
+	check_bytes_single(&odd_buf);
+}
+
+static void *item_producer(void *arg)
+{
+	struct ring_buf *buf = arg;
+	uint32_t data[MAX_ITEM_SIZE32];
+
+	for (uint32_t seq = 0; seq < NUM_ITEMS; seq++) {
+		uint8_t size32 = seq % (MAX_ITEM_SIZE32 + 1);
+
+		for (int i = 0; i < size32; i++) {
+			data[i] = seq + i;
+		}
+
+		while (sys_ring_buf_put(buf, ITEM_TYPE, seq & 0xff, data,
+					size32) != 0) {
+			sched_yield();
+		}
+	}
+
+	return NULL;
+}
+
+static void check_items_spsc(struct ring_buf *buf)
+{
+	uint32_t data[MAX_ITEM_SIZE32];
+	struct timespec start;
+	pthread_t producer;
+	uint32_t seq = 0;
+
+	sys_ring_buf_init(buf, buf->size, buf->buf);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&producer, NULL, item_producer, buf);
+
+	while (seq < NUM_ITEMS) {
+		uint8_t size32 = ARRAY_SIZE(data);
+		uint16_t type;
+		uint8_t value;
+
+		if (sys_ring_buf_get(buf, &type, &value, data,
+				     &size32) != 0) {
+			sched_yield();
+			continue;
+		}
+
+		assert_equal(type, ITEM_TYPE, "corrupted type");
+		assert_equal(value, seq & 0xff, "corrupted value");
+		assert_equal(size32, seq % (MAX_ITEM_SIZE32 + 1),
+			     "corrupted size");
+		for (int i = 0; i < size32; i++) {
+			assert_equal(data[i], seq + i, "corrupted data");
+		}
+		seq++;
+	}
+
+	pthread_join(producer, NULL);
+
+	assert_true(sys_ring_buf_is_empty(buf), "buffer not empty");
+	PRINT("%u words buffer: %.0f items/s\n", buf->size,
+	      NUM_ITEMS / elapsed(&start));
+}
+
+static void test_items_spsc(void)
+{
+	check_items_spsc(&pow2_buf);
+	check_items_spsc(&odd_buf);
+}
+
+/* the producer writes in place half of the time, and copies otherwise */
+static void *byte_producer(void *arg)
+{
+	struct ring_buf *buf = arg;
+	uint8_t data[MAX_ITEM_SIZE32 * 4];
+	uint32_t put = 0;
+
+	while (put < NUM_BYTES) {
+		uint32_t size = min(put % 29 + 1, NUM_BYTES - put);
+		uint32_t len;
+
+		if (put & 1) {
+			uint8_t *p;
+
+			len = sys_ring_buf_byte_put_claim(buf, &p, size);
+			for (uint32_t i = 0; i < len; i++) {
+				p[i] = stream_byte(put + i);
+			}
+			sys_ring_buf_byte_put_finish(buf, len);
+		} else {
+			for (uint32_t i = 0; i < size; i++) {
+				data[i] = stream_byte(put + i);
+			}
+			len = sys_ring_buf_byte_put(buf, data, size);
+		}
+
+		if (!len) {
+			sched_yield();
+		}
+		put += len;
+	}
+
+	return NULL;
+}
+
+static void check_bytes_spsc(struct ring_buf *buf)
+{
+	struct timespec start;
+	pthread_t producer;
+	uint32_t got = 0;
+
+	sys_ring_buf_init(buf, buf->size, buf->buf);
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&producer, NULL, byte_producer, buf);
+
+	while (got < NUM_BYTES) {
+		uint8_t *p;
+		uint32_t len;
+
+		len = sys_ring_buf_byte_get_claim(buf, &p, NUM_BYTES);
+		if (!len) {
+			sched_yield();
+			continue;
+		}
+
+		for (uint32_t i = 0; i < len; i++) {
+			assert_equal(p[i], stream_byte(got + i),
+				     "corrupted byte");
+		}
+		sys_ring_buf_byte_get_finish(buf, len);
+		got += len;
+	}
+
+	pthread_join(producer, NULL);
+
+	assert_true(sys_ring_buf_is_empty(buf), "buffer not empty");
+	PRINT("%u bytes buffer: %.1f MB/s\n", buf->size * 4,
+	      NUM_BYTES / elapsed(&start) / 1e6);
+}
+
+static void test_bytes_spsc(void)
+{
+	check_bytes_spsc(&pow2_buf);
+	check_bytes_spsc(&odd_buf);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(ring_buffer_test,
+		ztest_unit_test(test_bytes_single),
+		ztest_unit_test(test_items_spsc),
+		ztest_unit_test(test_bytes_spsc)
+	);
+
+	ztest_run_test_suite(ring_buffer_test);
+}